@@ -0,0 +1,205 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <sstream>
+#include <cstdlib>
+
+#include "benchmark_sketches.h"
+
+using namespace std;
+
+// size copies of a closed profile with two lines, a tangent arc, and five dimensional constraints
+static void GenerateCopies(BenchmarkSketch &benchmark, int size)
+{
+	Sketch &sketch = benchmark.GetSketch();
+	for(int i = 0; i < size; i++)
+	{
+		Point2DPointer point1 = sketch.AddPoint2D(0.0,0.0,false,false);
+		Point2DPointer point2 = sketch.AddPoint2D(10.0,0.0,true,false);
+		Point2DPointer point3 = sketch.AddPoint2D(10.0,10.0,true,true);
+		Arc2DPointer arc1 = sketch.AddArc2D(1.5,6.0,(mmcPI/2.0)*.8,(mmcPI)*1.2,2.0,true,true,true,true,false);
+
+		Line2DPointer line1 = sketch.AddLine2D(point1,point2);
+		Line2DPointer line2 = sketch.AddLine2D(point2,point3);
+		Line2DPointer line3 = sketch.AddLine2D(point3,arc1->GetPoint1());
+		Line2DPointer line4 = sketch.AddLine2D(arc1->GetPoint2(),point1);
+
+		sketch.AddDistancePoint2D(point1,point2,6.0);
+		sketch.AddDistancePoint2D(point2,point3,12.0);
+		sketch.AddParallelLine2D(line1,line3);
+		sketch.AddParallelLine2D(line2,line4);
+		sketch.AddAngleLine2D(line1,line2,mmcPI/2.0,false);
+		sketch.AddTangentEdge2D(line3,Point2,arc1,Point1);
+		sketch.AddTangentEdge2D(line4,Point1,arc1,Point2);
+	}
+}
+
+// a staircase of size alternating horizontal and vertical segments with a length constraint on each, forms one cluster
+static void GenerateChain(BenchmarkSketch &benchmark, int size)
+{
+	Sketch &sketch = benchmark.GetSketch();
+	const double length = 10.0;
+
+	Point2DPointer previous_point = sketch.AddPoint2D(0.0,0.0,false,false);
+	for(int i = 0; i < size; i++)
+	{
+		bool vertical = (i % 2 == 1);
+		double s = previous_point->GetSDOF()->GetValue() + (vertical ? 0.0 : length);
+		double t = previous_point->GetTDOF()->GetValue() + (vertical ? length : 0.0);
+
+		Point2DPointer point = sketch.AddPoint2D(s,t,true,true);
+		Line2DPointer line = sketch.AddLine2D(previous_point,point);
+		sketch.AddHoriVertLine2D(line,vertical);
+		sketch.AddDistancePoint2D(previous_point,point,length);
+
+		benchmark.AddPerturbedPoint(point);
+		previous_point = point;
+	}
+}
+
+// a (size+1)x(size+1) grid of points connected by horizontal and vertical lines with length constraints (over-constrained but consistent)
+static void GenerateGrid(BenchmarkSketch &benchmark, int size)
+{
+	Sketch &sketch = benchmark.GetSketch();
+	const double spacing = 10.0;
+
+	std::vector<Point2DPointer> points;
+	for(int row = 0; row <= size; row++)
+		for(int col = 0; col <= size; col++)
+		{
+			bool free = (row != 0 || col != 0);
+			points.push_back(sketch.AddPoint2D(col*spacing,row*spacing,free,free));
+			benchmark.AddPerturbedPoint(points.back());
+		}
+
+	for(int row = 0; row <= size; row++)
+		for(int col = 0; col <= size; col++)
+		{
+			Point2DPointer point = points[row*(size+1) + col];
+			if(col < size)
+			{
+				Point2DPointer right = points[row*(size+1) + col + 1];
+				sketch.AddHoriVertLine2D(sketch.AddLine2D(point,right),false);
+				sketch.AddDistancePoint2D(point,right,spacing);
+			}
+			if(row < size)
+			{
+				Point2DPointer up = points[(row+1)*(size+1) + col];
+				sketch.AddHoriVertLine2D(sketch.AddLine2D(point,up),true);
+				sketch.AddDistancePoint2D(point,up,spacing);
+			}
+		}
+}
+
+// a polygon with size sides and rounded corners, each side is tangent to the arcs at both of its ends
+static void GenerateTangentLoop(BenchmarkSketch &benchmark, int size)
+{
+	Sketch &sketch = benchmark.GetSketch();
+	if(size < 3)
+		size = 3;
+
+	const double corner_distance = 10.0*size/mmcPI;  // distance from the origin to the arc centers
+	const double radius = 2.0;
+	const double half_angle = mmcPI/size;
+	const double side_length = 2.0*corner_distance*sin(half_angle);
+
+	std::vector<Arc2DPointer> arcs;
+	for(int i = 0; i < size; i++)
+	{
+		double phi = 2.0*mmcPI*i/size;
+		bool free = (i != 0);
+		arcs.push_back(sketch.AddArc2D(corner_distance*cos(phi),corner_distance*sin(phi),phi-half_angle,phi+half_angle,radius,free,free,true,true,false));
+		benchmark.AddPerturbedDOF(arcs.back()->GetSCenter());
+		benchmark.AddPerturbedDOF(arcs.back()->GetTCenter());
+	}
+
+	for(int i = 0; i < size; i++)
+	{
+		Arc2DPointer arc = arcs[i];
+		Arc2DPointer next_arc = arcs[(i+1) % size];
+
+		Line2DPointer line = sketch.AddLine2D(arc->GetPoint2(),next_arc->GetPoint1());
+		sketch.AddTangentEdge2D(line,Point1,arc,Point2);
+		sketch.AddTangentEdge2D(line,Point2,next_arc,Point1);
+		sketch.AddDistancePoint2D(arc->GetPoint2(),next_arc->GetPoint1(),side_length);
+	}
+}
+
+// size independent cells, each with a rectangle, a point dimensioned to two of its edges, and an angled line
+static void GenerateMixed(BenchmarkSketch &benchmark, int size)
+{
+	Sketch &sketch = benchmark.GetSketch();
+
+	for(int i = 0; i < size; i++)
+	{
+		double offset = 40.0*i;
+
+		Point2DPointer a = sketch.AddPoint2D(offset,0.0,false,false);
+		Point2DPointer b = sketch.AddPoint2D(offset+20.0,0.0,true,true);
+		Point2DPointer c = sketch.AddPoint2D(offset+20.0,10.0,true,true);
+		Point2DPointer d = sketch.AddPoint2D(offset,10.0,true,true);
+		Point2DPointer e = sketch.AddPoint2D(offset+5.0,4.0,true,true);
+		Point2DPointer f = sketch.AddPoint2D(offset+8.0,6.0,true,true);
+
+		Line2DPointer ab = sketch.AddLine2D(a,b);
+		Line2DPointer bc = sketch.AddLine2D(b,c);
+		Line2DPointer cd = sketch.AddLine2D(c,d);
+		Line2DPointer da = sketch.AddLine2D(d,a);
+		Line2DPointer af = sketch.AddLine2D(a,f);
+
+		sketch.AddHoriVertLine2D(ab,false);
+		sketch.AddHoriVertLine2D(bc,true);
+		sketch.AddParallelLine2D(cd,ab);
+		sketch.AddParallelLine2D(da,bc);
+		sketch.AddDistancePoint2D(a,b,20.0);
+		sketch.AddDistancePoint2D(b,c,10.0);
+		sketch.AddDistancePointLine2D(e,ab);
+		sketch.AddDistancePointLine2D(e,da);
+		sketch.AddAngleLine2D(ab,af,false);
+		sketch.AddDistancePoint2D(a,f);
+
+		benchmark.AddPerturbedPoint(b);
+		benchmark.AddPerturbedPoint(c);
+		benchmark.AddPerturbedPoint(d);
+		benchmark.AddPerturbedPoint(e);
+		benchmark.AddPerturbedPoint(f);
+	}
+}
+
+const BenchmarkScenario benchmark_scenarios[] = {
+	{"copies", GenerateCopies, "1,10,100,1000", 0.0},  // the profile does not start at a solution, no perturbation is needed
+	{"chain", GenerateChain, "10,100,1000", 1.0},
+	{"grid", GenerateGrid, "3,10,20", 1.0},
+	{"tangent_loop", GenerateTangentLoop, "4,16,64", 0.5},
+	{"mixed", GenerateMixed, "1,10,100", 1.0}
+};
+const int num_benchmark_scenarios = sizeof(benchmark_scenarios)/sizeof(benchmark_scenarios[0]);
+
+std::vector<int> ParseSizes(const std::string &size_list)
+{
+	std::vector<int> sizes;
+	stringstream stream(size_list);
+	std::string item;
+	while(getline(stream, item, ','))
+		if(atoi(item.c_str()) > 0)
+			sizes.push_back(atoi(item.c_str()));
+	return sizes;
+}
@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Parameterized sketches shared by the benchmarks
+
+#ifndef benchmark_sketchesH
+#define benchmark_sketchesH
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "../ConstraintSolver/Sketch.h"
+
+// sketch that gives the benchmarks access to all of its constraint equations
+class BenchmarkModel : public Sketch
+{
+public:
+	BenchmarkModel(VectorPointer normal, VectorPointer up, PointPointer base) : Sketch(normal, up, base) {;}
+
+	const std::map<unsigned,ConstraintEquationBasePointer> & GetConstraintEquationList() const {return constraint_equation_list_;}
+};
+
+// A generated sketch along with the independent DOF's that are perturbed away from the solution before solving
+class BenchmarkSketch
+{
+public:
+	BenchmarkSketch()
+	{
+		VectorPointer normal(new Vector(0.0,0.0,1.0));
+		VectorPointer up(new Vector(0.0,1.0,0.0));
+		PointPointer base(new Point(0.0,0.0,0.0));
+		sketch_.reset(new BenchmarkModel(normal, up, base));
+	}
+
+	BenchmarkModel & GetSketch() {return *sketch_;}
+
+	void AddPerturbedDOF(DOFPointer dof) {if(dof->IsFree()) perturbed_dofs_.push_back(dof);}
+	void AddPerturbedPoint(Point2DPointer point) {AddPerturbedDOF(point->GetSDOF()); AddPerturbedDOF(point->GetTDOF());}
+
+	// moves each free DOF a random amount, the sketch starts at an exact solution so this creates the work for the solver
+	void Perturb(double magnitude)
+	{
+		for(unsigned i = 0; i < perturbed_dofs_.size(); i++)
+			perturbed_dofs_[i]->SetValue(perturbed_dofs_[i]->GetValue() + magnitude*(2.0*rand()/(double)RAND_MAX - 1.0));
+	}
+
+	unsigned GetNumFreeDOFs() const {return perturbed_dofs_.size();}
+
+private:
+	boost::shared_ptr<BenchmarkModel> sketch_;
+	std::vector<DOFPointer> perturbed_dofs_;
+};
+
+struct BenchmarkScenario
+{
+	const char *name;
+	void (*generator)(BenchmarkSketch &benchmark, int size);
+	const char *default_sizes;
+	double perturbation;
+};
+
+extern const BenchmarkScenario benchmark_scenarios[];
+extern const int num_benchmark_scenarios;
+
+// parses a comma separated list of positive sizes
+std::vector<int> ParseSizes(const std::string &size_list);
+
+#endif //benchmark_sketchesH
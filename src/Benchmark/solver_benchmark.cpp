@@ -0,0 +1,163 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Solver benchmark
+// Generates parameterized sketches through the Sketch API, solves each one, and writes one CSV row per solve to
+// standard output so that the results can be compared between releases. The verbose solver output is discarded
+// unless -v is given.
+//
+// usage: psketcher_benchmark [-s scenario] [-n size1,size2,...] [-e bfgs|lm] [-r repeats] [-v]
+//   scenarios: copies, chain, grid, tangent_loop, mixed (default is all of them, each over its default size sweep)
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "benchmark_sketches.h"
+
+using namespace std;
+
+// every heap allocation made by the program is counted, the solver may allocate from several threads
+static volatile unsigned long benchmark_allocations = 0;
+
+void *operator new(size_t size)
+{
+	__sync_fetch_and_add(&benchmark_allocations, 1UL);
+	void *memory = malloc(size > 0 ? size : 1);
+	if(memory == 0)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void *operator new[](size_t size) {return operator new(size);}
+void operator delete(void *memory) throw() {free(memory);}
+void operator delete[](void *memory) throw() {free(memory);}
+void operator delete(void *memory, size_t) throw() {free(memory);}
+void operator delete[](void *memory, size_t) throw() {free(memory);}
+
+static double GetWallTime()
+{
+	timeval time;
+	gettimeofday(&time, 0);
+	return time.tv_sec + 1.0e-6*time.tv_usec;
+}
+
+// peak resident set size of the process in kilobytes
+static long GetPeakRSS()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static void RunScenario(const BenchmarkScenario &scenario, const std::vector<int> &sizes, SOLVER_ENGINE engine, int repeats, bool verbose)
+{
+	for(unsigned size_index = 0; size_index < sizes.size(); size_index++)
+	{
+		for(int repeat = 0; repeat < repeats; repeat++)
+		{
+			srand(repeat + 1);
+
+			BenchmarkSketch benchmark;
+			scenario.generator(benchmark, sizes[size_index]);
+			benchmark.Perturb(scenario.perturbation);
+			benchmark.GetSketch().SetSolverEngine(engine);
+
+			// the solver writes its progress to std::cerr
+			std::streambuf *cerr_buffer = std::cerr.rdbuf();
+			stringstream discarded_output;
+			if(!verbose)
+				std::cerr.rdbuf(discarded_output.rdbuf());
+
+			unsigned long start_allocations = benchmark_allocations;
+			double start_time = GetWallTime();
+
+			benchmark.GetSketch().SolveConstraints();
+
+			double wall_time = GetWallTime() - start_time;
+			unsigned long allocations = benchmark_allocations - start_allocations;
+
+			std::cerr.rdbuf(cerr_buffer);
+
+			const SolveReport &report = benchmark.GetSketch().GetSolveReport();
+			const SolverStatistics &statistics = report.statistics;
+			cout << scenario.name << "," << sizes[size_index] << "," << (engine == BFGS_ENGINE ? "bfgs" : "lm") << "," << repeat << ","
+			     << statistics.free_parameters << "," << statistics.constraints << "," << statistics.eliminated_parameters << "," << statistics.eliminated_constraints << "," << statistics.constructed_parameters << "," << statistics.constructed_constraints << "," << statistics.clusters_solved << ","
+			     << wall_time << "," << statistics.iterations << "," << statistics.value_evaluations << "," << statistics.gradient_evaluations << ","
+			     << allocations << "," << GetPeakRSS() << "," << report.final_merit << ","
+			     << statistics.line_search_time << "," << statistics.search_direction_time << "," << statistics.value_evaluation_time << "," << statistics.gradient_evaluation_time << endl;
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	std::string scenario_name;
+	std::string size_list;
+	SOLVER_ENGINE engine = BFGS_ENGINE;
+	int repeats = 1;
+	bool verbose = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		if(argument == "-s" && i+1 < argc)
+			scenario_name = argv[++i];
+		else if(argument == "-n" && i+1 < argc)
+			size_list = argv[++i];
+		else if(argument == "-e" && i+1 < argc)
+			engine = (std::string(argv[++i]) == "lm") ? LEVENBERG_MARQUARDT_ENGINE : BFGS_ENGINE;
+		else if(argument == "-r" && i+1 < argc)
+			repeats = atoi(argv[++i]);
+		else if(argument == "-v")
+			verbose = true;
+		else {
+			std::cerr << "usage: " << argv[0] << " [-s scenario] [-n size1,size2,...] [-e bfgs|lm] [-r repeats] [-v]" << std::endl;
+			return 1;
+		}
+	}
+
+	// peak_rss_kb is the peak for the whole process up to the end of the solve, it only increases between rows
+	cout << "scenario,size,engine,repeat,free_parameters,constraints,eliminated_parameters,eliminated_constraints,constructed_parameters,constructed_constraints,clusters_solved,wall_time_s,iterations,value_evaluations,gradient_evaluations,allocations,peak_rss_kb,final_merit,line_search_time_s,search_direction_time_s,value_evaluation_time_s,gradient_evaluation_time_s" << endl;
+
+	bool found = false;
+	for(int i = 0; i < num_benchmark_scenarios; i++)
+	{
+		if(scenario_name.empty() || scenario_name == benchmark_scenarios[i].name)
+		{
+			found = true;
+			RunScenario(benchmark_scenarios[i], ParseSizes(size_list.empty() ? benchmark_scenarios[i].default_sizes : size_list), engine, repeats, verbose);
+		}
+	}
+
+	if(!found)
+	{
+		std::cerr << "Unknown scenario: " << scenario_name << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
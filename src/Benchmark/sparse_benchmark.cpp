@@ -0,0 +1,209 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Sparse linear solver benchmark
+// Harvests the jacobian of every generated sketch (all of the constraint equations with respect to all of the free
+// DOF's, without clustering or presolving) at the perturbed starting point and times the sparse Cholesky factorization of
+// the damped normal equations and the sparse QR factorization of the damped least squares problem, with and without the
+// approximate minimum degree ordering. One CSV row is written per jacobian and ordering.
+//
+// usage: psketcher_sparse_benchmark [-s scenario] [-n size1,size2,...] [-r repeats]
+//   the times are averaged over the repeats, the residuals are relative to |J^T*r|
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "benchmark_sketches.h"
+#include "../NumOptimization/solver_timer.h"
+#include "../mmcSparse/mmcSparseCholesky.h"
+#include "../mmcSparse/mmcSparseQR.h"
+
+using namespace std;
+
+// Levenberg-Marquardt damping used for the factorizations, relative to the largest diagonal entry of J^T*J
+const double benchmark_relative_damping = 1.0e-3;
+
+static void CollectDOFs(const SolverFunctionsBasePointer &solver_function, std::set<unsigned> &visited, std::vector<DOFPointer> &free_parameters, std::vector<DOFPointer> &fixed_parameters)
+{
+	for(unsigned i = 0; i < solver_function->GetNumDOFs(); i++)
+	{
+		DOFPointer dof = solver_function->GetDOF(i);
+		if(dof->IsDependent())
+		{
+			CollectDOFs(dof->GetSolverFunction(), visited, free_parameters, fixed_parameters);
+			continue;
+		}
+		if(visited.insert(dof->GetID()).second)
+			(dof->IsFree() ? free_parameters : fixed_parameters).push_back(dof);
+	}
+}
+
+// jacobian of the weighted residuals of all of the constraint equations of the sketch at the current DOF values, the residuals are returned in residuals
+static mmcSparseMatrix HarvestJacobian(BenchmarkModel &sketch, mmcMatrix &residuals)
+{
+	std::vector<SolverFunctionsBasePointer> constraints;
+	std::vector<double> weights;
+	std::vector<DOFPointer> free_parameters;
+	std::vector<DOFPointer> fixed_parameters;
+	std::set<unsigned> visited;
+
+	const std::map<unsigned,ConstraintEquationBasePointer> &equations = sketch.GetConstraintEquationList();
+	for(std::map<unsigned,ConstraintEquationBasePointer>::const_iterator it = equations.begin(); it != equations.end(); it++)
+	{
+		constraints.push_back(it->second->GetSolverFunction());
+		weights.push_back(it->second->GetWeight());
+		CollectDOFs(constraints.back(), visited, free_parameters, fixed_parameters);
+	}
+
+	if(constraints.size() == 0 || free_parameters.size() == 0)
+		return mmcSparseMatrix();
+
+	std::vector<double> fixed_values;
+	for(unsigned i = 0; i < fixed_parameters.size(); i++)
+		fixed_values.push_back(fixed_parameters[i]->GetValue());
+
+	mmcMatrix x(free_parameters.size(),1);
+	for(unsigned i = 0; i < free_parameters.size(); i++)
+		x(i,0) = free_parameters[i]->GetValue();
+
+	ConstraintSolver constraint_solver(constraints, weights, free_parameters, fixed_parameters, fixed_values);
+	SparseJacobian jacobian(free_parameters.size());
+	residuals.SetSize(constraints.size(),1);
+	constraint_solver.GetResidualsPlusJacobian(x, residuals, jacobian);
+
+	return mmcSparseMatrix::FromCompressedRows(jacobian.GetNumRows(), jacobian.GetNumColumns(), jacobian.GetRowStart(), jacobian.GetColumns(), jacobian.GetValues());
+}
+
+static void RunScenario(const BenchmarkScenario &scenario, const std::vector<int> &sizes, int repeats)
+{
+	for(unsigned size_index = 0; size_index < sizes.size(); size_index++)
+	{
+		srand(1);
+		BenchmarkSketch benchmark;
+		scenario.generator(benchmark, sizes[size_index]);
+		benchmark.Perturb(scenario.perturbation);
+
+		mmcMatrix residuals;
+		mmcSparseMatrix jacobian = HarvestJacobian(benchmark.GetSketch(), residuals);
+		if(jacobian.GetNumRows() == 0 || jacobian.GetNumColumns() == 0)
+			continue;
+
+		mmcMatrix gradient = jacobian.TransposeMultiply(residuals);
+		double gradient_norm = gradient.GetMagnitude();
+		if(gradient_norm == 0.0)
+			gradient_norm = 1.0;
+
+		mmcSparseMatrix normal = jacobian.GetNormalMatrix();
+		double damping = 0.0;
+		for(int i = 0; i < normal.GetNumColumns(); i++)
+			damping = max(damping, normal.GetElement(i,i));
+		damping = (damping > 0.0 ? damping : 1.0)*benchmark_relative_damping;
+		normal = jacobian.GetNormalMatrix(damping);
+
+		for(int ordering_index = 0; ordering_index < 2; ordering_index++)
+		{
+			mmcSparseOrderingMethod ordering = (ordering_index == 0) ? MMC_NATURAL_ORDERING : MMC_AMD_ORDERING;
+			double cholesky_analyze_time = 0.0, cholesky_factorize_time = 0.0, cholesky_solve_time = 0.0;
+			double qr_analyze_time = 0.0, qr_factorize_time = 0.0, qr_solve_time = 0.0;
+			mmcSparseCholesky cholesky;
+			mmcSparseQR qr;
+			mmcMatrix cholesky_step, qr_step;
+			for(int repeat = 0; repeat < repeats; repeat++)
+			{
+				double start = GetSolverTime();
+				cholesky.Analyze(normal, ordering);
+				cholesky_analyze_time += GetSolverTime() - start;
+
+				start = GetSolverTime();
+				cholesky.Factorize(normal);
+				cholesky_factorize_time += GetSolverTime() - start;
+
+				start = GetSolverTime();
+				cholesky_step = cholesky.Solve(gradient);
+				cholesky_solve_time += GetSolverTime() - start;
+
+				start = GetSolverTime();
+				qr.Analyze(jacobian, ordering);
+				qr_analyze_time += GetSolverTime() - start;
+
+				start = GetSolverTime();
+				qr.Factorize(jacobian, damping);
+				qr_factorize_time += GetSolverTime() - start;
+
+				start = GetSolverTime();
+				qr_step = qr.Solve(residuals);
+				qr_solve_time += GetSolverTime() - start;
+			}
+
+			mmcMatrix cholesky_residual = normal*cholesky_step - gradient;
+			mmcMatrix qr_residual = jacobian.TransposeMultiply(jacobian*qr_step - residuals) + qr_step.GetScaled(damping);
+
+			cout << scenario.name << "," << sizes[size_index] << "," << jacobian.GetNumRows() << "," << jacobian.GetNumColumns() << "," << jacobian.GetNumNonZeros() << ","
+			     << (ordering == MMC_AMD_ORDERING ? "amd" : "natural") << "," << normal.GetNumNonZeros() << ","
+			     << cholesky.GetNumFactorNonZeros() << "," << cholesky_analyze_time/repeats << "," << cholesky_factorize_time/repeats << "," << cholesky_solve_time/repeats << "," << cholesky_residual.GetMagnitude()/gradient_norm << ","
+			     << qr.GetNumFactorNonZeros() << "," << qr_analyze_time/repeats << "," << qr_factorize_time/repeats << "," << qr_solve_time/repeats << "," << qr_residual.GetMagnitude()/gradient_norm << endl;
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	std::string scenario_name;
+	std::string size_list;
+	int repeats = 1;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		if(argument == "-s" && i+1 < argc)
+			scenario_name = argv[++i];
+		else if(argument == "-n" && i+1 < argc)
+			size_list = argv[++i];
+		else if(argument == "-r" && i+1 < argc)
+			repeats = max(1, atoi(argv[++i]));
+		else {
+			std::cerr << "usage: " << argv[0] << " [-s scenario] [-n size1,size2,...] [-r repeats]" << std::endl;
+			return 1;
+		}
+	}
+
+	cout << "scenario,size,rows,columns,jacobian_nonzeros,ordering,normal_nonzeros,cholesky_factor_nonzeros,cholesky_analyze_s,cholesky_factorize_s,cholesky_solve_s,cholesky_residual,qr_factor_nonzeros,qr_analyze_s,qr_factorize_s,qr_solve_s,qr_residual" << endl;
+
+	bool found = false;
+	for(int i = 0; i < num_benchmark_scenarios; i++)
+	{
+		if(scenario_name.empty() || scenario_name == benchmark_scenarios[i].name)
+		{
+			found = true;
+			RunScenario(benchmark_scenarios[i], ParseSizes(size_list.empty() ? benchmark_scenarios[i].default_sizes : size_list), repeats);
+		}
+	}
+
+	if(!found)
+	{
+		std::cerr << "Unknown scenario: " << scenario_name << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -24,6 +24,8 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "IndependentDOF.h"
 
 #include "pSketcherModel.h"
+#include "DatabaseRow.h"
+#include "DatabaseSnapshot.h"
 
 using namespace std;
 
@@ -235,94 +237,16 @@ void AngleLine2D::RemoveFromDatabase()
 
 void AngleLine2D::DatabaseAddRemove(bool add_to_database) // Utility method used by AddToDatabase and RemoveFromDatabase
 {
-	string sql_do, sql_undo;
-
-	stringstream dof_list_table_name;
-	dof_list_table_name << "dof_table_" << GetID();
-	stringstream primitive_list_table_name;
-	primitive_list_table_name << "primitive_table_" << GetID();
-	stringstream constraint_list_table_name;
-
-	// First, create the sql statements to undo and redo this operation
-	stringstream temp_stream;
-	temp_stream.precision(__DBL_DIG__);
-	temp_stream << "BEGIN; "
-                << "INSERT INTO " << SQL_angle_line2d_database_table_name << " VALUES(" 
-                << GetID() << ",'" << dof_list_table_name.str() << "','" 
-				<< primitive_list_table_name.str() 
-				<< "'," << line1_->GetID() << "," << line2_->GetID()
-				<< "," << angle_->GetID() << "," << interior_angle_
-				<< "," << text_angle_->GetID() << "," << text_radius_->GetID()
-				<< "," << text_s_->GetID() << "," << text_t_->GetID()
-                << "," << weight_
-				<< "); "
-                << "INSERT INTO constraint_equation_list VALUES("
-                << GetID() << ",'" << SQL_angle_line2d_database_table_name << "'); "
-                << "COMMIT; ";
-
-	if(add_to_database)
-		sql_do = temp_stream.str();
-	else
-		sql_undo = temp_stream.str();
-
-	temp_stream.str(""); // clears the string stream
-
-	temp_stream << "BEGIN; "
-				<< "DELETE FROM constraint_equation_list WHERE id=" << GetID() 
-				<< "; DELETE FROM " << SQL_angle_line2d_database_table_name << " WHERE id=" << GetID() 
-				<< "; COMMIT;";
-
-	if(add_to_database)
-		sql_undo = temp_stream.str();
-	else
-		sql_do = temp_stream.str();
-
-	// add this object to the appropriate tables by executing the SQL command sql_insert 
-	char *zErrMsg = 0;
-	int rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		if(add_to_database)
-		{
-			//std::cerr << "SQL error: " << zErrMsg << endl;
-			sqlite3_free(zErrMsg);
-			
-			// the table "independent_dof_list" may not exist, attempt to create
-			rc = sqlite3_exec(database_, ("ROLLBACK;"+SQL_angle_line2d_database_schema).c_str(), 0, 0, &zErrMsg);  // need to add ROLLBACK since previous transaction failed
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-	
-			// now that the table has been created, attempt the insert one last time
-			rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-		} else {
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
-		}
-	}
-
-	// finally, update the undo_redo_list in the database with the database changes that have just been made
-	// need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-	char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q')",sql_undo.c_str(),sql_do.c_str());
-
-	rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
-
-	sqlite3_free(sql_undo_redo);
+	DatabaseRow row(SQL_angle_line2d_database_table_name, SQL_angle_line2d_database_schema, "constraint_equation_list", GetID());
+	row << line1_->GetID() << line2_->GetID()
+		<< angle_->GetID() << interior_angle_
+		<< text_angle_->GetID() << text_radius_->GetID()
+		<< text_s_->GetID() << text_t_->GetID()
+		<< weight_;
+	row.AddRemove(database_, add_to_database);
 
 	// Now use the methods provided by PrimitiveBase and ConstraintEquationBase to create the tables listing the DOF's, the other Primitives that this primitive depends on, and the constraint equations
-	DatabaseAddDeleteLists(add_to_database,dof_list_table_name.str(),primitive_list_table_name.str());
+	DatabaseAddDeleteLists(add_to_database);
 }
 
 bool AngleLine2D::SyncToDatabase(pSketcherModel &psketcher_model)
@@ -331,38 +255,20 @@ bool AngleLine2D::SyncToDatabase(pSketcherModel &psketcher_model)
 
 	string table_name = SQL_angle_line2d_database_table_name;
 
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-	
-	stringstream sql_command;
-	sql_command << "SELECT * FROM " << table_name << " WHERE id=" << GetID() << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	stringstream dof_table_name, primitive_table_name;
+	TableRow row(psketcher_model, table_name, GetID());
 
-	if(rc == SQLITE_ROW) {
+	if(row.Exists()) {
 		// row exists, store the values to initialize this object
 		
-		dof_table_name << sqlite3_column_text(statement,1);
-		primitive_table_name << sqlite3_column_text(statement,2);
-		line1_ = psketcher_model.FetchPrimitive<Line2D>(sqlite3_column_int(statement,3));
-		line2_ = psketcher_model.FetchPrimitive<Line2D>(sqlite3_column_int(statement,4));
-		angle_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,5));
-		interior_angle_ = sqlite3_column_int(statement,6);
-		text_angle_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,7));
-		text_radius_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,8));
-		text_s_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,9));
-		text_t_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,10));
-        weight_ = sqlite3_column_double(statement,11);
+		line1_ = psketcher_model.FetchPrimitive<Line2D>(row.GetInt(1));
+		line2_ = psketcher_model.FetchPrimitive<Line2D>(row.GetInt(2));
+		angle_ = psketcher_model.FetchDOF(row.GetInt(3));
+		interior_angle_ = row.GetInt(4);
+		text_angle_ = psketcher_model.FetchDOF(row.GetInt(5));
+		text_radius_ = psketcher_model.FetchDOF(row.GetInt(6));
+		text_s_ = psketcher_model.FetchDOF(row.GetInt(7));
+		text_t_ = psketcher_model.FetchDOF(row.GetInt(8));
+        weight_ = row.GetDouble(9);
 
         if(interior_angle_)
         {
@@ -373,28 +279,11 @@ bool AngleLine2D::SyncToDatabase(pSketcherModel &psketcher_model)
 
 	} else {
 		// the requested row does not exist in the database
-		sqlite3_finalize(statement);	
-
 		return false; // row does not exist in the database, exit method and return false
 	}
 
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
 	// now sync the lists store in the base classes
-	SyncListsToDatabase(dof_table_name.str(),primitive_table_name.str(),psketcher_model); // PrimitiveBase
+	SyncListsToDatabase(psketcher_model); // PrimitiveBase
 
 	return true; // row existed in the database
 }
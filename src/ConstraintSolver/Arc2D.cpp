@@ -29,6 +29,8 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "DependentDOF.h"
 #include "SolverFunctions.h"
 #include "pSketcherModel.h"
+#include "DatabaseRow.h"
+#include "DatabaseSnapshot.h"
 
 using namespace std;
 
@@ -278,95 +280,19 @@ void Arc2D::RemoveFromDatabase()
 
 void Arc2D::DatabaseAddRemove(bool add_to_database) // Utility method used by AddToDatabase and RemoveFromDatabase
 {
-    string sql_do, sql_undo;
-
-    stringstream dof_list_table_name;
-    dof_list_table_name << "dof_table_" << GetID();
-    stringstream primitive_list_table_name;
-    primitive_list_table_name << "primitive_table_" << GetID();
-
-    //"CREATE TABLE arc2d_list (id INTEGER PRIMARY KEY, dof_table_name TEXT NOT NULL, primitive_table_name TEXT NOT NULL, sketch_plane INTEGER NOT NULL, center_point INTEGER NOT NULL, radius_dof INTEGER NOT NULL, s_center_dof INTEGER NOT NULL, t_center_dof INTEGER NOT NULL, theta_1_dof INTEGER NOT NULL, theta_2_dof INTEGER NOT NULL, end1_point INTEGER NOT NULL, end2_point INTEGER NOT NULL, text_angle_dof INTEGER NOT NULL, text_radius_dof INTEGER NOT NULL);";
-
-    // First, create the sql statements to undo and redo this operation
-    stringstream temp_stream;
-    temp_stream.precision(__DBL_DIG__);
-    temp_stream << "BEGIN; "
-                << "INSERT INTO " << SQL_arc2d_database_table_name << " VALUES(" 
-                << GetID() << ",'" << dof_list_table_name.str() << "','" 
-                << primitive_list_table_name.str() << "'," << GetSketchPlane()->GetID() 
-                << "," << center_point_->GetID() << "," << radius_->GetID()
-                << "," << s_center_->GetID() << "," << t_center_->GetID() 
-                << "," << theta_1_->GetID() << "," << theta_2_->GetID()
-                << "," << point1_->GetID() << "," << point2_->GetID()
-                << "," << text_angle_->GetID() << "," << text_radius_->GetID()
-                << "); "
-                << "INSERT INTO primitive_list VALUES("
-                << GetID() << ",'" << SQL_arc2d_database_table_name << "'); "
-                << "COMMIT; ";
-
-    if(add_to_database)
-        sql_do = temp_stream.str();
-    else
-        sql_undo = temp_stream.str();
-
-    temp_stream.str(""); // clears the string stream
-
-    temp_stream << "BEGIN; "
-                << "DELETE FROM primitive_list WHERE id=" << GetID() 
-                << "; DELETE FROM " << SQL_arc2d_database_table_name << " WHERE id=" << GetID() 
-                << "; COMMIT;";
-
-    if(add_to_database)
-        sql_undo = temp_stream.str();
-    else
-        sql_do = temp_stream.str();
-
-    // add this object to the appropriate tables by executing the SQL command sql_insert 
-    char *zErrMsg = 0;
-    int rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        if(add_to_database)
-        {
-            //std::cerr << "SQL error: " << zErrMsg << endl;
-            sqlite3_free(zErrMsg);
-            
-            // the table "independent_dof_list" may not exist, attempt to create
-            rc = sqlite3_exec(database_, ("ROLLBACK;"+SQL_arc2d_database_schema).c_str(), 0, 0, &zErrMsg);  // need to add ROLLBACK since previous transaction failed
-            if( rc!=SQLITE_OK ){
-                std::string error_description = "SQL error: " + std::string(zErrMsg);
-                sqlite3_free(zErrMsg);
-                throw pSketcherException(error_description);
-            }
-    
-            // now that the table has been created, attempt the insert one last time
-            rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-            if( rc!=SQLITE_OK ){
-                std::string error_description = "SQL error: " + std::string(zErrMsg);
-                sqlite3_free(zErrMsg);
-                throw pSketcherException(error_description);
-            }
-        } else {
-            std::string error_description = "SQL error: " + std::string(zErrMsg);
-            sqlite3_free(zErrMsg);
-            throw pSketcherException(error_description);
-        }
-    }
-
-    // finally, update the undo_redo_list in the database with the database changes that have just been made
-    // need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-    char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q')",sql_undo.c_str(),sql_do.c_str());
-
-    rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
-
-    sqlite3_free(sql_undo_redo);
-
-    // Now use the method provided by PrimitiveBase to create the tables listing the DOF's and the other Primitives that this primitive depends on
-    DatabaseAddDeleteLists(add_to_database,dof_list_table_name.str(),primitive_list_table_name.str());
+    //"CREATE TABLE arc2d_list (id INTEGER PRIMARY KEY, sketch_plane INTEGER NOT NULL, center_point INTEGER NOT NULL, radius_dof INTEGER NOT NULL, s_center_dof INTEGER NOT NULL, t_center_dof INTEGER NOT NULL, theta_1_dof INTEGER NOT NULL, theta_2_dof INTEGER NOT NULL, end1_point INTEGER NOT NULL, end2_point INTEGER NOT NULL, text_angle_dof INTEGER NOT NULL, text_radius_dof INTEGER NOT NULL);";
+
+    DatabaseRow row(SQL_arc2d_database_table_name, SQL_arc2d_database_schema, "primitive_list", GetID());
+    row << GetSketchPlane()->GetID() << center_point_->GetID()
+        << radius_->GetID() << s_center_->GetID()
+        << t_center_->GetID() << theta_1_->GetID()
+        << theta_2_->GetID() << point1_->GetID()
+        << point2_->GetID() << text_angle_->GetID()
+        << text_radius_->GetID();
+    row.AddRemove(database_, add_to_database);
+
+    // Now use the method provided by PrimitiveBase to add the links to the DOF's and the other Primitives that this primitive depends on
+    DatabaseAddDeleteLists(add_to_database);
 }
 
 bool Arc2D::SyncToDatabase(pSketcherModel &psketcher_model)
@@ -375,65 +301,30 @@ bool Arc2D::SyncToDatabase(pSketcherModel &psketcher_model)
 
     string table_name = SQL_arc2d_database_table_name;
 
-    char *zErrMsg = 0;
-    int rc;
-    sqlite3_stmt *statement;
-    
-    stringstream sql_command;
-    sql_command << "SELECT * FROM " << table_name << " WHERE id=" << GetID() << ";";
+    TableRow row(psketcher_model, table_name, GetID());
 
-    rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-        throw pSketcherException(error_description.str());
-    }
-
-    rc = sqlite3_step(statement);
-
-    stringstream dof_table_name, primitive_table_name;
-
-    if(rc == SQLITE_ROW) {
+    if(row.Exists()) {
         // row exists, store the values to initialize this object
         
-        dof_table_name << sqlite3_column_text(statement,1);
-        primitive_table_name << sqlite3_column_text(statement,2);
-        SetSketchPlane(psketcher_model.FetchPrimitive<SketchPlane>(sqlite3_column_int(statement,3)));
-        center_point_ = psketcher_model.FetchPrimitive<Point2D>(sqlite3_column_int(statement,4));
-        radius_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,5));
-        s_center_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,6));
-        t_center_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,7));
-        theta_1_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,8));
-        theta_2_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,9));
-        point1_ = psketcher_model.FetchPrimitive<Point2D>(sqlite3_column_int(statement,10));
-        point2_ = psketcher_model.FetchPrimitive<Point2D>(sqlite3_column_int(statement,11));
-        text_angle_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,12));
-        text_radius_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,13));
+        SetSketchPlane(psketcher_model.FetchPrimitive<SketchPlane>(row.GetInt(1)));
+        center_point_ = psketcher_model.FetchPrimitive<Point2D>(row.GetInt(2));
+        radius_ = psketcher_model.FetchDOF(row.GetInt(3));
+        s_center_ = psketcher_model.FetchDOF(row.GetInt(4));
+        t_center_ = psketcher_model.FetchDOF(row.GetInt(5));
+        theta_1_ = psketcher_model.FetchDOF(row.GetInt(6));
+        theta_2_ = psketcher_model.FetchDOF(row.GetInt(7));
+        point1_ = psketcher_model.FetchPrimitive<Point2D>(row.GetInt(8));
+        point2_ = psketcher_model.FetchPrimitive<Point2D>(row.GetInt(9));
+        text_angle_ = psketcher_model.FetchDOF(row.GetInt(10));
+        text_radius_ = psketcher_model.FetchDOF(row.GetInt(11));
 
     } else {
         // the requested row does not exist in the database
-        sqlite3_finalize(statement);    
-
         return false; // row does not exist in the database, exit method and return false
     }
 
-    rc = sqlite3_step(statement);
-    if( rc!=SQLITE_DONE ){
-        // sql statement didn't finish properly, some error must to have occured
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-        throw pSketcherException(error_description.str());
-    }
-    
-    rc = sqlite3_finalize(statement);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-        throw pSketcherException(error_description.str());
-    }
-
     // now sync the lists store in the base classes
-    SyncListsToDatabase(dof_table_name.str(),primitive_table_name.str(),psketcher_model); // PrimitiveBase
+    SyncListsToDatabase(psketcher_model); // PrimitiveBase
 
     return true; // row existed in the database
 }
@@ -0,0 +1,102 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef AutoDiffSolverFunctionH
+#define AutoDiffSolverFunctionH
+
+#include "SolverFunctionsBase.h"
+#include "DualNumber.h"
+
+// Base class for solver functions that are written once as a template and differentiated with DualNumber instead of
+// being generated by generate_constraint_functions.py. Function is the derived class (curiously recurring template) and
+// must provide
+//
+//     template <class T> T Evaluate(const T *params) const;
+//
+// where params[i] is the value of DOF i, and GetName(). NumDOFs is the number of DOF's the derived class adds with AddDOF
+// in its constructor. For example:
+//
+//     class my_distance_2d: public AutoDiffSolverFunction<my_distance_2d,5>
+//     {
+//         public:
+//             my_distance_2d(DOFPointer point1s, DOFPointer point1t, DOFPointer point2s, DOFPointer point2t, DOFPointer distance)
+//             {AddDOF(point1s); AddDOF(point1t); AddDOF(point2s); AddDOF(point2t); AddDOF(distance);}
+//
+//             template <class T> T Evaluate(const T *params) const
+//             {return sqrt(pow(params[0] - params[2], 2) + pow(params[1] - params[3], 2)) - params[4];}
+//
+//             std::string GetName() const {return "my_distance_2d";}
+//     };
+template <class Function, int NumDOFs> class AutoDiffSolverFunction: public SolverFunctionsBase
+{
+    public:
+        typedef DualNumber<NumDOFs> Dual;
+
+        double GetValue() const
+        {
+            CheckNumDOFs();
+            double params[NumDOFs];
+            for(int i = 0; i < NumDOFs; i++)
+                params[i] = GetDOF(i)->GetValue();
+            return static_cast<const Function *>(this)->Evaluate(params);
+        }
+
+        double GetValueSelf(const SolverFunctionsVector &params) const
+        {
+            CheckNumDOFs();
+            double local_params[NumDOFs];
+            for(int i = 0; i < NumDOFs; i++)
+                local_params[i] = params(i,0);
+            return static_cast<const Function *>(this)->Evaluate(local_params);
+        }
+
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const
+        {
+            SolverFunctionsVector gradient;
+            GetValueAndGradientSelf(params, gradient);
+            return gradient;
+        }
+
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+        {
+            CheckNumDOFs();
+            Dual local_params[NumDOFs];
+            for(int i = 0; i < NumDOFs; i++)
+                local_params[i] = Dual(params(i,0), i);
+
+            Dual value = static_cast<const Function *>(this)->Evaluate(local_params);
+            for(int i = 0; i < NumDOFs; i++)
+                gradient(i,0) = value.GetGradient(i);
+            return value.GetValue();
+        }
+
+    private:
+        // the local parameter vectors hold at most solver_functions_max_dofs DOF's, the array size is negative at compile time otherwise
+        typedef char NumDOFsCheck[NumDOFs <= solver_functions_max_dofs ? 1 : -1];
+
+        void CheckNumDOFs() const
+        {
+            if(GetNumDOFs() != NumDOFs)
+                throw SolverFunctionsException("AutoDiffSolverFunction: the number of DOF's added does not match the template parameter NumDOFs.");
+        }
+};
+
+#endif //AutoDiffSolverFunctionH
@@ -19,13 +19,32 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <math.h>
+#include <pthread.h>
+#include <sstream>
+#include <algorithm>
+#include <set>
 #include "ConstraintSolver.h"
+#include "SolverFunctionsSIMD.h"
+#include "PrimitiveBase.h"
+#include "../mmcMatrix/mmcThreadPool.h"
 
 using namespace std;
 
+// clusters with at least this many free parameters are solved with L-BFGS instead of dense BFGS
+const unsigned lbfgs_min_free_parameters = 500;
+const int lbfgs_history = 10;
+
 // Constructor
-ConstraintSolver::ConstraintSolver(const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> & weights, const std::vector<DOFPointer> & free_parameters, const std::vector<DOFPointer> & fixed_parameters, const std::vector<double> & fixed_values):
-MeritFunction(free_parameters.size())
+ConstraintSolver::ConstraintSolver(const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> & weights, const std::vector<DOFPointer> & free_parameters, const std::vector<DOFPointer> & fixed_parameters, const std::vector<double> & fixed_values,
+                                   const std::vector<DOFPointer> & merged_parameters, const std::vector<DOFPointer> & merged_targets):
+MeritFunction(free_parameters.size()),
+ResidualFunction(free_parameters.size(),constraints.size()),
+num_value_evaluations_(0),
+num_gradient_evaluations_(0),
+value_evaluation_time_(0.0),
+gradient_evaluation_time_(0.0),
+profiling_(false),
+stop_flag_(0)
 {
 	if(constraints.size() < 1)
 		throw MeritFunctionException();
@@ -38,16 +57,15 @@ MeritFunction(free_parameters.size())
 		
 	if(fixed_parameters.size() != fixed_values.size())
 		throw MeritFunctionException(); 
+
+	if(merged_parameters.size() != merged_targets.size())
+		throw MeritFunctionException();
 	
 	free_parameters_ = free_parameters;
 	fixed_parameters_ = fixed_parameters;
 	weights_ = weights;
 	constraints_ = constraints;
 	
-    fixed_values_.SetSize(fixed_values.size(),1);
-    for(int i=0; i < fixed_values.size(); i++)
-        fixed_values_(i,0) = fixed_values[i];
-
     // Define the dof map, used by each solver function to map the global parameter list to their local parameter list.
     map<unsigned,unsigned> dof_map;
     unsigned location = 0;
@@ -60,35 +78,1099 @@ MeritFunction(free_parameters.size())
         dof_map.insert(pair<unsigned,unsigned>(fixed_parameters_[i]->GetID(),location++));
     }
 
-    // let each constraint create its own transform from the global parameter list to their local parameter list
-    // each constraint also takes care of any dependent DOFs that also neet to define a transform
+    // merged parameters share the location of their target
+    for(int i=0; i < merged_parameters.size(); i++)
+    {
+        map<unsigned,unsigned>::iterator target_it = dof_map.find(merged_targets[i]->GetID());
+        if(target_it == dof_map.end())
+            throw MeritFunctionException();
+        dof_map.insert(pair<unsigned,unsigned>(merged_parameters[i]->GetID(),target_it->second));
+    }
+
+    // the dependent DOF's are placed after the fixed parameters
+    first_dependent_index_ = location;
     for(int i=0; i < constraints_.size(); i++)
-        constraints_[i]->DefineInputMap(dof_map);
+        for(unsigned j=0; j < constraints_[i]->GetNumDOFs(); j++)
+            if(constraints_[i]->GetDOF(j)->IsDependent())
+                AddDependentDOF(constraints_[i]->GetDOF(j), dof_map);
+    dependent_gradients_.resize(dependent_functions_.size());
+
+    // the full input vector holds the free parameters followed by the fixed parameters, the fixed values are stored once here
+    // and only the free parameters are copied in for each evaluation
+    full_input_vector_.SetSize(first_dependent_index_+dependent_functions_.size(),1);
+    full_gradient_.SetSize(first_dependent_index_+dependent_functions_.size(),1);
+    for(int i=0; i < fixed_values.size(); i++)
+        full_input_vector_(free_parameters_.size()+i,0) = fixed_values[i];
+
+    // let each constraint create its own map from the global parameter list to their local parameter list
+    // each constraint also takes care of any dependent DOFs that also need to define a map
+    dof_map_ = dof_map;
+    DefineInputMaps();
+
+    // group the constraints that only use independent DOF's by type so that they can be evaluated with the batched kernels
+    map<SolverFunctionsValueAndGradientBatch,unsigned> batch_map;
+    for(int i=0; i < constraints_.size(); i++)
+    {
+        constraint_timing_indices_.push_back(GetFunctionTimingIndex(constraints_[i]));
+
+        SolverFunctionsValueAndGradientBatch kernel = constraints_[i]->GetValueAndGradientBatchKernel();
+        if(kernel == 0 || constraints_[i]->GetValueBatchKernel() == 0)
+        {
+            unbatched_constraints_.push_back(i);
+            continue;
+        }
+
+        map<SolverFunctionsValueAndGradientBatch,unsigned>::iterator batch_it = batch_map.find(kernel);
+        if(batch_it == batch_map.end())
+        {
+            batch_it = batch_map.insert(pair<SolverFunctionsValueAndGradientBatch,unsigned>(kernel,constraint_batches_.size())).first;
+            constraint_batches_.push_back(ConstraintBatch(constraints_[i]));
+            batch_timing_indices_.push_back(constraint_timing_indices_[i]);
+        }
+        constraint_batches_[batch_it->second].AddConstraint(constraints_[i], weights_[i]);
+    }
+
+    for(unsigned i=0; i < dependent_functions_.size(); i++)
+        dependent_timing_indices_.push_back(GetFunctionTimingIndex(dependent_functions_[i]));
 
 }
 
+void ConstraintSolver::DefineInputMaps()
+{
+    for(unsigned i=0; i < constraints_.size(); i++)
+        constraints_[i]->DefineInputMap(dof_map_);
+}
+
+unsigned ConstraintSolver::GetFunctionTimingIndex(const SolverFunctionsBasePointer &constraint)
+{
+    std::string name = constraint->GetName();
+    for(unsigned i=0; i < function_timings_.size(); i++)
+        if(function_timings_[i].name == name)
+            return i;
+
+    function_timings_.push_back(SolverFunctionTiming(name));
+    return function_timings_.size() - 1;
+}
+
+void ConstraintSolver::AddFunctionTime(unsigned timing_index, unsigned evaluations, double start_time)
+{
+    function_timings_[timing_index].evaluations += evaluations;
+    function_timings_[timing_index].time += GetSolverTime() - start_time;
+}
+
+void ConstraintSolver::ResetEvaluationCounts()
+{
+    num_value_evaluations_ = 0;
+    num_gradient_evaluations_ = 0;
+    value_evaluation_time_ = 0.0;
+    gradient_evaluation_time_ = 0.0;
+
+    for(unsigned i=0; i < function_timings_.size(); i++)
+    {
+        function_timings_[i].evaluations = 0;
+        function_timings_[i].time = 0.0;
+    }
+}
+
+void ConstraintSolver::SetFixedValues(const std::vector<double> & fixed_values)
+{
+	if(fixed_values.size() != fixed_parameters_.size())
+		throw MeritFunctionException();
+
+	for(int i=0; i < fixed_values.size(); i++)
+		full_input_vector_(free_parameters_.size()+i,0) = fixed_values[i];
+}
+
+// adds dof and any dependent DOF's that it depends on to dependent_functions_, dependencies are added first
+void ConstraintSolver::AddDependentDOF(DOFPointer dof, map<unsigned,unsigned> &dof_map)
+{
+    if(dof_map.find(dof->GetID()) != dof_map.end())
+        return;
+
+    SolverFunctionsBasePointer solver_function = dof->GetSolverFunction();
+    for(unsigned i=0; i < solver_function->GetNumDOFs(); i++)
+        if(solver_function->GetDOF(i)->IsDependent())
+            AddDependentDOF(solver_function->GetDOF(i), dof_map);
+
+    dof_map.insert(pair<unsigned,unsigned>(dof->GetID(),first_dependent_index_+dependent_functions_.size()));
+    dependent_functions_.push_back(solver_function);
+}
+
+// copies the free parameters into the persistent full input vector and evaluates the dependent DOF's, no memory is allocated
+const mmcMatrix & ConstraintSolver::GetFullInputVector(const mmcMatrix & x, bool compute_gradients)
+{
+    if(x.GetNumRows() != free_parameters_.size())
+        throw MeritFunctionException();
+
+    double *full_input_data = full_input_vector_.GetMatrixData();
+    const double *x_data = x.GetMatrixData();
+    for(int i=0; i < free_parameters_.size(); i++)
+        full_input_data[i] = x_data[i];
+
+    // in topological order, so the DOF's that each dependent DOF reads from the full input vector are already up to date
+    for(unsigned i=0; i < dependent_functions_.size(); i++)
+    {
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        if(compute_gradients)
+            full_input_data[first_dependent_index_+i] = dependent_functions_[i]->GetValuePlusLocalGradient(full_input_vector_, dependent_gradients_[i]);
+        else
+            full_input_data[first_dependent_index_+i] = dependent_functions_[i]->GetValue(full_input_vector_);
+        if(profiling_)
+            AddFunctionTime(dependent_timing_indices_[i], 1, function_start);
+    }
+
+    return full_input_vector_;
+}
+
+// reverse topological order, a dependent DOF has received all of its gradient contributions before it passes them on
+void ConstraintSolver::AccumulateDependentGradients()
+{
+    double *full_gradient_data = full_gradient_.GetMatrixData();
+    for(int i = dependent_functions_.size()-1; i >= 0; i--)
+    {
+        double dependent_gradient = full_gradient_data[first_dependent_index_+i];
+        if(dependent_gradient == 0.0)
+            continue;
+
+        const SolverFunctionsBasePointer &solver_function = dependent_functions_[i];
+        for(unsigned j=0; j < solver_function->GetNumDOFs(); j++)
+            full_gradient_data[solver_function->GetInputIndex(j)] += dependent_gradient*dependent_gradients_[i](j,0);
+    }
+}
+
+void ConstraintSolver::ExpandDependentEntries(std::vector<std::pair<int,double> > &entries) const
+{
+    // entries appended for dependent DOF's that depend on other dependent DOF's are expanded by later passes through the loop
+    for(unsigned i=0; i < entries.size(); i++)
+    {
+        if(entries[i].first < (int)first_dependent_index_)
+            continue;
+
+        unsigned dependent = entries[i].first - first_dependent_index_;
+        double scale = entries[i].second;
+        entries[i].first = -1; // dropped by SparseJacobian::AddRow
+
+        const SolverFunctionsBasePointer &solver_function = dependent_functions_[dependent];
+        for(unsigned j=0; j < solver_function->GetNumDOFs(); j++)
+            entries.push_back(pair<int,double>(solver_function->GetInputIndex(j),scale*dependent_gradients_[dependent](j,0)));
+    }
+}
+
 double ConstraintSolver::GetMeritValue(const mmcMatrix & x)
 {
 	double result = 0;
+	double evaluation_start = GetSolverTime();
+	num_value_evaluations_++;
 
-    mmcMatrix full_input_vector = x.CombineAsColumn(fixed_values_);
+    const mmcMatrix &full_input_vector = GetFullInputVector(x, false);
 
-    for(int i=0; i < constraints_.size(); i++)
-        result += weights_[i]*pow(constraints_[i]->GetValue(full_input_vector),2);
+    for(int i=0; i < constraint_batches_.size(); i++)
+    {
+        ConstraintBatch &batch = constraint_batches_[i];
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        batch.AddMeritValue(full_input_vector, result);
+        if(profiling_)
+            AddFunctionTime(batch_timing_indices_[i], batch.GetCount(), function_start);
+    }
 
+    for(int i=0; i < unbatched_constraints_.size(); i++)
+    {
+        unsigned current = unbatched_constraints_[i];
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        result += weights_[current]*pow(constraints_[current]->GetValue(full_input_vector),2);
+        if(profiling_)
+            AddFunctionTime(constraint_timing_indices_[current], 1, function_start);
+    }
+
+	value_evaluation_time_ += GetSolverTime() - evaluation_start;
 	return result;
 }
 
 mmcMatrix ConstraintSolver::GetMeritGradient(const mmcMatrix & x)
 {
-    mmcMatrix full_input_vector = x.CombineAsColumn(fixed_values_);
+    double value;
+    mmcMatrix gradient;
 
-    mmcMatrix gradient(full_input_vector.GetNumRows(),1,0.0);
+    GetMeritValuePlusGradient(x, value, gradient);
 
-    for(int i=0; i < constraints_.size(); i++)
-        gradient += weights_[i]*2.0*constraints_[i]->GetValue(full_input_vector)*constraints_[i]->GetGradient(full_input_vector);
+    return gradient;
+}
+
+// uses the fused value and gradient kernels so that each constraint is only evaluated once
+void ConstraintSolver::GetMeritValuePlusGradient(const mmcMatrix & x, double &value, mmcMatrix &gradient)
+{
+    double evaluation_start = GetSolverTime();
+    num_gradient_evaluations_++;
+    const mmcMatrix &full_input_vector = GetFullInputVector(x, true);
+
+    full_gradient_.SetZero();
+    double *full_gradient_data = full_gradient_.GetMatrixData();
+
+    value = 0.0;
+    for(int i=0; i < constraint_batches_.size(); i++)
+    {
+        ConstraintBatch &batch = constraint_batches_[i];
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        batch.AddMeritValueAndGradient(full_input_vector, value, full_gradient_data);
+        if(profiling_)
+            AddFunctionTime(batch_timing_indices_[i], batch.GetCount(), function_start);
+    }
+
+    for(int i=0; i < unbatched_constraints_.size(); i++)
+    {
+        unsigned current = unbatched_constraints_[i];
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        double constraint_value = constraints_[current]->AddValueWeightedGradient(full_input_vector, weights_[current]*2.0, full_gradient_);
+        if(profiling_)
+            AddFunctionTime(constraint_timing_indices_[current], 1, function_start);
+        value += weights_[current]*constraint_value*constraint_value;
+    }
 
-    return gradient.GetSubMatrix(0,0,free_parameters_.size()-1,0);
+    AccumulateDependentGradients();
+
+    gradient.SetSize(free_parameters_.size(),1);
+    double *gradient_data = gradient.GetMatrixData();
+    for(int i=0; i < free_parameters_.size(); i++)
+        gradient_data[i] = full_gradient_data[i];
+
+    gradient_evaluation_time_ += GetSolverTime() - evaluation_start;
 }
 
+void ConstraintSolver::GetResiduals(const mmcMatrix & x, mmcMatrix &residuals)
+{
+    double evaluation_start = GetSolverTime();
+    num_value_evaluations_++;
+    const mmcMatrix &full_input_vector = GetFullInputVector(x, false);
+
+    residuals.SetSize(constraints_.size(),1);
+    unsigned row = 0;
+
+    for(int i=0; i < constraint_batches_.size(); i++)
+    {
+        ConstraintBatch &batch = constraint_batches_[i];
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        batch.EvaluateValues(full_input_vector);
+        if(profiling_)
+            AddFunctionTime(batch_timing_indices_[i], batch.GetCount(), function_start);
+
+        for(unsigned k=0; k < batch.GetCount(); k++)
+            residuals(row++,0) = sqrt(batch.GetWeight(k))*batch.GetValue(k);
+    }
 
+    for(int i=0; i < unbatched_constraints_.size(); i++)
+    {
+        unsigned current = unbatched_constraints_[i];
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        residuals(row++,0) = sqrt(weights_[current])*constraints_[current]->GetValue(full_input_vector);
+        if(profiling_)
+            AddFunctionTime(constraint_timing_indices_[current], 1, function_start);
+    }
+
+    value_evaluation_time_ += GetSolverTime() - evaluation_start;
+}
+
+void ConstraintSolver::GetResidualsPlusJacobian(const mmcMatrix & x, mmcMatrix &residuals, SparseJacobian &jacobian)
+{
+    double evaluation_start = GetSolverTime();
+    num_gradient_evaluations_++;
+    const mmcMatrix &full_input_vector = GetFullInputVector(x, true);
+
+    residuals.SetSize(constraints_.size(),1);
+    jacobian.Clear(free_parameters_.size());
+    unsigned row = 0;
+
+    // each constraint contributes one sparse row, entries for the fixed parameters are dropped by the jacobian and entries for dependent DOF's are expanded with the chain rule
+    std::vector<std::pair<int,double> > row_entries;
+
+    for(int i=0; i < constraint_batches_.size(); i++)
+    {
+        ConstraintBatch &batch = constraint_batches_[i];
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        batch.EvaluateValuesAndGradients(full_input_vector);
+        if(profiling_)
+            AddFunctionTime(batch_timing_indices_[i], batch.GetCount(), function_start);
+
+        for(unsigned k=0; k < batch.GetCount(); k++)
+        {
+            double weight = sqrt(batch.GetWeight(k));
+            residuals(row++,0) = weight*batch.GetValue(k);
+
+            row_entries.clear();
+            for(unsigned j=0; j < batch.GetNumParameters(); j++)
+                row_entries.push_back(pair<int,double>(batch.GetParameterIndex(j,k),weight*batch.GetGradient(j,k)));
+            ExpandDependentEntries(row_entries);
+            jacobian.AddRow(row_entries);
+        }
+    }
+
+    for(int i=0; i < unbatched_constraints_.size(); i++)
+    {
+        unsigned current = unbatched_constraints_[i];
+        double weight = sqrt(weights_[current]);
+        row_entries.clear();
+        double function_start = profiling_ ? GetSolverTime() : 0.0;
+        residuals(row++,0) = weight*constraints_[current]->GetValuePlusGradient(full_input_vector, weight, row_entries);
+        if(profiling_)
+            AddFunctionTime(constraint_timing_indices_[current], 1, function_start);
+        ExpandDependentEntries(row_entries);
+        jacobian.AddRow(row_entries);
+    }
+
+    gradient_evaluation_time_ += GetSolverTime() - evaluation_start;
+}
+
+ConstraintBatch::ConstraintBatch(const SolverFunctionsBasePointer &prototype)
+{
+    value_kernel_ = prototype->GetValueBatchKernel();
+    value_and_gradient_kernel_ = GetVectorizedBatchKernel(*prototype);
+    num_parameters_ = prototype->GetNumDOFs();
+
+    parameter_indices_.resize(num_parameters_);
+    parameters_.resize(num_parameters_);
+    gradients_.resize(num_parameters_);
+}
+
+void ConstraintBatch::AddConstraint(const SolverFunctionsBasePointer &constraint, double weight)
+{
+    weights_.push_back(weight);
+
+    for(unsigned j=0; j < num_parameters_; j++)
+    {
+        parameter_indices_[j].push_back(constraint->GetInputIndex(j));
+        parameters_[j].push_back(0.0);
+        gradients_[j].push_back(0.0);
+    }
+    values_.push_back(0.0);
+
+    parameter_pointers_.resize(num_parameters_);
+    gradient_pointers_.resize(num_parameters_);
+    index_pointers_.resize(num_parameters_);
+    for(unsigned j=0; j < num_parameters_; j++)
+    {
+        parameter_pointers_[j] = &parameters_[j][0];
+        gradient_pointers_[j] = &gradients_[j][0];
+        index_pointers_[j] = &parameter_indices_[j][0];
+    }
+}
+
+void ConstraintBatch::GatherParameters(const mmcMatrix &full_x)
+{
+    double *full_x_data = full_x.GetMatrixData();
+
+    for(unsigned j=0; j < num_parameters_; j++)
+    {
+        const int *indices = &parameter_indices_[j][0];
+        double *parameters = &parameters_[j][0];
+        for(unsigned k=0; k < weights_.size(); k++)
+            parameters[k] = full_x_data[indices[k]];
+    }
+}
+
+void ConstraintBatch::EvaluateValues(const mmcMatrix &full_x)
+{
+    GatherParameters(full_x);
+    value_kernel_(GetCount(), &parameter_pointers_[0], &values_[0]);
+}
+
+void ConstraintBatch::EvaluateValuesAndGradients(const mmcMatrix &full_x)
+{
+    GatherParameters(full_x);
+    value_and_gradient_kernel_(GetCount(), &parameter_pointers_[0], &values_[0], &gradient_pointers_[0]);
+}
+
+void ConstraintBatch::AddMeritValue(const mmcMatrix &full_x, double &value)
+{
+    EvaluateValues(full_x);
+
+    const double *weights = &weights_[0];
+    const double *values = &values_[0];
+    for(unsigned k=0; k < weights_.size(); k++)
+        value += weights[k]*values[k]*values[k];
+}
+
+void ConstraintBatch::AddMeritValueAndGradient(const mmcMatrix &full_x, double &value, double *full_gradient)
+{
+    EvaluateValuesAndGradients(full_x);
+
+    unsigned count = weights_.size();
+    const double *weights = &weights_[0];
+    const double *values = &values_[0];
+    double *const *gradients = &gradient_pointers_[0];
+    const int *const *indices = &index_pointers_[0];
+    for(unsigned k=0; k < count; k++)
+    {
+        double scale = 2.0*weights[k]*values[k];
+        value += weights[k]*values[k]*values[k];
+
+        // each constraint only adds to the rows of the gradient for the DOF's that it depends on
+        for(unsigned j=0; j < num_parameters_; j++)
+            full_gradient[indices[j][k]] += scale*gradients[j][k];
+    }
+}
+
+static unsigned FindMergeRoot(std::map<unsigned,unsigned> &parent, unsigned id)
+{
+	std::map<unsigned,unsigned>::iterator parent_it = parent.find(id);
+	if(parent_it == parent.end())
+	{
+		parent[id] = id;
+		return id;
+	}
+
+	if(parent_it->second == id)
+		return id;
+
+	// path compression
+	unsigned root = FindMergeRoot(parent, parent_it->second);
+	parent[id] = root;
+	return root;
+}
+
+// true if the solver function depends on one of the DOF's in ids, directly or through its dependent DOF's
+static bool UsesParameter(const SolverFunctionsBasePointer &solver_function, const std::set<unsigned> &ids, const std::map<unsigned,unsigned> &merged_ids)
+{
+	for(unsigned int i = 0; i < solver_function->GetNumDOFs(); i++)
+	{
+		DOFPointer dof = solver_function->GetDOF(i);
+		if(dof->IsDependent())
+		{
+			if(UsesParameter(dof->GetSolverFunction(), ids, merged_ids))
+				return true;
+			continue;
+		}
+
+		std::map<unsigned,unsigned>::const_iterator merged_it = merged_ids.find(dof->GetID());
+		if(ids.count(merged_it == merged_ids.end() ? dof->GetID() : merged_it->second) > 0)
+			return true;
+	}
+
+	return false;
+}
+
+void ConstraintCluster::AddConstraint(SolverFunctionsBasePointer constraint, double weight)
+{
+	constraints_.push_back(constraint);
+	weights_.push_back(weight);
+}
+
+void ConstraintCluster::AddFreeParameter(DOFPointer free_parameter)
+{
+	free_parameters_.push_back(free_parameter);
+}
+
+void ConstraintCluster::AddFixedParameter(DOFPointer fixed_parameter)
+{
+	fixed_parameters_.push_back(fixed_parameter);
+}
+
+void SolverStatistics::Add(const SolverStatistics &rhs)
+{
+	clusters_solved += rhs.clusters_solved;
+	free_parameters += rhs.free_parameters;
+	constraints += rhs.constraints;
+	eliminated_parameters += rhs.eliminated_parameters;
+	eliminated_constraints += rhs.eliminated_constraints;
+	constructed_parameters += rhs.constructed_parameters;
+	constructed_constraints += rhs.constructed_constraints;
+	iterations += rhs.iterations;
+	value_evaluations += rhs.value_evaluations;
+	gradient_evaluations += rhs.gradient_evaluations;
+	starts += rhs.starts;
+	perturbed_wins += rhs.perturbed_wins;
+	interrupted += rhs.interrupted;
+
+	solve_time += rhs.solve_time;
+	line_search_time += rhs.line_search_time;
+	search_direction_time += rhs.search_direction_time;
+	value_evaluation_time += rhs.value_evaluation_time;
+	gradient_evaluation_time += rhs.gradient_evaluation_time;
+
+	// the timings are merged by solver function name
+	for(unsigned i = 0; i < rhs.function_timings.size(); i++)
+	{
+		unsigned j = 0;
+		while(j < function_timings.size() && function_timings[j].name != rhs.function_timings[i].name)
+			j++;
+
+		if(j == function_timings.size())
+			function_timings.push_back(SolverFunctionTiming(rhs.function_timings[i].name));
+
+		function_timings[j].evaluations += rhs.function_timings[i].evaluations;
+		function_timings[j].time += rhs.function_timings[i].time;
+	}
+}
+
+// merges the DOF's of the DOF equality constraints using union-find, the root of each group is its representative
+// a fixed DOF is always preferred as the root so that the free DOF's of a group that contains a single fixed DOF become fixed
+void ConstraintCluster::Presolve()
+{
+	reduced_constraints_.clear();
+	reduced_weights_.clear();
+	reduced_free_parameters_.clear();
+	merged_parameters_.clear();
+	merged_targets_.clear();
+
+	std::map<unsigned,DOFPointer> dofs;
+	std::set<unsigned> fixed_ids;
+	for(unsigned int i = 0; i < free_parameters_.size(); i++)
+		dofs[free_parameters_[i]->GetID()] = free_parameters_[i];
+	for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+	{
+		dofs[fixed_parameters_[i]->GetID()] = fixed_parameters_[i];
+		fixed_ids.insert(fixed_parameters_[i]->GetID());
+	}
+
+	// a group of DOF's made equal by the equalities that holds more than one fixed DOF is not merged since only one of the fixed values
+	// could be kept, its equalities are solved numerically so that conflicting fixed values are resolved in the least squares sense
+	std::map<unsigned,unsigned> group;
+	for(unsigned int i = 0; i < constraints_.size(); i++)
+		if(constraints_[i]->IsDOFEquality() && !constraints_[i]->HasDependentDOFs())
+			group[FindMergeRoot(group, constraints_[i]->GetDOF(0)->GetID())] = FindMergeRoot(group, constraints_[i]->GetDOF(1)->GetID());
+
+	std::map<unsigned,unsigned> group_fixed_count;
+	for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+		if(group.count(fixed_parameters_[i]->GetID()) > 0)
+			group_fixed_count[FindMergeRoot(group, fixed_parameters_[i]->GetID())]++;
+
+	std::map<unsigned,unsigned> parent;
+	for(unsigned int i = 0; i < constraints_.size(); i++)
+	{
+		// dependent DOF's are computed from other DOF's so they cannot be merged, these constraints are solved numerically
+		if(!constraints_[i]->IsDOFEquality() || constraints_[i]->HasDependentDOFs() || group_fixed_count[FindMergeRoot(group, constraints_[i]->GetDOF(0)->GetID())] > 1)
+		{
+			reduced_constraints_.push_back(constraints_[i]);
+			reduced_weights_.push_back(weights_[i]);
+			continue;
+		}
+
+		unsigned root1 = FindMergeRoot(parent, constraints_[i]->GetDOF(0)->GetID());
+		unsigned root2 = FindMergeRoot(parent, constraints_[i]->GetDOF(1)->GetID());
+		if(root1 == root2)
+			continue;
+
+		if(fixed_ids.count(root1) > 0)
+			parent[root2] = root1;
+		else
+			parent[root1] = root2;
+	}
+
+	std::map<unsigned,unsigned> merged_ids;
+	for(unsigned int i = 0; i < free_parameters_.size(); i++)
+	{
+		unsigned root = FindMergeRoot(parent, free_parameters_[i]->GetID());
+		if(root == free_parameters_[i]->GetID())
+			reduced_free_parameters_.push_back(free_parameters_[i]);
+		else {
+			merged_parameters_.push_back(free_parameters_[i]);
+			merged_targets_.push_back(dofs[root]);
+			merged_ids[free_parameters_[i]->GetID()] = root;
+		}
+	}
+
+	// the constructed parameters become fixed parameters for the numerical solver
+	construction_plan_.Build(reduced_constraints_, reduced_free_parameters_, fixed_parameters_, merged_parameters_, merged_targets_);
+	const std::vector<DOFPointer> &constructed_parameters = construction_plan_.GetConstructedParameters();
+	std::set<unsigned> constructed_ids;
+	for(unsigned int i = 0; i < constructed_parameters.size(); i++)
+		constructed_ids.insert(constructed_parameters[i]->GetID());
+
+	numeric_free_parameters_.clear();
+	std::set<unsigned> numeric_free_ids;
+	for(unsigned int i = 0; i < reduced_free_parameters_.size(); i++)
+		if(constructed_ids.count(reduced_free_parameters_[i]->GetID()) == 0)
+		{
+			numeric_free_parameters_.push_back(reduced_free_parameters_[i]);
+			numeric_free_ids.insert(reduced_free_parameters_[i]->GetID());
+		}
+
+	numeric_fixed_parameters_ = fixed_parameters_;
+	numeric_fixed_parameters_.insert(numeric_fixed_parameters_.end(), constructed_parameters.begin(), constructed_parameters.end());
+
+	// constraints that no longer depend on any free parameter are left out, they are satisfied by the construction or cannot be changed
+	numeric_constraints_.clear();
+	numeric_weights_.clear();
+	for(unsigned int i = 0; i < reduced_constraints_.size(); i++)
+		if(!construction_plan_.IsConstraintUsed(i) && UsesParameter(reduced_constraints_[i], numeric_free_ids, merged_ids))
+		{
+			numeric_constraints_.push_back(reduced_constraints_[i]);
+			numeric_weights_.push_back(reduced_weights_[i]);
+		}
+
+	presolved_ = true;
+}
+
+void ConstraintCluster::TakeSnapshot()
+{
+	if(snapshot_index_.size() != free_parameters_.size() + fixed_parameters_.size())
+	{
+		snapshot_index_.clear();
+		for(unsigned int i = 0; i < free_parameters_.size(); i++)
+			snapshot_index_[free_parameters_[i]->GetID()] = i;
+		for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+			snapshot_index_[fixed_parameters_[i]->GetID()] = free_parameters_.size() + i;
+	}
+
+	snapshot_.resize(free_parameters_.size() + fixed_parameters_.size());
+	for(unsigned int i = 0; i < free_parameters_.size(); i++)
+		snapshot_[i] = free_parameters_[i]->GetValue();
+	for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+		snapshot_[free_parameters_.size() + i] = fixed_parameters_[i]->GetValue();
+}
+
+bool ConstraintCluster::IsSnapshotCurrent() const
+{
+	if(snapshot_.size() != free_parameters_.size() + fixed_parameters_.size())
+		return false;
+
+	for(unsigned int i = 0; i < free_parameters_.size(); i++)
+		if(snapshot_[i] != free_parameters_[i]->GetValue())
+			return false;
+
+	for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+		if(snapshot_[free_parameters_.size() + i] != fixed_parameters_[i]->GetValue())
+			return false;
+
+	return true;
+}
+
+double ConstraintCluster::GetSnapshotValue(const DOFPointer &dof) const
+{
+	map<unsigned,unsigned>::const_iterator index_it = snapshot_index_.find(dof->GetID());
+	if(index_it == snapshot_index_.end())
+		throw pSketcherException("DOF is not part of the constraint cluster snapshot.");
+
+	return snapshot_[index_it->second];
+}
+
+void ConstraintCluster::Solve(SOLVER_ENGINE solver_engine, bool profiling, const RobustSolveOptions &robust, const SolveLimits &limits)
+{
+	solution_.clear();
+	solution_parameters_.clear();
+	statistics_ = SolverStatistics();
+
+	if(constraints_.size() == 0 || free_parameters_.size() == 0)
+		return;
+
+	if(!presolved_)
+		Presolve();
+
+	statistics_.clusters_solved = 1;
+	statistics_.eliminated_parameters = merged_parameters_.size();
+	statistics_.eliminated_constraints = constraints_.size() - reduced_constraints_.size();
+
+	std::vector<double> fixed_values(snapshot_.begin() + free_parameters_.size(), snapshot_.end());
+
+	const std::vector<DOFPointer> &slot_dofs = construction_plan_.GetSlotDOFs();
+	std::vector<double> slot_values(slot_dofs.size());
+	for(unsigned int i = 0; i < slot_dofs.size(); i++)
+		slot_values[i] = GetSnapshotValue(slot_dofs[i]);
+
+	std::vector<double> constructed_values;
+	if(construction_plan_.Execute(slot_values, constructed_values))
+	{
+		statistics_.constructed_parameters = constructed_values.size();
+		statistics_.constructed_constraints = reduced_constraints_.size() - numeric_constraints_.size();
+
+		fixed_values.insert(fixed_values.end(), constructed_values.begin(), constructed_values.end());
+		SolveNumerically(constraint_solver_, numeric_constraints_, numeric_weights_, numeric_free_parameters_, numeric_fixed_parameters_, fixed_values, solver_engine, profiling, robust, limits);
+
+		const std::vector<DOFPointer> &constructed_parameters = construction_plan_.GetConstructedParameters();
+		solution_parameters_.insert(solution_parameters_.end(), constructed_parameters.begin(), constructed_parameters.end());
+		solution_.insert(solution_.end(), constructed_values.begin(), constructed_values.end());
+	} else {
+		// the constraints used by the plan are inconsistent for the current fixed values, the least squares solution of the whole cluster is used instead
+		SolveNumerically(fallback_solver_, reduced_constraints_, reduced_weights_, reduced_free_parameters_, fixed_parameters_, fixed_values, solver_engine, profiling, robust, limits);
+	}
+}
+
+// runs the optimizer selected by solver_engine from initial_free_values
+static mmcMatrix MinimizeWithEngine(ConstraintSolver &constraint_solver, const mmcMatrix &initial_free_values, SOLVER_ENGINE solver_engine, std::ostream *output)
+{
+	if(solver_engine == LEVENBERG_MARQUARDT_ENGINE)
+		return constraint_solver.MinimizeResiduals(initial_free_values, 1e-10, 500, 1, output);
+	else
+		return constraint_solver.MinimizeMeritFunction(initial_free_values, 1000, 1e-10, 1e-15, 500, 1, output);
+}
+
+void ConstraintCluster::SolveNumerically(boost::shared_ptr<ConstraintSolver> &constraint_solver, const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> &weights,
+                                         const std::vector<DOFPointer> &free_parameters, const std::vector<DOFPointer> &fixed_parameters, const std::vector<double> &fixed_values,
+                                         SOLVER_ENGINE solver_engine, bool profiling, const RobustSolveOptions &robust, const SolveLimits &limits)
+{
+	statistics_.free_parameters = free_parameters.size();
+	statistics_.constraints = constraints.size();
+
+	// nothing left for the numerical solver, the parameters keep their current values
+	if(constraints.size() == 0 || free_parameters.size() == 0)
+	{
+		for(unsigned int i = 0; i < free_parameters.size(); i++)
+		{
+			solution_parameters_.push_back(free_parameters[i]);
+			solution_.push_back(GetSnapshotValue(free_parameters[i]));
+		}
+		return;
+	}
+
+	mmcMatrix initial_free_values(free_parameters.size(),1);
+	for(unsigned int i = 0; i < free_parameters.size(); i++)
+		initial_free_values(i,0) = GetSnapshotValue(free_parameters[i]);
+
+	// the dof maps only need to be built the first time the cluster is solved
+	if(constraint_solver.get() == 0)
+	{
+		constraint_solver.reset(new ConstraintSolver(constraints, weights, free_parameters, fixed_parameters, fixed_values, merged_parameters_, merged_targets_));
+
+		// the dense inverse hessian grows with the square of the number of free parameters, switch to the limited memory update for large clusters
+		if(free_parameters.size() >= lbfgs_min_free_parameters)
+			constraint_solver->SetLbfgsHistory(lbfgs_history);
+	}
+	else
+	{
+		constraint_solver->SetFixedValues(fixed_values);
+
+		// the other solver of this cluster may have been used last
+		constraint_solver->DefineInputMaps();
+	}
+
+	stringstream output;
+	mmcMatrix computed_free_values;
+	boost::shared_ptr<ConstraintSolver> used_solver = constraint_solver;
+	constraint_solver->ResetEvaluationCounts();
+	constraint_solver->SetProfiling(profiling);
+	constraint_solver->SetCancelFlag(limits.cancel_flag);
+	constraint_solver->SetDeadline(limits.deadline);
+	double solve_start = GetSolverTime();
+	if(robust.num_starts > 1)
+	{
+		computed_free_values = SolveMultiStart(constraint_solver, constraints, weights, free_parameters, fixed_parameters, fixed_values, initial_free_values, solver_engine, robust, limits, used_solver);
+	} else {
+		computed_free_values = MinimizeWithEngine(*constraint_solver, initial_free_values, solver_engine, &output);
+		solver_output_ = output.str();
+		statistics_.starts = 1;
+	}
+	statistics_.solve_time = GetSolverTime() - solve_start;
+
+	if(solver_engine == LEVENBERG_MARQUARDT_ENGINE)
+	{
+		statistics_.iterations = used_solver->ResidualFunction::GetNumIterations();
+		statistics_.search_direction_time = used_solver->GetLinearSolveTime();
+		statistics_.interrupted = used_solver->ResidualFunction::WasInterrupted() ? 1 : 0;
+	} else {
+		statistics_.iterations = used_solver->MeritFunction::GetNumIterations();
+		statistics_.interrupted = used_solver->MeritFunction::WasInterrupted() ? 1 : 0;
+		statistics_.line_search_time = used_solver->GetLineSearchTime();
+		statistics_.search_direction_time = used_solver->GetSearchDirectionTime();
+	}
+	statistics_.value_evaluations = used_solver->GetNumValueEvaluations();
+	statistics_.gradient_evaluations = used_solver->GetNumGradientEvaluations();
+	statistics_.value_evaluation_time = used_solver->GetValueEvaluationTime();
+	statistics_.gradient_evaluation_time = used_solver->GetGradientEvaluationTime();
+	if(profiling)
+		statistics_.function_timings = used_solver->GetFunctionTimings();
+
+	for(unsigned int i = 0; i < free_parameters.size(); i++)
+	{
+		solution_parameters_.push_back(free_parameters[i]);
+		solution_.push_back(computed_free_values(i,0));
+	}
+}
+
+// data shared by the worker threads of a multi-start solve
+typedef struct StartThreadData_s{
+	std::vector<ConstraintSolver *> solvers;
+	std::vector<mmcMatrix> start_values;
+	std::vector<mmcMatrix> results;
+	std::vector<double> merits;
+	std::vector<std::string> outputs;
+	std::vector<bool> failed;
+	SOLVER_ENGINE solver_engine;
+	double merit_tolerance;
+	unsigned next_start;
+	int winner;           // first start to reach the merit tolerance, -1 if none has
+	int stop;             // set when a winner is found, checked by the optimizers once per iteration with __atomic_load_n
+	pthread_mutex_t lock;
+}StartThreadData;
+
+static void *StartThreadSolve(void *thread_data)
+{
+	StartThreadData *data = (StartThreadData *)thread_data;
+
+	while(true)
+	{
+		pthread_mutex_lock(&data->lock);
+		unsigned current = data->next_start++;
+		pthread_mutex_unlock(&data->lock);
+
+		if(current >= data->solvers.size())
+			break;
+
+		try {
+			ConstraintSolver &constraint_solver = *data->solvers[current];
+			stringstream output;
+			constraint_solver.SetStopFlag(&data->stop);
+			data->results[current] = MinimizeWithEngine(constraint_solver, data->start_values[current], data->solver_engine, &output);
+			constraint_solver.SetStopFlag(0);
+			data->merits[current] = constraint_solver.GetMeritValue(data->results[current]);
+			data->outputs[current] = output.str();
+
+			pthread_mutex_lock(&data->lock);
+			if(data->winner < 0 && data->merits[current] <= data->merit_tolerance)
+			{
+				data->winner = current;
+				__atomic_store_n(&data->stop, 1, __ATOMIC_RELEASE);
+			}
+			pthread_mutex_unlock(&data->lock);
+		}
+		catch (...) {
+			data->solvers[current]->SetStopFlag(0);
+			data->failed[current] = true;
+		}
+	}
+
+	return 0;
+}
+
+mmcMatrix ConstraintCluster::SolveMultiStart(boost::shared_ptr<ConstraintSolver> &constraint_solver, const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> &weights,
+                                             const std::vector<DOFPointer> &free_parameters, const std::vector<DOFPointer> &fixed_parameters, const std::vector<double> &fixed_values,
+                                             const mmcMatrix &initial_free_values, SOLVER_ENGINE solver_engine, const RobustSolveOptions &robust, const SolveLimits &limits, boost::shared_ptr<ConstraintSolver> &winning_solver)
+{
+	unsigned num_starts = robust.num_starts;
+
+	// each start has its own solver since the solvers keep per evaluation state, they are built on this thread because building a solver
+	// defines the input maps of the shared solver functions (all of the solvers define the same maps)
+	if(start_solvers_owner_ != constraint_solver.get() || start_solvers_.size() != num_starts - 1)
+	{
+		start_solvers_.clear();
+		for(unsigned i = 1; i < num_starts; i++)
+		{
+			start_solvers_.push_back(boost::shared_ptr<ConstraintSolver>(new ConstraintSolver(constraints, weights, free_parameters, fixed_parameters, fixed_values, merged_parameters_, merged_targets_)));
+			start_solvers_.back()->SetLbfgsHistory(constraint_solver->GetLbfgsHistory());
+		}
+		start_solvers_owner_ = constraint_solver.get();
+	} else {
+		for(unsigned i = 0; i < start_solvers_.size(); i++)
+			start_solvers_[i]->SetFixedValues(fixed_values);
+	}
+
+	StartThreadData thread_data;
+	thread_data.solvers.push_back(constraint_solver.get());
+	thread_data.start_values.push_back(initial_free_values);
+	mmcMatrix perturbation(free_parameters.size(),1);
+	for(unsigned i = 0; i < free_parameters.size(); i++)
+		perturbation(i,0) = robust.perturbation*(fabs(initial_free_values(i,0)) + 1.0);
+	for(unsigned i = 0; i < start_solvers_.size(); i++)
+	{
+		start_solvers_[i]->ResetEvaluationCounts();
+		start_solvers_[i]->SetProfiling(constraint_solver->GetProfiling());
+		start_solvers_[i]->SetCancelFlag(limits.cancel_flag);
+		start_solvers_[i]->SetDeadline(limits.deadline);
+		thread_data.solvers.push_back(start_solvers_[i].get());
+
+		// the random numbers are drawn on this thread
+		thread_data.start_values.push_back(constraint_solver->MonteCarloOptimization(initial_free_values, perturbation, robust.monte_carlo_samples > 0 ? robust.monte_carlo_samples : 1, 0, false));
+	}
+	thread_data.results.resize(num_starts);
+	thread_data.merits.assign(num_starts, HUGE_VAL);
+	thread_data.outputs.resize(num_starts);
+	thread_data.failed.assign(num_starts, false);
+	thread_data.solver_engine = solver_engine;
+	thread_data.merit_tolerance = robust.merit_tolerance;
+	thread_data.next_start = 0;
+	thread_data.winner = -1;
+	__atomic_store_n(&thread_data.stop, 0, __ATOMIC_RELEASE);
+	pthread_mutex_init(&thread_data.lock, 0);
+
+	// one thread per start so that every start makes progress until one of them succeeds, the calling thread takes the first one
+	std::vector<pthread_t> threads;
+	for(unsigned int i = 1; i < num_starts; i++)
+	{
+		pthread_t new_thread;
+		if(pthread_create(&new_thread, 0, StartThreadSolve, (void *)&thread_data) == 0)
+			threads.push_back(new_thread);
+		else
+			cerr << "Error occurred while creating thread number: " << i << endl;
+	}
+
+	StartThreadSolve((void *)&thread_data);
+
+	for(unsigned int i = 0; i < threads.size(); i++)
+		if(pthread_join(threads[i], 0))
+			cerr << "Error joining thread." << endl;
+
+	pthread_mutex_destroy(&thread_data.lock);
+
+	// without a winner the start with the lowest merit is used
+	int best = thread_data.winner;
+	if(best < 0)
+		for(unsigned i = 0; i < num_starts; i++)
+			if(!thread_data.failed[i] && (best < 0 || thread_data.merits[i] < thread_data.merits[best]))
+				best = i;
+	if(best < 0)
+		throw pSketcherException("Solver failure in every start of a multi-start solve.");
+
+	statistics_.starts = num_starts;
+	statistics_.perturbed_wins = (best > 0) ? 1 : 0;
+	solver_output_ = thread_data.outputs[best];
+	winning_solver = (best == 0) ? constraint_solver : start_solvers_[best-1];
+	return thread_data.results[best];
+}
+
+void ConstraintCluster::ApplySolution(bool update_db)
+{
+	for(unsigned int i = 0; i < solution_.size(); i++)
+		solution_parameters_[i]->SetValue(solution_[i], update_db);
+
+	// the targets have been updated above, or are fixed
+	for(unsigned int i = 0; i < merged_parameters_.size(); i++)
+		merged_parameters_[i]->SetValue(merged_targets_[i]->GetValue(), update_db);
+
+	residual_merit_current_ = false;
+}
+
+double ConstraintCluster::GetResidualMerit()
+{
+	if(!residual_merit_current_)
+	{
+		residual_merit_ = 0.0;
+		for(unsigned int i = 0; i < constraints_.size(); i++)
+		{
+			double residual = constraints_[i]->GetValue();
+			residual_merit_ += weights_[i]*residual*residual;
+		}
+		residual_merit_current_ = true;
+	}
+
+	return residual_merit_;
+}
+
+bool ConstraintCluster::IsModified() const
+{
+	if(modified_)
+		return true;
+
+	for(unsigned int i = 0; i < free_parameters_.size(); i++)
+		if(free_parameters_[i]->IsModified())
+			return true;
+
+	for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+		if(fixed_parameters_[i]->IsModified())
+			return true;
+
+	return false;
+}
+
+void ConstraintCluster::ClearModified()
+{
+	modified_ = false;
+
+	for(unsigned int i = 0; i < free_parameters_.size(); i++)
+		free_parameters_[i]->ClearModified();
+
+	for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+		fixed_parameters_[i]->ClearModified();
+}
+
+bool ConstraintCluster::IsPartitionValid() const
+{
+	for(unsigned int i = 0; i < free_parameters_.size(); i++)
+		if(!free_parameters_[i]->IsFree())
+			return false;
+
+	for(unsigned int i = 0; i < fixed_parameters_.size(); i++)
+		if(fixed_parameters_[i]->IsFree())
+			return false;
+
+	return true;
+}
+
+// data shared by the thread pool tasks of SolveConstraintClusters
+typedef struct ClusterThreadData_s{
+	std::vector<ConstraintCluster> *clusters;
+	const std::vector<unsigned> *solve_order;
+	SOLVER_ENGINE solver_engine;
+	bool profiling;
+	RobustSolveOptions robust;
+	SolveLimits limits;
+	unsigned next_cluster;
+	bool error;
+	pthread_mutex_t lock;
+}ClusterThreadData;
+
+// each task claims clusters until none are left, so a thread that finishes a small cluster moves on to the next one
+static void ClusterTaskSolve(int /* task */, void *thread_data)
+{
+	ClusterThreadData *data = (ClusterThreadData *)thread_data;
+
+	while(true)
+	{
+		// obtain the mutex lock and claim the next unsolved cluster
+		pthread_mutex_lock(&data->lock);
+		unsigned current = data->next_cluster++;
+		pthread_mutex_unlock(&data->lock);
+
+		if(current >= data->solve_order->size())
+			break;
+
+		try {
+			(*data->clusters)[(*data->solve_order)[current]].Solve(data->solver_engine, data->profiling, data->robust, data->limits);
+		}
+		catch (...) {
+			// exceptions cannot cross the thread boundary, rethrown by SolveConstraintClusters
+			pthread_mutex_lock(&data->lock);
+			data->error = true;
+			pthread_mutex_unlock(&data->lock);
+		}
+	}
+}
+
+// used to sort the clusters so that the largest clusters are started first
+class ClusterSizeCompare
+{
+public:
+	ClusterSizeCompare(const std::vector<ConstraintCluster> &clusters) : clusters_(clusters) {;}
+	bool operator()(unsigned a, unsigned b) const {return clusters_[a].GetNumFreeParameters() > clusters_[b].GetNumFreeParameters();}
+private:
+	const std::vector<ConstraintCluster> &clusters_;
+};
+
+std::vector<unsigned> PrepareConstraintClusters(std::vector<ConstraintCluster> &clusters)
+{
+	std::vector<unsigned> solve_order;
+	for(unsigned int i = 0; i < clusters.size(); i++)
+	{
+		if(clusters[i].IsModified())
+		{
+			clusters[i].TakeSnapshot();
+			solve_order.push_back(i);
+		}
+	}
+	stable_sort(solve_order.begin(), solve_order.end(), ClusterSizeCompare(clusters));
+
+	return solve_order;
+}
+
+void SolveConstraintClusters(std::vector<ConstraintCluster> &clusters, const std::vector<unsigned> &solve_order, SOLVER_ENGINE solver_engine, bool profiling, const RobustSolveOptions &robust,
+                             const SolveLimits &limits)
+{
+	ClusterThreadData thread_data;
+	thread_data.clusters = &clusters;
+	thread_data.solve_order = &solve_order;
+	thread_data.solver_engine = solver_engine;
+	thread_data.profiling = profiling;
+	thread_data.robust = robust;
+	thread_data.limits = limits;
+	thread_data.next_cluster = 0;
+	thread_data.error = false;
+	pthread_mutex_init(&thread_data.lock, 0);
+
+	// the clusters are solved on the persistent mmcMatrix thread pool so that no threads are created per solve, a single
+	// cluster is solved on the calling thread which leaves the pool free for the matrix operations of that solve
+	unsigned num_tasks = mmcGetNumThreads();
+	if(num_tasks > solve_order.size())
+		num_tasks = solve_order.size();
+	mmcRunTasks(ClusterTaskSolve, (void *)&thread_data, num_tasks);
+
+	pthread_mutex_destroy(&thread_data.lock);
+
+	if(thread_data.error)
+		throw pSketcherException("Solver failure while solving a constraint cluster.");
+}
@@ -22,27 +22,317 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define ConstraintSolverH
 
 #include <map>
+#include <string>
 #include "SolverFunctions.h"
+#include "ConstructionPlan.h"
 #include "../mmcMatrix/mmcMatrix.h"
 #include "../NumOptimization/bfgs.h"
+#include "../NumOptimization/levenberg_marquardt.h"
+
+enum SOLVER_ENGINE {BFGS_ENGINE, LEVENBERG_MARQUARDT_ENGINE};
+
+// Evaluation count and time for one solver function type, only collected when profiling is enabled
+struct SolverFunctionTiming
+{
+	SolverFunctionTiming(const std::string &function_name = "") : name(function_name), evaluations(0), time(0.0) {;}
+
+	std::string name;      // as returned by SolverFunctionsBase::GetName()
+	unsigned evaluations;  // number of times a constraint of this type was evaluated (value or value and gradient)
+	double time;           // seconds
+};
+
+// Work done by the solver, reported for each cluster and summed over the clusters solved by a SolveConstraints call
+// Times are in seconds, since clusters may be solved concurrently the summed times can exceed the wall time of the solve
+struct SolverStatistics
+{
+	SolverStatistics() : clusters_solved(0), free_parameters(0), constraints(0), eliminated_parameters(0), eliminated_constraints(0), constructed_parameters(0), constructed_constraints(0), iterations(0), value_evaluations(0), gradient_evaluations(0),
+	                     solve_time(0.0), line_search_time(0.0), search_direction_time(0.0), value_evaluation_time(0.0), gradient_evaluation_time(0.0), starts(0), perturbed_wins(0), interrupted(0) {;}
+	void Add(const SolverStatistics &rhs);
+
+	unsigned clusters_solved;
+	unsigned free_parameters;         // free parameters and constraints handed to the numerical solver after the presolve
+	unsigned constraints;
+	unsigned eliminated_parameters;   // removed by the presolve
+	unsigned eliminated_constraints;
+	unsigned constructed_parameters;  // placed in closed form by the ConstructionPlan
+	unsigned constructed_constraints;
+	unsigned iterations;
+	unsigned value_evaluations;     // evaluations of the merit function or the residuals alone
+	unsigned gradient_evaluations;  // evaluations of the merit function and its gradient or the residuals and the jacobian
+
+	double solve_time;               // total time spent in the optimizer
+	double line_search_time;         // BFGS line search, includes the evaluations made by the line search
+	double search_direction_time;    // BFGS inverse hessian update or the Levenberg-Marquardt linear solve
+	double value_evaluation_time;
+	double gradient_evaluation_time;
+
+	std::vector<SolverFunctionTiming> function_timings; // one entry per solver function type
+
+	unsigned starts;          // number of starting points solved concurrently by the robust solve (1 for a normal solve)
+	unsigned perturbed_wins;  // number of clusters where a perturbed start was used instead of the current DOF values
+	unsigned interrupted;     // number of clusters where the optimizer was stopped by the SolveLimits before it converged
+};
+
+// Multi-start solve for clusters where a single start can end in a local minimum. The cluster is solved from the current DOF
+// values and from num_starts-1 perturbed starting points at the same time, each on its own thread with its own ConstraintSolver.
+// Each perturbed start is the lowest merit point found by MeritFunction::MonteCarloOptimization among monte_carlo_samples random
+// points within perturbation*(|x|+1) of the current values. The first start to reach a merit of merit_tolerance is used and the
+// others are cancelled, if none reaches it the start with the lowest merit is used.
+struct RobustSolveOptions
+{
+	RobustSolveOptions(unsigned starts = 1, double perturbation_scale = 0.1, unsigned samples = 8, double tolerance = 1.0e-12) :
+		num_starts(starts), perturbation(perturbation_scale), monte_carlo_samples(samples), merit_tolerance(tolerance) {;}
+
+	unsigned num_starts;  // 1 disables the robust solve
+	double perturbation;
+	unsigned monte_carlo_samples;
+	double merit_tolerance;
+};
+
+// Limits for an anytime solve (used while dragging), the optimizers stop at the start of the first iteration after GetSolverTime() passes
+// the deadline or *cancel_flag becomes non-zero and the best iterate found so far is used as the solution
+struct SolveLimits
+{
+	SolveLimits(double deadline_time = 0.0, const int *cancel = 0) : deadline(deadline_time), cancel_flag(cancel) {;}
+
+	double deadline;                 // 0 for no time limit
+	const int *cancel_flag; // may be set from another thread with __atomic_store_n, 0 for no cancellation
+};
+
+// Constraints of the same solver function type, dependent DOF's are read from their location in the full input vector like any other parameter
+// The parameters of the whole group are gathered into structure-of-arrays form and evaluated with one batched kernel call
+class ConstraintBatch
+{
+public:
+	ConstraintBatch(const SolverFunctionsBasePointer &prototype);
+
+	void AddConstraint(const SolverFunctionsBasePointer &constraint, double weight);
+
+	void EvaluateValues(const mmcMatrix &full_x);
+	void EvaluateValuesAndGradients(const mmcMatrix &full_x);
+
+	// add the weighted squared values to value and, for the second form, 2*weight*value*gradient of each constraint
+	// directly to full_gradient, the merit function paths use these so that no per-element accessors are needed
+	void AddMeritValue(const mmcMatrix &full_x, double &value);
+	void AddMeritValueAndGradient(const mmcMatrix &full_x, double &value, double *full_gradient);
+
+	unsigned GetCount() const {return weights_.size();}
+	unsigned GetNumParameters() const {return num_parameters_;}
+	double GetWeight(unsigned k) const {return weights_[k];}
+	double GetValue(unsigned k) const {return values_[k];}
+	double GetGradient(unsigned j, unsigned k) const {return gradients_[j][k];} // derivative of constraint k with respect to its parameter j
+	int GetParameterIndex(unsigned j, unsigned k) const {return parameter_indices_[j][k];} // location of parameter j of constraint k in the global parameter vector
+
+private:
+	void GatherParameters(const mmcMatrix &full_x);
+
+	SolverFunctionsValueBatch value_kernel_;
+	SolverFunctionsValueAndGradientBatch value_and_gradient_kernel_;
+	unsigned num_parameters_;
+
+	std::vector<double> weights_;
+	std::vector<std::vector<int> > parameter_indices_;
+	std::vector<std::vector<double> > parameters_;
+	std::vector<std::vector<double> > gradients_;
+	std::vector<double> values_;
+
+	// pointers to the first element of each of the structure-of-arrays vectors above, passed to the kernels
+	std::vector<const double *> parameter_pointers_;
+	std::vector<double *> gradient_pointers_;
+	std::vector<const int *> index_pointers_;
+};
 
 /* Now will define the merit function derived class used in the template matching */
-class ConstraintSolver : public MeritFunction
+class ConstraintSolver : public MeritFunction, public ResidualFunction
 {
 public:
-	ConstraintSolver(const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> & weights, const std::vector<DOFPointer> & free_parameters, const std::vector<DOFPointer> & fixed_parameters, const std::vector<double> & fixed_values);
+	// each DOF in merged_parameters takes its value from the free or fixed parameter at the same position in merged_targets
+	ConstraintSolver(const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> & weights, const std::vector<DOFPointer> & free_parameters, const std::vector<DOFPointer> & fixed_parameters, const std::vector<double> & fixed_values,
+	                 const std::vector<DOFPointer> & merged_parameters = std::vector<DOFPointer>(), const std::vector<DOFPointer> & merged_targets = std::vector<DOFPointer>());
 	virtual ~ConstraintSolver() {;}
 
 	virtual double GetMeritValue(const mmcMatrix & x);
 	virtual mmcMatrix GetMeritGradient(const mmcMatrix & x);
+	virtual void GetMeritValuePlusGradient(const mmcMatrix & x, double &value, mmcMatrix &gradient);
+
+	void SetFixedValues(const std::vector<double> & fixed_values); // update the fixed parameter values without rebuilding the solver
+
+	// residual form of the merit function used by the Levenberg-Marquardt engine, residual i is sqrt(weight_i)*constraint_i
+	virtual void GetResiduals(const mmcMatrix & x, mmcMatrix &residuals);
+	virtual void GetResidualsPlusJacobian(const mmcMatrix & x, mmcMatrix &residuals, SparseJacobian &jacobian);
+
+	// number and duration of the evaluations since the last call to ResetEvaluationCounts
+	unsigned GetNumValueEvaluations() const {return num_value_evaluations_;}
+	unsigned GetNumGradientEvaluations() const {return num_gradient_evaluations_;}
+	double GetValueEvaluationTime() const {return value_evaluation_time_;}
+	double GetGradientEvaluationTime() const {return gradient_evaluation_time_;}
+	const std::vector<SolverFunctionTiming> & GetFunctionTimings() const {return function_timings_;}
+	void ResetEvaluationCounts();
+
+	// when profiling is enabled each batch and each individually evaluated constraint is timed separately and the time is accumulated by solver function type
+	void SetProfiling(bool profiling) {profiling_ = profiling;}
+	bool GetProfiling() const {return profiling_;}
+
+	// the solver functions keep the map from the global parameter vector to their parameters, several solvers that share solver functions
+	// (the numerical and fallback solvers of a cluster) must call this before they are used if another solver was used last
+	void DefineInputMaps();
+
+	// cancels both MinimizeMeritFunction and MinimizeResiduals
+	void SetCancelFlag(const int *cancel_flag) {MeritFunction::SetCancelFlag(cancel_flag); ResidualFunction::SetCancelFlag(cancel_flag);}
+	void SetDeadline(double deadline) {MeritFunction::SetDeadline(deadline); ResidualFunction::SetDeadline(deadline);}
+
+	// a second cancel flag, used by a multi-start solve to stop the remaining starts without replacing the caller's cancel flag
+	void SetStopFlag(const int *stop_flag) {stop_flag_ = stop_flag;}
+	virtual bool IsCancelled() const {return MeritFunction::IsCancelled() || (stop_flag_ != 0 && __atomic_load_n(stop_flag_, __ATOMIC_ACQUIRE) != 0);}
 
 private:
+	// copies x into the full input vector and evaluates the dependent DOF's, their local gradients are also evaluated if compute_gradients is true
+	const mmcMatrix & GetFullInputVector(const mmcMatrix & x, bool compute_gradients);
+	void AddDependentDOF(DOFPointer dof, std::map<unsigned,unsigned> &dof_map);
+	void AccumulateDependentGradients(); // chain rule, moves the gradient of each dependent DOF in full_gradient_ to the DOF's it depends on
+	void ExpandDependentEntries(std::vector<std::pair<int,double> > &entries) const; // same as AccumulateDependentGradients for one sparse jacobian row
+
 	std::vector<DOFPointer> free_parameters_;
 	std::vector<DOFPointer> fixed_parameters_;
-	mmcMatrix fixed_values_;
+	std::map<unsigned,unsigned> dof_map_; // location of each DOF ID in full_input_vector_
+	mmcMatrix full_input_vector_; // free parameters followed by the fixed parameter values and then the values of the dependent DOF's
+	mmcMatrix full_gradient_;     // scratch space reused by each gradient evaluation
+
+	// dependent DOF's used by the constraints in topological order, each one only depends on DOF's that come before it
+	// each dependent DOF is evaluated once per iterate and stored in full_input_vector_ so that constraints that share a dependent DOF do not evaluate it again
+	std::vector<SolverFunctionsBasePointer> dependent_functions_;
+	std::vector<SolverFunctionsVector> dependent_gradients_; // local gradient of each dependent DOF at the current iterate
+	unsigned first_dependent_index_;                          // location of the first dependent DOF in full_input_vector_
 	std::vector<double> weights_;
 	std::vector<SolverFunctionsBasePointer> constraints_;
+
+	// constraints are evaluated in batches by type where possible, the rest (those using dependent DOF's) are evaluated individually
+	// the residuals of the batched constraints come first, followed by the individually evaluated constraints
+	std::vector<ConstraintBatch> constraint_batches_;
+	std::vector<unsigned> unbatched_constraints_;
+
+	// index into function_timings_ for each batch and for each constraint in constraints_
+	unsigned GetFunctionTimingIndex(const SolverFunctionsBasePointer &constraint);
+	void AddFunctionTime(unsigned timing_index, unsigned evaluations, double start_time);
+	std::vector<unsigned> batch_timing_indices_;
+	std::vector<unsigned> constraint_timing_indices_;
+	std::vector<unsigned> dependent_timing_indices_;
+
+	unsigned num_value_evaluations_;
+	unsigned num_gradient_evaluations_;
+	double value_evaluation_time_;
+	double gradient_evaluation_time_;
+	std::vector<SolverFunctionTiming> function_timings_;
+	bool profiling_;
+	const int *stop_flag_;
 };
 
+// A group of constraint equations that shares no free DOF's or dependent DOF's with any other group
+// Each cluster is solved with its own ConstraintSolver, so the clusters of a model can be solved in parallel
+class ConstraintCluster
+{
+public:
+	ConstraintCluster() : modified_(true), presolved_(false), start_solvers_owner_(0), residual_merit_(0.0), residual_merit_current_(false) {;}
+
+	void AddConstraint(SolverFunctionsBasePointer constraint, double weight);
+	void AddFreeParameter(DOFPointer free_parameter);
+	void AddFixedParameter(DOFPointer fixed_parameter);
+
+	// copies the current values of the free and fixed DOF's, Solve reads the DOF values from this snapshot only so that the model can be edited
+	// while the cluster is solved on another thread, must be called from the thread that owns the model
+	void TakeSnapshot();
+	bool IsSnapshotCurrent() const; // false if the value of any free or fixed DOF has changed since the last call to TakeSnapshot
+
+	// solves the cluster from the snapshot, the DOF's are not modified, the result is stored until ApplySolution is called
+	// the DOF equalities (hori_vert_2d for example) are removed by a presolve and each group of DOF's that they make equal is replaced by one
+	// representative DOF, a fixed DOF if the group contains one (a group with more than one fixed DOF is left to the numerical solver), then the points that can be placed in closed form are placed by a ConstructionPlan
+	// and are treated as fixed parameters, so that the numerical solver only sees the remaining coupled constraints
+	// solver output is captured by the cluster instead of being written directly since the clusters may be solved concurrently
+	// the ConstraintSolver is kept between calls and each solve is warm started from the current DOF values
+	// if profiling is true the statistics include the time spent in each solver function type
+	// if robust.num_starts is greater than one the numerical solve is a multi-start solve (see RobustSolveOptions)
+	// the numerical solve stops early if the limits are reached, the cluster then remains modified
+	void Solve(SOLVER_ENGINE solver_engine, bool profiling = false, const RobustSolveOptions &robust = RobustSolveOptions(), const SolveLimits &limits = SolveLimits());
+	void ApplySolution(bool update_db = true); // writes the computed values to the free DOF's, must be called from the thread that owns the model
+
+	// a cluster needs to be solved if it is new or if any of its DOF's have been modified since the last solve
+	bool IsModified() const;
+	void SetModified() {modified_ = true; residual_merit_current_ = false;}
+	void ClearModified();
+
+	// returns false if the free state of any DOF has changed since the cluster was created, the model then needs to be partitioned again
+	bool IsPartitionValid() const;
+
+	unsigned GetNumConstraints() const {return constraints_.size();}
+	unsigned GetNumFreeParameters() const {return free_parameters_.size();}
+	const std::string & GetSolverOutput() const {return solver_output_;}
+	const SolverStatistics & GetStatistics() const {return statistics_;} // work done by the last call to Solve
+
+	// weighted sum of the squared constraint values at the current DOF values, only evaluated again after ApplySolution has been called
+	// so that the clusters that were not solved again do not add to the cost of a solve
+	double GetResidualMerit();
+
+private:
+	std::vector<SolverFunctionsBasePointer> constraints_;
+	std::vector<double> weights_;
+	std::vector<DOFPointer> free_parameters_;
+	std::vector<DOFPointer> fixed_parameters_;
+
+	// values of free_parameters_ followed by fixed_parameters_ when TakeSnapshot was called
+	std::vector<double> snapshot_;
+	std::map<unsigned,unsigned> snapshot_index_; // DOF id to location in snapshot_
+	double GetSnapshotValue(const DOFPointer &dof) const;
+
+	void Presolve();
+	void SolveNumerically(boost::shared_ptr<ConstraintSolver> &constraint_solver, const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> &weights,
+	                      const std::vector<DOFPointer> &free_parameters, const std::vector<DOFPointer> &fixed_parameters, const std::vector<double> &fixed_values,
+	                      SOLVER_ENGINE solver_engine, bool profiling, const RobustSolveOptions &robust, const SolveLimits &limits);
+	mmcMatrix SolveMultiStart(boost::shared_ptr<ConstraintSolver> &constraint_solver, const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<double> &weights,
+	                          const std::vector<DOFPointer> &free_parameters, const std::vector<DOFPointer> &fixed_parameters, const std::vector<double> &fixed_values,
+	                          const mmcMatrix &initial_free_values, SOLVER_ENGINE solver_engine, const RobustSolveOptions &robust, const SolveLimits &limits, boost::shared_ptr<ConstraintSolver> &winning_solver);
+
+	boost::shared_ptr<ConstraintSolver> constraint_solver_;
+	bool modified_;
+
+	// result of the presolve, kept for as long as the cluster
+	bool presolved_;
+	std::vector<SolverFunctionsBasePointer> reduced_constraints_;
+	std::vector<double> reduced_weights_;
+	std::vector<DOFPointer> reduced_free_parameters_;
+	std::vector<DOFPointer> merged_parameters_; // free DOF's removed by the presolve
+	std::vector<DOFPointer> merged_targets_;    // the DOF that each merged DOF is equal to
+
+	// the part of the reduced cluster that is left for the numerical solver after the construction plan
+	ConstructionPlan construction_plan_;
+	std::vector<SolverFunctionsBasePointer> numeric_constraints_;
+	std::vector<double> numeric_weights_;
+	std::vector<DOFPointer> numeric_free_parameters_;
+	std::vector<DOFPointer> numeric_fixed_parameters_; // the fixed parameters followed by the constructed parameters
+
+	// used instead of constraint_solver_ if the construction plan fails for the current fixed values
+	boost::shared_ptr<ConstraintSolver> fallback_solver_;
+
+	// solvers for the perturbed starts of the robust solve, built for the problem of start_solvers_owner_
+	std::vector<boost::shared_ptr<ConstraintSolver> > start_solvers_;
+	const ConstraintSolver *start_solvers_owner_;
+
+	std::vector<double> solution_;
+	std::vector<DOFPointer> solution_parameters_;
+	std::string solver_output_;
+	SolverStatistics statistics_;
+
+	double residual_merit_;
+	bool residual_merit_current_;
+};
+
+// Takes a snapshot of each modified cluster and returns their indices in the order they should be solved (largest first),
+// must be called from the thread that owns the model
+std::vector<unsigned> PrepareConstraintClusters(std::vector<ConstraintCluster> &clusters);
+
+// Solves the clusters in solve_order using a pool of worker threads, one thread per processor core
+// only the snapshots taken by PrepareConstraintClusters are read so this may be called from a thread that does not own the model
+void SolveConstraintClusters(std::vector<ConstraintCluster> &clusters, const std::vector<unsigned> &solve_order, SOLVER_ENGINE solver_engine, bool profiling = false,
+                             const RobustSolveOptions &robust = RobustSolveOptions(), const SolveLimits &limits = SolveLimits());
+
 #endif //ConstraintSolverH
 
@@ -0,0 +1,343 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <deque>
+#include "ConstructionPlan.h"
+
+using namespace std;
+
+// a step whose discriminant is negative by less than this amount (relative to the squared radius) is treated as tangent
+const double construction_tolerance = 1.0e-10;
+
+static double SquaredDistance(double s1, double t1, double s2, double t2)
+{
+	return (s1-s2)*(s1-s2) + (t1-t2)*(t1-t2);
+}
+
+int ConstructionPlan::GetSlot(DOFPointer dof)
+{
+	if(dof->IsDependent())
+		return -1;
+
+	map<unsigned,DOFPointer>::iterator merged_it = merged_map_.find(dof->GetID());
+	if(merged_it != merged_map_.end())
+		dof = merged_it->second;
+
+	map<unsigned,int>::iterator slot_it = slot_map_.find(dof->GetID());
+	if(slot_it != slot_map_.end())
+		return slot_it->second;
+
+	int slot = slot_dofs_.size();
+	slot_map_[dof->GetID()] = slot;
+	slot_dofs_.push_back(dof);
+	slot_known_.push_back(free_ids_.count(dof->GetID()) == 0); // fixed DOF's are known from the start
+	return slot;
+}
+
+void ConstructionPlan::MarkKnown(int slot)
+{
+	slot_known_[slot] = true;
+	constructed_slots_.push_back(slot);
+	constructed_parameters_.push_back(slot_dofs_[slot]);
+}
+
+void ConstructionPlan::Build(const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<DOFPointer> &free_parameters, const std::vector<DOFPointer> &fixed_parameters,
+                             const std::vector<DOFPointer> &merged_parameters, const std::vector<DOFPointer> &merged_targets)
+{
+	steps_.clear();
+	constructed_parameters_.clear();
+	constructed_slots_.clear();
+	used_constraints_.clear();
+	slot_dofs_.clear();
+	slot_known_.clear();
+	slot_map_.clear();
+	merged_map_.clear();
+	free_ids_.clear();
+	constraints_.clear();
+	incidence_.clear();
+
+	for(unsigned int i = 0; i < merged_parameters.size(); i++)
+		merged_map_[merged_parameters[i]->GetID()] = merged_targets[i];
+	for(unsigned int i = 0; i < free_parameters.size(); i++)
+		free_ids_.insert(free_parameters[i]->GetID());
+
+	// describe each constraint by its slots
+	for(unsigned int i = 0; i < constraints.size(); i++)
+	{
+		SolverFunctionsBase *solver_function = constraints[i].get();
+		ConstructionConstraint current;
+
+		if(dynamic_cast<distance_point_2d *>(solver_function) != 0) {
+			current.type = DISTANCE_CONSTRAINT;
+			current.num_points = 2;
+		} else if(dynamic_cast<angle_line_2d_interior *>(solver_function) != 0) {
+			current.type = ANGLE_CONSTRAINT;
+			current.num_points = 4;
+		} else if(dynamic_cast<angle_line_2d_exterior *>(solver_function) != 0) {
+			current.type = ANGLE_CONSTRAINT;
+			current.num_points = 4;
+			current.exterior = true;
+		} else if(dynamic_cast<parallel_line_2d *>(solver_function) != 0) {
+			current.type = PARALLEL_CONSTRAINT;
+			current.num_points = 4;
+		}
+
+		for(int j = 0; j < current.num_points; j++)
+		{
+			current.point_s[j] = GetSlot(solver_function->GetDOF(2*j));
+			current.point_t[j] = GetSlot(solver_function->GetDOF(2*j+1));
+			incidence_[current.point_s[j]].push_back(i);
+			incidence_[current.point_t[j]].push_back(i);
+		}
+		if(current.type == DISTANCE_CONSTRAINT || current.type == ANGLE_CONSTRAINT)
+			current.value = GetSlot(solver_function->GetDOF(2*current.num_points));
+
+		constraints_.push_back(current);
+	}
+
+	// propagate outward from the known DOF's, when a point is placed the constraints that use it are checked again
+	std::deque<unsigned> work_list;
+	for(unsigned int i = 0; i < constraints_.size(); i++)
+		if(constraints_[i].type != OTHER_CONSTRAINT)
+			work_list.push_back(i);
+
+	while(work_list.size() > 0)
+	{
+		unsigned current = work_list.front();
+		work_list.pop_front();
+
+		for(int j = 0; j < constraints_[current].num_points; j++)
+		{
+			int point_s = constraints_[current].point_s[j];
+			int point_t = constraints_[current].point_t[j];
+			if(!TryPlacePoint(point_s, point_t))
+				continue;
+
+			work_list.insert(work_list.end(), incidence_[point_s].begin(), incidence_[point_s].end());
+			work_list.insert(work_list.end(), incidence_[point_t].begin(), incidence_[point_t].end());
+		}
+	}
+}
+
+bool ConstructionPlan::TryPlacePoint(int point_s, int point_t)
+{
+	if(point_s < 0 || point_t < 0 || point_s == point_t)
+		return false;
+
+	bool s_unknown = IsUnknown(point_s);
+	bool t_unknown = IsUnknown(point_t);
+	if((!s_unknown && !IsKnown(point_s)) || (!t_unknown && !IsKnown(point_t)) || (!s_unknown && !t_unknown))
+		return false;
+
+	// unused distance constraints from this point to a known point
+	std::vector<unsigned> distances;
+	std::vector<int> centers;
+	const std::vector<unsigned> &incident = incidence_[point_s];
+	for(unsigned int i = 0; i < incident.size(); i++)
+	{
+		const ConstructionConstraint &constraint = constraints_[incident[i]];
+		if(constraint.type != DISTANCE_CONSTRAINT || used_constraints_.count(incident[i]) > 0 || !IsKnown(constraint.value))
+			continue;
+
+		for(int j = 0; j < 2; j++)
+			if(constraint.point_s[j] == point_s && constraint.point_t[j] == point_t && IsPointKnown(constraint, 1-j))
+			{
+				distances.push_back(incident[i]);
+				centers.push_back(1-j);
+			}
+	}
+
+	if(distances.size() == 0)
+		return false;
+
+	ConstructionStep step;
+	step.point_s = point_s;
+	step.point_t = point_t;
+	step.center1_s = constraints_[distances[0]].point_s[centers[0]];
+	step.center1_t = constraints_[distances[0]].point_t[centers[0]];
+	step.radius1 = constraints_[distances[0]].value;
+	unsigned second_constraint = distances[0];
+
+	if(!s_unknown || !t_unknown)
+	{
+		step.type = CIRCLE_COORDINATE;
+		step.solve_s = s_unknown;
+	} else {
+		// a second distance constraint with a different center
+		bool found = false;
+		for(unsigned int i = 1; i < distances.size() && !found; i++)
+		{
+			const ConstructionConstraint &constraint = constraints_[distances[i]];
+			if(constraint.point_s[centers[i]] == step.center1_s && constraint.point_t[centers[i]] == step.center1_t)
+				continue;
+
+			step.type = CIRCLE_CIRCLE;
+			step.center2_s = constraint.point_s[centers[i]];
+			step.center2_t = constraint.point_t[centers[i]];
+			step.radius2 = constraint.value;
+			second_constraint = distances[i];
+			found = true;
+		}
+
+		// an angle or parallel constraint between the line from the first center to the point and a known line
+		for(unsigned int i = 0; i < incident.size() && !found; i++)
+		{
+			const ConstructionConstraint &constraint = constraints_[incident[i]];
+			if((constraint.type != ANGLE_CONSTRAINT && constraint.type != PARALLEL_CONSTRAINT) || used_constraints_.count(incident[i]) > 0)
+				continue;
+			if(constraint.type == ANGLE_CONSTRAINT && !IsKnown(constraint.value))
+				continue;
+
+			for(int line = 0; line < 2 && !found; line++)
+			{
+				int other_line = 1 - line;
+				if(!IsPointKnown(constraint, 2*other_line) || !IsPointKnown(constraint, 2*other_line+1))
+					continue;
+
+				for(int end = 0; end < 2 && !found; end++)
+				{
+					int point = 2*line + end;
+					int center = 2*line + 1 - end;
+					if(constraint.point_s[point] != point_s || constraint.point_t[point] != point_t ||
+					   constraint.point_s[center] != step.center1_s || constraint.point_t[center] != step.center1_t)
+						continue;
+
+					step.type = DISTANCE_ANGLE;
+					step.line_point1_s = constraint.point_s[2*other_line];
+					step.line_point1_t = constraint.point_t[2*other_line];
+					step.line_point2_s = constraint.point_s[2*other_line+1];
+					step.line_point2_t = constraint.point_t[2*other_line+1];
+					step.angle = (constraint.type == ANGLE_CONSTRAINT) ? constraint.value : -1;
+					step.exterior = constraint.exterior;
+					step.direction = (end == 0) ? 1.0 : -1.0;
+					second_constraint = incident[i];
+					found = true;
+				}
+			}
+		}
+
+		if(!found)
+			return false;
+	}
+
+	used_constraints_.insert(distances[0]);
+	used_constraints_.insert(second_constraint);
+	if(s_unknown)
+		MarkKnown(point_s);
+	if(t_unknown)
+		MarkKnown(point_t);
+	steps_.push_back(step);
+
+	return true;
+}
+
+bool ConstructionPlan::Execute(const std::vector<double> &slot_values, std::vector<double> &constructed_values) const
+{
+	// the current values of the constructed DOF's are used to choose between the two solutions of each step
+	std::vector<double> values(slot_values);
+
+	for(unsigned int i = 0; i < steps_.size(); i++)
+	{
+		const ConstructionStep &step = steps_[i];
+		double current_s = values[step.point_s];
+		double current_t = values[step.point_t];
+		double center_s = values[step.center1_s];
+		double center_t = values[step.center1_t];
+		double radius = values[step.radius1];
+
+		double candidate_s[2], candidate_t[2];
+
+		if(step.type == CIRCLE_COORDINATE)
+		{
+			double known_offset = step.solve_s ? current_t - center_t : current_s - center_s;
+			double discriminant = radius*radius - known_offset*known_offset;
+			if(discriminant < -construction_tolerance*(radius*radius + 1.0))
+				return false;
+			double offset = sqrt(max(discriminant, 0.0));
+
+			for(int j = 0; j < 2; j++)
+			{
+				double sign = (j == 0) ? 1.0 : -1.0;
+				candidate_s[j] = step.solve_s ? center_s + sign*offset : current_s;
+				candidate_t[j] = step.solve_s ? current_t : center_t + sign*offset;
+			}
+		} else if(step.type == CIRCLE_CIRCLE) {
+			double center2_s = values[step.center2_s];
+			double center2_t = values[step.center2_t];
+			double radius2 = values[step.radius2];
+
+			double center_distance = sqrt(SquaredDistance(center_s, center_t, center2_s, center2_t));
+			if(center_distance < construction_tolerance)
+				return false;
+
+			// distance along the line between the centers to the chord through the two intersections
+			double along = (radius*radius - radius2*radius2 + center_distance*center_distance)/(2.0*center_distance);
+			double discriminant = radius*radius - along*along;
+			if(discriminant < -construction_tolerance*(radius*radius + 1.0))
+				return false;
+			double across = sqrt(max(discriminant, 0.0));
+
+			double unit_s = (center2_s - center_s)/center_distance;
+			double unit_t = (center2_t - center_t)/center_distance;
+			for(int j = 0; j < 2; j++)
+			{
+				double sign = (j == 0) ? 1.0 : -1.0;
+				candidate_s[j] = center_s + along*unit_s - sign*across*unit_t;
+				candidate_t[j] = center_t + along*unit_t + sign*across*unit_s;
+			}
+		} else {
+			double line_s = values[step.line_point1_s] - values[step.line_point2_s];
+			double line_t = values[step.line_point1_t] - values[step.line_point2_t];
+			double line_length = sqrt(line_s*line_s + line_t*line_t);
+			if(line_length < construction_tolerance)
+				return false;
+			line_s /= line_length;
+			line_t /= line_length;
+
+			// a parallel line points either way along the reference line, an angle can be measured to either side of it
+			// the exterior angle is pi - angle, cos(pi - angle) = -cos(angle) and sin(pi - angle) = sin(angle)
+			double rotation_cos = 1.0, rotation_sin = 0.0;
+			if(step.angle >= 0)
+			{
+				rotation_cos = step.exterior ? -cos(values[step.angle]) : cos(values[step.angle]);
+				rotation_sin = sin(values[step.angle]);
+			}
+
+			for(int j = 0; j < 2; j++)
+			{
+				double candidate_cos = (step.angle < 0 && j == 1) ? -rotation_cos : rotation_cos;
+				double candidate_sin = (j == 1) ? -rotation_sin : rotation_sin;
+				candidate_s[j] = center_s + step.direction*radius*(candidate_cos*line_s - candidate_sin*line_t);
+				candidate_t[j] = center_t + step.direction*radius*(candidate_sin*line_s + candidate_cos*line_t);
+			}
+		}
+
+		int best = (SquaredDistance(candidate_s[0], candidate_t[0], current_s, current_t) <= SquaredDistance(candidate_s[1], candidate_t[1], current_s, current_t)) ? 0 : 1;
+		values[step.point_s] = candidate_s[best];
+		values[step.point_t] = candidate_t[best];
+	}
+
+	constructed_values.clear();
+	for(unsigned int i = 0; i < constructed_slots_.size(); i++)
+		constructed_values.push_back(values[constructed_slots_[i]]);
+
+	return true;
+}
@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ConstructionPlanH
+#define ConstructionPlanH
+
+#include <map>
+#include <set>
+#include <vector>
+#include "SolverFunctions.h"
+
+// Closed form steps, each one places one point using constraints to points that have already been placed or are fixed
+// CIRCLE_CIRCLE:     two distance constraints to known points
+// CIRCLE_COORDINATE: one coordinate of the point is known and there is a distance constraint to a known point
+// DISTANCE_ANGLE:    a distance constraint to a known point A and an angle or parallel constraint between the line from A and a known line
+enum ConstructionStepType {CIRCLE_CIRCLE, CIRCLE_COORDINATE, DISTANCE_ANGLE};
+
+// The values used by the steps are stored in slots, each slot is one independent DOF (merged DOF's share the slot of their target)
+struct ConstructionStep
+{
+	ConstructionStepType type;
+	int point_s, point_t;              // the point being placed
+	bool solve_s;                      // CIRCLE_COORDINATE only, true if the s coordinate is the unknown one
+	int center1_s, center1_t, radius1;
+	int center2_s, center2_t, radius2; // CIRCLE_CIRCLE only
+
+	// DISTANCE_ANGLE only, the point is placed at center1 + direction*radius1*(unit vector of the reference line rotated by the angle)
+	int line_point1_s, line_point1_t, line_point2_s, line_point2_t;
+	int angle;                         // -1 for a parallel constraint
+	bool exterior;                     // the angle constraint is satisfied by pi - angle
+	double direction;                  // +1 if the point is the first point of its line, -1 if it is the second point
+};
+
+// The constraints that the planner uses, described by their slots
+// a DISTANCE_CONSTRAINT has two points and the distance as its value, ANGLE_CONSTRAINT and PARALLEL_CONSTRAINT have two lines (four points)
+enum ConstructionConstraintType {OTHER_CONSTRAINT, DISTANCE_CONSTRAINT, ANGLE_CONSTRAINT, PARALLEL_CONSTRAINT};
+
+struct ConstructionConstraint
+{
+	ConstructionConstraint() : type(OTHER_CONSTRAINT), num_points(0), value(-1), exterior(false) {;}
+
+	ConstructionConstraintType type;
+	int point_s[4], point_t[4];
+	int num_points;
+	int value;
+	bool exterior;
+};
+
+// Graph constructive planner for the simple rigid parts of a constraint cluster
+// Build finds the points that can be placed in closed form by propagating outward from the fixed DOF's, the constraints
+// that are used to place them no longer need to be solved numerically. Execute places the points from the current fixed values,
+// where a step has two solutions the one closest to the current location of the point is used so that the sketch keeps its shape.
+class ConstructionPlan
+{
+public:
+	// constraints and free_parameters are the cluster after the DOF equality presolve, each merged parameter is replaced by its target
+	void Build(const std::vector<SolverFunctionsBasePointer> &constraints, const std::vector<DOFPointer> &free_parameters, const std::vector<DOFPointer> &fixed_parameters,
+	           const std::vector<DOFPointer> &merged_parameters, const std::vector<DOFPointer> &merged_targets);
+
+	// computes the values of the constructed parameters, returns false if a step has no real solution (the constraints are inconsistent)
+	// slot_values holds the value of each DOF returned by GetSlotDOFs
+	bool Execute(const std::vector<double> &slot_values, std::vector<double> &constructed_values) const;
+
+	const std::vector<DOFPointer> & GetSlotDOFs() const {return slot_dofs_;} // the DOF's read by Execute
+	unsigned GetNumSteps() const {return steps_.size();}
+	const std::vector<DOFPointer> & GetConstructedParameters() const {return constructed_parameters_;}
+	bool IsConstraintUsed(unsigned constraint_index) const {return used_constraints_.count(constraint_index) > 0;}
+
+private:
+	int GetSlot(DOFPointer dof);
+	bool IsKnown(int slot) const {return slot >= 0 && slot_known_[slot];}
+	bool IsUnknown(int slot) const {return slot >= 0 && !slot_known_[slot] && free_ids_.count(slot_dofs_[slot]->GetID()) > 0;}
+	bool IsPointKnown(const ConstructionConstraint &constraint, int point) const {return IsKnown(constraint.point_s[point]) && IsKnown(constraint.point_t[point]);}
+	bool TryPlacePoint(int point_s, int point_t);
+	void MarkKnown(int slot);
+
+	std::vector<ConstructionStep> steps_;
+	std::vector<DOFPointer> constructed_parameters_;
+	std::vector<int> constructed_slots_;
+	std::set<unsigned> used_constraints_;
+
+	std::vector<DOFPointer> slot_dofs_;
+	std::vector<bool> slot_known_;
+	std::map<unsigned,int> slot_map_;           // DOF id to slot
+	std::map<unsigned,DOFPointer> merged_map_;  // merged DOF id to its target
+	std::set<unsigned> free_ids_;
+	std::vector<ConstructionConstraint> constraints_;
+	std::map<int,std::vector<unsigned> > incidence_; // constraints that use each slot
+};
+
+#endif //ConstructionPlanH
@@ -32,7 +32,8 @@ unsigned DOF::next_id_number_ = 1;
 DOF::DOF (bool free, bool dependent) :
 id_number_(next_id_number_++),free_(free), dependent_(dependent),
 database_(0),
-delete_me_(false)
+delete_me_(false),
+modified_(true)
 {
 	// by default, name variable using id_number_
 	stringstream variable_name;
@@ -44,7 +45,8 @@ delete_me_(false)
 DOF::DOF ( const char *name, bool free, bool dependent) :
 id_number_(next_id_number_++),free_(free), dependent_(dependent),
 database_(0),
-delete_me_(false)
+delete_me_(false),
+modified_(true)
 {
 	name_ = name;
 }
@@ -52,7 +54,8 @@ delete_me_(false)
 DOF::DOF (unsigned id, bool dependent) :
 id_number_(id),free_(false), dependent_(dependent),
 database_(0),
-delete_me_(false)
+delete_me_(false),
+modified_(true)
 {
 
 }
\ No newline at end of file
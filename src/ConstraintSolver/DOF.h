@@ -53,10 +53,14 @@ class DOF
         void SetSolverFunction(SolverFunctionsBasePointer solver_function) {solver_function_ = solver_function;}
 
 		bool IsFree()const {return free_;}
-		virtual void SetFree(bool free) {free_ = free;}
+		virtual void SetFree(bool free) {free_ = free; MarkModified();}
 
 		bool IsDependent()const {return dependent_;}
 
+		// set whenever the value or the free state of this DOF changes, used by pSketcherModel to determine which constraint clusters need to be solved again
+		bool IsModified()const {return modified_;}
+		void ClearModified() {modified_ = false;}
+
 		void FlagForDeletion() {delete_me_ = true;}
 		void UnflagForDeletion() {delete_me_ = false;}
 		bool IsFlaggedForDeletion() const {return delete_me_;}
@@ -70,6 +74,8 @@ class DOF
 		virtual bool SyncToDatabase(pSketcherModel &psketcher_model) = 0;
 
 	protected:
+		void MarkModified() {modified_ = true;}
+
 		// if not zero, this is the database where changes to the value of this DOF are stored
 		sqlite3 *database_;
 
@@ -80,6 +86,8 @@ class DOF
 		// deletion flag used when deleting primitives model
 		bool delete_me_;
 
+		bool modified_;
+
 		bool dependent_;
 		// static variable used to provide a unique ID number to each instance of this class
 		static unsigned next_id_number_;
@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <sstream>
+#include "DatabaseRow.h"
+#include "UndoLog.h"
+#include "PrimitiveBase.h"
+
+using namespace std;
+
+DatabaseRow::DatabaseRow(const std::string &table_name, const std::string &table_schema, const std::string &list_table_name, unsigned id):
+table_name_(table_name),
+table_schema_(table_schema),
+list_table_name_(list_table_name),
+id_(id)
+{
+}
+
+DatabaseRow & DatabaseRow::operator<<(int value)
+{
+	values_.push_back(DatabaseValue(value));
+	return *this;
+}
+
+DatabaseRow & DatabaseRow::operator<<(double value)
+{
+	values_.push_back(DatabaseValue(value));
+	return *this;
+}
+
+DatabaseRow & DatabaseRow::operator<<(const std::string &value)
+{
+	values_.push_back(DatabaseValue(value));
+	return *this;
+}
+
+void DatabaseRow::AddRemove(sqlite3 *database, bool add_to_database) const
+{
+	vector<DatabaseValue> row(1, DatabaseValue((int)id_));
+	row.insert(row.end(), values_.begin(), values_.end());
+
+	vector<DatabaseValue> list_row(1, DatabaseValue((int)id_));
+	list_row.push_back(DatabaseValue(table_name_));
+
+	// a savepoint is used instead of BEGIN/COMMIT so that the row can be added or removed inside of a larger transaction
+	CachedStatement(database, "SAVEPOINT database_row;").Execute();
+
+	try {
+		if(add_to_database)
+		{
+			// the table may not exist yet if this is the first object of its type
+			CachedStatement table_exists(database, "SELECT count(*) FROM sqlite_master WHERE type='table' AND name=?;");
+			table_exists.Bind(1,table_name_).Step();
+			if(table_exists.GetInt(0) == 0)
+				ExecuteSQL(database, table_schema_);
+
+			stringstream sql_command;
+			sql_command << "INSERT INTO " << table_name_ << " VALUES(?";
+			for(unsigned int i = 0; i < values_.size(); i++)
+				sql_command << ",?";
+			sql_command << ");";
+
+			CachedStatement insert_row(database, sql_command.str());
+			for(unsigned int i = 0; i < row.size(); i++)
+				insert_row.Bind(i+1,row[i]);
+			insert_row.Execute();
+
+			CachedStatement insert_list(database, "INSERT INTO " + list_table_name_ + " VALUES(?,?);");
+			insert_list.Bind(1,id_).Bind(2,table_name_).Execute();
+
+			RecordRowChange(database, table_name_, row, true);
+			RecordRowChange(database, list_table_name_, list_row, true);
+		} else {
+			CachedStatement(database, "DELETE FROM " + list_table_name_ + " WHERE id=?;").Bind(1,id_).Execute();
+			CachedStatement(database, "DELETE FROM " + table_name_ + " WHERE id=?;").Bind(1,id_).Execute();
+
+			RecordRowChange(database, list_table_name_, list_row, false);
+			RecordRowChange(database, table_name_, row, false);
+		}
+	}
+	catch (pSketcherException e) {
+		ExecuteSQL(database, "ROLLBACK TO database_row; RELEASE database_row;");
+		throw;
+	}
+
+	CachedStatement(database, "RELEASE database_row;").Execute();
+}
+
+DatabaseLinks::DatabaseLinks(const std::string &link_table_name, unsigned owner_id):
+link_table_name_(link_table_name),
+owner_id_(owner_id)
+{
+}
+
+std::vector<DatabaseValue> DatabaseLinks::GetLinkRow(unsigned position) const
+{
+	vector<DatabaseValue> row;
+	row.push_back(DatabaseValue((int)owner_id_));
+	row.push_back(DatabaseValue((int)position));
+	row.push_back(DatabaseValue((int)linked_ids_[position]));
+	return row;
+}
+
+void DatabaseLinks::AddRemove(sqlite3 *database, bool add_to_database) const
+{
+	// nothing to add, remove or undo
+	if(linked_ids_.size() == 0)
+		return;
+
+	CachedStatement(database, "SAVEPOINT database_links;").Execute();
+
+	try {
+		if(add_to_database)
+		{
+			string sql_insert_link = "INSERT INTO " + link_table_name_ + " VALUES(?,?,?);";
+			for(unsigned int position = 0; position < linked_ids_.size(); position++)
+			{
+				CachedStatement(database, sql_insert_link).Bind(1,owner_id_).Bind(2,position).Bind(3,linked_ids_[position]).Execute();
+				RecordRowChange(database, link_table_name_, GetLinkRow(position), true);
+			}
+		} else {
+			CachedStatement(database, "DELETE FROM " + link_table_name_ + " WHERE owner_id=?;").Bind(1,owner_id_).Execute();
+
+			for(unsigned int position = 0; position < linked_ids_.size(); position++)
+				RecordRowChange(database, link_table_name_, GetLinkRow(position), false);
+		}
+	}
+	catch (pSketcherException e) {
+		ExecuteSQL(database, "ROLLBACK TO database_links; RELEASE database_links;");
+		throw;
+	}
+
+	CachedStatement(database, "RELEASE database_links;").Execute();
+}
@@ -0,0 +1,76 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef DatabaseRowH
+#define DatabaseRowH
+
+#include <string>
+#include <vector>
+#include "StatementCache.h"
+
+// One row of the table that stores a DOF, primitive or constraint equation along with its entry in the list table
+// (dof_list, primitive_list or constraint_equation_list) that maps the id to the table.
+// AddRemove(..) inserts or deletes the row using cached prepared statements and records the change in the undo log.
+class DatabaseRow
+{
+	public:
+		// table_schema is executed to create the table if it does not exist yet
+		DatabaseRow(const std::string &table_name, const std::string &table_schema, const std::string &list_table_name, unsigned id);
+
+		// append the values of the remaining columns in the order that they appear in the table
+		DatabaseRow & operator<<(int value);
+		DatabaseRow & operator<<(unsigned value) {return *this << (int)value;}
+		DatabaseRow & operator<<(bool value) {return *this << (int)value;}
+		DatabaseRow & operator<<(double value);
+		DatabaseRow & operator<<(const std::string &value);
+
+		void AddRemove(sqlite3 *database, bool add_to_database) const;
+
+	private:
+		std::string table_name_;
+		std::string table_schema_;
+		std::string list_table_name_;
+		unsigned id_;
+
+		std::vector<DatabaseValue> values_;
+};
+
+// The ids that one object links to in a link table (dof_link_list, primitive_link_list or source_dof_link_list), one row
+// (owner_id, position, linked id) is stored for each link so that the order of the links is preserved.
+// AddRemove(..) inserts or deletes the links using cached prepared statements and records the change in the undo log.
+class DatabaseLinks
+{
+	public:
+		DatabaseLinks(const std::string &link_table_name, unsigned owner_id);
+
+		// append the next linked id
+		DatabaseLinks & operator<<(unsigned linked_id) {linked_ids_.push_back(linked_id); return *this;}
+
+		void AddRemove(sqlite3 *database, bool add_to_database) const;
+
+	private:
+		std::vector<DatabaseValue> GetLinkRow(unsigned position) const; // (owner_id, position, linked id)
+
+		std::string link_table_name_;
+		unsigned owner_id_;
+		std::vector<unsigned> linked_ids_;
+};
+
+#endif //DatabaseRowH
@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <sstream>
+#include "DatabaseSnapshot.h"
+#include "StatementCache.h"
+#include "pSketcherModel.h"
+
+using namespace std;
+
+// copies the current row of statement
+static void CopyRow(const CachedStatement &statement, SnapshotRow &row)
+{
+	row.resize(statement.GetColumnCount());
+	for(int column = 0; column < (int)row.size(); column++)
+	{
+		// the column type must be checked before any conversion takes place
+		if(statement.GetType(column) == SQLITE_TEXT)
+		{
+			row[column].number = 0.0;
+			row[column].text = statement.GetText(column);
+		} else {
+			row[column].number = statement.GetDouble(column);
+		}
+	}
+}
+
+DatabaseSnapshot::DatabaseSnapshot(sqlite3 *database):
+database_(database)
+{
+	// the lists of all of the DOF's, primitives and constraint equations, the second column names the table that defines each object
+	ReadTable("dof_list");
+	ReadTable("primitive_list");
+	ReadTable("constraint_equation_list");
+
+	// each type of object has its own table
+	set<string> object_tables;
+	CollectText("dof_list",1,object_tables);
+	CollectText("primitive_list",1,object_tables);
+	CollectText("constraint_equation_list",1,object_tables);
+
+	for(set<string>::const_iterator table_it = object_tables.begin(); table_it != object_tables.end(); table_it++)
+		ReadTable(*table_it);
+
+	// the DOF's and primitives that each object depends on
+	ReadLinkTable(SQL_dof_link_database_table_name);
+	ReadLinkTable(SQL_primitive_link_database_table_name);
+	ReadLinkTable(SQL_source_dof_link_database_table_name);
+}
+
+const SnapshotTable *DatabaseSnapshot::FindTable(const std::string &table_name) const
+{
+	map<string,SnapshotTable>::const_iterator table_it = tables_.find(table_name);
+
+	if(table_it != tables_.end())
+		return &table_it->second;
+	else
+		return 0;
+}
+
+const SnapshotLinks *DatabaseSnapshot::FindLinks(const std::string &link_table_name) const
+{
+	map<string,SnapshotLinks>::const_iterator links_it = links_.find(link_table_name);
+
+	if(links_it != links_.end())
+		return &links_it->second;
+	else
+		return 0;
+}
+
+void DatabaseSnapshot::ReadTable(const std::string &table_name)
+{
+	SnapshotTable &table = tables_[table_name];
+
+	CachedStatement statement(database_, "SELECT * FROM " + table_name + ";");
+	while(statement.Step())
+		CopyRow(statement, table[statement.GetInt(0)]);
+}
+
+void DatabaseSnapshot::ReadLinkTable(const std::string &link_table_name)
+{
+	SnapshotLinks &links = links_[link_table_name];
+
+	// the primary key (owner_id, position) index returns the links of each owner in order
+	CachedStatement statement(database_, "SELECT * FROM " + link_table_name + " ORDER BY owner_id, position;");
+	while(statement.Step())
+		links[statement.GetInt(0)].push_back(statement.GetInt(2));
+}
+
+void DatabaseSnapshot::CollectText(const std::string &table_name, int column, std::set<std::string> &values) const
+{
+	const SnapshotTable *table = FindTable(table_name);
+	if(table == 0)
+		return;
+
+	for(SnapshotTable::const_iterator row_it = table->begin(); row_it != table->end(); row_it++)
+	{
+		if(column < (int)row_it->second.size())
+			values.insert(row_it->second[column].text);
+	}
+}
+
+TableRow::TableRow(pSketcherModel &psketcher_model, const std::string &table_name, unsigned id):
+row_(0)
+{
+	const SnapshotTable *table = 0;
+	if(psketcher_model.GetSnapshot() != 0)
+		table = psketcher_model.GetSnapshot()->FindTable(table_name);
+
+	if(table != 0)
+	{
+		SnapshotTable::const_iterator row_it = table->find(id);
+		if(row_it != table->end())
+			row_ = &row_it->second;
+	} else {
+		// the table is not part of a snapshot, read the row from the database
+		CachedStatement statement(psketcher_model.GetDatabase(), "SELECT * FROM " + table_name + " WHERE id=?;");
+		statement.Bind(1,id);
+
+		if(statement.Step())
+		{
+			CopyRow(statement, fetched_row_);
+			row_ = &fetched_row_;
+		}
+	}
+}
+
+void ReadLinks(pSketcherModel &psketcher_model, const std::string &link_table_name, unsigned owner_id, std::vector<unsigned> &linked_ids)
+{
+	linked_ids.clear();
+
+	const SnapshotLinks *links = 0;
+	if(psketcher_model.GetSnapshot() != 0)
+		links = psketcher_model.GetSnapshot()->FindLinks(link_table_name);
+
+	if(links != 0)
+	{
+		SnapshotLinks::const_iterator links_it = links->find(owner_id);
+		if(links_it != links->end())
+			linked_ids = links_it->second;
+	} else {
+		// the table is not part of a snapshot, read the links from the database
+		CachedStatement statement(psketcher_model.GetDatabase(), "SELECT * FROM " + link_table_name + " WHERE owner_id=? ORDER BY position;");
+		statement.Bind(1,owner_id);
+
+		while(statement.Step())
+			linked_ids.push_back(statement.GetInt(2));
+	}
+}
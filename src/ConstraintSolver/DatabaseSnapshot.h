@@ -0,0 +1,91 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef DatabaseSnapshotH
+#define DatabaseSnapshotH
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "../sqlite3/sqlite3.h"
+
+class pSketcherModel;
+
+// one column of a row read from the database, text is only stored for text columns
+struct SnapshotValue
+{
+	double number;
+	std::string text;
+};
+typedef std::vector<SnapshotValue> SnapshotRow;
+typedef std::map<unsigned,SnapshotRow> SnapshotTable; // rows keyed by id
+typedef std::map<unsigned,std::vector<unsigned> > SnapshotLinks; // linked ids in position order keyed by owner id
+
+// In memory copy of the tables that define the DOF's, primitives and constraint equations of a model.
+// Each table, including the link tables, is read with a single query so that pSketcherModel::SyncToDatabase can
+// construct and synchronize every object without issuing queries of its own for each object.
+class DatabaseSnapshot
+{
+	public:
+		DatabaseSnapshot(sqlite3 *database);
+
+		// returns 0 if the table is not part of the snapshot
+		const SnapshotTable *FindTable(const std::string &table_name) const;
+		const SnapshotLinks *FindLinks(const std::string &link_table_name) const;
+
+		// returns false if dof_id has already been marked, used so that each DOF is only synchronized once per snapshot
+		bool MarkSynced(unsigned dof_id) {return synced_dofs_.insert(dof_id).second;}
+
+	private:
+		void ReadTable(const std::string &table_name);
+		void ReadLinkTable(const std::string &link_table_name);
+		// adds the values of a text column of a table that has already been read to values
+		void CollectText(const std::string &table_name, int column, std::set<std::string> &values) const;
+
+		sqlite3 *database_;
+		std::map<std::string,SnapshotTable> tables_;
+		std::map<std::string,SnapshotLinks> links_;
+		std::set<unsigned> synced_dofs_;
+};
+
+// Row id of table_name, taken from the snapshot that psketcher_model is currently synchronizing from if there is one
+// and read from the database otherwise
+class TableRow
+{
+	public:
+		TableRow(pSketcherModel &psketcher_model, const std::string &table_name, unsigned id);
+
+		bool Exists() const {return row_ != 0;}
+
+		// column accessors, index starts at 0 as with sqlite3_column_*
+		int GetInt(int column) const {return (int)(*row_)[column].number;}
+		double GetDouble(int column) const {return (*row_)[column].number;}
+		std::string GetText(int column) const {return (*row_)[column].text;}
+
+	private:
+		const SnapshotRow *row_;
+		SnapshotRow fetched_row_;
+};
+
+// reads the ids that owner_id links to in link_table_name in position order, from the snapshot if there is one
+void ReadLinks(pSketcherModel &psketcher_model, const std::string &link_table_name, unsigned owner_id, std::vector<unsigned> &linked_ids);
+
+#endif //DatabaseSnapshotH
@@ -28,7 +28,11 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 const std::string SQL_dependent_dof_database_table_name = "dependent_dof_list";
 
-const std::string SQL_dependent_dof_database_schema = "CREATE TABLE " + SQL_dependent_dof_database_table_name + " (id INTEGER PRIMARY KEY, variable_name TEXT NOT NULL, solver_function TEXT NOT NULL, source_dof_table_name TEXT NOT NULL);";
+const std::string SQL_dependent_dof_database_schema = "CREATE TABLE " + SQL_dependent_dof_database_table_name + " (id INTEGER PRIMARY KEY, variable_name TEXT NOT NULL, solver_function TEXT NOT NULL);";
+
+// link table listing the source DOF's of each dependent DOF in the order that its solver function expects them
+const std::string SQL_source_dof_link_database_table_name = "source_dof_link_list";
+const std::string SQL_source_dof_link_database_schema = "CREATE TABLE " + SQL_source_dof_link_database_table_name + " (owner_id INTEGER NOT NULL, position INTEGER NOT NULL, dof_id INTEGER NOT NULL, PRIMARY KEY(owner_id, position), FOREIGN KEY(dof_id) REFERENCES dof_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED); CREATE INDEX source_dof_link_list_dof_id ON " + SQL_source_dof_link_database_table_name + " (dof_id);";
 
 // DependentDOF class
 class DependentDOF : public DOF
@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef DualNumberH
+#define DualNumberH
+
+#include <math.h>
+
+// Forward mode automatic differentiation
+// A DualNumber<N> carries a value and its gradient with respect to N independent variables. Arithmetic and the math
+// functions below propagate the gradient with the chain rule, so a function written once as a template on its scalar type
+// returns the exact value when evaluated with double and the exact value and gradient, in a single pass, when evaluated
+// with DualNumber<N>. No heap memory is ever allocated.
+template <int N> class DualNumber
+{
+    public:
+        enum {NumVariables = N};
+
+        // default constructor, the value and gradient are not initialized
+        DualNumber() {}
+
+        // constant, the gradient is zero
+        DualNumber(double value) : value_(value) {for(int i = 0; i < N; i++) gradient_[i] = 0.0;}
+
+        // independent variable number index
+        DualNumber(double value, int index) : value_(value) {for(int i = 0; i < N; i++) gradient_[i] = 0.0; gradient_[index] = 1.0;}
+
+        double GetValue() const {return value_;}
+        double GetGradient(int index) const {return gradient_[index];}
+
+        // returns the value and stores the partial derivative of the value with respect to each variable in gradient[0..N-1]
+        double GetValueAndGradient(double *gradient) const {for(int i = 0; i < N; i++) gradient[i] = gradient_[i]; return value_;}
+
+        // applies the chain rule for an elementary function f, value is f(x) and derivative is f'(x)
+        DualNumber Chain(double value, double derivative) const
+        {
+            DualNumber result;
+            result.value_ = value;
+            for(int i = 0; i < N; i++) result.gradient_[i] = derivative*gradient_[i];
+            return result;
+        }
+
+        // compound assignment
+        DualNumber & operator+=(const DualNumber &rhs) {value_ += rhs.value_; for(int i = 0; i < N; i++) gradient_[i] += rhs.gradient_[i]; return *this;}
+        DualNumber & operator-=(const DualNumber &rhs) {value_ -= rhs.value_; for(int i = 0; i < N; i++) gradient_[i] -= rhs.gradient_[i]; return *this;}
+        DualNumber & operator*=(const DualNumber &rhs)
+        {
+            for(int i = 0; i < N; i++) gradient_[i] = gradient_[i]*rhs.value_ + value_*rhs.gradient_[i];
+            value_ *= rhs.value_;
+            return *this;
+        }
+        DualNumber & operator/=(const DualNumber &rhs)
+        {
+            double inverse = 1.0/rhs.value_;
+            value_ *= inverse;
+            for(int i = 0; i < N; i++) gradient_[i] = (gradient_[i] - value_*rhs.gradient_[i])*inverse;
+            return *this;
+        }
+        DualNumber & operator+=(double rhs) {value_ += rhs; return *this;}
+        DualNumber & operator-=(double rhs) {value_ -= rhs; return *this;}
+        DualNumber & operator*=(double rhs) {value_ *= rhs; for(int i = 0; i < N; i++) gradient_[i] *= rhs; return *this;}
+        DualNumber & operator/=(double rhs) {return *this *= 1.0/rhs;}
+
+        // arithmetic, the overloads taking a double avoid carrying a zero gradient for constants
+        friend DualNumber operator+(const DualNumber &lhs, const DualNumber &rhs) {DualNumber result(lhs); return result += rhs;}
+        friend DualNumber operator-(const DualNumber &lhs, const DualNumber &rhs) {DualNumber result(lhs); return result -= rhs;}
+        friend DualNumber operator*(const DualNumber &lhs, const DualNumber &rhs) {DualNumber result(lhs); return result *= rhs;}
+        friend DualNumber operator/(const DualNumber &lhs, const DualNumber &rhs) {DualNumber result(lhs); return result /= rhs;}
+        friend DualNumber operator+(const DualNumber &lhs, double rhs) {DualNumber result(lhs); return result += rhs;}
+        friend DualNumber operator-(const DualNumber &lhs, double rhs) {DualNumber result(lhs); return result -= rhs;}
+        friend DualNumber operator*(const DualNumber &lhs, double rhs) {DualNumber result(lhs); return result *= rhs;}
+        friend DualNumber operator/(const DualNumber &lhs, double rhs) {DualNumber result(lhs); return result /= rhs;}
+        friend DualNumber operator+(double lhs, const DualNumber &rhs) {DualNumber result(rhs); return result += lhs;}
+        friend DualNumber operator-(double lhs, const DualNumber &rhs) {return rhs.Chain(lhs - rhs.value_, -1.0);}
+        friend DualNumber operator*(double lhs, const DualNumber &rhs) {DualNumber result(rhs); return result *= lhs;}
+        friend DualNumber operator/(double lhs, const DualNumber &rhs) {double inverse = 1.0/rhs.value_; return rhs.Chain(lhs*inverse, -lhs*inverse*inverse);}
+        friend DualNumber operator+(const DualNumber &rhs) {return rhs;}
+        friend DualNumber operator-(const DualNumber &rhs) {return rhs.Chain(-rhs.value_, -1.0);}
+
+        // comparisons only consider the value so that branches in a templated function take the same path for double and DualNumber
+        friend bool operator<(const DualNumber &lhs, const DualNumber &rhs) {return lhs.value_ < rhs.value_;}
+        friend bool operator>(const DualNumber &lhs, const DualNumber &rhs) {return lhs.value_ > rhs.value_;}
+        friend bool operator<=(const DualNumber &lhs, const DualNumber &rhs) {return lhs.value_ <= rhs.value_;}
+        friend bool operator>=(const DualNumber &lhs, const DualNumber &rhs) {return lhs.value_ >= rhs.value_;}
+        friend bool operator==(const DualNumber &lhs, const DualNumber &rhs) {return lhs.value_ == rhs.value_;}
+        friend bool operator!=(const DualNumber &lhs, const DualNumber &rhs) {return lhs.value_ != rhs.value_;}
+
+        // elementary functions, found by argument dependent lookup so that templated code can call sqrt(x), sin(x), ... unqualified
+        friend DualNumber sqrt(const DualNumber &x) {double value = ::sqrt(x.value_); return x.Chain(value, 0.5/value);}
+        friend DualNumber pow(const DualNumber &x, double exponent) {double value = ::pow(x.value_, exponent); return x.Chain(value, exponent*::pow(x.value_, exponent - 1.0));}
+        friend DualNumber exp(const DualNumber &x) {double value = ::exp(x.value_); return x.Chain(value, value);}
+        friend DualNumber log(const DualNumber &x) {return x.Chain(::log(x.value_), 1.0/x.value_);}
+        friend DualNumber sin(const DualNumber &x) {return x.Chain(::sin(x.value_), ::cos(x.value_));}
+        friend DualNumber cos(const DualNumber &x) {return x.Chain(::cos(x.value_), -::sin(x.value_));}
+        friend DualNumber tan(const DualNumber &x) {double value = ::tan(x.value_); return x.Chain(value, 1.0 + value*value);}
+        friend DualNumber asin(const DualNumber &x) {return x.Chain(::asin(x.value_), 1.0/::sqrt(1.0 - x.value_*x.value_));}
+        friend DualNumber acos(const DualNumber &x) {return x.Chain(::acos(x.value_), -1.0/::sqrt(1.0 - x.value_*x.value_));}
+        friend DualNumber atan(const DualNumber &x) {return x.Chain(::atan(x.value_), 1.0/(1.0 + x.value_*x.value_));}
+        friend DualNumber fabs(const DualNumber &x) {return x.value_ < 0.0 ? -x : x;}
+        friend DualNumber atan2(const DualNumber &y, const DualNumber &x)
+        {
+            double scale = 1.0/(x.value_*x.value_ + y.value_*y.value_);
+            DualNumber result;
+            result.value_ = ::atan2(y.value_, x.value_);
+            for(int i = 0; i < N; i++) result.gradient_[i] = (x.value_*y.gradient_[i] - y.value_*x.gradient_[i])*scale;
+            return result;
+        }
+        friend DualNumber atan2(const DualNumber &y, double x) {return atan2(y, DualNumber(x));}
+        friend DualNumber atan2(double y, const DualNumber &x) {return atan2(DualNumber(y), x);}
+
+    private:
+        double value_;
+        double gradient_[N];
+};
+
+#endif //DualNumberH
@@ -24,6 +24,10 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "IndependentDOF.h"
 #include "PrimitiveBase.h"
 #include "pSketcherModel.h"
+#include "StatementCache.h"
+#include "UndoLog.h"
+#include "DatabaseSnapshot.h"
+#include "DatabaseRow.h"
 
 using namespace std;
 
@@ -57,147 +61,53 @@ bool IndependentDOF :: SyncToDatabase(pSketcherModel &psketcher_model)
 {
 	database_ = psketcher_model.GetDatabase();
 
-	string table_name = SQL_independent_dof_database_table_name;
-
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-
 	// "CREATE TABLE independent_dof_list (id INTEGER PRIMARY KEY, variable_name TEXT NOT NULL, bool_free INTEGER NOT NULL, value REAL NOT NULL);"
 	
-	stringstream sql_command;
-	sql_command << "SELECT * FROM " << table_name << " WHERE id=" << GetID() << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
+	TableRow row(psketcher_model, SQL_independent_dof_database_table_name, GetID());
 
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
+	if(row.Exists()) {
 		// row exist, store the values to initialize this object
-		
-		stringstream variable_name;
-		variable_name << sqlite3_column_text(statement,1);
-		name_ = variable_name.str();
-		free_ = sqlite3_column_int(statement,2);
-		value_ = sqlite3_column_double(statement,3);
-
+		name_ = row.GetText(1);
+		free_ = row.GetInt(2);
+		value_ = row.GetDouble(3);
+		MarkModified();
 	} else {
-		// the requested row does not exist in the database
-		sqlite3_finalize(statement);	
-
 		return false; // row does not exist in the database, exit method and return false
 	}
 
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
 	return true; // row existed in the database
 }
 
 void IndependentDOF::SetValue ( double value, bool update_db) 
 {
     value_ = value;
+    MarkModified();
 
 	if(database_ != 0 && update_db ) // if this DOF is tied to a database then update the database
 	{
 		double old_value;
 
         // first retrieve the current value in the database so that the undo command can be set properly
-        string table_name = SQL_independent_dof_database_table_name;
-    
-        char *zErrMsg = 0;
-        int rc;
-        sqlite3_stmt *statement;
-        
-        stringstream sql_command;
-        sql_command << "SELECT * FROM " << table_name << " WHERE id=" << GetID() << ";";
-    
-        rc = sqlite3_prepare(database_, sql_command.str().c_str(), -1, &statement, 0);
-        if( rc!=SQLITE_OK ){
-            stringstream error_description;
-            error_description << "SQL error: " << sqlite3_errmsg(database_);
-            throw pSketcherException(error_description.str());
-        }
-    
-        rc = sqlite3_step(statement);
-    
-        if(rc == SQLITE_ROW) {
-            // row exist, retreive the previous value
-            old_value = sqlite3_column_double(statement,3);
-    
-        } else {
-            // the requested row does not exist in the database
-            sqlite3_finalize(statement);    
-            throw pSketcherException("DOF value is being updated for a DOF that is not currently stored in the database.");
-        }
-    
-        rc = sqlite3_step(statement);
-        if( rc!=SQLITE_DONE ){
-            // sql statement didn't finish properly, some error must to have occured
-            stringstream error_description;
-            error_description << "SQL error: " << sqlite3_errmsg(database_);
-            throw pSketcherException(error_description.str());
-        }
-        
-        rc = sqlite3_finalize(statement);
-        if( rc!=SQLITE_OK ){
-            stringstream error_description;
-            error_description << "SQL error: " << sqlite3_errmsg(database_);
-            throw pSketcherException(error_description.str());
-        }
-
-        // Now that the prevoius value is know, update the database
-		// define the update statement
-		stringstream sql_stream;
-		sql_stream.precision(__DBL_DIG__);
-		sql_stream << "UPDATE " << SQL_independent_dof_database_table_name << " SET value=" 
-					<< value_ << " WHERE id=" << GetID() << ";";
+		{
+			CachedStatement statement(database_, "SELECT value FROM " + SQL_independent_dof_database_table_name + " WHERE id=?;");
+			statement.Bind(1,GetID());
 
-		string sql_update = sql_stream.str();
-		
-		// define the undo statement
-		sql_stream.str("");
-		sql_stream << "UPDATE " << SQL_independent_dof_database_table_name << " SET value=" 
-					<< old_value << " WHERE id=" << GetID() << ";";
-	
-		string sql_undo = sql_stream.str();
-		
-		// do the database update
-		rc = sqlite3_exec(database_, sql_update.c_str(), 0, 0, &zErrMsg);
-		if( rc!=SQLITE_OK ){
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
+			if(statement.Step())
+				old_value = statement.GetDouble(0);
+			else
+				throw pSketcherException("DOF value is being updated for a DOF that is not currently stored in the database.");
 		}
 
-		// store the undo/redo information in the database
-		// need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-		char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q');",sql_undo.c_str(),sql_update.c_str());
-	
-		rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-		if( rc!=SQLITE_OK ){
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
-		}
+		// nothing to write or to undo if the stored value is already up to date
+		if(old_value == value_)
+			return;
+
+        // Now that the prevoius value is know, update the database
+		CachedStatement update(database_, "UPDATE " + SQL_independent_dof_database_table_name + " SET value=? WHERE id=?;");
+		update.Bind(1,value_).Bind(2,GetID()).Execute();
 
+		// store the undo/redo information, coalesced with the earlier changes to this value since the last stable point
+		RecordValueChange(database_, SQL_independent_dof_database_table_name, "value", GetID(), old_value, value_);
 	} // if(database_ != 0 && update_db)
 }
 
@@ -205,47 +115,17 @@ void IndependentDOF::SetFree(bool free)
 {
 	if(free != free_)
 	{
+		MarkModified();
+
 		if(database_ != 0) // if this DOF is tied to a database then update the database
 		{
 			bool old_value = free_;
 			free_ = free;
-	
-			// define the update statement
-			stringstream sql_stream;
-			sql_stream.precision(__DBL_DIG__);
-			sql_stream << "UPDATE " << SQL_independent_dof_database_table_name << " SET bool_free=" 
-						<< free_ << " WHERE id=" << GetID() << ";";
-	
-			string sql_update = sql_stream.str();
-			
-			// define the undo statement
-			sql_stream.str("");
-			sql_stream << "UPDATE " << SQL_independent_dof_database_table_name << " SET bool_free=" 
-						<< old_value << " WHERE id=" << GetID() << ";";
-		
-			string sql_undo = sql_stream.str();
-			
-			// do the database update
-			char *zErrMsg = 0;
-			int rc = sqlite3_exec(database_, sql_update.c_str(), 0, 0, &zErrMsg);
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-	
-			// store the undo/redo information in the database
-			// need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-			char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q');",sql_undo.c_str(),sql_update.c_str());
-		
-			rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
 
-			sqlite3_free(sql_undo_redo);
+			CachedStatement update(database_, "UPDATE " + SQL_independent_dof_database_table_name + " SET bool_free=? WHERE id=?;");
+			update.Bind(1,(int)free_).Bind(2,GetID()).Execute();
+	
+			RecordValueChange(database_, SQL_independent_dof_database_table_name, "bool_free", GetID(), (int)old_value, (int)free_);
 	
 		}else{
 			// this is the case where there is not a database
@@ -273,77 +153,7 @@ void IndependentDOF::RemoveFromDatabase()
 
 void IndependentDOF::DatabaseAddDelete(bool add_to_database) // utility method called by AddToDatabase and DeleteFromDatabase since they both do similar things
 {	
-	string sql_do, sql_undo;
-	
-	// First, create the sql statements to undo and redo this operation
-	stringstream temp_stream;
-	temp_stream.precision(__DBL_DIG__);
-	temp_stream << "BEGIN; "
-                << "INSERT INTO " << SQL_independent_dof_database_table_name << " VALUES(" 
-                << GetID() << ",'" << name_ << "'," 
-				<< free_ << "," << value_ <<"); "
-                << "INSERT INTO dof_list VALUES("
-                << GetID() << ",'" << SQL_independent_dof_database_table_name << "'); "
-                << "COMMIT; ";
-
-	if(add_to_database)
-		sql_do = temp_stream.str();
-	else
-		sql_undo = temp_stream.str();
-
-	temp_stream.str(""); // clears the string stream
-
-	temp_stream << "BEGIN; "
-				<< "DELETE FROM dof_list WHERE id=" << GetID() 
-				<< "; DELETE FROM " << SQL_independent_dof_database_table_name << " WHERE id=" << GetID() 
-				<< "; COMMIT;";
-
-	if(add_to_database)
-		sql_undo = temp_stream.str();
-	else
-		sql_do = temp_stream.str();
-
-	// add this object to the appropriate tables by executing the SQL command sql_insert 
-	char *zErrMsg = 0;
-	int rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		if(add_to_database)
-		{
-			//std::cerr << "SQL error: " << zErrMsg << endl;
-			sqlite3_free(zErrMsg);
-			
-			// the table "independent_dof_list" may not exist, attempt to create
-			rc = sqlite3_exec(database_, ("ROLLBACK;"+SQL_independent_dof_database_schema).c_str(), 0, 0, &zErrMsg);  // need to add ROLLBACK since previous transaction failed
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-	
-			// now that the table has been created, attempt the insert one last time
-			rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-		} else {
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
-		}
-	}
-
-	// finally, update the undo_redo_list in the database with the database changes that have just been made
-	// need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-	char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q')",sql_undo.c_str(),sql_do.c_str());
-
-	rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
-
-	sqlite3_free(sql_undo_redo);
+	DatabaseRow row(SQL_independent_dof_database_table_name, SQL_independent_dof_database_schema, "dof_list", GetID());
+	row << name_ << free_ << value_;
+	row.AddRemove(database_, add_to_database);
 }
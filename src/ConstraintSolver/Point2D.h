@@ -23,10 +23,11 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define Point2DH
 
 #include "Primitive2DBase.h"
+#include "../mmcMatrix/mmcFixedMatrix.h"
 
 const std::string SQL_point2d_database_table_name = "point2d_list";
 
-const std::string SQL_point2d_database_schema = "CREATE TABLE " + SQL_point2d_database_table_name + " (id INTEGER PRIMARY KEY, dof_table_name TEXT NOT NULL, primitive_table_name TEXT NOT NULL, sketch_plane INTEGER NOT NULL, s_dof INTEGER NOT NULL, t_dof INTEGER NOT NULL, FOREIGN KEY(id) REFERENCES primitive_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED, FOREIGN KEY(sketch_plane) REFERENCES primitive_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED, FOREIGN KEY(s_dof) REFERENCES dof_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED, FOREIGN KEY(t_dof) REFERENCES dof_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED);";
+const std::string SQL_point2d_database_schema = "CREATE TABLE " + SQL_point2d_database_table_name + " (id INTEGER PRIMARY KEY, sketch_plane INTEGER NOT NULL, s_dof INTEGER NOT NULL, t_dof INTEGER NOT NULL, FOREIGN KEY(id) REFERENCES primitive_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED, FOREIGN KEY(sketch_plane) REFERENCES primitive_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED, FOREIGN KEY(s_dof) REFERENCES dof_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED, FOREIGN KEY(t_dof) REFERENCES dof_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED);";
 
 // Point2D class (a point constrained to a sketch plane)
 class Point2D : public Primitive2DBase
@@ -52,7 +53,7 @@ class Point2D : public Primitive2DBase
 
 		void Get3DLocation(double & x_location, double & y_location, double & z_location)const;
 
-		mmcMatrix GetmmcMatrix()const;
+		mmcFixedMatrix<2,1> GetmmcMatrix()const;  // returns the current location, converts to an mmcMatrix where needed
 
 		// method for adding this object to the SQLite3 database
 		virtual void AddToDatabase(sqlite3 *database);
@@ -24,6 +24,8 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "PrimitiveBase.h"
 #include "DependentDOF.h"
 #include "pSketcherModel.h"
+#include "DatabaseRow.h"
+#include "DatabaseSnapshot.h"
 
 using namespace std;
 
@@ -106,164 +108,45 @@ bool PrimitiveBase::FlagForDeletionIfDependent(boost::shared_ptr<PrimitiveBase>
 }
 
 // utility method used to add the dof_list_ and the primitive_list_ to the database
-void PrimitiveBase::DatabaseAddDeleteLists(bool add_to_database, const string &dof_list_table_name, const string &primitive_list_table_name)
+void PrimitiveBase::DatabaseAddDeleteLists(bool add_to_database)
 {
-	string sql_do, sql_undo;
-
-	stringstream temp_stream;
-
-	temp_stream << "BEGIN;"
-				<< "CREATE TABLE " << dof_list_table_name << " (id INTEGER PRIMARY KEY, FOREIGN KEY(id) REFERENCES dof_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED);"
-				<< "CREATE TABLE " << primitive_list_table_name << " (id INTEGER PRIMARY KEY, FOREIGN KEY(id) REFERENCES primitive_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED);";
-
-	// add the insert statements for each dof in dof_list_	
+	DatabaseLinks dof_links(SQL_dof_link_database_table_name, GetID());
 	for(unsigned int current_dof = 0; current_dof < dof_list_.size(); current_dof++)
-	{
-		temp_stream << "INSERT INTO " << dof_list_table_name << " VALUES(" << dof_list_[current_dof]->GetID() << "); ";
-	}
+		dof_links << dof_list_[current_dof]->GetID();
 
-	// add the insert statements for each primitive in primitive_list_	
+	DatabaseLinks primitive_links(SQL_primitive_link_database_table_name, GetID());
 	for(unsigned int current_primitive = 0; current_primitive < primitive_list_.size(); current_primitive++)
-	{
-		temp_stream << "INSERT INTO " << primitive_list_table_name << " VALUES(" << primitive_list_[current_primitive]->GetID() << "); ";
-	}
-
-	temp_stream << "COMMIT;";
-
-	if(add_to_database)
-		sql_do = temp_stream.str();
-	else
-		sql_undo = temp_stream.str();
-
-	temp_stream.str("");
-
-	// define the undo sql statement
-	temp_stream << "BEGIN; "
- 				<< "DROP TABLE " << dof_list_table_name
-				<< "; DROP TABLE " << primitive_list_table_name
-				<< "; COMMIT;";
+		primitive_links << primitive_list_[current_primitive]->GetID();
 
-	if(add_to_database)
-		sql_undo = temp_stream.str();
-	else
-		sql_do = temp_stream.str();
-
-	// go ahead and create the sql tables
-	char *zErrMsg = 0;
-	int rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
-
-	// finally, update the undo_redo_list in the database with the database changes that have just been made
-	// need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-	char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q')",sql_undo.c_str(),sql_do.c_str());
-
-	rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
+	dof_links.AddRemove(database_, add_to_database);
+	primitive_links.AddRemove(database_, add_to_database);
 }
 
-// Utility method to sync dof_list_ and primitive_list_ to the database
-void PrimitiveBase::SyncListsToDatabase(const std::string &dof_list_table_name, const std::string &primitive_list_table_name, pSketcherModel &psketcher_model)
+void PrimitiveBase::SyncListsToDatabase(pSketcherModel &psketcher_model)
 {
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
+	vector<unsigned> ids;
 
 	// synchronize the dof_list_ vector to the database
 	
 	// clear the contents of the vector, will be recreated from the database
 	dof_list_.clear();
 
-	stringstream sql_command;
-	sql_command << "SELECT * FROM " << dof_list_table_name << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-	
-	int current_dof_id;
-	DOFPointer current_dof;
-	while(rc == SQLITE_ROW) {
-		current_dof_id = sqlite3_column_int(statement,0);
-
+	ReadLinks(psketcher_model, SQL_dof_link_database_table_name, GetID(), ids);
+	for(unsigned int current_dof = 0; current_dof < ids.size(); current_dof++)
+	{
 		// get the dof (it will be automatically created from the database if it doesn't already exist)
-		current_dof = psketcher_model.FetchDOF(current_dof_id);
-
-		dof_list_.push_back(current_dof);
-
-		rc = sqlite3_step(statement);
-	}
-
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
+		dof_list_.push_back(psketcher_model.FetchDOF(ids[current_dof]));
 	}
 
-
-
 	// synchronize the primitive_list_ to the database
 
 	// clear the contents of the vector, will be recreated from the database
 	primitive_list_.clear();
 
-	sql_command.str(""); // clear the contents of the string stream
-	sql_command << "SELECT * FROM " << primitive_list_table_name << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-	
-	int current_primitive_id;
-	PrimitiveBasePointer current_primitive;
-	while(rc == SQLITE_ROW) {
-		current_primitive_id = sqlite3_column_int(statement,0);
-
-		// get the dof (it will be automatically created from the database if it doesn't already exist)
-		current_primitive = psketcher_model.FetchPrimitive<PrimitiveBase>(current_primitive_id);
-
-		primitive_list_.push_back(current_primitive);
-
-		rc = sqlite3_step(statement);
-	}
-
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
+	ReadLinks(psketcher_model, SQL_primitive_link_database_table_name, GetID(), ids);
+	for(unsigned int current_primitive = 0; current_primitive < ids.size(); current_primitive++)
+	{
+		// get the primitive (it will be automatically created from the database if it doesn't already exist)
+		primitive_list_.push_back(psketcher_model.FetchPrimitive<PrimitiveBase>(ids[current_primitive]));
 	}
-
 }
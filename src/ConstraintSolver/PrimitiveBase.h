@@ -32,6 +32,13 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 class dimeEntity;
 
+// link tables listing the DOF's and the primitives that each primitive and constraint equation depends on (dof_list_ and primitive_list_)
+const std::string SQL_dof_link_database_table_name = "dof_link_list";
+const std::string SQL_dof_link_database_schema = "CREATE TABLE " + SQL_dof_link_database_table_name + " (owner_id INTEGER NOT NULL, position INTEGER NOT NULL, dof_id INTEGER NOT NULL, PRIMARY KEY(owner_id, position), FOREIGN KEY(dof_id) REFERENCES dof_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED); CREATE INDEX dof_link_list_dof_id ON " + SQL_dof_link_database_table_name + " (dof_id);";
+
+const std::string SQL_primitive_link_database_table_name = "primitive_link_list";
+const std::string SQL_primitive_link_database_schema = "CREATE TABLE " + SQL_primitive_link_database_table_name + " (owner_id INTEGER NOT NULL, position INTEGER NOT NULL, primitive_id INTEGER NOT NULL, PRIMARY KEY(owner_id, position), FOREIGN KEY(primitive_id) REFERENCES primitive_list(id) ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED); CREATE INDEX primitive_link_list_primitive_id ON " + SQL_primitive_link_database_table_name + " (primitive_id);";
+
 //Exception class
 class pSketcherException
 {
@@ -82,14 +89,14 @@ class PrimitiveBase
 		virtual void Erase() {;}
 
 		// Utility method to add the dof_list_ and primitive_list_ to the database
-		void DatabaseAddDeleteLists(bool add_to_database, const std::string &dof_list_table_name, const std::string &primitive_list_table_name);
+		void DatabaseAddDeleteLists(bool add_to_database);
 
 		// method for adding this object to the SQLite3 database, needs to be implement by each child class
 		virtual void AddToDatabase(sqlite3 *database) {;} // @fixme: change to a abstract method (=0) so that the compiler finds any child classes that don't implement this method
 		virtual void RemoveFromDatabase() {;} // @fixme: change to abstract (=0) 
 
 		// Utility method to sync dof_list_ and primitive_list_ to the database
-		void SyncListsToDatabase(const std::string &dof_list_table_name, const std::string &primitive_list_table_name, pSketcherModel &psketcher_model);
+		void SyncListsToDatabase(pSketcherModel &psketcher_model);
 
 		// method to synchronize this object to the database, needs to be implemented by each child class
 		// returns true on success, returns false if row does not exist in the database
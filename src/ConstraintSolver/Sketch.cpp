@@ -19,8 +19,8 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <iostream>
-#include <sstream>
 #include "Sketch.h"
+#include "StatementCache.h"
 
 const std::string SQL_sketch_database_schema = "CREATE TABLE sketch (sketch_plane INTEGER NOT NULL);";
 
@@ -36,73 +36,29 @@ Sketch::Sketch(const std::string &file_name, PrimitiveBasePointer (*current_prim
 pSketcherModel(file_name, current_primitive_factory, current_constraint_factory)
 {
 	// need to set the value for sketch_plane_ from the database
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-	
-	std::string sql_command = "SELECT * FROM sketch;";
-
-	rc = sqlite3_prepare(GetDatabase(), sql_command.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// set the sketch plane based on the database
-		sketch_plane_ = FetchPrimitive<SketchPlane>(sqlite3_column_int(statement,0));
-
-	} else {
-		// the requested row does not exist in the database
-		sqlite3_finalize(statement);	
+	unsigned sketch_plane_id;
+	{
+		CachedStatement statement(GetDatabase(), "SELECT * FROM sketch;");
+		if(!statement.Step())
+			throw pSketcherException("SketchPlane ID not stored in database, cannot initialize Sketch Object");
+		sketch_plane_id = statement.GetInt(0);
 
-		throw pSketcherException("SketchPlane ID not stored in database, cannot initialize Sketch Object");
-	}
-
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
+		if(statement.Step())
+			throw pSketcherException("More than one SketchPlane ID stored in database, cannot initialize Sketch Object");
 	}
 
+	// set the sketch plane based on the database
+	sketch_plane_ = FetchPrimitive<SketchPlane>(sketch_plane_id);
 }
 
 // Add the information needed by this class to the database
 void Sketch::AddToDatabase()
 {
 	// initialize the database schema for this class
-	char *zErrMsg = 0;
-	int rc;
-	rc = sqlite3_exec(GetDatabase(), SQL_sketch_database_schema.c_str(), 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
+	ExecuteSQL(GetDatabase(), SQL_sketch_database_schema);
 
 	// Add the database row for this class
-	std::stringstream temp_stream;
-	temp_stream << "INSERT INTO sketch VALUES("
-                << sketch_plane_->GetID() << "); ";
-	rc = sqlite3_exec(GetDatabase(), temp_stream.str().c_str(), 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
-
+	CachedStatement(GetDatabase(), "INSERT INTO sketch VALUES(?);").Bind(1,sketch_plane_->GetID()).Execute();
 }
 
 Point2DPointer Sketch::AddPoint2D ( double s, double t, bool s_free, bool t_free)
@@ -115,6 +71,9 @@ Point2DPointer Sketch::AddPoint2D ( double s, double t, bool s_free, bool t_free
 
 Arc2DPointer Sketch::AddArc2D (double s_center, double t_center, double theta_1, double theta_2, double radius, bool s_center_free, bool t_center_free, bool theta_1_free, bool theta_2_free, bool radius_free)
 {
+	// the arc and its points are added to the database in one transaction
+	BatchEdit batch(*this);
+
 	Arc2DPointer new_arc(new Arc2D(s_center, t_center, theta_1, theta_2, radius, sketch_plane_,s_center_free, t_center_free, theta_1_free, theta_2_free, radius_free));
 	AddPrimitive(new_arc);
 
@@ -129,6 +88,9 @@ Arc2DPointer Sketch::AddArc2D (double s_center, double t_center, double theta_1,
 
 Circle2DPointer Sketch::AddCircle2D (double s_center, double t_center, double radius, bool s_center_free, bool t_center_free, bool radius_free)
 {
+    // the circle and its center point are added to the database in one transaction
+    BatchEdit batch(*this);
+
     Circle2DPointer new_circle(new Circle2D(s_center, t_center, radius, sketch_plane_, s_center_free, t_center_free, radius_free));
     AddPrimitive(new_circle);
 
@@ -154,6 +116,9 @@ Arc2DPointer Sketch::AddArc2D (double s1, double t1, double s2, double t2, doubl
 	
 	if(success)
 	{
+		// the arc and its points are added to the database in one transaction
+		BatchEdit batch(*this);
+
 		AddPrimitive(new_arc);
 		
 		// now add the end points and the center of the arc as seperate primitives so that they can be selected by the user for constructing lines and other primitives
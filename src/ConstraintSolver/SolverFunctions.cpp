@@ -93,10 +93,10 @@ double distance_point_2d::GetValue() const
     double point2t = GetDOF(3)->GetValue();
     double distance = GetDOF(4)->GetValue();
 
-    return -distance + pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return -distance + sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-double distance_point_2d::GetValueSelf(const mmcMatrix &params) const
+double distance_point_2d::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double point1s = params(0,0);
     double point1t = params(1,0);
@@ -104,12 +104,12 @@ double distance_point_2d::GetValueSelf(const mmcMatrix &params) const
     double point2t = params(3,0);
     double distance = params(4,0);
 
-    return -distance + pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return -distance + sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-mmcMatrix distance_point_2d::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector distance_point_2d::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double point1s = params(0,0);
     double point1t = params(1,0);
@@ -117,15 +117,76 @@ mmcMatrix distance_point_2d::GetGradientSelf(const mmcMatrix &params) const
     double point2t = params(3,0);
     double distance = params(4,0);
 
-    result(0,0) = (point1s - point2s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
-    result(1,0) = (point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
-    result(2,0) = (point2s - point1s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
-    result(3,0) = (point2t - point1t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    result(0,0) = (point1s - point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    result(1,0) = (point1t - point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    result(2,0) = (-point1s + point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    result(3,0) = (-point1t + point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
     result(4,0) = -1;
 
     return result;
 }
 
+double distance_point_2d::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double point1s = params(0,0);
+    double point1t = params(1,0);
+    double point2s = params(2,0);
+    double point2t = params(3,0);
+    double distance = params(4,0);
+
+    double temp0 = point1s - point2s;
+    double temp1 = point1t - point2t;
+    double temp2 = sqrt(pow(temp0, 2) + pow(temp1, 2));
+    double temp3 = 1.0/temp2;
+
+    gradient(0,0) = temp0*temp3;
+    gradient(1,0) = temp1*temp3;
+    gradient(2,0) = -temp0*temp3;
+    gradient(3,0) = -temp1*temp3;
+    gradient(4,0) = -1;
+
+    return -distance + temp2;
+}
+
+void distance_point_2d::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+        double distance = params[4][k];
+
+        values[k] = -distance + sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    }
+}
+
+void distance_point_2d::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+        double distance = params[4][k];
+
+        double temp0 = point1s - point2s;
+        double temp1 = point1t - point2t;
+        double temp2 = sqrt(pow(temp0, 2) + pow(temp1, 2));
+        double temp3 = 1.0/temp2;
+
+        gradients[0][k] = temp0*temp3;
+        gradients[1][k] = temp1*temp3;
+        gradients[2][k] = -temp0*temp3;
+        gradients[3][k] = -temp1*temp3;
+        gradients[4][k] = -1;
+
+        values[k] = -distance + temp2;
+    }
+}
+
 angle_line_2d_interior::angle_line_2d_interior(DOFPointer line1_point1s, DOFPointer line1_point1t, DOFPointer line1_point2s, DOFPointer line1_point2t, DOFPointer line2_point1s, DOFPointer line2_point1t, DOFPointer line2_point2s, DOFPointer line2_point2t, DOFPointer angle)
 {
     AddDOF(line1_point1s);
@@ -161,10 +222,10 @@ double angle_line_2d_interior::GetValue() const
     double line2_point2t = GetDOF(7)->GetValue();
     double angle = GetDOF(8)->GetValue();
 
-    return -cos(angle) + ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
+    return ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) - cos(angle);
 }
 
-double angle_line_2d_interior::GetValueSelf(const mmcMatrix &params) const
+double angle_line_2d_interior::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double line1_point1s = params(0,0);
     double line1_point1t = params(1,0);
@@ -176,12 +237,12 @@ double angle_line_2d_interior::GetValueSelf(const mmcMatrix &params) const
     double line2_point2t = params(7,0);
     double angle = params(8,0);
 
-    return -cos(angle) + ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
+    return ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) - cos(angle);
 }
 
-mmcMatrix angle_line_2d_interior::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector angle_line_2d_interior::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double line1_point1s = params(0,0);
     double line1_point1t = params(1,0);
@@ -193,19 +254,124 @@ mmcMatrix angle_line_2d_interior::GetGradientSelf(const mmcMatrix &params) const
     double line2_point2t = params(7,0);
     double angle = params(8,0);
 
-    result(0,0) = (line2_point1s - line2_point2s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point2s - line1_point1s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(1,0) = (line2_point1t - line2_point2t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point2t - line1_point1t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(2,0) = (line2_point2s - line2_point1s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point1s - line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(3,0) = (line2_point2t - line2_point1t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point1t - line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(4,0) = (line1_point1s - line1_point2s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point2s - line2_point1s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
-    result(5,0) = (line1_point1t - line1_point2t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point2t - line2_point1t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
-    result(6,0) = (line1_point2s - line1_point1s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point1s - line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
-    result(7,0) = (line1_point2t - line1_point1t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point1t - line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
+    result(0,0) = (-line1_point1s + line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1s - line2_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(1,0) = (-line1_point1t + line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1t - line2_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(2,0) = (line1_point1s - line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1s + line2_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(3,0) = (line1_point1t - line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1t + line2_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(4,0) = (line1_point1s - line1_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1s + line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
+    result(5,0) = (line1_point1t - line1_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1t + line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
+    result(6,0) = (-line1_point1s + line1_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1s - line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
+    result(7,0) = (-line1_point1t + line1_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1t - line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
     result(8,0) = sin(angle);
 
     return result;
 }
 
+double angle_line_2d_interior::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double line1_point1s = params(0,0);
+    double line1_point1t = params(1,0);
+    double line1_point2s = params(2,0);
+    double line1_point2t = params(3,0);
+    double line2_point1s = params(4,0);
+    double line2_point1t = params(5,0);
+    double line2_point2s = params(6,0);
+    double line2_point2t = params(7,0);
+    double angle = params(8,0);
+
+    double temp0 = line1_point1s - line1_point2s;
+    double temp1 = line2_point1s - line2_point2s;
+    double temp2 = line1_point1t - line1_point2t;
+    double temp3 = line2_point1t - line2_point2t;
+    double temp4 = temp0*temp1 + temp2*temp3;
+    double temp5 = pow(temp0, 2) + pow(temp2, 2);
+    double temp6 = pow(temp5, -1.0/2.0);
+    double temp7 = pow(temp1, 2) + pow(temp3, 2);
+    double temp8 = pow(temp7, -1.0/2.0);
+    double temp9 = temp6*temp8;
+    double temp10 = -temp0;
+    double temp11 = temp4*temp8/pow(temp5, 3.0/2.0);
+    double temp12 = -temp2;
+    double temp13 = -temp1;
+    double temp14 = -temp3;
+    double temp15 = temp4*temp6/pow(temp7, 3.0/2.0);
+
+    gradient(0,0) = temp1*temp9 + temp10*temp11;
+    gradient(1,0) = temp11*temp12 + temp3*temp9;
+    gradient(2,0) = temp0*temp11 + temp13*temp9;
+    gradient(3,0) = temp11*temp2 + temp14*temp9;
+    gradient(4,0) = temp0*temp9 + temp13*temp15;
+    gradient(5,0) = temp14*temp15 + temp2*temp9;
+    gradient(6,0) = temp1*temp15 + temp10*temp9;
+    gradient(7,0) = temp12*temp9 + temp15*temp3;
+    gradient(8,0) = sin(angle);
+
+    return temp4*temp9 - cos(angle);
+}
+
+void angle_line_2d_interior::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double line1_point1s = params[0][k];
+        double line1_point1t = params[1][k];
+        double line1_point2s = params[2][k];
+        double line1_point2t = params[3][k];
+        double line2_point1s = params[4][k];
+        double line2_point1t = params[5][k];
+        double line2_point2s = params[6][k];
+        double line2_point2t = params[7][k];
+        double angle = params[8][k];
+
+        values[k] = ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) - cos(angle);
+    }
+}
+
+void angle_line_2d_interior::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double line1_point1s = params[0][k];
+        double line1_point1t = params[1][k];
+        double line1_point2s = params[2][k];
+        double line1_point2t = params[3][k];
+        double line2_point1s = params[4][k];
+        double line2_point1t = params[5][k];
+        double line2_point2s = params[6][k];
+        double line2_point2t = params[7][k];
+        double angle = params[8][k];
+
+        double temp0 = line1_point1s - line1_point2s;
+        double temp1 = line2_point1s - line2_point2s;
+        double temp2 = line1_point1t - line1_point2t;
+        double temp3 = line2_point1t - line2_point2t;
+        double temp4 = temp0*temp1 + temp2*temp3;
+        double temp5 = pow(temp0, 2) + pow(temp2, 2);
+        double temp6 = pow(temp5, -1.0/2.0);
+        double temp7 = pow(temp1, 2) + pow(temp3, 2);
+        double temp8 = pow(temp7, -1.0/2.0);
+        double temp9 = temp6*temp8;
+        double temp10 = -temp0;
+        double temp11 = temp4*temp8/pow(temp5, 3.0/2.0);
+        double temp12 = -temp2;
+        double temp13 = -temp1;
+        double temp14 = -temp3;
+        double temp15 = temp4*temp6/pow(temp7, 3.0/2.0);
+
+        gradients[0][k] = temp1*temp9 + temp10*temp11;
+        gradients[1][k] = temp11*temp12 + temp3*temp9;
+        gradients[2][k] = temp0*temp11 + temp13*temp9;
+        gradients[3][k] = temp11*temp2 + temp14*temp9;
+        gradients[4][k] = temp0*temp9 + temp13*temp15;
+        gradients[5][k] = temp14*temp15 + temp2*temp9;
+        gradients[6][k] = temp1*temp15 + temp10*temp9;
+        gradients[7][k] = temp12*temp9 + temp15*temp3;
+        gradients[8][k] = sin(angle);
+
+        values[k] = temp4*temp9 - cos(angle);
+    }
+}
+
 angle_line_2d_exterior::angle_line_2d_exterior(DOFPointer line1_point1s, DOFPointer line1_point1t, DOFPointer line1_point2s, DOFPointer line1_point2t, DOFPointer line2_point1s, DOFPointer line2_point1t, DOFPointer line2_point2s, DOFPointer line2_point2t, DOFPointer angle)
 {
     AddDOF(line1_point1s);
@@ -241,10 +407,10 @@ double angle_line_2d_exterior::GetValue() const
     double line2_point2t = GetDOF(7)->GetValue();
     double angle = GetDOF(8)->GetValue();
 
-    return ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + cos(angle);
+    return ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + cos(angle);
 }
 
-double angle_line_2d_exterior::GetValueSelf(const mmcMatrix &params) const
+double angle_line_2d_exterior::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double line1_point1s = params(0,0);
     double line1_point1t = params(1,0);
@@ -256,12 +422,12 @@ double angle_line_2d_exterior::GetValueSelf(const mmcMatrix &params) const
     double line2_point2t = params(7,0);
     double angle = params(8,0);
 
-    return ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + cos(angle);
+    return ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + cos(angle);
 }
 
-mmcMatrix angle_line_2d_exterior::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector angle_line_2d_exterior::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double line1_point1s = params(0,0);
     double line1_point1t = params(1,0);
@@ -273,19 +439,124 @@ mmcMatrix angle_line_2d_exterior::GetGradientSelf(const mmcMatrix &params) const
     double line2_point2t = params(7,0);
     double angle = params(8,0);
 
-    result(0,0) = (line2_point1s - line2_point2s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point2s - line1_point1s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(1,0) = (line2_point1t - line2_point2t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point2t - line1_point1t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(2,0) = (line2_point2s - line2_point1s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point1s - line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(3,0) = (line2_point2t - line2_point1t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line1_point1t - line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(3.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0)));
-    result(4,0) = (line1_point1s - line1_point2s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point2s - line2_point1s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
-    result(5,0) = (line1_point1t - line1_point2t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point2t - line2_point1t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
-    result(6,0) = (line1_point2s - line1_point1s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point1s - line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
-    result(7,0) = (line1_point2t - line1_point1t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(1.0/2.0))) + (line2_point1t - line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),(1.0/2.0))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),(3.0/2.0)));
+    result(0,0) = (-line1_point1s + line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1s - line2_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(1,0) = (-line1_point1t + line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1t - line2_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(2,0) = (line1_point1s - line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1s + line2_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(3,0) = (line1_point1t - line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 3.0/2.0)*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1t + line2_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(4,0) = (line1_point1s - line1_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1s + line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
+    result(5,0) = (line1_point1t - line1_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-line2_point1t + line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
+    result(6,0) = (-line1_point1s + line1_point2s)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1s - line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
+    result(7,0) = (-line1_point1t + line1_point2t)/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (line2_point1t - line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 3.0/2.0));
     result(8,0) = -sin(angle);
 
     return result;
 }
 
+double angle_line_2d_exterior::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double line1_point1s = params(0,0);
+    double line1_point1t = params(1,0);
+    double line1_point2s = params(2,0);
+    double line1_point2t = params(3,0);
+    double line2_point1s = params(4,0);
+    double line2_point1t = params(5,0);
+    double line2_point2s = params(6,0);
+    double line2_point2t = params(7,0);
+    double angle = params(8,0);
+
+    double temp0 = line1_point1s - line1_point2s;
+    double temp1 = line2_point1s - line2_point2s;
+    double temp2 = line1_point1t - line1_point2t;
+    double temp3 = line2_point1t - line2_point2t;
+    double temp4 = temp0*temp1 + temp2*temp3;
+    double temp5 = pow(temp0, 2) + pow(temp2, 2);
+    double temp6 = pow(temp5, -1.0/2.0);
+    double temp7 = pow(temp1, 2) + pow(temp3, 2);
+    double temp8 = pow(temp7, -1.0/2.0);
+    double temp9 = temp6*temp8;
+    double temp10 = -temp0;
+    double temp11 = temp4*temp8/pow(temp5, 3.0/2.0);
+    double temp12 = -temp2;
+    double temp13 = -temp1;
+    double temp14 = -temp3;
+    double temp15 = temp4*temp6/pow(temp7, 3.0/2.0);
+
+    gradient(0,0) = temp1*temp9 + temp10*temp11;
+    gradient(1,0) = temp11*temp12 + temp3*temp9;
+    gradient(2,0) = temp0*temp11 + temp13*temp9;
+    gradient(3,0) = temp11*temp2 + temp14*temp9;
+    gradient(4,0) = temp0*temp9 + temp13*temp15;
+    gradient(5,0) = temp14*temp15 + temp2*temp9;
+    gradient(6,0) = temp1*temp15 + temp10*temp9;
+    gradient(7,0) = temp12*temp9 + temp15*temp3;
+    gradient(8,0) = -sin(angle);
+
+    return temp4*temp9 + cos(angle);
+}
+
+void angle_line_2d_exterior::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double line1_point1s = params[0][k];
+        double line1_point1t = params[1][k];
+        double line1_point2s = params[2][k];
+        double line1_point2t = params[3][k];
+        double line2_point1s = params[4][k];
+        double line2_point1t = params[5][k];
+        double line2_point2s = params[6][k];
+        double line2_point2t = params[7][k];
+        double angle = params[8][k];
+
+        values[k] = ((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/(sqrt(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*sqrt(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + cos(angle);
+    }
+}
+
+void angle_line_2d_exterior::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double line1_point1s = params[0][k];
+        double line1_point1t = params[1][k];
+        double line1_point2s = params[2][k];
+        double line1_point2t = params[3][k];
+        double line2_point1s = params[4][k];
+        double line2_point1t = params[5][k];
+        double line2_point2s = params[6][k];
+        double line2_point2t = params[7][k];
+        double angle = params[8][k];
+
+        double temp0 = line1_point1s - line1_point2s;
+        double temp1 = line2_point1s - line2_point2s;
+        double temp2 = line1_point1t - line1_point2t;
+        double temp3 = line2_point1t - line2_point2t;
+        double temp4 = temp0*temp1 + temp2*temp3;
+        double temp5 = pow(temp0, 2) + pow(temp2, 2);
+        double temp6 = pow(temp5, -1.0/2.0);
+        double temp7 = pow(temp1, 2) + pow(temp3, 2);
+        double temp8 = pow(temp7, -1.0/2.0);
+        double temp9 = temp6*temp8;
+        double temp10 = -temp0;
+        double temp11 = temp4*temp8/pow(temp5, 3.0/2.0);
+        double temp12 = -temp2;
+        double temp13 = -temp1;
+        double temp14 = -temp3;
+        double temp15 = temp4*temp6/pow(temp7, 3.0/2.0);
+
+        gradients[0][k] = temp1*temp9 + temp10*temp11;
+        gradients[1][k] = temp11*temp12 + temp3*temp9;
+        gradients[2][k] = temp0*temp11 + temp13*temp9;
+        gradients[3][k] = temp11*temp2 + temp14*temp9;
+        gradients[4][k] = temp0*temp9 + temp13*temp15;
+        gradients[5][k] = temp14*temp15 + temp2*temp9;
+        gradients[6][k] = temp1*temp15 + temp10*temp9;
+        gradients[7][k] = temp12*temp9 + temp15*temp3;
+        gradients[8][k] = -sin(angle);
+
+        values[k] = temp4*temp9 + cos(angle);
+    }
+}
+
 tangent_edge_2d::tangent_edge_2d(DOFPointer s1, DOFPointer t1, DOFPointer s2, DOFPointer t2)
 {
     AddDOF(s1);
@@ -311,22 +582,22 @@ double tangent_edge_2d::GetValue() const
     double s2 = GetDOF(2)->GetValue();
     double t2 = GetDOF(3)->GetValue();
 
-    return -1 + pow((s1*s2 + t1*t2),2);
+    return pow(s1*s2 + t1*t2, 2) - 1;
 }
 
-double tangent_edge_2d::GetValueSelf(const mmcMatrix &params) const
+double tangent_edge_2d::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double s1 = params(0,0);
     double t1 = params(1,0);
     double s2 = params(2,0);
     double t2 = params(3,0);
 
-    return -1 + pow((s1*s2 + t1*t2),2);
+    return pow(s1*s2 + t1*t2, 2) - 1;
 }
 
-mmcMatrix tangent_edge_2d::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector tangent_edge_2d::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double s1 = params(0,0);
     double t1 = params(1,0);
@@ -341,6 +612,58 @@ mmcMatrix tangent_edge_2d::GetGradientSelf(const mmcMatrix &params) const
     return result;
 }
 
+double tangent_edge_2d::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double s1 = params(0,0);
+    double t1 = params(1,0);
+    double s2 = params(2,0);
+    double t2 = params(3,0);
+
+    double temp0 = s1*s2 + t1*t2;
+    double temp1 = 2*temp0;
+
+    gradient(0,0) = s2*temp1;
+    gradient(1,0) = t2*temp1;
+    gradient(2,0) = s1*temp1;
+    gradient(3,0) = t1*temp1;
+
+    return pow(temp0, 2) - 1;
+}
+
+void tangent_edge_2d::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double s1 = params[0][k];
+        double t1 = params[1][k];
+        double s2 = params[2][k];
+        double t2 = params[3][k];
+
+        values[k] = pow(s1*s2 + t1*t2, 2) - 1;
+    }
+}
+
+void tangent_edge_2d::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double s1 = params[0][k];
+        double t1 = params[1][k];
+        double s2 = params[2][k];
+        double t2 = params[3][k];
+
+        double temp0 = s1*s2 + t1*t2;
+        double temp1 = 2*temp0;
+
+        gradients[0][k] = s2*temp1;
+        gradients[1][k] = t2*temp1;
+        gradients[2][k] = s1*temp1;
+        gradients[3][k] = t1*temp1;
+
+        values[k] = pow(temp0, 2) - 1;
+    }
+}
+
 parallel_line_2d::parallel_line_2d(DOFPointer line1_point1s, DOFPointer line1_point1t, DOFPointer line1_point2s, DOFPointer line1_point2t, DOFPointer line2_point1s, DOFPointer line2_point1t, DOFPointer line2_point2s, DOFPointer line2_point2t)
 {
     AddDOF(line1_point1s);
@@ -374,10 +697,10 @@ double parallel_line_2d::GetValue() const
     double line2_point2s = GetDOF(6)->GetValue();
     double line2_point2t = GetDOF(7)->GetValue();
 
-    return -1 + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)));
+    return pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) - 1;
 }
 
-double parallel_line_2d::GetValueSelf(const mmcMatrix &params) const
+double parallel_line_2d::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double line1_point1s = params(0,0);
     double line1_point1t = params(1,0);
@@ -388,12 +711,12 @@ double parallel_line_2d::GetValueSelf(const mmcMatrix &params) const
     double line2_point2s = params(6,0);
     double line2_point2t = params(7,0);
 
-    return -1 + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)));
+    return pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) - 1;
 }
 
-mmcMatrix parallel_line_2d::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector parallel_line_2d::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double line1_point1s = params(0,0);
     double line1_point1t = params(1,0);
@@ -404,18 +727,130 @@ mmcMatrix parallel_line_2d::GetGradientSelf(const mmcMatrix &params) const
     double line2_point2s = params(6,0);
     double line2_point2t = params(7,0);
 
-    result(0,0) = (-2*line2_point2s + 2*line2_point1s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line1_point1s + 2*line1_point2s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),2)*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)));
-    result(1,0) = (-2*line2_point2t + 2*line2_point1t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line1_point1t + 2*line1_point2t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),2)*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)));
-    result(2,0) = (-2*line2_point1s + 2*line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line1_point2s + 2*line1_point1s)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),2)*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)));
-    result(3,0) = (-2*line2_point1t + 2*line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line1_point2t + 2*line1_point1t)/(pow((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2)),2)*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)));
-    result(4,0) = (-2*line1_point2s + 2*line1_point1s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line2_point1s + 2*line2_point2s)/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),2));
-    result(5,0) = (-2*line1_point2t + 2*line1_point1t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line2_point1t + 2*line2_point2t)/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),2));
-    result(6,0) = (-2*line1_point1s + 2*line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line2_point2s + 2*line2_point1s)/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),2));
-    result(7,0) = (-2*line1_point1t + 2*line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*(pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2))) + pow(((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t)),2)*(-2*line2_point2t + 2*line2_point1t)/((pow((line1_point1s - line1_point2s),2) + pow((line1_point1t - line1_point2t),2))*pow((pow((line2_point1s - line2_point2s),2) + pow((line2_point1t - line2_point2t),2)),2));
+    result(0,0) = (-2*line1_point1s + 2*line1_point2s)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 2)*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (2*line2_point1s - 2*line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(1,0) = (-2*line1_point1t + 2*line1_point2t)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 2)*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (2*line2_point1t - 2*line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(2,0) = (2*line1_point1s - 2*line1_point2s)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 2)*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-2*line2_point1s + 2*line2_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(3,0) = (2*line1_point1t - 2*line1_point2t)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/(pow(pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2), 2)*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-2*line2_point1t + 2*line2_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2)));
+    result(4,0) = (2*line1_point1s - 2*line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-2*line2_point1s + 2*line2_point2s)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 2));
+    result(5,0) = (2*line1_point1t - 2*line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (-2*line2_point1t + 2*line2_point2t)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 2));
+    result(6,0) = (-2*line1_point1s + 2*line1_point2s)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (2*line2_point1s - 2*line2_point2s)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 2));
+    result(7,0) = (-2*line1_point1t + 2*line1_point2t)*((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t))/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) + (2*line2_point1t - 2*line2_point2t)*pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*pow(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2), 2));
 
     return result;
 }
 
+double parallel_line_2d::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double line1_point1s = params(0,0);
+    double line1_point1t = params(1,0);
+    double line1_point2s = params(2,0);
+    double line1_point2t = params(3,0);
+    double line2_point1s = params(4,0);
+    double line2_point1t = params(5,0);
+    double line2_point2s = params(6,0);
+    double line2_point2t = params(7,0);
+
+    double temp0 = line1_point1s - line1_point2s;
+    double temp1 = line2_point1s - line2_point2s;
+    double temp2 = line1_point1t - line1_point2t;
+    double temp3 = line2_point1t - line2_point2t;
+    double temp4 = temp0*temp1 + temp2*temp3;
+    double temp5 = pow(temp4, 2);
+    double temp6 = pow(temp0, 2) + pow(temp2, 2);
+    double temp7 = 1.0/temp6;
+    double temp8 = pow(temp1, 2) + pow(temp3, 2);
+    double temp9 = 1.0/temp8;
+    double temp10 = temp7*temp9;
+    double temp11 = 2*line2_point1s - 2*line2_point2s;
+    double temp12 = temp10*temp4;
+    double temp13 = 2*line1_point1s - 2*line1_point2s;
+    double temp14 = -temp13;
+    double temp15 = temp5*temp9/pow(temp6, 2);
+    double temp16 = 2*line2_point1t - 2*line2_point2t;
+    double temp17 = 2*line1_point1t - 2*line1_point2t;
+    double temp18 = -temp17;
+    double temp19 = -temp11;
+    double temp20 = -temp16;
+    double temp21 = temp5*temp7/pow(temp8, 2);
+
+    gradient(0,0) = temp11*temp12 + temp14*temp15;
+    gradient(1,0) = temp12*temp16 + temp15*temp18;
+    gradient(2,0) = temp12*temp19 + temp13*temp15;
+    gradient(3,0) = temp12*temp20 + temp15*temp17;
+    gradient(4,0) = temp12*temp13 + temp19*temp21;
+    gradient(5,0) = temp12*temp17 + temp20*temp21;
+    gradient(6,0) = temp11*temp21 + temp12*temp14;
+    gradient(7,0) = temp12*temp18 + temp16*temp21;
+
+    return temp10*temp5 - 1;
+}
+
+void parallel_line_2d::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double line1_point1s = params[0][k];
+        double line1_point1t = params[1][k];
+        double line1_point2s = params[2][k];
+        double line1_point2t = params[3][k];
+        double line2_point1s = params[4][k];
+        double line2_point1t = params[5][k];
+        double line2_point2s = params[6][k];
+        double line2_point2t = params[7][k];
+
+        values[k] = pow((line1_point1s - line1_point2s)*(line2_point1s - line2_point2s) + (line1_point1t - line1_point2t)*(line2_point1t - line2_point2t), 2)/((pow(line1_point1s - line1_point2s, 2) + pow(line1_point1t - line1_point2t, 2))*(pow(line2_point1s - line2_point2s, 2) + pow(line2_point1t - line2_point2t, 2))) - 1;
+    }
+}
+
+void parallel_line_2d::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double line1_point1s = params[0][k];
+        double line1_point1t = params[1][k];
+        double line1_point2s = params[2][k];
+        double line1_point2t = params[3][k];
+        double line2_point1s = params[4][k];
+        double line2_point1t = params[5][k];
+        double line2_point2s = params[6][k];
+        double line2_point2t = params[7][k];
+
+        double temp0 = line1_point1s - line1_point2s;
+        double temp1 = line2_point1s - line2_point2s;
+        double temp2 = line1_point1t - line1_point2t;
+        double temp3 = line2_point1t - line2_point2t;
+        double temp4 = temp0*temp1 + temp2*temp3;
+        double temp5 = pow(temp4, 2);
+        double temp6 = pow(temp0, 2) + pow(temp2, 2);
+        double temp7 = 1.0/temp6;
+        double temp8 = pow(temp1, 2) + pow(temp3, 2);
+        double temp9 = 1.0/temp8;
+        double temp10 = temp7*temp9;
+        double temp11 = 2*line2_point1s - 2*line2_point2s;
+        double temp12 = temp10*temp4;
+        double temp13 = 2*line1_point1s - 2*line1_point2s;
+        double temp14 = -temp13;
+        double temp15 = temp5*temp9/pow(temp6, 2);
+        double temp16 = 2*line2_point1t - 2*line2_point2t;
+        double temp17 = 2*line1_point1t - 2*line1_point2t;
+        double temp18 = -temp17;
+        double temp19 = -temp11;
+        double temp20 = -temp16;
+        double temp21 = temp5*temp7/pow(temp8, 2);
+
+        gradients[0][k] = temp11*temp12 + temp14*temp15;
+        gradients[1][k] = temp12*temp16 + temp15*temp18;
+        gradients[2][k] = temp12*temp19 + temp13*temp15;
+        gradients[3][k] = temp12*temp20 + temp15*temp17;
+        gradients[4][k] = temp12*temp13 + temp19*temp21;
+        gradients[5][k] = temp12*temp17 + temp20*temp21;
+        gradients[6][k] = temp11*temp21 + temp12*temp14;
+        gradients[7][k] = temp12*temp18 + temp16*temp21;
+
+        values[k] = temp10*temp5 - 1;
+    }
+}
+
 arc2d_point_s::arc2d_point_s(DOFPointer s_center, DOFPointer radius, DOFPointer theta)
 {
     AddDOF(s_center);
@@ -439,21 +874,21 @@ double arc2d_point_s::GetValue() const
     double radius = GetDOF(1)->GetValue();
     double theta = GetDOF(2)->GetValue();
 
-    return s_center + radius*cos(theta);
+    return radius*cos(theta) + s_center;
 }
 
-double arc2d_point_s::GetValueSelf(const mmcMatrix &params) const
+double arc2d_point_s::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double s_center = params(0,0);
     double radius = params(1,0);
     double theta = params(2,0);
 
-    return s_center + radius*cos(theta);
+    return radius*cos(theta) + s_center;
 }
 
-mmcMatrix arc2d_point_s::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector arc2d_point_s::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double s_center = params(0,0);
     double radius = params(1,0);
@@ -466,6 +901,51 @@ mmcMatrix arc2d_point_s::GetGradientSelf(const mmcMatrix &params) const
     return result;
 }
 
+double arc2d_point_s::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double s_center = params(0,0);
+    double radius = params(1,0);
+    double theta = params(2,0);
+
+    double temp0 = cos(theta);
+
+    gradient(0,0) = 1;
+    gradient(1,0) = temp0;
+    gradient(2,0) = -radius*sin(theta);
+
+    return radius*temp0 + s_center;
+}
+
+void arc2d_point_s::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double s_center = params[0][k];
+        double radius = params[1][k];
+        double theta = params[2][k];
+
+        values[k] = radius*cos(theta) + s_center;
+    }
+}
+
+void arc2d_point_s::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double s_center = params[0][k];
+        double radius = params[1][k];
+        double theta = params[2][k];
+
+        double temp0 = cos(theta);
+
+        gradients[0][k] = 1;
+        gradients[1][k] = temp0;
+        gradients[2][k] = -radius*sin(theta);
+
+        values[k] = radius*temp0 + s_center;
+    }
+}
+
 arc2d_point_t::arc2d_point_t(DOFPointer t_center, DOFPointer radius, DOFPointer theta)
 {
     AddDOF(t_center);
@@ -489,21 +969,21 @@ double arc2d_point_t::GetValue() const
     double radius = GetDOF(1)->GetValue();
     double theta = GetDOF(2)->GetValue();
 
-    return t_center + radius*sin(theta);
+    return radius*sin(theta) + t_center;
 }
 
-double arc2d_point_t::GetValueSelf(const mmcMatrix &params) const
+double arc2d_point_t::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double t_center = params(0,0);
     double radius = params(1,0);
     double theta = params(2,0);
 
-    return t_center + radius*sin(theta);
+    return radius*sin(theta) + t_center;
 }
 
-mmcMatrix arc2d_point_t::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector arc2d_point_t::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double t_center = params(0,0);
     double radius = params(1,0);
@@ -516,6 +996,51 @@ mmcMatrix arc2d_point_t::GetGradientSelf(const mmcMatrix &params) const
     return result;
 }
 
+double arc2d_point_t::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double t_center = params(0,0);
+    double radius = params(1,0);
+    double theta = params(2,0);
+
+    double temp0 = sin(theta);
+
+    gradient(0,0) = 1;
+    gradient(1,0) = temp0;
+    gradient(2,0) = radius*cos(theta);
+
+    return radius*temp0 + t_center;
+}
+
+void arc2d_point_t::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double t_center = params[0][k];
+        double radius = params[1][k];
+        double theta = params[2][k];
+
+        values[k] = radius*sin(theta) + t_center;
+    }
+}
+
+void arc2d_point_t::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double t_center = params[0][k];
+        double radius = params[1][k];
+        double theta = params[2][k];
+
+        double temp0 = sin(theta);
+
+        gradients[0][k] = 1;
+        gradients[1][k] = temp0;
+        gradients[2][k] = radius*cos(theta);
+
+        values[k] = radius*temp0 + t_center;
+    }
+}
+
 arc2d_tangent_s::arc2d_tangent_s(DOFPointer theta)
 {
     AddDOF(theta);
@@ -538,16 +1063,16 @@ double arc2d_tangent_s::GetValue() const
     return sin(theta);
 }
 
-double arc2d_tangent_s::GetValueSelf(const mmcMatrix &params) const
+double arc2d_tangent_s::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double theta = params(0,0);
 
     return sin(theta);
 }
 
-mmcMatrix arc2d_tangent_s::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector arc2d_tangent_s::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double theta = params(0,0);
 
@@ -556,6 +1081,39 @@ mmcMatrix arc2d_tangent_s::GetGradientSelf(const mmcMatrix &params) const
     return result;
 }
 
+double arc2d_tangent_s::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double theta = params(0,0);
+
+
+    gradient(0,0) = cos(theta);
+
+    return sin(theta);
+}
+
+void arc2d_tangent_s::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double theta = params[0][k];
+
+        values[k] = sin(theta);
+    }
+}
+
+void arc2d_tangent_s::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double theta = params[0][k];
+
+
+        gradients[0][k] = cos(theta);
+
+        values[k] = sin(theta);
+    }
+}
+
 arc2d_tangent_t::arc2d_tangent_t(DOFPointer theta)
 {
     AddDOF(theta);
@@ -578,16 +1136,16 @@ double arc2d_tangent_t::GetValue() const
     return -cos(theta);
 }
 
-double arc2d_tangent_t::GetValueSelf(const mmcMatrix &params) const
+double arc2d_tangent_t::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double theta = params(0,0);
 
     return -cos(theta);
 }
 
-mmcMatrix arc2d_tangent_t::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector arc2d_tangent_t::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double theta = params(0,0);
 
@@ -596,6 +1154,39 @@ mmcMatrix arc2d_tangent_t::GetGradientSelf(const mmcMatrix &params) const
     return result;
 }
 
+double arc2d_tangent_t::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double theta = params(0,0);
+
+
+    gradient(0,0) = sin(theta);
+
+    return -cos(theta);
+}
+
+void arc2d_tangent_t::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double theta = params[0][k];
+
+        values[k] = -cos(theta);
+    }
+}
+
+void arc2d_tangent_t::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double theta = params[0][k];
+
+
+        gradients[0][k] = sin(theta);
+
+        values[k] = -cos(theta);
+    }
+}
+
 point2d_tangent1_s::point2d_tangent1_s(DOFPointer point1s, DOFPointer point1t, DOFPointer point2s, DOFPointer point2t)
 {
     AddDOF(point1s);
@@ -621,36 +1212,98 @@ double point2d_tangent1_s::GetValue() const
     double point2s = GetDOF(2)->GetValue();
     double point2t = GetDOF(3)->GetValue();
 
-    return (point1s - point2s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (point1s - point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-double point2d_tangent1_s::GetValueSelf(const mmcMatrix &params) const
+double point2d_tangent1_s::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    return (point1s - point2s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (point1s - point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-mmcMatrix point2d_tangent1_s::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector point2d_tangent1_s::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    result(0,0) = (point2s - point1s)*(point1s - point2s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) + pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(-1.0/2.0));
-    result(1,0) = (point2t - point1t)*(point1s - point2s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
-    result(2,0) = pow((point1s - point2s),2)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) - 1/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
-    result(3,0) = (point1s - point2s)*(point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
+    result(0,0) = (-point1s + point2s)*(point1s - point2s)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) + pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), -1.0/2.0);
+    result(1,0) = (point1s - point2s)*(-point1t + point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
+    result(2,0) = pow(point1s - point2s, 2)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) - 1/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    result(3,0) = (point1s - point2s)*(point1t - point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
 
     return result;
 }
 
+double point2d_tangent1_s::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double point1s = params(0,0);
+    double point1t = params(1,0);
+    double point2s = params(2,0);
+    double point2t = params(3,0);
+
+    double temp0 = point1s - point2s;
+    double temp1 = pow(temp0, 2);
+    double temp2 = point1t - point2t;
+    double temp3 = temp1 + pow(temp2, 2);
+    double temp4 = pow(temp3, -1.0/2.0);
+    double temp5 = pow(temp3, -3.0/2.0);
+    double temp6 = temp0*temp5;
+
+    gradient(0,0) = -temp0*temp6 + temp4;
+    gradient(1,0) = -temp2*temp6;
+    gradient(2,0) = temp1*temp5 - temp4;
+    gradient(3,0) = temp2*temp6;
+
+    return temp0*temp4;
+}
+
+void point2d_tangent1_s::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        values[k] = (point1s - point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    }
+}
+
+void point2d_tangent1_s::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        double temp0 = point1s - point2s;
+        double temp1 = pow(temp0, 2);
+        double temp2 = point1t - point2t;
+        double temp3 = temp1 + pow(temp2, 2);
+        double temp4 = pow(temp3, -1.0/2.0);
+        double temp5 = pow(temp3, -3.0/2.0);
+        double temp6 = temp0*temp5;
+
+        gradients[0][k] = -temp0*temp6 + temp4;
+        gradients[1][k] = -temp2*temp6;
+        gradients[2][k] = temp1*temp5 - temp4;
+        gradients[3][k] = temp2*temp6;
+
+        values[k] = temp0*temp4;
+    }
+}
+
 point2d_tangent1_t::point2d_tangent1_t(DOFPointer point1s, DOFPointer point1t, DOFPointer point2s, DOFPointer point2t)
 {
     AddDOF(point1s);
@@ -676,36 +1329,98 @@ double point2d_tangent1_t::GetValue() const
     double point2s = GetDOF(2)->GetValue();
     double point2t = GetDOF(3)->GetValue();
 
-    return (point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (point1t - point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-double point2d_tangent1_t::GetValueSelf(const mmcMatrix &params) const
+double point2d_tangent1_t::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    return (point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (point1t - point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-mmcMatrix point2d_tangent1_t::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector point2d_tangent1_t::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    result(0,0) = (point2s - point1s)*(point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
-    result(1,0) = (point2t - point1t)*(point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) + pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(-1.0/2.0));
-    result(2,0) = (point1s - point2s)*(point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
-    result(3,0) = pow((point1t - point2t),2)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) - 1/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    result(0,0) = (-point1s + point2s)*(point1t - point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
+    result(1,0) = (-point1t + point2t)*(point1t - point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) + pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), -1.0/2.0);
+    result(2,0) = (point1s - point2s)*(point1t - point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
+    result(3,0) = pow(point1t - point2t, 2)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) - 1/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 
     return result;
 }
 
+double point2d_tangent1_t::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double point1s = params(0,0);
+    double point1t = params(1,0);
+    double point2s = params(2,0);
+    double point2t = params(3,0);
+
+    double temp0 = point1t - point2t;
+    double temp1 = point1s - point2s;
+    double temp2 = pow(temp0, 2);
+    double temp3 = pow(temp1, 2) + temp2;
+    double temp4 = pow(temp3, -1.0/2.0);
+    double temp5 = pow(temp3, -3.0/2.0);
+    double temp6 = temp0*temp5;
+
+    gradient(0,0) = -temp1*temp6;
+    gradient(1,0) = -temp0*temp6 + temp4;
+    gradient(2,0) = temp1*temp6;
+    gradient(3,0) = temp2*temp5 - temp4;
+
+    return temp0*temp4;
+}
+
+void point2d_tangent1_t::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        values[k] = (point1t - point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    }
+}
+
+void point2d_tangent1_t::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        double temp0 = point1t - point2t;
+        double temp1 = point1s - point2s;
+        double temp2 = pow(temp0, 2);
+        double temp3 = pow(temp1, 2) + temp2;
+        double temp4 = pow(temp3, -1.0/2.0);
+        double temp5 = pow(temp3, -3.0/2.0);
+        double temp6 = temp0*temp5;
+
+        gradients[0][k] = -temp1*temp6;
+        gradients[1][k] = -temp0*temp6 + temp4;
+        gradients[2][k] = temp1*temp6;
+        gradients[3][k] = temp2*temp5 - temp4;
+
+        values[k] = temp0*temp4;
+    }
+}
+
 point2d_tangent2_s::point2d_tangent2_s(DOFPointer point1s, DOFPointer point1t, DOFPointer point2s, DOFPointer point2t)
 {
     AddDOF(point1s);
@@ -731,36 +1446,98 @@ double point2d_tangent2_s::GetValue() const
     double point2s = GetDOF(2)->GetValue();
     double point2t = GetDOF(3)->GetValue();
 
-    return (point2s - point1s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (-point1s + point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-double point2d_tangent2_s::GetValueSelf(const mmcMatrix &params) const
+double point2d_tangent2_s::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    return (point2s - point1s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (-point1s + point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-mmcMatrix point2d_tangent2_s::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector point2d_tangent2_s::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    result(0,0) = pow((point2s - point1s),2)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) - 1/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
-    result(1,0) = (point2s - point1s)*(point2t - point1t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
-    result(2,0) = (point2s - point1s)*(point1s - point2s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) + pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(-1.0/2.0));
-    result(3,0) = (point2s - point1s)*(point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
+    result(0,0) = pow(-point1s + point2s, 2)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) - 1/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    result(1,0) = (-point1s + point2s)*(-point1t + point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
+    result(2,0) = (-point1s + point2s)*(point1s - point2s)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) + pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), -1.0/2.0);
+    result(3,0) = (-point1s + point2s)*(point1t - point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
 
     return result;
 }
 
+double point2d_tangent2_s::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double point1s = params(0,0);
+    double point1t = params(1,0);
+    double point2s = params(2,0);
+    double point2t = params(3,0);
+
+    double temp0 = point1s - point2s;
+    double temp1 = -temp0;
+    double temp2 = point1t - point2t;
+    double temp3 = pow(temp0, 2) + pow(temp2, 2);
+    double temp4 = pow(temp3, -1.0/2.0);
+    double temp5 = pow(temp3, -3.0/2.0);
+    double temp6 = temp1*temp5;
+
+    gradient(0,0) = pow(temp1, 2)*temp5 - temp4;
+    gradient(1,0) = -temp2*temp6;
+    gradient(2,0) = temp0*temp6 + temp4;
+    gradient(3,0) = temp2*temp6;
+
+    return temp1*temp4;
+}
+
+void point2d_tangent2_s::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        values[k] = (-point1s + point2s)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    }
+}
+
+void point2d_tangent2_s::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        double temp0 = point1s - point2s;
+        double temp1 = -temp0;
+        double temp2 = point1t - point2t;
+        double temp3 = pow(temp0, 2) + pow(temp2, 2);
+        double temp4 = pow(temp3, -1.0/2.0);
+        double temp5 = pow(temp3, -3.0/2.0);
+        double temp6 = temp1*temp5;
+
+        gradients[0][k] = pow(temp1, 2)*temp5 - temp4;
+        gradients[1][k] = -temp2*temp6;
+        gradients[2][k] = temp0*temp6 + temp4;
+        gradients[3][k] = temp2*temp6;
+
+        values[k] = temp1*temp4;
+    }
+}
+
 point2d_tangent2_t::point2d_tangent2_t(DOFPointer point1s, DOFPointer point1t, DOFPointer point2s, DOFPointer point2t)
 {
     AddDOF(point1s);
@@ -786,36 +1563,98 @@ double point2d_tangent2_t::GetValue() const
     double point2s = GetDOF(2)->GetValue();
     double point2t = GetDOF(3)->GetValue();
 
-    return (point2t - point1t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (-point1t + point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-double point2d_tangent2_t::GetValueSelf(const mmcMatrix &params) const
+double point2d_tangent2_t::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    return (point2t - point1t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
+    return (-point1t + point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
 }
 
-mmcMatrix point2d_tangent2_t::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector point2d_tangent2_t::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double point1s = params(0,0);
     double point1t = params(1,0);
     double point2s = params(2,0);
     double point2t = params(3,0);
 
-    result(0,0) = (point2s - point1s)*(point2t - point1t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
-    result(1,0) = pow((point2t - point1t),2)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) - 1/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(1.0/2.0));
-    result(2,0) = (point2t - point1t)*(point1s - point2s)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0));
-    result(3,0) = (point2t - point1t)*(point1t - point2t)/pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(3.0/2.0)) + pow((pow((point1s - point2s),2) + pow((point1t - point2t),2)),(-1.0/2.0));
+    result(0,0) = (-point1s + point2s)*(-point1t + point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
+    result(1,0) = pow(-point1t + point2t, 2)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) - 1/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    result(2,0) = (point1s - point2s)*(-point1t + point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0);
+    result(3,0) = (-point1t + point2t)*(point1t - point2t)/pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), 3.0/2.0) + pow(pow(point1s - point2s, 2) + pow(point1t - point2t, 2), -1.0/2.0);
 
     return result;
 }
 
+double point2d_tangent2_t::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double point1s = params(0,0);
+    double point1t = params(1,0);
+    double point2s = params(2,0);
+    double point2t = params(3,0);
+
+    double temp0 = point1t - point2t;
+    double temp1 = -temp0;
+    double temp2 = point1s - point2s;
+    double temp3 = pow(temp0, 2) + pow(temp2, 2);
+    double temp4 = pow(temp3, -1.0/2.0);
+    double temp5 = pow(temp3, -3.0/2.0);
+    double temp6 = temp1*temp5;
+
+    gradient(0,0) = -temp2*temp6;
+    gradient(1,0) = pow(temp1, 2)*temp5 - temp4;
+    gradient(2,0) = temp2*temp6;
+    gradient(3,0) = temp0*temp6 + temp4;
+
+    return temp1*temp4;
+}
+
+void point2d_tangent2_t::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        values[k] = (-point1t + point2t)/sqrt(pow(point1s - point2s, 2) + pow(point1t - point2t, 2));
+    }
+}
+
+void point2d_tangent2_t::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point1s = params[0][k];
+        double point1t = params[1][k];
+        double point2s = params[2][k];
+        double point2t = params[3][k];
+
+        double temp0 = point1t - point2t;
+        double temp1 = -temp0;
+        double temp2 = point1s - point2s;
+        double temp3 = pow(temp0, 2) + pow(temp2, 2);
+        double temp4 = pow(temp3, -1.0/2.0);
+        double temp5 = pow(temp3, -3.0/2.0);
+        double temp6 = temp1*temp5;
+
+        gradients[0][k] = -temp2*temp6;
+        gradients[1][k] = pow(temp1, 2)*temp5 - temp4;
+        gradients[2][k] = temp2*temp6;
+        gradients[3][k] = temp0*temp6 + temp4;
+
+        values[k] = temp1*temp4;
+    }
+}
+
 distance_point_line_2d::distance_point_line_2d(DOFPointer point_s, DOFPointer point_t, DOFPointer line_point1s, DOFPointer line_point1t, DOFPointer line_point2s, DOFPointer line_point2t, DOFPointer distance)
 {
     AddDOF(point_s);
@@ -847,10 +1686,10 @@ double distance_point_line_2d::GetValue() const
     double line_point2t = GetDOF(5)->GetValue();
     double distance = GetDOF(6)->GetValue();
 
-    return -pow(distance,2) + pow(((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t)),2)/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2));
+    return -pow(distance, 2) + pow((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t), 2)/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
 }
 
-double distance_point_line_2d::GetValueSelf(const mmcMatrix &params) const
+double distance_point_line_2d::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double point_s = params(0,0);
     double point_t = params(1,0);
@@ -860,12 +1699,12 @@ double distance_point_line_2d::GetValueSelf(const mmcMatrix &params) const
     double line_point2t = params(5,0);
     double distance = params(6,0);
 
-    return -pow(distance,2) + pow(((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t)),2)/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2));
+    return -pow(distance, 2) + pow((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t), 2)/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
 }
 
-mmcMatrix distance_point_line_2d::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector distance_point_line_2d::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double point_s = params(0,0);
     double point_t = params(1,0);
@@ -875,17 +1714,114 @@ mmcMatrix distance_point_line_2d::GetGradientSelf(const mmcMatrix &params) const
     double line_point2t = params(5,0);
     double distance = params(6,0);
 
-    result(0,0) = (-2*line_point1t + 2*line_point2t)*((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t))/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2));
-    result(1,0) = (-2*line_point2s + 2*line_point1s)*((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t))/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2));
-    result(2,0) = (-2*line_point2t + 2*point_t)*((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t))/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)) + pow(((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t)),2)*(-2*line_point1s + 2*line_point2s)/pow((pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)),2);
-    result(3,0) = (-2*point_s + 2*line_point2s)*((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t))/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)) + pow(((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t)),2)*(-2*line_point1t + 2*line_point2t)/pow((pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)),2);
-    result(4,0) = (-2*point_t + 2*line_point1t)*((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t))/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)) + pow(((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t)),2)*(-2*line_point2s + 2*line_point1s)/pow((pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)),2);
-    result(5,0) = (-2*line_point1s + 2*point_s)*((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t))/(pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)) + pow(((line_point1t - point_t)*(line_point2s - line_point1s) - (line_point1s - point_s)*(line_point2t - line_point1t)),2)*(-2*line_point2t + 2*line_point1t)/pow((pow((line_point2s - line_point1s),2) + pow((line_point2t - line_point1t),2)),2);
+    result(0,0) = (-2*line_point1t + 2*line_point2t)*((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t))/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
+    result(1,0) = (2*line_point1s - 2*line_point2s)*((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t))/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
+    result(2,0) = (-2*line_point1s + 2*line_point2s)*pow((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t), 2)/pow(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2), 2) + (-2*line_point2t + 2*point_t)*((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t))/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
+    result(3,0) = (-2*line_point1t + 2*line_point2t)*pow((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t), 2)/pow(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2), 2) + (2*line_point2s - 2*point_s)*((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t))/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
+    result(4,0) = (2*line_point1s - 2*line_point2s)*pow((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t), 2)/pow(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2), 2) + (2*line_point1t - 2*point_t)*((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t))/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
+    result(5,0) = (-2*line_point1s + 2*point_s)*((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t))/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2)) + (2*line_point1t - 2*line_point2t)*pow((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t), 2)/pow(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2), 2);
     result(6,0) = -2*distance;
 
     return result;
 }
 
+double distance_point_line_2d::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double point_s = params(0,0);
+    double point_t = params(1,0);
+    double line_point1s = params(2,0);
+    double line_point1t = params(3,0);
+    double line_point2s = params(4,0);
+    double line_point2t = params(5,0);
+    double distance = params(6,0);
+
+    double temp0 = -line_point1s + line_point2s;
+    double temp1 = -line_point1t + line_point2t;
+    double temp2 = pow(temp0, 2) + pow(temp1, 2);
+    double temp3 = 1.0/temp2;
+    double temp4 = temp0*(line_point1t - point_t) - temp1*(line_point1s - point_s);
+    double temp5 = pow(temp4, 2);
+    double temp6 = 2*line_point1t;
+    double temp7 = 2*line_point2t;
+    double temp8 = temp6 - temp7;
+    double temp9 = -temp8;
+    double temp10 = temp3*temp4;
+    double temp11 = 2*line_point1s;
+    double temp12 = 2*line_point2s;
+    double temp13 = temp11 - temp12;
+    double temp14 = -2*point_t;
+    double temp15 = temp5/pow(temp2, 2);
+    double temp16 = -2*point_s;
+
+    gradient(0,0) = temp10*temp9;
+    gradient(1,0) = temp10*temp13;
+    gradient(2,0) = temp10*(-temp14 - temp7) - temp13*temp15;
+    gradient(3,0) = temp10*(temp12 + temp16) + temp15*temp9;
+    gradient(4,0) = temp10*(temp14 + temp6) + temp13*temp15;
+    gradient(5,0) = temp10*(-temp11 - temp16) + temp15*temp8;
+    gradient(6,0) = -2*distance;
+
+    return -pow(distance, 2) + temp3*temp5;
+}
+
+void distance_point_line_2d::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point_s = params[0][k];
+        double point_t = params[1][k];
+        double line_point1s = params[2][k];
+        double line_point1t = params[3][k];
+        double line_point2s = params[4][k];
+        double line_point2t = params[5][k];
+        double distance = params[6][k];
+
+        values[k] = -pow(distance, 2) + pow((-line_point1s + line_point2s)*(line_point1t - point_t) - (line_point1s - point_s)*(-line_point1t + line_point2t), 2)/(pow(-line_point1s + line_point2s, 2) + pow(-line_point1t + line_point2t, 2));
+    }
+}
+
+void distance_point_line_2d::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double point_s = params[0][k];
+        double point_t = params[1][k];
+        double line_point1s = params[2][k];
+        double line_point1t = params[3][k];
+        double line_point2s = params[4][k];
+        double line_point2t = params[5][k];
+        double distance = params[6][k];
+
+        double temp0 = -line_point1s + line_point2s;
+        double temp1 = -line_point1t + line_point2t;
+        double temp2 = pow(temp0, 2) + pow(temp1, 2);
+        double temp3 = 1.0/temp2;
+        double temp4 = temp0*(line_point1t - point_t) - temp1*(line_point1s - point_s);
+        double temp5 = pow(temp4, 2);
+        double temp6 = 2*line_point1t;
+        double temp7 = 2*line_point2t;
+        double temp8 = temp6 - temp7;
+        double temp9 = -temp8;
+        double temp10 = temp3*temp4;
+        double temp11 = 2*line_point1s;
+        double temp12 = 2*line_point2s;
+        double temp13 = temp11 - temp12;
+        double temp14 = -2*point_t;
+        double temp15 = temp5/pow(temp2, 2);
+        double temp16 = -2*point_s;
+
+        gradients[0][k] = temp10*temp9;
+        gradients[1][k] = temp10*temp13;
+        gradients[2][k] = temp10*(-temp14 - temp7) - temp13*temp15;
+        gradients[3][k] = temp10*(temp12 + temp16) + temp15*temp9;
+        gradients[4][k] = temp10*(temp14 + temp6) + temp13*temp15;
+        gradients[5][k] = temp10*(-temp11 - temp16) + temp15*temp8;
+        gradients[6][k] = -2*distance;
+
+        values[k] = -pow(distance, 2) + temp3*temp5;
+    }
+}
+
 hori_vert_2d::hori_vert_2d(DOFPointer dof1, DOFPointer dof2)
 {
     AddDOF(dof1);
@@ -910,7 +1846,7 @@ double hori_vert_2d::GetValue() const
     return dof1 - dof2;
 }
 
-double hori_vert_2d::GetValueSelf(const mmcMatrix &params) const
+double hori_vert_2d::GetValueSelf(const SolverFunctionsVector &params) const
 {
     double dof1 = params(0,0);
     double dof2 = params(1,0);
@@ -918,9 +1854,9 @@ double hori_vert_2d::GetValueSelf(const mmcMatrix &params) const
     return dof1 - dof2;
 }
 
-mmcMatrix hori_vert_2d::GetGradientSelf(const mmcMatrix &params) const
+SolverFunctionsVector hori_vert_2d::GetGradientSelf(const SolverFunctionsVector &params) const
 {
-    mmcMatrix result(GetNumDOFs(),1);
+    SolverFunctionsVector result;
 
     double dof1 = params(0,0);
     double dof2 = params(1,0);
@@ -931,3 +1867,41 @@ mmcMatrix hori_vert_2d::GetGradientSelf(const mmcMatrix &params) const
     return result;
 }
 
+double hori_vert_2d::GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const
+{
+    double dof1 = params(0,0);
+    double dof2 = params(1,0);
+
+
+    gradient(0,0) = 1;
+    gradient(1,0) = -1;
+
+    return dof1 - dof2;
+}
+
+void hori_vert_2d::GetValueBatch(int count, const double * const *params, double *values)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double dof1 = params[0][k];
+        double dof2 = params[1][k];
+
+        values[k] = dof1 - dof2;
+    }
+}
+
+void hori_vert_2d::GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients)
+{
+    for(int k = 0; k < count; k++)
+    {
+        double dof1 = params[0][k];
+        double dof2 = params[1][k];
+
+
+        gradients[0][k] = 1;
+        gradients[1][k] = -1;
+
+        values[k] = dof1 - dof2;
+    }
+}
+
@@ -35,9 +35,15 @@ class distance_point_2d: public SolverFunctionsBase
         distance_point_2d(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "distance_point_2d";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class angle_line_2d_interior: public SolverFunctionsBase
@@ -47,9 +53,15 @@ class angle_line_2d_interior: public SolverFunctionsBase
         angle_line_2d_interior(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "angle_line_2d_interior";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class angle_line_2d_exterior: public SolverFunctionsBase
@@ -59,9 +71,15 @@ class angle_line_2d_exterior: public SolverFunctionsBase
         angle_line_2d_exterior(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "angle_line_2d_exterior";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class tangent_edge_2d: public SolverFunctionsBase
@@ -71,9 +89,15 @@ class tangent_edge_2d: public SolverFunctionsBase
         tangent_edge_2d(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "tangent_edge_2d";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class parallel_line_2d: public SolverFunctionsBase
@@ -83,9 +107,15 @@ class parallel_line_2d: public SolverFunctionsBase
         parallel_line_2d(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "parallel_line_2d";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class arc2d_point_s: public SolverFunctionsBase
@@ -95,9 +125,15 @@ class arc2d_point_s: public SolverFunctionsBase
         arc2d_point_s(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "arc2d_point_s";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class arc2d_point_t: public SolverFunctionsBase
@@ -107,9 +143,15 @@ class arc2d_point_t: public SolverFunctionsBase
         arc2d_point_t(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "arc2d_point_t";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class arc2d_tangent_s: public SolverFunctionsBase
@@ -119,9 +161,15 @@ class arc2d_tangent_s: public SolverFunctionsBase
         arc2d_tangent_s(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "arc2d_tangent_s";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class arc2d_tangent_t: public SolverFunctionsBase
@@ -131,9 +179,15 @@ class arc2d_tangent_t: public SolverFunctionsBase
         arc2d_tangent_t(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "arc2d_tangent_t";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class point2d_tangent1_s: public SolverFunctionsBase
@@ -143,9 +197,15 @@ class point2d_tangent1_s: public SolverFunctionsBase
         point2d_tangent1_s(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "point2d_tangent1_s";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class point2d_tangent1_t: public SolverFunctionsBase
@@ -155,9 +215,15 @@ class point2d_tangent1_t: public SolverFunctionsBase
         point2d_tangent1_t(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "point2d_tangent1_t";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class point2d_tangent2_s: public SolverFunctionsBase
@@ -167,9 +233,15 @@ class point2d_tangent2_s: public SolverFunctionsBase
         point2d_tangent2_s(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "point2d_tangent2_s";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class point2d_tangent2_t: public SolverFunctionsBase
@@ -179,9 +251,15 @@ class point2d_tangent2_t: public SolverFunctionsBase
         point2d_tangent2_t(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "point2d_tangent2_t";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class distance_point_line_2d: public SolverFunctionsBase
@@ -191,9 +269,15 @@ class distance_point_line_2d: public SolverFunctionsBase
         distance_point_line_2d(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "distance_point_line_2d";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
 };
 
 class hori_vert_2d: public SolverFunctionsBase
@@ -203,9 +287,16 @@ class hori_vert_2d: public SolverFunctionsBase
         hori_vert_2d(std::vector<DOFPointer> dof_list);
 
         double GetValue() const;
-        double GetValueSelf(const mmcMatrix &params) const;
-        mmcMatrix GetGradientSelf(const mmcMatrix &params) const;
+        double GetValueSelf(const SolverFunctionsVector &params) const;
+        SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const;
+        double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const;
         std::string GetName() const {return "hori_vert_2d";}
+
+        static void GetValueBatch(int count, const double * const *params, double *values);
+        static void GetValueAndGradientBatch(int count, const double * const *params, double *values, double * const *gradients);
+        SolverFunctionsValueBatch GetValueBatchKernel() const {return GetValueBatch;}
+        SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return GetValueAndGradientBatch;}
+        bool IsDOFEquality() const {return true;}
 };
 
 
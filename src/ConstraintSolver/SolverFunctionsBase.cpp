@@ -12,72 +12,137 @@ SolverFunctionsBase::~SolverFunctionsBase()
 
 void SolverFunctionsBase::AddDOF(DOFPointer new_pointer)
 {
+    if(dof_list_.size() >= solver_functions_max_dofs)
+    {
+        stringstream error_message;
+        error_message << "SolverFunctionsBase::AddDOF: solver functions cannot depend on more than " << solver_functions_max_dofs << " DOF's.";
+        throw SolverFunctionsException(error_message.str());
+    }
+
     dof_list_.push_back(new_pointer);
 }
 
 double SolverFunctionsBase::GetValue(const mmcMatrix &x) const
 {
-    mmcMatrix local_x = transform_*x;
+    return GetValueSelf(GetLocalParameters(x));
+}
+
+mmcMatrix SolverFunctionsBase::GetGradient(const mmcMatrix &x) const
+{
+    mmcMatrix gradient(x.GetNumRows(),1,0.0);
+
+    AddGradient(x,1.0,gradient);
+
+    return gradient;
+}
+
+void SolverFunctionsBase::AddGradient(const mmcMatrix &x, double scale, mmcMatrix &gradient) const
+{
+    ScatterGradient(x, scale, GetGradientSelf(GetLocalParameters(x)), gradient);
+}
+
+void SolverFunctionsBase::AddGradient(const mmcMatrix &x, double scale, std::vector<std::pair<int,double> > &gradient_entries) const
+{
+    ScatterGradient(x, scale, GetGradientSelf(GetLocalParameters(x)), gradient_entries);
+}
+
+double SolverFunctionsBase::AddValueWeightedGradient(const mmcMatrix &x, double scale, mmcMatrix &gradient) const
+{
+    SolverFunctionsVector local_gradient;
+    double value = GetValueAndGradientSelf(GetLocalParameters(x), local_gradient);
+
+    ScatterGradient(x, scale*value, local_gradient, gradient);
+
+    return value;
+}
+
+double SolverFunctionsBase::GetValuePlusGradient(const mmcMatrix &x, double scale, std::vector<std::pair<int,double> > &gradient_entries) const
+{
+    SolverFunctionsVector local_gradient;
+    double value = GetValueAndGradientSelf(GetLocalParameters(x), local_gradient);
+
+    ScatterGradient(x, scale, local_gradient, gradient_entries);
 
+    return value;
+}
+
+double SolverFunctionsBase::GetValuePlusLocalGradient(const mmcMatrix &x, SolverFunctionsVector &local_gradient) const
+{
+    return GetValueAndGradientSelf(GetLocalParameters(x), local_gradient);
+}
 
+void SolverFunctionsBase::ScatterGradient(const mmcMatrix &x, double scale, const SolverFunctionsVector &local_gradient, mmcMatrix &gradient) const
+{
     for(int i = 0; i < dof_list_.size(); i++)
     {
-        if (dof_list_[i]->IsDependent())
+        if (input_map_[i] < 0)
         {
-            local_x(i,0) = dof_list_[i]->GetSolverFunction()->GetValue(x);
+            // chain rule, the dependent dof scatters its own gradient into the global gradient
+            dof_list_[i]->GetSolverFunction()->AddGradient(x,scale*local_gradient(i,0),gradient);
+        } else {
+            gradient(input_map_[i],0) += scale*local_gradient(i,0);
         }
     }
+}
+
+void SolverFunctionsBase::ScatterGradient(const mmcMatrix &x, double scale, const SolverFunctionsVector &local_gradient, std::vector<std::pair<int,double> > &gradient_entries) const
+{
+    for(int i = 0; i < dof_list_.size(); i++)
+    {
+        if (input_map_[i] < 0)
+            dof_list_[i]->GetSolverFunction()->AddGradient(x,scale*local_gradient(i,0),gradient_entries);
+        else
+            gradient_entries.push_back(pair<int,double>(input_map_[i],scale*local_gradient(i,0)));
+    }
+}
+
+bool SolverFunctionsBase::HasDependentDOFs() const
+{
+    for(int i = 0; i < dof_list_.size(); i++)
+        if (dof_list_[i]->IsDependent())
+            return true;
 
-    return GetValueSelf(local_x);
+    return false;
 }
 
-mmcMatrix SolverFunctionsBase::GetGradient(const mmcMatrix &x) const
+SolverFunctionsVector SolverFunctionsBase::GetLocalParameters(const mmcMatrix &x) const
 {
-    mmcMatrix local_x = transform_*x;
-    mmcMatrix temp(dof_list_.size(),dof_list_.size());
-    temp.SetIdentity();
-    mmcMatrix jacobian = transform_.GetTranspose()*temp;
+    SolverFunctionsVector local_x;
 
     for(int i = 0; i < dof_list_.size(); i++)
     {
-        if (dof_list_[i]->IsDependent())
-        {
+        if (input_map_[i] < 0)
             local_x(i,0) = dof_list_[i]->GetSolverFunction()->GetValue(x);
-            jacobian.SetSubmatrix(0,i,dof_list_[i]->GetSolverFunction()->GetGradient(x));
-        }
+        else
+            local_x(i,0) = x(input_map_[i],0);
     }
 
-    return jacobian*GetGradientSelf(local_x);
+    return local_x;
 }
 
 void SolverFunctionsBase::DefineInputMap(const std::map<unsigned,unsigned> &input_dof_map)
 {
-    mmcMatrix new_transform(dof_list_.size(),input_dof_map.size(),0.0);
+    input_map_.assign(dof_list_.size(),-1);
 
     map<unsigned,unsigned>::const_iterator map_it;
 
     for(int i = 0; i < dof_list_.size(); i++)
     {
-        if (!dof_list_[i]->IsDependent())
+        map_it = input_dof_map.find(dof_list_[i]->GetID());
+        if(map_it != input_dof_map.end())
         {
-            map_it = input_dof_map.find(dof_list_[i]->GetID());
-            if(map_it != input_dof_map.end())
-            {
-                // dof found in map
-                new_transform(i,map_it->second) = 1.0;
-            } else {
-                // dof not found in map, need to throw an exception
-                stringstream error_message;
-                error_message << "DOF with the ID " << dof_list_[i]->GetID() << " not found in input map while defining transform_ for a SolverFunctionsBase instance.";
-                throw pSketcherException(error_message.str());
-            }
+            // dof found in map, dependent dof's may also be given a location
+            input_map_[i] = map_it->second;
+        } else if (!dof_list_[i]->IsDependent()) {
+            // dof not found in map, need to throw an exception
+            stringstream error_message;
+            error_message << "DOF with the ID " << dof_list_[i]->GetID() << " not found in input map while defining input_map_ for a SolverFunctionsBase instance.";
+            throw pSketcherException(error_message.str());
         }
     }
 
-    transform_ = new_transform;
-
-    // let each dependent dof create its own transform_
+    // let each dependent dof create its own input_map_
     for(int i=0; i < dof_list_.size(); i++)
         if(dof_list_[i]->IsDependent())
             dof_list_[i]->GetSolverFunction()->DefineInputMap(input_dof_map);
-}
+}
\ No newline at end of file
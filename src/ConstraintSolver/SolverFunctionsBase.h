@@ -28,6 +28,7 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "DOF.h"
 #include "../mmcMatrix/mmcMatrix.h"
+#include "../mmcMatrix/mmcFixedMatrix.h"
 
 //Exception class
 class SolverFunctionsException
@@ -37,6 +38,17 @@ class SolverFunctionsException
         SolverFunctionsException(std::string error_description) {std::cerr << "SolverFunctions exception thrown: " << error_description << std::endl;}
 };
 
+// Batched kernels evaluate many instances of the same solver function at once. The parameters, values, and gradients
+// are stored as structure-of-arrays, params[j][k] is parameter j of instance k, so that the kernels can be vectorized.
+typedef void (*SolverFunctionsValueBatch)(int count, const double * const *params, double *values);
+typedef void (*SolverFunctionsValueAndGradientBatch)(int count, const double * const *params, double *values, double * const *gradients);
+
+// Local parameter and gradient vectors of the solver functions are stored on the stack. No solver function may depend on
+// more than solver_functions_max_dofs DOF's (generate_constraint_functions.py checks this limit for the generated functions and
+// AutoDiffSolverFunction checks it at compile time).
+const int solver_functions_max_dofs = 12;
+typedef mmcFixedMatrix<solver_functions_max_dofs,1> SolverFunctionsVector;
+
 // Abstract Solver Function base class
 class SolverFunctionsBase
 {
@@ -47,20 +59,42 @@ class SolverFunctionsBase
         void AddDOF(DOFPointer new_pointer);
         double GetValue(const mmcMatrix &x) const;
         mmcMatrix GetGradient(const mmcMatrix &x) const;
+        void AddGradient(const mmcMatrix &x, double scale, mmcMatrix &gradient) const; // adds scale*gradient to the global gradient vector, only the rows this function depends on are touched
+        void AddGradient(const mmcMatrix &x, double scale, std::vector<std::pair<int,double> > &gradient_entries) const; // appends (row, scale*gradient) pairs for the DOF's this function depends on, used to build sparse jacobians
+        double AddValueWeightedGradient(const mmcMatrix &x, double scale, mmcMatrix &gradient) const; // returns the value f of this function and adds scale*f*gradient(f) to the global gradient vector using one fused evaluation
+        double GetValuePlusGradient(const mmcMatrix &x, double scale, std::vector<std::pair<int,double> > &gradient_entries) const; // returns the value of this function and appends scale*gradient as (row, value) pairs using one fused evaluation
+        double GetValuePlusLocalGradient(const mmcMatrix &x, SolverFunctionsVector &local_gradient) const; // returns the value and the gradient with respect to each DOF in the dof list, dependent DOF's are not expanded
         void DefineInputMap(const std::map<unsigned,unsigned> &input_dof_map);
         DOFPointer GetDOF(unsigned index) const {return dof_list_[index];}
         unsigned GetNumDOFs() const {return dof_list_.size();}
         const std::vector<DOFPointer> & GetDOFList() const {return dof_list_;}
+        int GetInputIndex(unsigned index) const {return input_map_[index];} // location of DOF index in the global parameter vector, -1 for dependent DOF's that are not in the parameter vector
+        bool HasDependentDOFs() const;
+
+        // batched kernels, solver functions that do not provide them return 0 and are always evaluated individually
+        virtual SolverFunctionsValueBatch GetValueBatchKernel() const {return 0;}
+        virtual SolverFunctionsValueAndGradientBatch GetValueAndGradientBatchKernel() const {return 0;}
+
+        // true if the function is the difference of its two DOF's, the presolve merges the DOF's of these functions
+        virtual bool IsDOFEquality() const {return false;}
 
         // pure abstract methods
         virtual double GetValue() const = 0;
-        virtual double GetValueSelf(const mmcMatrix &params) const = 0;
-        virtual mmcMatrix GetGradientSelf(const mmcMatrix &params) const = 0;
+        virtual double GetValueSelf(const SolverFunctionsVector &params) const = 0;
+        virtual SolverFunctionsVector GetGradientSelf(const SolverFunctionsVector &params) const = 0; // only the first GetNumDOFs() rows are defined
+        virtual double GetValueAndGradientSelf(const SolverFunctionsVector &params, SolverFunctionsVector &gradient) const = 0;
         virtual std::string GetName() const = 0;
 
     private:
+        SolverFunctionsVector GetLocalParameters(const mmcMatrix &x) const; // gathers the local parameter vector from the global parameter vector x
+        void ScatterGradient(const mmcMatrix &x, double scale, const SolverFunctionsVector &local_gradient, mmcMatrix &gradient) const;
+        void ScatterGradient(const mmcMatrix &x, double scale, const SolverFunctionsVector &local_gradient, std::vector<std::pair<int,double> > &gradient_entries) const;
+
         std::vector<DOFPointer> dof_list_;
-        mmcMatrix transform_;
+        // location of each DOF in dof_list_ within the global parameter vector
+        // a dependent DOF is either given its own location, in which case the caller is responsible for storing its current value there and
+        // for applying the chain rule to its gradient, or -1, in which case its solver function is evaluated recursively every time it is needed
+        std::vector<int> input_map_;
 
 };
 typedef boost::shared_ptr<SolverFunctionsBase> SolverFunctionsBasePointer;
@@ -0,0 +1,162 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <string>
+#include "SolverFunctionsSIMD.h"
+
+using namespace std;
+
+// The AVX2 kernels are compiled with the target attribute so that the rest of the library does not require -mavx2,
+// the processor is checked at run time before any of them are used
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PSKETCHER_AVX2_KERNELS
+#endif
+
+#ifdef PSKETCHER_AVX2_KERNELS
+#include <immintrin.h>
+#include "SolverFunctions.h"
+
+// advances the structure-of-arrays pointers to instance offset so that the scalar kernels can finish the remainder of a batch
+#define SIMD_OFFSET_POINTERS(source,dest,num_params,offset) for(int j = 0; j < num_params; j++) dest[j] = source[j] + offset;
+
+// distance_point_2d(point1s,point1t,point2s,point2t,distance) = sqrt((point1s-point2s)**2+(point1t-point2t)**2) - distance
+__attribute__((target("avx2,fma")))
+static void distance_point_2d_avx2(int count, const double * const *params, double *values, double * const *gradients)
+{
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d minus_one = _mm256_set1_pd(-1.0);
+    const __m256d zero = _mm256_setzero_pd();
+
+    int k = 0;
+    for(; k + 4 <= count; k += 4)
+    {
+        __m256d ds = _mm256_sub_pd(_mm256_loadu_pd(params[0]+k), _mm256_loadu_pd(params[2]+k));
+        __m256d dt = _mm256_sub_pd(_mm256_loadu_pd(params[1]+k), _mm256_loadu_pd(params[3]+k));
+        __m256d length = _mm256_sqrt_pd(_mm256_fmadd_pd(ds, ds, _mm256_mul_pd(dt, dt)));
+        __m256d inverse_length = _mm256_div_pd(one, length);
+
+        __m256d gradient_s = _mm256_mul_pd(ds, inverse_length);
+        __m256d gradient_t = _mm256_mul_pd(dt, inverse_length);
+
+        _mm256_storeu_pd(gradients[0]+k, gradient_s);
+        _mm256_storeu_pd(gradients[1]+k, gradient_t);
+        _mm256_storeu_pd(gradients[2]+k, _mm256_sub_pd(zero, gradient_s));
+        _mm256_storeu_pd(gradients[3]+k, _mm256_sub_pd(zero, gradient_t));
+        _mm256_storeu_pd(gradients[4]+k, minus_one);
+
+        _mm256_storeu_pd(values+k, _mm256_sub_pd(length, _mm256_loadu_pd(params[4]+k)));
+    }
+
+    if(k < count)
+    {
+        const double *remaining_params[5];
+        double *remaining_gradients[5];
+        SIMD_OFFSET_POINTERS(params,remaining_params,5,k)
+        SIMD_OFFSET_POINTERS(gradients,remaining_gradients,5,k)
+        distance_point_2d::GetValueAndGradientBatch(count-k, remaining_params, values+k, remaining_gradients);
+    }
+}
+
+// hori_vert_2d(dof1,dof2) = dof1 - dof2
+__attribute__((target("avx2,fma")))
+static void hori_vert_2d_avx2(int count, const double * const *params, double *values, double * const *gradients)
+{
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d minus_one = _mm256_set1_pd(-1.0);
+
+    int k = 0;
+    for(; k + 4 <= count; k += 4)
+    {
+        _mm256_storeu_pd(gradients[0]+k, one);
+        _mm256_storeu_pd(gradients[1]+k, minus_one);
+        _mm256_storeu_pd(values+k, _mm256_sub_pd(_mm256_loadu_pd(params[0]+k), _mm256_loadu_pd(params[1]+k)));
+    }
+
+    if(k < count)
+    {
+        const double *remaining_params[2];
+        double *remaining_gradients[2];
+        SIMD_OFFSET_POINTERS(params,remaining_params,2,k)
+        SIMD_OFFSET_POINTERS(gradients,remaining_gradients,2,k)
+        hori_vert_2d::GetValueAndGradientBatch(count-k, remaining_params, values+k, remaining_gradients);
+    }
+}
+
+// tangent_edge_2d(s1,t1,s2,t2) = (s1*s2+t1*t2)**2-1
+__attribute__((target("avx2,fma")))
+static void tangent_edge_2d_avx2(int count, const double * const *params, double *values, double * const *gradients)
+{
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+
+    int k = 0;
+    for(; k + 4 <= count; k += 4)
+    {
+        __m256d s1 = _mm256_loadu_pd(params[0]+k);
+        __m256d t1 = _mm256_loadu_pd(params[1]+k);
+        __m256d s2 = _mm256_loadu_pd(params[2]+k);
+        __m256d t2 = _mm256_loadu_pd(params[3]+k);
+
+        __m256d dot = _mm256_fmadd_pd(s1, s2, _mm256_mul_pd(t1, t2));
+        __m256d two_dot = _mm256_mul_pd(two, dot);
+
+        _mm256_storeu_pd(gradients[0]+k, _mm256_mul_pd(two_dot, s2));
+        _mm256_storeu_pd(gradients[1]+k, _mm256_mul_pd(two_dot, t2));
+        _mm256_storeu_pd(gradients[2]+k, _mm256_mul_pd(two_dot, s1));
+        _mm256_storeu_pd(gradients[3]+k, _mm256_mul_pd(two_dot, t1));
+
+        _mm256_storeu_pd(values+k, _mm256_fmsub_pd(dot, dot, one));
+    }
+
+    if(k < count)
+    {
+        const double *remaining_params[4];
+        double *remaining_gradients[4];
+        SIMD_OFFSET_POINTERS(params,remaining_params,4,k)
+        SIMD_OFFSET_POINTERS(gradients,remaining_gradients,4,k)
+        tangent_edge_2d::GetValueAndGradientBatch(count-k, remaining_params, values+k, remaining_gradients);
+    }
+}
+
+static bool ProcessorSupportsAVX2()
+{
+    static bool avx2_supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return avx2_supported;
+}
+#endif //PSKETCHER_AVX2_KERNELS
+
+SolverFunctionsValueAndGradientBatch GetVectorizedBatchKernel(const SolverFunctionsBase &solver_function)
+{
+#ifdef PSKETCHER_AVX2_KERNELS
+    if(ProcessorSupportsAVX2())
+    {
+        string name = solver_function.GetName();
+
+        if(name == "distance_point_2d")
+            return distance_point_2d_avx2;
+        else if(name == "hori_vert_2d")
+            return hori_vert_2d_avx2;
+        else if(name == "tangent_edge_2d")
+            return tangent_edge_2d_avx2;
+    }
+#endif
+
+    return solver_function.GetValueAndGradientBatchKernel();
+}
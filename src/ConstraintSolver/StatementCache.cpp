@@ -0,0 +1,214 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <map>
+#include <vector>
+#include <sstream>
+#include "StatementCache.h"
+#include "PrimitiveBase.h"
+
+using namespace std;
+
+// one cached statement and whether it is currently checked out by a CachedStatement object
+struct CacheEntry
+{
+	CacheEntry(sqlite3_stmt *new_statement) : statement(new_statement), in_use(false) {}
+	sqlite3_stmt *statement;
+	bool in_use;
+};
+
+typedef map<string, vector<CacheEntry> > StatementMap;
+static map<sqlite3 *, StatementMap> statement_cache;
+
+static void ThrowSQLError(sqlite3 *database)
+{
+	stringstream error_description;
+	error_description << "SQL error: " << sqlite3_errmsg(database);
+	throw pSketcherException(error_description.str());
+}
+
+CachedStatement::CachedStatement(sqlite3 *database, const std::string &sql):
+database_(database),
+statement_(0)
+{
+	vector<CacheEntry> &entries = statement_cache[database][sql];
+
+	for(unsigned int i = 0; i < entries.size(); i++)
+	{
+		if(!entries[i].in_use)
+		{
+			entries[i].in_use = true;
+			statement_ = entries[i].statement;
+			return;
+		}
+	}
+
+	// sqlite3_prepare_v2 is used so that the statement is transparently recompiled if the schema changes
+	int rc = sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement_, 0);
+	if( rc!=SQLITE_OK ){
+		sqlite3_finalize(statement_);
+		ThrowSQLError(database_);
+	}
+
+	entries.push_back(CacheEntry(statement_));
+	entries.back().in_use = true;
+}
+
+CachedStatement::~CachedStatement()
+{
+	sqlite3_reset(statement_);
+	sqlite3_clear_bindings(statement_);
+
+	map<sqlite3 *, StatementMap>::iterator database_it = statement_cache.find(database_);
+	if(database_it == statement_cache.end())
+		return;
+
+	StatementMap::iterator sql_it = database_it->second.find(sqlite3_sql(statement_));
+	if(sql_it == database_it->second.end())
+		return;
+
+	for(unsigned int i = 0; i < sql_it->second.size(); i++)
+		if(sql_it->second[i].statement == statement_)
+			sql_it->second[i].in_use = false;
+}
+
+CachedStatement & CachedStatement::Bind(int index, int value)
+{
+	if(sqlite3_bind_int(statement_, index, value) != SQLITE_OK)
+		ThrowSQLError(database_);
+	return *this;
+}
+
+CachedStatement & CachedStatement::Bind(int index, double value)
+{
+	if(sqlite3_bind_double(statement_, index, value) != SQLITE_OK)
+		ThrowSQLError(database_);
+	return *this;
+}
+
+CachedStatement & CachedStatement::Bind(int index, const std::string &value)
+{
+	if(sqlite3_bind_text(statement_, index, value.c_str(), -1, SQLITE_TRANSIENT) != SQLITE_OK)
+		ThrowSQLError(database_);
+	return *this;
+}
+
+CachedStatement & CachedStatement::Bind(int index, const DatabaseValue &value)
+{
+	int rc;
+	if(value.type == SQLITE_INTEGER)
+		rc = sqlite3_bind_int64(statement_, index, value.integer);
+	else if(value.type == SQLITE_FLOAT)
+		rc = sqlite3_bind_double(statement_, index, value.real);
+	else if(value.type == SQLITE_TEXT)
+		rc = sqlite3_bind_text(statement_, index, value.text.c_str(), -1, SQLITE_TRANSIENT);
+	else
+		rc = sqlite3_bind_null(statement_, index);
+
+	if(rc != SQLITE_OK)
+		ThrowSQLError(database_);
+	return *this;
+}
+
+CachedStatement & CachedStatement::BindBlob(int index, const std::string &value)
+{
+	if(sqlite3_bind_blob(statement_, index, value.data(), value.size(), SQLITE_TRANSIENT) != SQLITE_OK)
+		ThrowSQLError(database_);
+	return *this;
+}
+
+bool CachedStatement::Step()
+{
+	int rc = sqlite3_step(statement_);
+
+	if(rc == SQLITE_ROW)
+		return true;
+	else if(rc == SQLITE_DONE)
+		return false;
+
+	ThrowSQLError(database_);
+	return false;
+}
+
+void CachedStatement::Execute()
+{
+	if(Step())
+		throw pSketcherException("SQL error: statement returned rows when none were expected.");
+}
+
+std::string CachedStatement::GetText(int column) const
+{
+	const unsigned char *text = sqlite3_column_text(statement_,column);
+	if(text == 0)
+		return "";
+	else
+		return string(reinterpret_cast<const char *>(text));
+}
+
+std::string CachedStatement::GetBlob(int column) const
+{
+	const char *blob = reinterpret_cast<const char *>(sqlite3_column_blob(statement_,column));
+	if(blob == 0)
+		return "";
+	else
+		return string(blob, sqlite3_column_bytes(statement_,column));
+}
+
+DatabaseValue CachedStatement::GetValue(int column) const
+{
+	int type = sqlite3_column_type(statement_,column);
+
+	if(type == SQLITE_INTEGER)
+	{
+		DatabaseValue value(0);
+		value.integer = sqlite3_column_int64(statement_,column);
+		return value;
+	}
+	else if(type == SQLITE_FLOAT)
+		return DatabaseValue(GetDouble(column));
+	else if(type == SQLITE_TEXT)
+		return DatabaseValue(GetText(column));
+	else
+		return DatabaseValue(); // blobs are not stored in the tables that DatabaseValue is used with
+}
+
+void FinalizeCachedStatements(sqlite3 *database)
+{
+	map<sqlite3 *, StatementMap>::iterator database_it = statement_cache.find(database);
+	if(database_it == statement_cache.end())
+		return;
+
+	for(StatementMap::iterator sql_it = database_it->second.begin(); sql_it != database_it->second.end(); sql_it++)
+		for(unsigned int i = 0; i < sql_it->second.size(); i++)
+			sqlite3_finalize(sql_it->second[i].statement);
+
+	statement_cache.erase(database_it);
+}
+
+void ExecuteSQL(sqlite3 *database, const std::string &sql)
+{
+	char *zErrMsg = 0;
+	int rc = sqlite3_exec(database, sql.c_str(), 0, 0, &zErrMsg);
+	if( rc!=SQLITE_OK ){
+		std::string error_description = "SQL error: " + std::string(zErrMsg);
+		sqlite3_free(zErrMsg);
+		throw pSketcherException(error_description);
+	}
+}
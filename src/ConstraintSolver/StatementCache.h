@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef StatementCacheH
+#define StatementCacheH
+
+#include <string>
+#include "../sqlite3/sqlite3.h"
+
+// typed column value, used where a row is kept outside of the database such as in the undo log
+struct DatabaseValue
+{
+	DatabaseValue() : type(SQLITE_NULL), integer(0), real(0.0) {}
+	DatabaseValue(int value) : type(SQLITE_INTEGER), integer(value), real(0.0) {}
+	DatabaseValue(double value) : type(SQLITE_FLOAT), integer(0), real(value) {}
+	DatabaseValue(const std::string &value) : type(SQLITE_TEXT), integer(0), real(0.0), text(value) {}
+
+	bool operator==(const DatabaseValue &other) const {return type == other.type && integer == other.integer && real == other.real && text == other.text;}
+	bool operator!=(const DatabaseValue &other) const {return !(*this == other);}
+
+	int type; // SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT or SQLITE_NULL
+	sqlite3_int64 integer;
+	double real;
+	std::string text;
+};
+
+// Prepared statement taken from a cache that is kept for each database connection and keyed by the SQL text, so each
+// statement used to read and write the DOF, primitive, constraint and undo tables is only parsed once per connection.
+// The statement is reset and its bindings are cleared when this object goes out of scope so that it can be reused.
+// If the same SQL is already in use further up the call stack (for example, a DependentDOF that is synced while syncing
+// another DependentDOF) a second copy of the statement is prepared and cached.
+// The cache is not thread safe, only the thread that owns the database may use it.
+class CachedStatement
+{
+	public:
+		CachedStatement(sqlite3 *database, const std::string &sql);
+		~CachedStatement();
+
+		// bind parameters, index starts at 1 as with sqlite3_bind_*
+		CachedStatement & Bind(int index, int value);
+		CachedStatement & Bind(int index, unsigned value) {return Bind(index, (int)value);}
+		CachedStatement & Bind(int index, double value);
+		CachedStatement & Bind(int index, const std::string &value);
+		CachedStatement & Bind(int index, const DatabaseValue &value);
+		CachedStatement & BindBlob(int index, const std::string &value);
+
+		// returns true if a row of results is available and false when the statement has finished
+		bool Step();
+		// steps a statement that does not return any rows
+		void Execute();
+
+		// column accessors for the current row, index starts at 0 as with sqlite3_column_*
+		int GetInt(int column) const {return sqlite3_column_int(statement_,column);}
+		double GetDouble(int column) const {return sqlite3_column_double(statement_,column);}
+		std::string GetText(int column) const;
+		std::string GetBlob(int column) const;
+		DatabaseValue GetValue(int column) const;
+		int GetColumnCount() const {return sqlite3_column_count(statement_);}
+		int GetType(int column) const {return sqlite3_column_type(statement_,column);}
+
+	private:
+		sqlite3 *database_;
+		sqlite3_stmt *statement_;
+};
+
+// finalizes the cached statements for database, must be called before the database is closed
+void FinalizeCachedStatements(sqlite3 *database);
+
+// executes one or more SQL statements that are not worth caching (schema changes and transaction control)
+void ExecuteSQL(sqlite3 *database, const std::string &sql);
+
+#endif //StatementCacheH
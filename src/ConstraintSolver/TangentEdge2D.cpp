@@ -24,6 +24,8 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "TangentEdge2D.h"
 
 #include "pSketcherModel.h"
+#include "DatabaseRow.h"
+#include "DatabaseSnapshot.h"
 
 using namespace std;
 
@@ -89,92 +91,16 @@ void TangentEdge2D::RemoveFromDatabase()
 
 void TangentEdge2D::DatabaseAddRemove(bool add_to_database) // Utility method used by AddToDatabase and RemoveFromDatabase
 {
-	string sql_do, sql_undo;
-
-	stringstream dof_list_table_name;
-	dof_list_table_name << "dof_table_" << GetID();
-	stringstream primitive_list_table_name;
-	primitive_list_table_name << "primitive_table_" << GetID();
-
-	// First, create the sql statements to undo and redo this operation
-	stringstream temp_stream;
-	temp_stream.precision(__DBL_DIG__);
-	temp_stream << "BEGIN; "
-                << "INSERT INTO " << SQL_tangent_edge2d_database_table_name << " VALUES("
-                << GetID() << ",'" << dof_list_table_name.str() << "','"
-				<< primitive_list_table_name.str()
-				<< "'," << edge1_->GetID() << "," << edge2_->GetID()
-				<< "," << point_num_1_ << "," << point_num_2_
-                << "," << s_1_->GetID() << "," << t_1_->GetID()
-                << "," << s_2_->GetID() << "," << t_2_->GetID() 
-                << "," << weight_ << "); "
-                << "INSERT INTO constraint_equation_list VALUES("
-                << GetID() << ",'" << SQL_tangent_edge2d_database_table_name << "'); "
-                << "COMMIT; ";
-
-	if(add_to_database)
-		sql_do = temp_stream.str();
-	else
-		sql_undo = temp_stream.str();
-
-	temp_stream.str(""); // clears the string stream
-
-	temp_stream << "BEGIN; "
-				<< "DELETE FROM constraint_equation_list WHERE id=" << GetID() 
-				<< "; DELETE FROM " << SQL_tangent_edge2d_database_table_name << " WHERE id=" << GetID() 
-				<< "; COMMIT;";
-
-	if(add_to_database)
-		sql_undo = temp_stream.str();
-	else
-		sql_do = temp_stream.str();
-
-	// add this object to the appropriate tables by executing the SQL command sql_insert 
-	char *zErrMsg = 0;
-	int rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		if(add_to_database)
-		{
-			//std::cerr << "SQL error: " << zErrMsg << endl;
-			sqlite3_free(zErrMsg);
-			
-			// the table "independent_dof_list" may not exist, attempt to create
-			rc = sqlite3_exec(database_, ("ROLLBACK;"+SQL_tangent_edge2d_database_schema).c_str(), 0, 0, &zErrMsg);  // need to add ROLLBACK since previous transaction failed
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-	
-			// now that the table has been created, attempt the insert one last time
-			rc = sqlite3_exec(database_, sql_do.c_str(), 0, 0, &zErrMsg);
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-		} else {
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
-		}
-	}
-
-	// finally, update the undo_redo_list in the database with the database changes that have just been made
-	// need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-	char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q')",sql_undo.c_str(),sql_do.c_str());
-
-	rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
-
-	sqlite3_free(sql_undo_redo);
-
-	// Now use the method provided by PrimitiveBase to create the tables listing the DOF's and the other Primitives that this primitive depends on.
-	DatabaseAddDeleteLists(add_to_database,dof_list_table_name.str(),primitive_list_table_name.str());
+	DatabaseRow row(SQL_tangent_edge2d_database_table_name, SQL_tangent_edge2d_database_schema, "constraint_equation_list", GetID());
+	row << edge1_->GetID() << edge2_->GetID()
+		<< point_num_1_ << point_num_2_
+		<< s_1_->GetID() << t_1_->GetID()
+		<< s_2_->GetID() << t_2_->GetID()
+		<< weight_;
+	row.AddRemove(database_, add_to_database);
+
+	// Now use the method provided by PrimitiveBase to add the links to the DOF's and the other Primitives that this primitive depends on.
+	DatabaseAddDeleteLists(add_to_database);
 }
 
 bool TangentEdge2D::SyncToDatabase(pSketcherModel &psketcher_model)
@@ -183,66 +109,33 @@ bool TangentEdge2D::SyncToDatabase(pSketcherModel &psketcher_model)
 
 	string table_name = SQL_tangent_edge2d_database_table_name;
 
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-	
-	stringstream sql_command;
-	sql_command << "SELECT * FROM " << table_name << " WHERE id=" << GetID() << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
+	TableRow row(psketcher_model, table_name, GetID());
 
-	stringstream dof_table_name, primitive_table_name, constraint_table_name;
+	stringstream constraint_table_name;
 
-	if(rc == SQLITE_ROW) {
+	if(row.Exists()) {
 		// row exists, store the values to initialize this object
 		
-		dof_table_name << sqlite3_column_text(statement,1);
-		primitive_table_name << sqlite3_column_text(statement,2);
-		edge1_ = psketcher_model.FetchPrimitive<Edge2DBase>(sqlite3_column_int(statement,3));
-		edge2_ = psketcher_model.FetchPrimitive<Edge2DBase>(sqlite3_column_int(statement,4));
-		point_num_1_ = static_cast<EdgePointNumber>(sqlite3_column_int(statement,5));
-		point_num_2_ = static_cast<EdgePointNumber>(sqlite3_column_int(statement,6));
-        s_1_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,7));
-        t_1_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,8));
-        s_2_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,9));
-        t_2_ = psketcher_model.FetchDOF(sqlite3_column_int(statement,10));
-        weight_ = sqlite3_column_double(statement,11);
+		edge1_ = psketcher_model.FetchPrimitive<Edge2DBase>(row.GetInt(1));
+		edge2_ = psketcher_model.FetchPrimitive<Edge2DBase>(row.GetInt(2));
+		point_num_1_ = static_cast<EdgePointNumber>(row.GetInt(3));
+		point_num_2_ = static_cast<EdgePointNumber>(row.GetInt(4));
+        s_1_ = psketcher_model.FetchDOF(row.GetInt(5));
+        t_1_ = psketcher_model.FetchDOF(row.GetInt(6));
+        s_2_ = psketcher_model.FetchDOF(row.GetInt(7));
+        t_2_ = psketcher_model.FetchDOF(row.GetInt(8));
+        weight_ = row.GetDouble(9);
 
         // define the constraint equation
         solver_function_.reset(new tangent_edge_2d(s_1_,t_1_,s_2_,t_2_));
 
 	} else {
 		// the requested row does not exist in the database
-		sqlite3_finalize(statement);	
-
 		return false; // row does not exist in the database, exit method and return false
 	}
 
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
 	// now sync the lists stored in the base classes
-	SyncListsToDatabase(dof_table_name.str(),primitive_table_name.str(),psketcher_model); // PrimitiveBase
+	SyncListsToDatabase(psketcher_model); // PrimitiveBase
 
 	return true; // row existed in the database
 }
@@ -0,0 +1,521 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <map>
+#include <sstream>
+#include <cstring>
+#include "UndoLog.h"
+#include "PrimitiveBase.h"
+
+using namespace std;
+
+// format of the undo_redo_list rows, stored as the first byte of each row
+const unsigned char undo_log_format = 1;
+
+enum UndoRecordType {ValueChangeRecord = 0, RowAddedRecord = 1, RowRemovedRecord = 2};
+
+// one change in the undo log, table and column are indices into the names of the UndoEntry
+struct UndoRecord
+{
+	unsigned char type;
+	unsigned table;
+	unsigned column; // ValueChangeRecord only
+	vector<DatabaseValue> values; // primary key of the row for ValueChangeRecord, every column of the row otherwise
+	DatabaseValue old_value; // ValueChangeRecord only
+	DatabaseValue new_value; // ValueChangeRecord only
+};
+
+// the records stored in one undo_redo_list row, each table and column name is stored once
+struct UndoEntry
+{
+	vector<string> names;
+	vector<UndoRecord> records;
+};
+
+struct UndoLog
+{
+	UndoLog() : batch_depth(0), batch_start(0) {}
+	unsigned batch_depth;
+	unsigned batch_start; // size of pending.records when the outermost batch began, the records after it are discarded if the batch is rolled back
+	UndoEntry pending; // changes that have not been written to undo_redo_list yet
+	map<string, unsigned> value_change_index; // "table.column.id" -> index into pending.records of the changes that can still be coalesced
+};
+static map<sqlite3 *, UndoLog> undo_logs;
+
+// primary key columns of a table, position is the index of the column in the table
+struct TableKey
+{
+	vector<string> names;
+	vector<int> positions;
+};
+
+static unsigned GetNameIndex(UndoEntry &entry, const string &name)
+{
+	for(unsigned int i = 0; i < entry.names.size(); i++)
+		if(entry.names[i] == name)
+			return i;
+
+	entry.names.push_back(name);
+	return entry.names.size()-1;
+}
+
+static bool IsNoOp(const UndoRecord &record)
+{
+	return record.type == ValueChangeRecord && record.old_value == record.new_value;
+}
+
+static void WriteVarint(string &buffer, sqlite3_uint64 value)
+{
+	while(value >= 0x80)
+	{
+		buffer += (char)((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	buffer += (char)value;
+}
+
+static void WriteString(string &buffer, const string &value)
+{
+	WriteVarint(buffer, value.size());
+	buffer += value;
+}
+
+static void WriteValue(string &buffer, const DatabaseValue &value)
+{
+	buffer += (char)value.type;
+
+	if(value.type == SQLITE_INTEGER)
+	{
+		// zigzag encoding keeps small negative numbers small
+		WriteVarint(buffer, ((sqlite3_uint64)value.integer << 1) ^ (sqlite3_uint64)(value.integer >> 63));
+	}
+	else if(value.type == SQLITE_FLOAT)
+	{
+		// stored little endian so that the file can be moved between machines
+		sqlite3_uint64 bits;
+		memcpy(&bits, &value.real, sizeof(bits));
+		for(unsigned int i = 0; i < 8; i++)
+			buffer += (char)((bits >> (8*i)) & 0xff);
+	}
+	else if(value.type == SQLITE_TEXT)
+		WriteString(buffer, value.text);
+}
+
+// returns the number of records written, value changes that leave the value where it started are left out
+static unsigned EncodeUndoEntry(const UndoEntry &entry, string &buffer)
+{
+	unsigned num_records = 0;
+	for(unsigned int i = 0; i < entry.records.size(); i++)
+		if(!IsNoOp(entry.records[i]))
+			num_records++;
+
+	buffer = (char)undo_log_format;
+
+	WriteVarint(buffer, entry.names.size());
+	for(unsigned int i = 0; i < entry.names.size(); i++)
+		WriteString(buffer, entry.names[i]);
+
+	WriteVarint(buffer, num_records);
+	for(unsigned int i = 0; i < entry.records.size(); i++)
+	{
+		const UndoRecord &record = entry.records[i];
+		if(IsNoOp(record))
+			continue;
+
+		buffer += (char)record.type;
+		WriteVarint(buffer, record.table);
+		if(record.type == ValueChangeRecord)
+			WriteVarint(buffer, record.column);
+
+		WriteVarint(buffer, record.values.size());
+		for(unsigned int j = 0; j < record.values.size(); j++)
+			WriteValue(buffer, record.values[j]);
+
+		if(record.type == ValueChangeRecord)
+		{
+			WriteValue(buffer, record.old_value);
+			WriteValue(buffer, record.new_value);
+		}
+	}
+
+	return num_records;
+}
+
+// reads the fields of one undo_redo_list row, throws if the row is truncated
+class UndoEntryReader
+{
+	public:
+		UndoEntryReader(const string &buffer) : buffer_(buffer), position_(0) {}
+
+		unsigned char ReadByte()
+		{
+			if(position_ >= buffer_.size())
+				throw pSketcherException("pSketcherModel Error: Corrupt undo_redo_list row.");
+			return buffer_[position_++];
+		}
+
+		sqlite3_uint64 ReadVarint()
+		{
+			sqlite3_uint64 value = 0;
+			for(unsigned int shift = 0; shift < 64; shift += 7)
+			{
+				unsigned char byte = ReadByte();
+				value |= (sqlite3_uint64)(byte & 0x7f) << shift;
+				if((byte & 0x80) == 0)
+					return value;
+			}
+			throw pSketcherException("pSketcherModel Error: Corrupt undo_redo_list row.");
+		}
+
+		string ReadString()
+		{
+			sqlite3_uint64 length = ReadVarint();
+			if(length > buffer_.size() - position_)
+				throw pSketcherException("pSketcherModel Error: Corrupt undo_redo_list row.");
+			position_ += length;
+			return buffer_.substr(position_ - length, length);
+		}
+
+		DatabaseValue ReadValue()
+		{
+			DatabaseValue value;
+			value.type = ReadByte();
+
+			if(value.type == SQLITE_INTEGER)
+			{
+				sqlite3_uint64 zigzag = ReadVarint();
+				value.integer = (sqlite3_int64)(zigzag >> 1) ^ -(sqlite3_int64)(zigzag & 1);
+			}
+			else if(value.type == SQLITE_FLOAT)
+			{
+				sqlite3_uint64 bits = 0;
+				for(unsigned int i = 0; i < 8; i++)
+					bits |= (sqlite3_uint64)ReadByte() << (8*i);
+				memcpy(&value.real, &bits, sizeof(bits));
+			}
+			else if(value.type == SQLITE_TEXT)
+				value.text = ReadString();
+			else if(value.type != SQLITE_NULL)
+				throw pSketcherException("pSketcherModel Error: Corrupt undo_redo_list row.");
+
+			return value;
+		}
+
+	private:
+		const string &buffer_;
+		unsigned position_;
+};
+
+static void DecodeUndoEntry(const string &buffer, UndoEntry &entry)
+{
+	UndoEntryReader reader(buffer);
+
+	if(reader.ReadByte() != undo_log_format)
+		throw pSketcherException("pSketcherModel Error: Unknown undo_redo_list row format.");
+
+	sqlite3_uint64 num_names = reader.ReadVarint();
+	for(sqlite3_uint64 i = 0; i < num_names; i++)
+		entry.names.push_back(reader.ReadString());
+
+	sqlite3_uint64 num_records = reader.ReadVarint();
+	for(sqlite3_uint64 i = 0; i < num_records; i++)
+	{
+		UndoRecord record;
+		record.type = reader.ReadByte();
+		record.table = reader.ReadVarint();
+		record.column = record.type == ValueChangeRecord ? reader.ReadVarint() : 0;
+
+		if(record.type > RowRemovedRecord || record.table >= entry.names.size() || record.column >= entry.names.size())
+			throw pSketcherException("pSketcherModel Error: Corrupt undo_redo_list row.");
+
+		sqlite3_uint64 num_values = reader.ReadVarint();
+		for(sqlite3_uint64 j = 0; j < num_values; j++)
+			record.values.push_back(reader.ReadValue());
+
+		if(record.type == ValueChangeRecord)
+		{
+			record.old_value = reader.ReadValue();
+			record.new_value = reader.ReadValue();
+		}
+
+		entry.records.push_back(record);
+	}
+}
+
+static void GetTableKey(sqlite3 *database, const string &table_name, TableKey &key)
+{
+	// the pk column of table_info is the position of the column in the primary key, starting at 1, or 0 if it is not part of the key
+	map<int, pair<string,int> > key_columns;
+	CachedStatement table_info(database, "PRAGMA table_info(" + table_name + ");");
+	while(table_info.Step())
+		if(table_info.GetInt(5) > 0)
+			key_columns[table_info.GetInt(5)] = pair<string,int>(table_info.GetText(1), table_info.GetInt(0));
+
+	if(key_columns.size() == 0)
+		throw pSketcherException("pSketcherModel Error: Table " + table_name + " does not have a primary key, its rows cannot be stored in the undo log.");
+
+	for(map<int, pair<string,int> >::iterator it = key_columns.begin(); it != key_columns.end(); it++)
+	{
+		key.names.push_back(it->second.first);
+		key.positions.push_back(it->second.second);
+	}
+}
+
+void GetPrimaryKeyColumns(sqlite3 *database, const std::string &table_name, std::vector<std::string> &key_columns)
+{
+	TableKey key;
+	GetTableKey(database, table_name, key);
+	key_columns = key.names;
+}
+
+// " WHERE key1=? AND key2=?;"
+static string GetKeyCondition(const TableKey &key)
+{
+	string condition = " WHERE ";
+	for(unsigned int i = 0; i < key.names.size(); i++)
+		condition += (i == 0 ? "" : " AND ") + key.names[i] + "=?";
+	return condition + ";";
+}
+
+static void ApplyRecord(sqlite3 *database, const UndoEntry &entry, const UndoRecord &record, bool undo, map<string, TableKey> &table_keys)
+{
+	const string &table_name = entry.names[record.table];
+
+	map<string, TableKey>::iterator key_it = table_keys.find(table_name);
+	if(key_it == table_keys.end())
+	{
+		key_it = table_keys.insert(pair<string, TableKey>(table_name, TableKey())).first;
+		GetTableKey(database, table_name, key_it->second);
+	}
+	const TableKey &key = key_it->second;
+
+	if(record.type == ValueChangeRecord)
+	{
+		if(record.values.size() != key.names.size())
+			throw pSketcherException("pSketcherModel Error: Corrupt undo_redo_list row.");
+
+		const string &column_name = entry.names[record.column];
+		const DatabaseValue &from_value = undo ? record.new_value : record.old_value;
+		const DatabaseValue &to_value = undo ? record.old_value : record.new_value;
+
+		CachedStatement update(database, "UPDATE " + table_name + " SET " + column_name + "=?" + GetKeyCondition(key));
+		update.Bind(1,to_value);
+
+		// the key is recorded as it was before the change, if the change was to a key column the row now has from_value
+		for(unsigned int i = 0; i < key.names.size(); i++)
+			update.Bind(i+2, key.names[i] == column_name ? from_value : record.values[i]);
+		update.Execute();
+	}
+	else if((record.type == RowAddedRecord) != undo)
+	{
+		stringstream sql_command;
+		sql_command << "INSERT INTO " << table_name << " VALUES(";
+		for(unsigned int i = 0; i < record.values.size(); i++)
+			sql_command << (i == 0 ? "?" : ",?");
+		sql_command << ");";
+
+		CachedStatement insert(database, sql_command.str());
+		for(unsigned int i = 0; i < record.values.size(); i++)
+			insert.Bind(i+1, record.values[i]);
+		insert.Execute();
+	}
+	else
+	{
+		CachedStatement remove(database, "DELETE FROM " + table_name + GetKeyCondition(key));
+		for(unsigned int i = 0; i < key.positions.size(); i++)
+		{
+			if(key.positions[i] >= (int)record.values.size())
+				throw pSketcherException("pSketcherModel Error: Corrupt undo_redo_list row.");
+			remove.Bind(i+1, record.values[key.positions[i]]);
+		}
+		remove.Execute();
+	}
+}
+
+void ApplyUndoLog(sqlite3 *database, int first_id, int last_id, bool undo)
+{
+	vector<string> deltas;
+	{
+		CachedStatement statement(database, undo ? "SELECT delta FROM undo_redo_list WHERE id > ? AND id <= ? ORDER BY id DESC;"
+		                                         : "SELECT delta FROM undo_redo_list WHERE id > ? AND id <= ? ORDER BY id ASC;");
+		statement.Bind(1,first_id).Bind(2,last_id);
+		while(statement.Step())
+			deltas.push_back(statement.GetBlob(0));
+	}
+
+	map<string, TableKey> table_keys;
+
+	CachedStatement(database, "SAVEPOINT apply_undo_log;").Execute();
+
+	try {
+		for(unsigned int i = 0; i < deltas.size(); i++)
+		{
+			UndoEntry entry;
+			DecodeUndoEntry(deltas[i], entry);
+
+			if(undo)
+			{
+				for(unsigned int j = entry.records.size(); j > 0; j--)
+					ApplyRecord(database, entry, entry.records[j-1], true, table_keys);
+			} else {
+				for(unsigned int j = 0; j < entry.records.size(); j++)
+					ApplyRecord(database, entry, entry.records[j], false, table_keys);
+			}
+		}
+	}
+	catch (pSketcherException e) {
+		ExecuteSQL(database, "ROLLBACK TO apply_undo_log; RELEASE apply_undo_log;");
+		throw;
+	}
+
+	CachedStatement(database, "RELEASE apply_undo_log;").Execute();
+}
+
+static UndoRecord & AddRecord(UndoLog &undo_log, UndoRecordType type, const string &table_name)
+{
+	undo_log.pending.records.push_back(UndoRecord());
+	UndoRecord &record = undo_log.pending.records.back();
+	record.type = type;
+	record.table = GetNameIndex(undo_log.pending, table_name);
+	record.column = 0;
+
+	return record;
+}
+
+void RecordRowChange(sqlite3 *database, const std::string &table_name, const std::vector<DatabaseValue> &row, bool row_added)
+{
+	UndoLog &undo_log = undo_logs[database];
+
+	UndoRecord &record = AddRecord(undo_log, row_added ? RowAddedRecord : RowRemovedRecord, table_name);
+	record.values = row;
+
+	// a value change recorded before this row was added or removed must not absorb one that is recorded after it
+	undo_log.value_change_index.clear();
+}
+
+void RecordValueChange(sqlite3 *database, const std::string &table_name, const std::string &column_name, unsigned id, const DatabaseValue &old_value, const DatabaseValue &new_value)
+{
+	UndoLog &undo_log = undo_logs[database];
+
+	stringstream key;
+	key << table_name << "." << column_name << "." << id;
+
+	map<string, unsigned>::iterator index_it = undo_log.value_change_index.find(key.str());
+	if(index_it != undo_log.value_change_index.end())
+	{
+		// the value has already been changed since the last flush, only the latest value needs to be kept
+		undo_log.pending.records[index_it->second].new_value = new_value;
+		return;
+	}
+
+	UndoRecord &record = AddRecord(undo_log, ValueChangeRecord, table_name);
+	record.column = GetNameIndex(undo_log.pending, column_name);
+	record.values.push_back(DatabaseValue((int)id));
+	record.old_value = old_value;
+	record.new_value = new_value;
+
+	undo_log.value_change_index[key.str()] = undo_log.pending.records.size()-1;
+}
+
+void RecordValueChange(sqlite3 *database, const std::string &table_name, const std::string &column_name, const std::vector<DatabaseValue> &key, const DatabaseValue &old_value, const DatabaseValue &new_value)
+{
+	UndoLog &undo_log = undo_logs[database];
+
+	UndoRecord &record = AddRecord(undo_log, ValueChangeRecord, table_name);
+	record.column = GetNameIndex(undo_log.pending, column_name);
+	record.values = key;
+	record.old_value = old_value;
+	record.new_value = new_value;
+
+	// the change may have been to a key column, so the value changes recorded so far can no longer be looked up by id
+	undo_log.value_change_index.clear();
+}
+
+void FlushUndoLog(sqlite3 *database)
+{
+	map<sqlite3 *, UndoLog>::iterator undo_log_it = undo_logs.find(database);
+	if(undo_log_it == undo_logs.end() || undo_log_it->second.pending.records.size() == 0)
+		return;
+
+	string delta;
+	if(EncodeUndoEntry(undo_log_it->second.pending, delta) > 0)
+		CachedStatement(database, "INSERT INTO undo_redo_list(delta) VALUES(?);").BindBlob(1,delta).Execute();
+
+	undo_log_it->second.pending = UndoEntry();
+	undo_log_it->second.value_change_index.clear();
+}
+
+bool IsUndoLogPending(sqlite3 *database)
+{
+	map<sqlite3 *, UndoLog>::iterator undo_log_it = undo_logs.find(database);
+	if(undo_log_it == undo_logs.end())
+		return false;
+
+	const vector<UndoRecord> &records = undo_log_it->second.pending.records;
+	for(unsigned int i = 0; i < records.size(); i++)
+		if(!IsNoOp(records[i]))
+			return true;
+
+	return false;
+}
+
+void ReleaseUndoLog(sqlite3 *database)
+{
+	undo_logs.erase(database);
+}
+
+void BeginDatabaseBatch(sqlite3 *database)
+{
+	UndoLog &undo_log = undo_logs[database];
+
+	// a savepoint is used instead of BEGIN so that a batch can be opened while a transaction is already in progress
+	if(undo_log.batch_depth == 0)
+	{
+		CachedStatement(database, "SAVEPOINT batch_edit;").Execute();
+
+		// changes made in the batch are not coalesced into records made before it, so that the batch can be discarded by truncating
+		undo_log.batch_start = undo_log.pending.records.size();
+		undo_log.value_change_index.clear();
+	}
+
+	undo_log.batch_depth++;
+}
+
+void EndDatabaseBatch(sqlite3 *database)
+{
+	map<sqlite3 *, UndoLog>::iterator undo_log_it = undo_logs.find(database);
+	if(undo_log_it == undo_logs.end() || undo_log_it->second.batch_depth == 0)
+		throw pSketcherException("EndDatabaseBatch called without a matching BeginDatabaseBatch.");
+
+	undo_log_it->second.batch_depth--;
+	if(undo_log_it->second.batch_depth > 0)
+		return;
+
+	try {
+		CachedStatement(database, "RELEASE batch_edit;").Execute();
+	}
+	catch (pSketcherException e) {
+		// the records of the changes that have been rolled back must not be written by the next FlushUndoLog
+		undo_log_it->second.pending.records.resize(undo_log_it->second.batch_start);
+		undo_log_it->second.value_change_index.clear();
+		ExecuteSQL(database, "ROLLBACK TO batch_edit; RELEASE batch_edit;");
+		throw;
+	}
+}
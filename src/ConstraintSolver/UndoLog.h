@@ -0,0 +1,70 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef UndoLogH
+#define UndoLogH
+
+#include <string>
+#include <vector>
+#include "StatementCache.h"
+
+// The undo log stores the changes made to the database as typed binary records, one undo_redo_list row for all of the
+// changes made between two stable points. A record either changes one column of one row, identified by its primary key,
+// from an old value to a new value or adds or removes a whole row. The records are collected in memory until FlushUndoLog
+// is called at the next stable point so that consecutive changes to the same value are coalesced into a single record.
+// Until then the undo history of those changes exists only in memory, a change made after the last stable point has no
+// undo_redo_list row and is not undoable if the program exits before the next stable point.
+// Undo applies the records of each row in reverse order using the old values and redo applies them in order using the
+// new values.
+
+// records that row, the values of all of the columns of the row in table order, has been added to or removed from table_name
+void RecordRowChange(sqlite3 *database, const std::string &table_name, const std::vector<DatabaseValue> &row, bool row_added);
+
+// records that column_name of row id in table_name has been changed from old_value to new_value
+// consecutive changes to the same value are coalesced and a value that is changed back to where it started is left out entirely
+void RecordValueChange(sqlite3 *database, const std::string &table_name, const std::string &column_name, unsigned id, const DatabaseValue &old_value, const DatabaseValue &new_value);
+
+// same as above for a row identified by the values of its primary key columns before the change, these changes are not coalesced
+void RecordValueChange(sqlite3 *database, const std::string &table_name, const std::string &column_name, const std::vector<DatabaseValue> &key, const DatabaseValue &old_value, const DatabaseValue &new_value);
+
+// writes the changes recorded since the last flush as one undo_redo_list row, nothing is written if there are none
+// if the model is at a stable point reached by an undo, the truncate_undo_list trigger discards the entries that could have been redone
+void FlushUndoLog(sqlite3 *database);
+
+// returns true if changes have been recorded that have not been written to undo_redo_list yet, undo and redo are not
+// available until they have been written at the next stable point
+bool IsUndoLogPending(sqlite3 *database);
+
+// applies the undo_redo_list rows with first_id < id <= last_id, the rows are undone in reverse order if undo is true
+void ApplyUndoLog(sqlite3 *database, int first_id, int last_id, bool undo);
+
+// discards the changes that have not been written and the batch state for database, must be called before the database is closed
+void ReleaseUndoLog(sqlite3 *database);
+
+// Batched edits, all of the changes made to database between BeginDatabaseBatch and the matching EndDatabaseBatch are made
+// in one transaction. Batches may be nested, the transaction is committed when the outermost batch ends. If the commit fails
+// the transaction is rolled back, the undo records of the batch are discarded, and EndDatabaseBatch throws pSketcherException.
+void BeginDatabaseBatch(sqlite3 *database);
+void EndDatabaseBatch(sqlite3 *database);
+
+// returns the names of the primary key columns of table_name in key order
+void GetPrimaryKeyColumns(sqlite3 *database, const std::string &table_name, std::vector<std::string> &key_columns);
+
+#endif //UndoLogH
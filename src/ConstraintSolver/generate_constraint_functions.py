@@ -2,11 +2,14 @@
 GiNaC functions in C++ for each constraint equation. The generated C++ files are 
 ConstraintFunctions.h and ConstraintFunctions.cpp. The existing C++ files are deleted. """
 
-from sympy import sympify,symbols,ccode
+from sympy import sympify,symbols,ccode,cse,numbered_symbols
 from string import split,strip,rstrip
 from mako.template import Template
 import re
 
+# must match solver_functions_max_dofs in SolverFunctionsBase.h, the local parameter vectors are fixed size
+solver_functions_max_dofs = 12
+
 class ConstraintEquation:
     def __init__(self,line):
         self.parse_equation(line)
@@ -34,11 +37,34 @@ class ConstraintEquation:
         self.function_name = strip(function_name)
         parameter_list = rstrip(strip(parameter_list),")")
         self.parameter_list = [strip(parameter) for parameter in split(parameter_list,",")]
+        if len(self.parameter_list) > solver_functions_max_dofs:
+            raise ValueError("The function " + self.function_name + " has more than " + str(solver_functions_max_dofs) + " parameters.")
         
         self.expression = sympify(strip(rhs))
         
         if substitution_list is not None:
             self.expression = self.expression.subs(substitution_list)
+
+        # functions of the form dof1 - dof2 are merged by the presolve in ConstraintCluster instead of being solved numerically
+        self.is_dof_equality = False
+        if len(self.parameter_list) == 2:
+            difference = sympify(self.parameter_list[0] + "-" + self.parameter_list[1])
+            self.is_dof_equality = (self.expression - difference).expand() == 0 or (self.expression + difference).expand() == 0
+
+    def fused_value_and_gradient(self):
+        """Applies common subexpression elimination to the expression and all of its partial
+        derivatives at once so that shared terms are only evaluated once. Returns the tuple
+        (temporary_list, value, gradient_list) where temporary_list is a list of
+        (temporary_name, c_code) pairs and value and gradient_list are C code strings. """
+
+        expression_list = [self.expression] + [self.expression.diff(parameter) for parameter in self.parameter_list]
+        (replacements, reduced_expressions) = cse(expression_list, symbols=numbered_symbols('temp'))
+
+        temporary_list = [(str(temporary), ccode(expression)) for (temporary, expression) in replacements]
+        value = ccode(reduced_expressions[0])
+        gradient_list = [ccode(expression) for expression in reduced_expressions[1:]]
+
+        return (temporary_list, value, gradient_list)
         
 
 if __name__ == "__main__":
@@ -21,6 +21,7 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
 #include <sstream>
+#include <set>
 #include <boost/filesystem.hpp>
 
 // Begining of includes related to libdime (used for dxf import and export)
@@ -31,30 +32,42 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // End of includes related to libdime
 
 #include "pSketcherModel.h"
+#include "StatementCache.h"
+#include "UndoLog.h"
+#include "DatabaseSnapshot.h"
 
 using namespace std;
 
+// each row of undo_redo_list holds the binary undo log records (see UndoLog.h) of the changes made between two stable points
+const std::string SQL_undo_redo_database_schema =
+	"CREATE TABLE undo_redo_list (id INTEGER PRIMARY KEY, delta BLOB NOT NULL);"
+	"CREATE TRIGGER truncate_undo_list BEFORE INSERT ON undo_redo_list "
+	"WHEN EXISTS (SELECT stable_point FROM undo_stable_points WHERE bool_current_stable_point=1) "
+	"BEGIN "
+		"DELETE FROM undo_redo_list WHERE id > (SELECT stable_point FROM  undo_stable_points WHERE bool_current_stable_point=1);"
+		"DELETE FROM undo_stable_points WHERE stable_point > (SELECT stable_point FROM  undo_stable_points WHERE bool_current_stable_point=1);"
+		"UPDATE undo_stable_points SET bool_current_stable_point=0 WHERE bool_current_stable_point=1;"
+	"END;";
+
 const std::string SQL_psketcher_database_schema = 
 "BEGIN;"
 	"CREATE TABLE dof_list (id INTEGER PRIMARY KEY, table_name TEXT NOT NULL);"
 	"CREATE TABLE primitive_list (id INTEGER PRIMARY KEY, table_name TEXT NOT NULL);"
 	"CREATE TABLE constraint_equation_list (id INTEGER PRIMARY KEY, table_name TEXT NOT NULL);"
-	"CREATE TABLE undo_redo_list (id INTEGER PRIMARY KEY, undo TEXT, redo TEXT);"
+	+ SQL_undo_redo_database_schema
+	+ SQL_dof_link_database_schema + SQL_primitive_link_database_schema + SQL_source_dof_link_database_schema +
 	"CREATE TABLE undo_stable_points (id INTEGER PRIMARY KEY, stable_point INTEGER NOT NULL UNIQUE, bool_current_stable_point INTEGER CHECK (bool_current_stable_point >= 0 AND bool_current_stable_point <= 1), description TEXT);"
 	"CREATE TRIGGER clear_current_stable_point BEFORE UPDATE ON undo_stable_points "
 	"WHEN (NEW.bool_current_stable_point == 1 AND OLD.bool_current_stable_point == 0) "
 	"BEGIN "
 		"UPDATE undo_stable_points SET bool_current_stable_point=0 WHERE bool_current_stable_point=1;"
 	"END;"
-	"CREATE TRIGGER truncate_undo_list BEFORE INSERT ON undo_redo_list "
-	"WHEN EXISTS (SELECT stable_point FROM undo_stable_points WHERE bool_current_stable_point=1) "
-	"BEGIN "
-		"DELETE FROM undo_redo_list WHERE id > (SELECT stable_point FROM  undo_stable_points WHERE bool_current_stable_point=1);"
-		"DELETE FROM undo_stable_points WHERE stable_point > (SELECT stable_point FROM  undo_stable_points WHERE bool_current_stable_point=1);"
-		"UPDATE undo_stable_points SET bool_current_stable_point=0 WHERE bool_current_stable_point=1;"
-	"END;"
 "COMMIT;";
 
+// stored in the user_version of the database, files written before the link tables were introduced are version 0 and
+// files with an SQL text undo log are version 1
+const int psketcher_database_version = 2;
+
 const std::string psketcher_current_database_file = "psketcher_working_db.current";
 const std::string psketcher_previous_database_file = "psketcher_working_db.previous";
 
@@ -65,8 +78,19 @@ CurrentPrimitiveFactory(current_primitive_factory),
 CurrentConstraintFactory(current_constraint_factory),
 current_selection_mask_(All),
 database_(0),
-current_file_name_("")
+snapshot_(0),
+current_file_name_(""),
+solver_engine_(BFGS_ENGINE),
+solve_profiling_(false),
+repartition_required_(true),
+num_async_requests_(0),
+async_running_(false),
+async_cancel_(0),
+async_finished_(false),
+async_error_(false)
 {
+	pthread_mutex_init(&async_lock_, 0);
+
 	// initialize an empty database
 	InitializeDatabase();
 }
@@ -77,8 +101,19 @@ CurrentPrimitiveFactory(current_primitive_factory),
 CurrentConstraintFactory(current_constraint_factory),
 current_selection_mask_(All),
 database_(0),
-current_file_name_(file_name)
+snapshot_(0),
+current_file_name_(file_name),
+solver_engine_(BFGS_ENGINE),
+solve_profiling_(false),
+repartition_required_(true),
+num_async_requests_(0),
+async_running_(false),
+async_cancel_(0),
+async_finished_(false),
+async_error_(false)
 {
+	pthread_mutex_init(&async_lock_, 0);
+
 	// delete the previous database file if it already exists
 	if(boost::filesystem::exists(psketcher_previous_database_file))
 		boost::filesystem::remove(psketcher_previous_database_file);
@@ -100,22 +135,14 @@ current_file_name_(file_name)
 	}
 
     // Turn on foreign key enforcement
-    char *zErrMsg = 0;
-    rc = sqlite3_exec(database_, "PRAGMA foreign_keys = ON;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "PRAGMA foreign_keys = ON;");
     
     // Allow program to continue before db writes are complete 
     // provides dramatic improvement in performance
-    rc = sqlite3_exec(database_, "PRAGMA synchronous=OFF;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "PRAGMA synchronous=OFF;");
+
+	// files written by older versions need to be converted to the current schema before they can be read
+	UpgradeDatabase();
 
 	// synchronize memory to the newly opened database
 	SyncToDatabase();
@@ -123,7 +150,12 @@ current_file_name_(file_name)
 
 pSketcherModel::~pSketcherModel() 
 {
-	// close the database
+	CancelAsyncSolve();
+	pthread_mutex_destroy(&async_lock_);
+
+	// close the database, the cached statements must be finalized first or sqlite3_close will fail
+	ReleaseUndoLog(database_);
+	FinalizeCachedStatements(database_);
 	int rc = sqlite3_close(database_);
 	if(rc)
 	{
@@ -172,32 +204,146 @@ void pSketcherModel::InitializeDatabase()
 	}
 
 	// initialize the database schema
-	char *zErrMsg = 0;
-	rc = sqlite3_exec(database_, SQL_psketcher_database_schema.c_str(), 0, 0, &zErrMsg);
-	if( rc!=SQLITE_OK ){
-		std::string error_description = "SQL error: " + std::string(zErrMsg);
-		sqlite3_free(zErrMsg);
-		throw pSketcherException(error_description);
-	}
+	ExecuteSQL(database_, SQL_psketcher_database_schema);
+
+	stringstream sql_version;
+	sql_version << "PRAGMA user_version = " << psketcher_database_version << ";";
+	ExecuteSQL(database_, sql_version.str());
+
     // Turn on foreign key enforcement
-    rc = sqlite3_exec(database_, "PRAGMA foreign_keys = ON;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "PRAGMA foreign_keys = ON;");
     
     // Allow program to continue before db writes are complete
     // provides dramatic increase in performance
-    rc = sqlite3_exec(database_, "PRAGMA synchronous=OFF;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "PRAGMA synchronous=OFF;");
 	
 }
 
+// returns the comma separated column names of table_name
+static string GetColumnList(sqlite3 *database, const string &table_name)
+{
+	CachedStatement table_info(database, "PRAGMA table_info(" + table_name + ");");
+
+	string column_list;
+	while(table_info.Step())
+	{
+		if(column_list.size() > 0)
+			column_list += ",";
+		column_list += table_info.GetText(1);
+	}
+
+	return column_list;
+}
+
+void pSketcherModel::UpgradeDatabase()
+{
+	int version;
+	{
+		CachedStatement statement(database_, "PRAGMA user_version;");
+		statement.Step();
+		version = statement.GetInt(0);
+	}
+
+	if(version > psketcher_database_version)
+		throw pSketcherException("pSketcherModel::UpgradeDatabase: The file was written by a newer version of pSketcher.");
+
+	if(version == psketcher_database_version)
+		return;
+
+	// Version 0 files store the DOF's and primitives that each primitive and constraint equation depends on in two tables of
+	// their own (dof_table_<id> and primitive_table_<id>) and the source DOF's of each dependent DOF in a table of its own
+	// (source_dof_table_<id>), the names of these tables are stored in each object's row. Move the contents of these tables
+	// into the link tables and remove the table name columns.
+	string primitive_tables[][2] = {
+		{SQL_point_database_table_name, SQL_point_database_schema},
+		{SQL_vector_database_table_name, SQL_vector_database_schema},
+		{SQL_sketch_plane_database_table_name, SQL_sketch_plane_database_schema},
+		{SQL_point2d_database_table_name, SQL_point2d_database_schema},
+		{SQL_line_database_table_name, SQL_line_database_schema},
+		{SQL_line2d_database_table_name, SQL_line2d_database_schema},
+		{SQL_arc2d_database_table_name, SQL_arc2d_database_schema},
+		{SQL_circle2d_database_table_name, SQL_circle2d_database_schema},
+		{SQL_distance_point2d_database_table_name, SQL_distance_point2d_database_schema},
+		{SQL_distance_pointline2d_database_table_name, SQL_distance_pointline2d_database_schema},
+		{SQL_parallel_line2d_database_table_name, SQL_parallel_line2d_database_schema},
+		{SQL_horivert_line2d_database_table_name, SQL_horivert_line2d_database_schema},
+		{SQL_tangent_edge2d_database_table_name, SQL_tangent_edge2d_database_schema},
+		{SQL_angle_line2d_database_table_name, SQL_angle_line2d_database_schema},
+		{SQL_dependent_dof_database_table_name, SQL_dependent_dof_database_schema}
+	};
+	unsigned int num_tables = sizeof(primitive_tables)/sizeof(primitive_tables[0]);
+
+	// foreign key enforcement has to be turned off before the transaction starts
+	ExecuteSQL(database_, "PRAGMA foreign_keys = OFF;");
+	ExecuteSQL(database_, "SAVEPOINT upgrade_database;");
+
+	try {
+		if(version < 1)
+		{
+			ExecuteSQL(database_, SQL_dof_link_database_schema + SQL_primitive_link_database_schema + SQL_source_dof_link_database_schema);
+
+			for(unsigned int current_table = 0; current_table < num_tables; current_table++)
+			{
+				const string &table_name = primitive_tables[current_table][0];
+				const string &table_schema = primitive_tables[current_table][1];
+
+				// tables are only created once an object of their type has been added
+				{
+					CachedStatement table_exists(database_, "SELECT count(*) FROM sqlite_master WHERE type='table' AND name=?;");
+					table_exists.Bind(1,table_name).Step();
+					if(table_exists.GetInt(0) == 0)
+						continue;
+				}
+
+				// the positions of the old rows are kept since they preserve the order in which the ids were stored
+				stringstream sql_command;
+				bool dependent_dof = (table_name == SQL_dependent_dof_database_table_name);
+				if(dependent_dof)
+				{
+					CachedStatement statement(database_, "SELECT id, source_dof_table_name FROM " + table_name + ";");
+					while(statement.Step())
+					{
+						sql_command << "INSERT INTO " << SQL_source_dof_link_database_table_name << " SELECT " << statement.GetInt(0) << ", id, dof_id FROM " << statement.GetText(1) << "; "
+									<< "DROP TABLE " << statement.GetText(1) << "; ";
+					}
+				} else {
+					CachedStatement statement(database_, "SELECT id, dof_table_name, primitive_table_name FROM " + table_name + ";");
+					while(statement.Step())
+					{
+						sql_command << "INSERT INTO " << SQL_dof_link_database_table_name << " SELECT " << statement.GetInt(0) << ", id, id FROM " << statement.GetText(1) << "; "
+									<< "INSERT INTO " << SQL_primitive_link_database_table_name << " SELECT " << statement.GetInt(0) << ", id, id FROM " << statement.GetText(2) << "; "
+									<< "DROP TABLE " << statement.GetText(1) << "; "
+									<< "DROP TABLE " << statement.GetText(2) << "; ";
+					}
+				}
+
+				// recreate the table without the table name columns
+				string old_table_name = table_name + "_version_0";
+				sql_command << "ALTER TABLE " << table_name << " RENAME TO " << old_table_name << "; "
+							<< table_schema;
+				ExecuteSQL(database_, sql_command.str());
+
+				string column_list = GetColumnList(database_, table_name);
+				ExecuteSQL(database_, "INSERT INTO " + table_name + " SELECT " + column_list + " FROM " + old_table_name + "; DROP TABLE " + old_table_name + ";");
+			}
+		}
+
+		// Version 0 and 1 files store the undo history as SQL text and the version 0 history also refers to the tables that
+		// have been removed above. The history cannot be converted to the binary undo log so it is discarded.
+		ExecuteSQL(database_, "DROP TABLE undo_redo_list; " + SQL_undo_redo_database_schema + " DELETE FROM undo_stable_points;");
+
+		stringstream sql_version;
+		sql_version << "PRAGMA user_version = " << psketcher_database_version << ";";
+		ExecuteSQL(database_, sql_version.str());
+	}
+	catch (pSketcherException e) {
+		ExecuteSQL(database_, "ROLLBACK TO upgrade_database; RELEASE upgrade_database; PRAGMA foreign_keys = ON;");
+		throw;
+	}
+
+	ExecuteSQL(database_, "RELEASE upgrade_database; PRAGMA foreign_keys = ON;");
+}
+
 bool pSketcherModel::Save(const std::string &file_name, bool save_copy)
 {
 	if(file_name != "" && !save_copy)
@@ -205,14 +351,11 @@ bool pSketcherModel::Save(const std::string &file_name, bool save_copy)
 
 	bool success = true;
 
+	// the changes made since the last stable point must be in the undo log of the saved file
+	FlushUndoLog(database_);
+
 	// first lock the database in a read only state so that it can be safely coppied
-    char *zErrMsg = 0;
-    int rc = sqlite3_exec(database_, "BEGIN IMMEDIATE;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "BEGIN IMMEDIATE;");
 
 	// now copy the working database to the location of current_file_name_
 	try{
@@ -231,18 +374,16 @@ bool pSketcherModel::Save(const std::string &file_name, bool save_copy)
 	}
 
 	// finally, remove the lock from the database
-    rc = sqlite3_exec(database_, "ROLLBACK;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "ROLLBACK;");
 
 	return success;
 }
 
 void pSketcherModel::AddConstraintEquation(const ConstraintEquationBasePointer &new_constraint_equation, bool update_database)
 {
+	// the clusters cannot change while they are being solved
+	CancelAsyncSolve();
+
     // Add DOF's to DOF map containter
     vector<DOFPointer>::const_iterator dof_it;
     vector<DOFPointer>::const_iterator dof_end = new_constraint_equation->GetDOFList().end();
@@ -271,7 +412,11 @@ void pSketcherModel::AddConstraintEquation(const ConstraintEquationBasePointer &
     if(constraint_ret.second && update_database) // constraint_ret.second is true if this constraint is not already in the map
         new_constraint_equation->AddToDatabase(database_);
 
-	ApplySelectionMask(current_selection_mask_);
+	InvalidateConstraintClusters();
+
+	// while synchronizing from a snapshot the mask is applied once all of the objects have been loaded
+	if(snapshot_ == 0)
+		ApplySelectionMask(current_selection_mask_);
 }
 
 /*
@@ -312,7 +457,9 @@ void pSketcherModel::AddPrimitive(const PrimitiveBasePointer &new_primitive, boo
     if(primitive_ret.second && update_database) // primitive_ret.second is true if this primitive is not already in the map
         new_primitive->AddToDatabase(database_);
 
-	ApplySelectionMask(current_selection_mask_);
+	// while synchronizing from a snapshot the mask is applied once all of the objects have been loaded
+	if(snapshot_ == 0)
+		ApplySelectionMask(current_selection_mask_);
 }
 
 /*
@@ -323,62 +470,315 @@ void pSketcherModel::AddPrimitives(const std::vector<PrimitiveBasePointer> &new_
 }
 */
 
-// This method solves the system of constraint equations for this model
-void pSketcherModel::SolveConstraints()
+// union-find helpers used by PartitionConstraints, the DOF ID's are the nodes of the graph
+static unsigned FindClusterRoot(std::map<unsigned,unsigned> &parent, unsigned id)
 {
-	// only procedd if at least one constraint equation exists
-	if(constraint_equation_list_.size() > 0)
+	unsigned root = id;
+	while(parent[root] != root)
+		root = parent[root];
+
+	// path compression
+	while(parent[id] != root)
 	{
-		unsigned int num_free_values;
-		unsigned int num_fixed_values; 
-		
-		// create constraint equation and constraint equation weight vectors
-		std::vector<SolverFunctionsBasePointer> constraints;
-		std::vector<double> weights;
-	
-		for(map<unsigned,ConstraintEquationBasePointer>::iterator constraint_it=constraint_equation_list_.begin() ; constraint_it != constraint_equation_list_.end(); constraint_it++ )
+		unsigned next = parent[id];
+		parent[id] = root;
+		id = next;
+	}
+
+	return root;
+}
+
+// collects the free and dependent DOF's (the graph nodes) and the fixed independent DOF's that a solver function depends on
+static void GetSolverFunctionDOFs(const SolverFunctionsBasePointer &solver_function, std::vector<DOFPointer> &nodes, std::vector<DOFPointer> &fixed_dofs)
+{
+	const std::vector<DOFPointer> &dof_list = solver_function->GetDOFList();
+
+	for(unsigned int i = 0; i < dof_list.size(); i++)
+	{
+		if(dof_list[i]->IsDependent())
 		{
-                constraints.push_back(constraint_it->second->GetSolverFunction());
-                weights.push_back(constraint_it->second->GetWeight());
+			nodes.push_back(dof_list[i]);
+			GetSolverFunctionDOFs(dof_list[i]->GetSolverFunction(), nodes, fixed_dofs);
+		} else if(dof_list[i]->IsFree()) {
+			nodes.push_back(dof_list[i]);
+		} else {
+			fixed_dofs.push_back(dof_list[i]);
 		}
-	
+	}
+}
 
-		// create the free parameters, free_values, fixed_parameters, and fixed_values lists
-		std::vector<DOFPointer> free_parameters;
-		std::vector<double> free_values;
-		std::vector<DOFPointer> fixed_parameters;
-		std::vector<double> fixed_values;
-		
-		for (map<unsigned,DOFPointer>::iterator dof_it=dof_list_.begin() ; dof_it != dof_list_.end(); dof_it++ )
+// Splits the constraint equations into clusters that share no free DOF's, each cluster can then be solved independently
+// Dependent DOF's are also treated as graph nodes since their solver functions are shared by every constraint that uses them
+void pSketcherModel::PartitionConstraints(std::vector<ConstraintCluster> &clusters)
+{
+	clusters.clear();
+
+	std::map<unsigned,unsigned> parent;
+	std::vector<unsigned> constraint_ids;
+	std::vector<SolverFunctionsBasePointer> constraints;
+	std::vector<double> weights;
+	std::vector<std::vector<DOFPointer> > constraint_nodes;
+	std::vector<std::vector<DOFPointer> > constraint_fixed_dofs;
+
+	for(map<unsigned,ConstraintEquationBasePointer>::iterator constraint_it=constraint_equation_list_.begin() ; constraint_it != constraint_equation_list_.end(); constraint_it++ )
+	{
+		SolverFunctionsBasePointer solver_function = constraint_it->second->GetSolverFunction();
+
+		std::vector<DOFPointer> nodes;
+		std::vector<DOFPointer> fixed_dofs;
+		GetSolverFunctionDOFs(solver_function, nodes, fixed_dofs);
+
+		// a constraint that only depends on fixed DOF's cannot be changed by the solver
+		if(nodes.size() == 0)
+			continue;
+
+		for(unsigned int i = 0; i < nodes.size(); i++)
+			if(parent.find(nodes[i]->GetID()) == parent.end())
+				parent[nodes[i]->GetID()] = nodes[i]->GetID();
+
+		// join all of the nodes of this constraint into one cluster
+		unsigned root = FindClusterRoot(parent, nodes[0]->GetID());
+		for(unsigned int i = 1; i < nodes.size(); i++)
+			parent[FindClusterRoot(parent, nodes[i]->GetID())] = root;
+
+		constraint_ids.push_back(constraint_it->first);
+		constraints.push_back(solver_function);
+		weights.push_back(constraint_it->second->GetWeight());
+		constraint_nodes.push_back(nodes);
+		constraint_fixed_dofs.push_back(fixed_dofs);
+	}
+
+	// assign a cluster index to each root
+	std::map<unsigned,unsigned> cluster_index;
+	for(unsigned int i = 0; i < constraints.size(); i++)
+	{
+		unsigned root = FindClusterRoot(parent, constraint_nodes[i][0]->GetID());
+		if(cluster_index.find(root) == cluster_index.end())
+		{
+			cluster_index[root] = clusters.size();
+			clusters.push_back(ConstraintCluster());
+
+			// clusters start out modified, only clusters made up entirely of previously solved constraints can skip the next solve
+			clusters.back().ClearModified();
+		}
+	}
+
+	// populate the clusters, each fixed DOF is only added once per cluster
+	std::vector<std::set<unsigned> > cluster_fixed_ids(clusters.size());
+	for(unsigned int i = 0; i < constraints.size(); i++)
+	{
+		unsigned current_cluster = cluster_index[FindClusterRoot(parent, constraint_nodes[i][0]->GetID())];
+		clusters[current_cluster].AddConstraint(constraints[i], weights[i]);
+		if(solved_constraint_ids_.find(constraint_ids[i]) == solved_constraint_ids_.end())
+			clusters[current_cluster].SetModified();
+
+		for(unsigned int j = 0; j < constraint_fixed_dofs[i].size(); j++)
+			if(cluster_fixed_ids[current_cluster].insert(constraint_fixed_dofs[i][j]->GetID()).second)
+				clusters[current_cluster].AddFixedParameter(constraint_fixed_dofs[i][j]);
+	}
+
+	// free DOF's that are not used by any constraint are not part of any cluster and are left unchanged
+	for (map<unsigned,DOFPointer>::iterator dof_it=dof_list_.begin() ; dof_it != dof_list_.end(); dof_it++ )
+	{
+		if(dof_it->second->IsFree() && parent.find(dof_it->first) != parent.end())
+			clusters[cluster_index[FindClusterRoot(parent, dof_it->first)]].AddFreeParameter(dof_it->second);
+	}
+}
+
+void pSketcherModel::InvalidateConstraintClusters(bool solve_all)
+{
+	repartition_required_ = true;
+
+	if(solve_all)
+		solved_constraint_ids_.clear();
+}
+
+// This method solves the system of constraint equations for this model
+// The constraints are split into independent clusters and only the clusters that have changed since the last solve are solved again
+// Each cluster is warm started from the current DOF values, which is the previous solution for any DOF's that were not edited
+void pSketcherModel::SolveConstraints()
+{
+	SolveConstraints(SolveLimits(), true);
+}
+
+void pSketcherModel::SolveConstraintsInteractive(double time_budget, const int *cancel_flag)
+{
+	SolveConstraints(SolveLimits(GetSolverTime() + time_budget, cancel_flag), false);
+}
+
+void pSketcherModel::SolveConstraints(const SolveLimits &limits, bool update_database)
+{
+	CancelAsyncSolve();
+
+	double solve_start = GetSolverTime();
+	std::vector<unsigned> solve_order = PrepareSolve();
+	double partition_time = GetSolverTime() - solve_start;
+
+	if(solve_order.size() > 0)
+		SolveConstraintClusters(constraint_clusters_, solve_order, solver_engine_, solve_profiling_, robust_solve_options_, limits);
+
+	FinishSolve(solve_order, update_database, solve_start, partition_time);
+}
+
+std::vector<unsigned> pSketcherModel::PrepareSolve()
+{
+	// a change in the free state of any DOF in a cluster changes the partition
+	for(unsigned int current_cluster = 0; current_cluster < constraint_clusters_.size() && !repartition_required_; current_cluster++)
+		if(!constraint_clusters_[current_cluster].IsPartitionValid())
+			repartition_required_ = true;
+
+	if(repartition_required_)
+	{
+		PartitionConstraints(constraint_clusters_);
+		repartition_required_ = false;
+	}
+
+	return PrepareConstraintClusters(constraint_clusters_);
+}
+
+void pSketcherModel::FinishSolve(const std::vector<unsigned> &solve_order, bool update_database, double solve_start, double partition_time)
+{
+	solve_report_ = SolveReport();
+	solve_report_.partition_time = partition_time;
+
+	// only procedd if at least one constraint cluster exists
+	if(constraint_clusters_.size() > 0)
+	{
+		// Update the free DOF's with the solution, done serially since SetValue updates the database
+		// the whole solution is written in one transaction and shares one undo entry, no transaction is opened if the database is not updated
+		double apply_start = GetSolverTime();
 		{
-			if((*dof_it).second->IsFree())
-			{	// free parameter
-				free_parameters.push_back((*dof_it).second);
-				free_values.push_back((*dof_it).second->GetValue());
-			} else if( ! (*dof_it).second->IsDependent()) 
-			{	// fixed, independent parameter
-				fixed_parameters.push_back((*dof_it).second);
-				fixed_values.push_back((*dof_it).second->GetValue());
+			BatchEdit batch(*this, update_database);
+			for(unsigned int i = 0; i < solve_order.size(); i++)
+			{
+				ConstraintCluster &cluster = constraint_clusters_[solve_order[i]];
+
+				std::cerr << cluster.GetSolverOutput();
+				solve_report_.statistics.Add(cluster.GetStatistics());
+
+				// a DOF edited, freed, or fixed during an asynchronous solve makes the solution out of date, it is discarded so that the
+				// edit is kept and the cluster is left modified to be solved again from the current DOF values by the next solve
+				if(!cluster.IsSnapshotCurrent() || !cluster.IsPartitionValid())
+				{
+					cluster.SetModified();
+					continue;
+				}
+
+				cluster.ApplySolution(update_database);
+
+				// the unsaved or unfinished solution is taken up again by the next solve
+				if(update_database && cluster.GetStatistics().interrupted == 0)
+					cluster.ClearModified();
 			}
 		}
-	
-		// only continue if there are actually some free values to solve for
-		if(free_values.size() > 0)
+		solve_report_.apply_solution_time = GetSolverTime() - apply_start;
+
+		for(map<unsigned,ConstraintEquationBasePointer>::iterator constraint_it=constraint_equation_list_.begin() ; constraint_it != constraint_equation_list_.end(); constraint_it++ )
+			solved_constraint_ids_.insert(constraint_it->first);
+	}
+
+	// the clusters that were not solved again keep their residual merit from an earlier solve
+	for(unsigned int i = 0; i < constraint_clusters_.size(); i++)
+		solve_report_.final_merit += constraint_clusters_[i].GetResidualMerit();
+
+	// listing every constraint costs an evaluation of the whole model, so it is only done when profiling
+	if(solve_profiling_)
+	{
+		for(map<unsigned,ConstraintEquationBasePointer>::iterator constraint_it=constraint_equation_list_.begin() ; constraint_it != constraint_equation_list_.end(); constraint_it++ )
 		{
-			// populate the initial condition matrix using free_values
-			mmcMatrix initial_free_values(free_values.size(),1);
-			for(unsigned int current_free_value = 0; current_free_value < free_values.size(); current_free_value++)
-				initial_free_values(current_free_value,0) = free_values[current_free_value];
-		
-			ConstraintSolver my_constraint_solver(constraints, weights, free_parameters, fixed_parameters, fixed_values);
-		
-			mmcMatrix computed_free_values = my_constraint_solver.MinimizeMeritFunction(initial_free_values, 1000, 1e-10, 1e-15, 500, 1, &std::cerr);
-		
-			// Update the free DOF's with the solution
-			for(unsigned int current_dof = 0; current_dof < free_parameters.size(); current_dof++)
-				free_parameters[current_dof]->SetValue(computed_free_values(current_dof,0));
+			SolverFunctionsBasePointer solver_function = constraint_it->second->GetSolverFunction();
+			solve_report_.residuals.push_back(ConstraintResidual(constraint_it->first, solver_function->GetName(), solver_function->GetValue()));
 		}
 	}
+
+	solve_report_.total_time = GetSolverTime() - solve_start;
+
+	SolveCompleted(solve_report_);
+}
+
+unsigned pSketcherModel::SolveConstraintsAsync()
+{
+	CancelAsyncSolve();
+
+	async_request_.start_time = GetSolverTime();
+	async_request_.solve_order = PrepareSolve();
+	async_request_.partition_time = GetSolverTime() - async_request_.start_time;
+	async_request_.number = ++num_async_requests_;
+	async_request_.solver_engine = solver_engine_;
+	async_request_.profiling = solve_profiling_;
+	async_request_.robust = robust_solve_options_;
+
+	__atomic_store_n(&async_cancel_, 0, __ATOMIC_RELEASE);
+	async_finished_ = false;
+	async_error_ = false;
+	if(pthread_create(&async_thread_, 0, AsyncSolveThread, (void *)this) != 0)
+		throw pSketcherException("Error occurred while creating the solver thread.");
+	async_running_ = true;
+
+	return async_request_.number;
+}
+
+void *pSketcherModel::AsyncSolveThread(void *psketcher_model)
+{
+	pSketcherModel &model = *(pSketcherModel *)psketcher_model;
+	const AsyncSolveRequest &request = model.async_request_;
+
+	bool error = false;
+	try {
+		if(request.solve_order.size() > 0)
+			SolveConstraintClusters(model.constraint_clusters_, request.solve_order, request.solver_engine, request.profiling, request.robust, SolveLimits(0.0, &model.async_cancel_));
+	}
+	catch (...) {
+		// exceptions cannot cross the thread boundary, rethrown by ApplyAsyncSolve
+		error = true;
+	}
+
+	pthread_mutex_lock(&model.async_lock_);
+	model.async_finished_ = true;
+	model.async_error_ = error;
+	pthread_mutex_unlock(&model.async_lock_);
+
+	if(!__atomic_load_n(&model.async_cancel_, __ATOMIC_ACQUIRE))
+		model.AsyncSolveFinished(request.number);
+
+	return 0;
+}
+
+bool pSketcherModel::ApplyAsyncSolve(unsigned request)
+{
+	if(!async_running_ || request != async_request_.number)
+		return false;
+
+	pthread_mutex_lock(&async_lock_);
+	bool finished = async_finished_;
+	bool error = async_error_;
+	pthread_mutex_unlock(&async_lock_);
+
+	if(!finished)
+		return false;
+
+	if(pthread_join(async_thread_, 0))
+		std::cerr << "Error joining thread." << std::endl;
+	async_running_ = false;
+
+	if(error)
+		throw pSketcherException("Solver failure while solving a constraint cluster.");
+
+	FinishSolve(async_request_.solve_order, true, async_request_.start_time, async_request_.partition_time);
+
+	return true;
+}
+
+void pSketcherModel::CancelAsyncSolve()
+{
+	if(!async_running_)
+		return;
+
+	// the clusters of a cancelled solve are not applied so they remain modified
+	__atomic_store_n(&async_cancel_, 1, __ATOMIC_RELEASE);
+	if(pthread_join(async_thread_, 0))
+		std::cerr << "Error joining thread." << std::endl;
+	async_running_ = false;
 }
 
 
@@ -473,57 +873,55 @@ void pSketcherModel::FlagDependentsForDeletion(PrimitiveBasePointer primitive_to
 // delete all of the primitives that have been flagged for deletion
 void pSketcherModel::DeleteFlagged(bool remove_from_db)
 {
+	CancelAsyncSolve();
+
     // Turn off foreign key enforcement until the end of this method since we
     // don't know the order in which the primitives will be deleted
-    char *zErrMsg = 0;
-    int rc;
-    rc = sqlite3_exec(database_, "PRAGMA foreign_keys = OFF;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "PRAGMA foreign_keys = OFF;");
 
-	map<unsigned,PrimitiveBasePointer>::iterator iter1 = primitive_list_.begin();
-
-	while(iter1 != primitive_list_.end())
 	{
-		if(iter1->second->IsFlaggedForDeletion())
+		// remove everything in one transaction, foreign key enforcement has to be turned off before the transaction starts
+		BatchEdit batch(*this);
+
+		map<unsigned,PrimitiveBasePointer>::iterator iter1 = primitive_list_.begin();
+
+		while(iter1 != primitive_list_.end())
 		{
-			iter1->second->Erase();
-			if(remove_from_db)
-				iter1->second->RemoveFromDatabase();
-			primitive_list_.erase(iter1++);
-		} else {
-			iter1++;
+			if(iter1->second->IsFlaggedForDeletion())
+			{
+				iter1->second->Erase();
+				if(remove_from_db)
+					iter1->second->RemoveFromDatabase();
+				primitive_list_.erase(iter1++);
+			} else {
+				iter1++;
+			}
 		}
-	}
 	
-	map<unsigned,ConstraintEquationBasePointer>::iterator iter2 = constraint_equation_list_.begin();
+		map<unsigned,ConstraintEquationBasePointer>::iterator iter2 = constraint_equation_list_.begin();
 
-	while(iter2 != constraint_equation_list_.end())
-	{
-		if(iter2->second->IsFlaggedForDeletion())
+		while(iter2 != constraint_equation_list_.end())
 		{
-			iter2->second->Erase();
-			if(remove_from_db)
-				iter2->second->RemoveFromDatabase();
-			constraint_equation_list_.erase(iter2++);
-		} else {
-			iter2++;
+			if(iter2->second->IsFlaggedForDeletion())
+			{
+				iter2->second->Erase();
+				if(remove_from_db)
+					iter2->second->RemoveFromDatabase();
+				constraint_equation_list_.erase(iter2++);
+			} else {
+				iter2++;
+			}
 		}
 	}
 
     // Turn foreign key enforcement back on
-    rc = sqlite3_exec(database_, "PRAGMA foreign_keys = ON;", 0, 0, &zErrMsg);
-    if( rc!=SQLITE_OK ){
-        std::string error_description = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        throw pSketcherException(error_description);
-    }
+    ExecuteSQL(database_, "PRAGMA foreign_keys = ON;");
 
 	// there may now be some DOF's that are not needed, go ahead and delete them
 	DeleteUnusedDOFs(false /* don't attempt to remove from the database */);
+
+	// removing constraints cannot invalidate the current solution so none of the remaining clusters need to be solved again
+	InvalidateConstraintClusters();
 }
 
 void pSketcherModel::DeleteSelected()
@@ -557,12 +955,16 @@ DOFPointer pSketcherModel::FetchDOF(unsigned id)
 	if(dof_it != dof_list_.end())
 	{
 		// dof exists, synchronize it to the database and return it
-		(dof_it->second)->SyncToDatabase(*this);
+		// while synchronizing from a snapshot each DOF only needs to be synchronized the first time it is fetched
+		if(snapshot_ == 0 || snapshot_->MarkSynced(id))
+			(dof_it->second)->SyncToDatabase(*this);
 		return(dof_it->second);
 
 	} else {
 		// dof object does not exist, need to create it from the database
 		DOFPointer new_dof = DOFFactory(id);
+		if(snapshot_ != 0)
+			snapshot_->MarkSynced(id);
 
 		// add this DOF to the DOF map container so that it is not reconstructed upon a subsiquent call to FetchDOF
 		dof_list_.insert(pair<unsigned,DOFPointer>(id,new_dof));
@@ -574,49 +976,20 @@ DOFPointer pSketcherModel::FetchDOF(unsigned id)
 DOFPointer pSketcherModel::DOFFactory(unsigned id)
 {
 	// grab the table name from the database so we now exactly which class needs to be created
-	int rc;
-	sqlite3_stmt *statement;
-	stringstream table_name_stream;
 	string table_name;
 
-	stringstream sql_command;
-	sql_command << "SELECT * FROM dof_list WHERE id=" << id << ";";
-
-	rc = sqlite3_prepare(database_, sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(database_);
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// row exist, store the values to initialize this object
-		table_name_stream << sqlite3_column_text(statement,1);
-		table_name = table_name_stream.str();
-	} else {
-		// the requested row does not exist in the database
-		sqlite3_finalize(statement);
-
-		stringstream error_description;
-		error_description << "SQLite rowid " << id << " in table dof_list does not exist";
-		throw pSketcherException(error_description.str());
-	}
+	{
+		TableRow row(*this, "dof_list", id);
 
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(database_);
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(database_);
-		throw pSketcherException(error_description.str());
+		if(row.Exists()) {
+			// row exist, store the values to initialize this object
+			table_name = row.GetText(1);
+		} else {
+			// the requested row does not exist in the database
+			stringstream error_description;
+			error_description << "SQLite rowid " << id << " in table dof_list does not exist";
+			throw pSketcherException(error_description.str());
+		}
 	}
 
 	// now generate the object based on the table name
@@ -639,49 +1012,20 @@ DOFPointer pSketcherModel::DOFFactory(unsigned id)
 PrimitiveBasePointer pSketcherModel::PrimitiveFactory(unsigned id, pSketcherModel &psketcher_model)
 {
 	// grab the table name from the database so we now exactly which class needs to be created
-	int rc;
-	sqlite3_stmt *statement;
-	stringstream table_name_stream;
 	string table_name;
 
-	stringstream sql_command;
-	sql_command << "SELECT * FROM primitive_list WHERE id=" << id << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// row exist, store the values to initialize this object
-		table_name_stream << sqlite3_column_text(statement,1);
-		table_name = table_name_stream.str();
-	} else {
-		// the requested row does not exist in the database
-		sqlite3_finalize(statement);
-
-		stringstream error_description;
-		error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
-		throw pSketcherException(error_description.str());
-	}
+	{
+		TableRow row(psketcher_model, "primitive_list", id);
 
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
+		if(row.Exists()) {
+			// row exist, store the values to initialize this object
+			table_name = row.GetText(1);
+		} else {
+			// the requested row does not exist in the database
+			stringstream error_description;
+			error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
+			throw pSketcherException(error_description.str());
+		}
 	}
 
 	// now generate the object based on the table name
@@ -720,49 +1064,20 @@ ConstraintEquationBasePointer pSketcherModel::ConstraintFactory(unsigned id, pSk
 {
 
 	// grab the table name from the database so we now exactly which class needs to be created
-	int rc;
-	sqlite3_stmt *statement;
-	stringstream table_name_stream;
 	string table_name;
 
-	stringstream sql_command;
-	sql_command << "SELECT * FROM constraint_equation_list WHERE id=" << id << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// row exist, store the values to initialize this object
-		table_name_stream << sqlite3_column_text(statement,1);
-		table_name = table_name_stream.str();
-	} else {
-		// the requested row does not exist in the database
-		sqlite3_finalize(statement);
-
-		stringstream error_description;
-		error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
-		throw pSketcherException(error_description.str());
-	}
+	{
+		TableRow row(psketcher_model, "constraint_equation_list", id);
 
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
+		if(row.Exists()) {
+			// row exist, store the values to initialize this object
+			table_name = row.GetText(1);
+		} else {
+			// the requested row does not exist in the database
+			stringstream error_description;
+			error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
+			throw pSketcherException(error_description.str());
+		}
 	}
 
 	// now generate the object based on the table name
@@ -857,122 +1172,81 @@ void pSketcherModel::DeleteUnusedDOFs(bool remove_from_db)
 // synchronize the primitive, constraint, and DOF lists to the database (used to implement file open and undo/redo)
 void pSketcherModel::SyncToDatabase()
 {
+	CancelAsyncSolve();
+
 	// set the next_id_number_ variables for the PrimitiveBase and DOF classes (this is a static member)
 	SetMaxIDNumbers();
 
-	// Step 1: Flag all primitives and constraint equations for deletion
-	for (map<unsigned,PrimitiveBasePointer>::iterator primitive_it=primitive_list_.begin() ; primitive_it != primitive_list_.end(); primitive_it++ )
-		(*primitive_it).second->FlagForDeletion();
-
-	for (map<unsigned,ConstraintEquationBasePointer>::iterator constraint_it=constraint_equation_list_.begin() ; constraint_it != constraint_equation_list_.end(); constraint_it++ )
-		(*constraint_it).second->FlagForDeletion();
+	InvalidateConstraintClusters(true /* solve_all */);
 
-	// Step 2: Fetch all primitives and constraints that are defined in the database
+	// read each table once, the objects are then constructed and synchronized from this copy rather than with queries of their own
+	DatabaseSnapshot snapshot(database_);
+	snapshot_ = &snapshot;
 
-	// synchronize the primitive_list_ container to the database
+	try {
+		// Step 1: Flag all primitives and constraint equations for deletion
+		for (map<unsigned,PrimitiveBasePointer>::iterator primitive_it=primitive_list_.begin() ; primitive_it != primitive_list_.end(); primitive_it++ )
+			(*primitive_it).second->FlagForDeletion();
 
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
+		for (map<unsigned,ConstraintEquationBasePointer>::iterator constraint_it=constraint_equation_list_.begin() ; constraint_it != constraint_equation_list_.end(); constraint_it++ )
+			(*constraint_it).second->FlagForDeletion();
 
-	stringstream sql_command;
-	sql_command << "SELECT * FROM primitive_list;";
-
-	rc = sqlite3_prepare(GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-	
-	int current_primitive_id;
-	PrimitiveBasePointer current_primitive;
-	while(rc == SQLITE_ROW) {
-		current_primitive_id = sqlite3_column_int(statement,0);
+		// Step 2: Fetch all DOF's, primitives and constraints that are defined in the database
+		// the DOF's are fetched first since everything else depends on them, FetchDOF constructs the source DOF's of a dependent DOF
+		// before the dependent DOF itself and the primitives that a primitive or constraint depends on are likewise fetched when they are
+		// first referenced, all of these references are resolved from the snapshot and the DOF and primitive maps
+		const SnapshotTable &dof_table = *snapshot.FindTable("dof_list");
+		for(SnapshotTable::const_iterator row_it = dof_table.begin(); row_it != dof_table.end(); row_it++)
+			FetchDOF(row_it->first);
 
-		// get the primitive (it will be automatically created from the database if it doesn't already exist)
-		current_primitive = FetchPrimitive<PrimitiveBase>(current_primitive_id);
-		
-		if(current_primitive->IsFlaggedForDeletion())
+		// synchronize the primitive_list_ container to the database
+		const SnapshotTable &primitive_table = *snapshot.FindTable("primitive_list");
+		PrimitiveBasePointer current_primitive;
+		for(SnapshotTable::const_iterator row_it = primitive_table.begin(); row_it != primitive_table.end(); row_it++)
 		{
-			// this primitive already existed in memory, all we need to do is sync it to the database
-			current_primitive->SyncToDatabase(*this);
-			current_primitive->UnflagForDeletion(); // don't need to delete this primitive since it exists in the database
-		} else {
-			// this primitive was not in memory, need to add it to the model
-			// don't update the database since we are in the process of syncing to the database
-			AddPrimitive(current_primitive, false /*bool update_database */);
+			// get the primitive (it will be automatically created from the database if it doesn't already exist)
+			current_primitive = FetchPrimitive<PrimitiveBase>(row_it->first);
+		
+			if(current_primitive->IsFlaggedForDeletion())
+			{
+				// this primitive already existed in memory, all we need to do is sync it to the database
+				current_primitive->SyncToDatabase(*this);
+				current_primitive->UnflagForDeletion(); // don't need to delete this primitive since it exists in the database
+			} else {
+				// this primitive was not in memory, need to add it to the model
+				// don't update the database since we are in the process of syncing to the database
+				AddPrimitive(current_primitive, false /*bool update_database */);
+			}
 		}
 
-		rc = sqlite3_step(statement);
-	}
-
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-
-	// synchronize the constraint_equation_list_ container to the database
-	sql_command.str(""); // clear the contents of the string stream
-	sql_command << "SELECT * FROM constraint_equation_list;";
-
-	rc = sqlite3_prepare(GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-	
-	int current_constraint_id;
-	ConstraintEquationBasePointer current_constraint;
-	while(rc == SQLITE_ROW) {
-		current_constraint_id = sqlite3_column_int(statement,0);
-
-		// get the constraint (it will be automatically created from the database if it doesn't already exist)
-		current_constraint = FetchConstraint<ConstraintEquationBase>(current_constraint_id);
-
-		if(current_constraint->IsFlaggedForDeletion())
+		// synchronize the constraint_equation_list_ container to the database
+		const SnapshotTable &constraint_table = *snapshot.FindTable("constraint_equation_list");
+		ConstraintEquationBasePointer current_constraint;
+		for(SnapshotTable::const_iterator row_it = constraint_table.begin(); row_it != constraint_table.end(); row_it++)
 		{
-			// this primitive already existed in memory, all we need to do is sync it to the database
-			current_constraint->SyncToDatabase(*this);
-			current_constraint->UnflagForDeletion(); // don't need to delete this primitive since it exists in the database
-		} else {
-			// this primitive was not in memory, need to add it to the model
-			// don't update the database since we are in the process of reading the model from the database
-			AddConstraintEquation(current_constraint, false /* bool update_database */);
-		}
+			// get the constraint (it will be automatically created from the database if it doesn't already exist)
+			current_constraint = FetchConstraint<ConstraintEquationBase>(row_it->first);
 
-		rc = sqlite3_step(statement);
+			if(current_constraint->IsFlaggedForDeletion())
+			{
+				// this primitive already existed in memory, all we need to do is sync it to the database
+				current_constraint->SyncToDatabase(*this);
+				current_constraint->UnflagForDeletion(); // don't need to delete this primitive since it exists in the database
+			} else {
+				// this primitive was not in memory, need to add it to the model
+				// don't update the database since we are in the process of reading the model from the database
+				AddConstraintEquation(current_constraint, false /* bool update_database */);
+			}
+		}
 	}
-
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
+	catch (...) {
+		snapshot_ = 0;
+		throw;
 	}
 
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
+	snapshot_ = 0;
 
+	ApplySelectionMask(current_selection_mask_);
 
 	// Step 3: Delete all primitives and constraints that are flagged for deletion
 	DeleteFlagged(false /* delete_from_db */);
@@ -981,68 +1255,17 @@ void pSketcherModel::SyncToDatabase()
 void pSketcherModel::SetMaxIDNumbers()
 {
 	// need to set the next_id_number_ members of the PrimitiveBase and DOF classes
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-
+	// max(id) is NULL, read as 0, when the table is empty
 	int max_primitive, max_constraint, next_primitive;
-	
-	std::string sql_command_primitive = "SELECT max(id) AS id FROM primitive_list;";
-	std::string sql_command_constraint = "SELECT max(id) AS id FROM constraint_equation_list;";
-	std::string sql_command_dof = "SELECT max(id) AS id FROM dof_list;";
-
-	rc = sqlite3_prepare(GetDatabase(), sql_command_primitive.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
 
-	if(rc == SQLITE_ROW) {
-		// set the next_primitive value based on the max id number in the database
-		max_primitive = sqlite3_column_int(statement,0);
-	} else {
-		// the requested row does not exist in the database so there are no existing primitive entities
-		// set max_primitve to 0
-		max_primitive=0;
-	}
-
-	rc = sqlite3_finalize(statement);
-
-	// make sure the finalize statement didn't generate an error
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_prepare(GetDatabase(), sql_command_constraint.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// set the max_constraint value from the database
-		max_constraint = sqlite3_column_int(statement,0);
-	} else {
-		// the requested row does not exist in the database so there are no existing constraint entities
-		// set max_constraint to 0
-		max_constraint=0;
+	{
+		CachedStatement statement(database_, "SELECT max(id) AS id FROM primitive_list;");
+		max_primitive = statement.Step() ? statement.GetInt(0) : 0;
 	}
 
-	rc = sqlite3_finalize(statement);
-
-	// make sure the finalize statement didn't generate an error
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
+	{
+		CachedStatement statement(database_, "SELECT max(id) AS id FROM constraint_equation_list;");
+		max_constraint = statement.Step() ? statement.GetInt(0) : 0;
 	}
 
 	next_primitive = max_constraint > max_primitive ? max_constraint+1 : max_primitive+1;
@@ -1050,36 +1273,10 @@ void pSketcherModel::SetMaxIDNumbers()
 	PrimitiveBase::SetNextID(next_primitive);
 	cerr << "next primitive = " << next_primitive << endl;	
 
-	rc = sqlite3_prepare(GetDatabase(), sql_command_dof.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// set the next_id_number_ value based on the max id number in the database
-		DOF::SetNextID(sqlite3_column_int(statement,0)+1);
-		
-		cerr << "next dof = " << sqlite3_column_int(statement,0)+1 << endl;
-	} else {
-		// the requested row does not exist in the database so there are no existing primitive entities
-		// set next_id_number_ to 1
-		DOF::SetNextID(1);
-
-		cerr << "next dof = " << 1 << endl;
-	}
-
-	rc = sqlite3_finalize(statement);
-
-	// make sure the finalize statement didn't generate an error
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
+	CachedStatement statement(database_, "SELECT max(id) AS id FROM dof_list;");
+	int next_dof = statement.Step() ? statement.GetInt(0)+1 : 1;
+	DOF::SetNextID(next_dof);
+	cerr << "next dof = " << next_dof << endl;
 }
 
 
@@ -1088,93 +1285,62 @@ void pSketcherModel::MarkStablePoint(const std::string &description)
 	// Add a new stable point, use the maximum id from the undo_redo_list table as the stable id
 	// Do add a stable point if the undo_redo_list table is empty or if this stable point has has already been defined
 
+	// write the changes made since the previous stable point to the undo_redo_list table
+	FlushUndoLog(database_);
+
 	// first get the max max undo_redo id and the max stable point
-	int max_undo_redo_id, max_stable_point;
+	int max_undo_redo_id = 0;
 	bool undo_redo_list_empty = false;
 	bool stable_point_already_exists = false;
-	bool stable_point_list_empty = false;
-
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-	
-	std::string sql_command_undo_redo_list = "SELECT max(id) AS id FROM undo_redo_list;";
-	std::string sql_command_undo_stable_points = "SELECT max(stable_point) AS stable_point FROM undo_stable_points;";
-
-	rc = sqlite3_prepare(GetDatabase(), sql_command_undo_redo_list.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
 
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// undo_redo_list is not empty, record the max id
-		max_undo_redo_id = sqlite3_column_int(statement,0);		
-	} else {
-		// the undo_redo_list is empty
-		undo_redo_list_empty = true;
+	{
+		CachedStatement statement(database_, "SELECT max(id) AS id FROM undo_redo_list;");
+		if(statement.Step())
+			max_undo_redo_id = statement.GetInt(0); // undo_redo_list is not empty, record the max id
+		else
+			undo_redo_list_empty = true;
 	}
 
-	rc = sqlite3_finalize(statement);
+	{
+		CachedStatement statement(database_, "SELECT max(stable_point) AS stable_point FROM undo_stable_points;");
 
-	// make sure the finalize statement didn't generate an error
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
+		// check to see if this stable point has already been defined
+		if(statement.Step() && !undo_redo_list_empty && max_undo_redo_id == statement.GetInt(0))
+			stable_point_already_exists = true;
 	}
+ 
+	// now add the row for this new stable point if it doesn't already exist and the unde/redo list is not empty
+	if(!undo_redo_list_empty && !stable_point_already_exists)
+		CachedStatement(database_, "INSERT INTO undo_stable_points(stable_point,bool_current_stable_point,description) VALUES(?,0,?);").Bind(1,max_undo_redo_id).Bind(2,description).Execute();
+}
 
+void pSketcherModel::BeginBatchEdit()
+{
+	BeginDatabaseBatch(database_);
+}
 
-	rc = sqlite3_prepare(GetDatabase(), sql_command_undo_stable_points.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
+void pSketcherModel::EndBatchEdit()
+{
+	try {
+		EndDatabaseBatch(database_);
 	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// the stable point list is not empty, record the max stable point
-		max_stable_point = sqlite3_column_int(statement,0);
-		
-		// check to see if this stable point has already been defined
-		if(!undo_redo_list_empty && max_undo_redo_id == max_stable_point)
-			stable_point_already_exists = true;
-	
-	} else {
-		// the undo_redo_list is empty
-		stable_point_list_empty = true;
+	catch (pSketcherException e) {
+		// the changes of the batch have been rolled back, the model is read from the database again so that it matches
+		SyncToDatabase();
+		throw;
 	}
+}
 
-	rc = sqlite3_finalize(statement);
+BatchEdit::~BatchEdit()
+{
+	if(!active_)
+		return;
 
-	// make sure the finalize statement didn't generate an error
-	if( rc!=SQLITE_OK ){
-		std::stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(GetDatabase());
-		throw pSketcherException(error_description.str());
+	// a destructor must not throw, pSketcherException reports the error when it is constructed
+	try {
+		psketcher_model_.EndBatchEdit();
 	}
- 
-	// now add the row for this new stable point if it doesn't already exist and the unde/redo list is not empty
-	if(!undo_redo_list_empty && !stable_point_already_exists)
-	{
-		// define the update statement
-		char *sql_statement = sqlite3_mprintf("INSERT INTO undo_stable_points(stable_point,bool_current_stable_point,description) VALUES(%d,0,'%q');",max_undo_redo_id,description.c_str());
-		
-		// do the database update
-		char *zErrMsg = 0;
-		int rc = sqlite3_exec(database_, sql_statement, 0, 0, &zErrMsg);
-		if( rc!=SQLITE_OK ){
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
-		}
-
-		sqlite3_free(sql_statement);
+	catch (pSketcherException e) {
 	}
 }
 
@@ -1192,260 +1358,91 @@ bool pSketcherModel::IsRedoAvailable(string &description)
 
 bool pSketcherModel::IsUndoAvailable(int &current_stable_point, int &new_stable_point, int &current_row_id /* current row id of table undo_stable_points */, string &description)
 {
-	stringstream temp_stream;
-
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-	
-	string sql_command = "SELECT * FROM undo_stable_points WHERE bool_current_stable_point=1;";
-
-	rc = sqlite3_prepare(database_, sql_command.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(database_);
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
+	// an undo cannot be performed if changes have been made since the last stable point
+	if(IsUndoLogPending(database_))
+		return false;
 
-	if(rc == SQLITE_ROW) {
-		// row exists
-		
-		current_row_id = sqlite3_column_int(statement,0);
-		current_stable_point = sqlite3_column_int(statement,1);
-		temp_stream.str("");
-		temp_stream << sqlite3_column_text(statement,3);
-		description = temp_stream.str();
-
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
+	bool at_current_stable_point;
+	{
+		CachedStatement statement(database_, "SELECT * FROM undo_stable_points WHERE bool_current_stable_point=1;");
+		at_current_stable_point = statement.Step();
+		if(at_current_stable_point)
+		{
+			current_row_id = statement.GetInt(0);
+			current_stable_point = statement.GetInt(1);
+			description = statement.GetText(3);
 		}
+	}
 
-	} else {
-		// the requested row does not exist in the database
+	if(!at_current_stable_point)
+	{
 		// we are at the end of the undo/redo list, retrieve that last row in undo_stable_points to determine if and undo is available
-		
-		// must first finalize the previous sql statement
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-		
 		// Check to insure that the last stable point int the table undo_stable_points matches the last id in the undo_redo_table
 		// an undo cannot be performed if the model is not currently at a stable point
-		sql_command = "SELECT * FROM undo_stable_points WHERE stable_point=(SELECT max(stable_point) AS stable_point FROM undo_stable_points);";
-		rc = sqlite3_prepare(database_, sql_command.c_str(), -1, &statement, 0);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-	
-		rc = sqlite3_step(statement);
-	
-		if(rc == SQLITE_ROW) {
-			// row exists
-			
-			current_row_id = sqlite3_column_int(statement,0);
-			current_stable_point = sqlite3_column_int(statement,1);
-			temp_stream.str("");
-			temp_stream << sqlite3_column_text(statement,3);
-			description = temp_stream.str();
-
-			rc = sqlite3_finalize(statement);
-			if( rc!=SQLITE_OK ){
-				stringstream error_description;
-				error_description << "SQL error: " << sqlite3_errmsg(database_);
-				throw pSketcherException(error_description.str());
-			}
-
-			// make sure that current_row_id matches the largest id in the undo_redo_table
-			sql_command = "SELECT max(id) AS id FROM undo_redo_list;";
-			rc = sqlite3_prepare(database_, sql_command.c_str(), -1, &statement, 0);
-			if( rc!=SQLITE_OK ){
-				stringstream error_description;
-				error_description << "SQL error: " << sqlite3_errmsg(database_);
-				throw pSketcherException(error_description.str());
-			}
-		
-			rc = sqlite3_step(statement);
-		
-			if(rc == SQLITE_ROW) {
-				// row exists
-				
-				int max_undo_redo_table_id = sqlite3_column_int(statement,0);
-	
-				rc = sqlite3_finalize(statement);
-				if( rc!=SQLITE_OK ){
-					stringstream error_description;
-					error_description << "SQL error: " << sqlite3_errmsg(database_);
-					throw pSketcherException(error_description.str());
-				}
-	
-				if(max_undo_redo_table_id != current_stable_point)
-				{
-					// The model is not currently at a stable point, cannot perform undo operation
-					return false;
-				}
+		{
+			CachedStatement statement(database_, "SELECT * FROM undo_stable_points WHERE stable_point=(SELECT max(stable_point) AS stable_point FROM undo_stable_points);");
 
-			} else {
-				// row doesn't exist (the undo_redo_table is emtpy), this is an error condition since there is a stable point defined
-				rc = sqlite3_finalize(statement);
-				throw pSketcherException("pSketcherModel Error: The undo_redo_table is empty while a stable point is defined.);");	
+			// undo_stable_points table is empty so undo is not available
+			if(!statement.Step())
 				return false;
-			}
 
+			current_row_id = statement.GetInt(0);
+			current_stable_point = statement.GetInt(1);
+			description = statement.GetText(3);
+		}
 
-		} else {
-			// undo_stable_points table is empty so undo is not available
+		// make sure that current_row_id matches the largest id in the undo_redo_table
+		CachedStatement statement(database_, "SELECT max(id) AS id FROM undo_redo_list;");
+		if(!statement.Step())
+			throw pSketcherException("pSketcherModel Error: The undo_redo_table is empty while a stable point is defined.");
 
-			// must first finalize the previous sql statement
-			rc = sqlite3_finalize(statement);
-			if( rc!=SQLITE_OK ){
-				stringstream error_description;
-				error_description << "SQL error: " << sqlite3_errmsg(database_);
-				throw pSketcherException(error_description.str());
-			}
+		// The model is not currently at a stable point, cannot perform undo operation
+		if(statement.GetInt(0) != current_stable_point)
 			return false;
-		}
 	}
 
+	// we are already at the first stable point, no more undos are available
 	if(current_row_id == 1)
-	{
-		// we are already at the first stable point, no more undos are available
 		return false;
-	} else {
-		// get teh new stalbe point
-		temp_stream.str("");
-		temp_stream << "SELECT stable_point FROM undo_stable_points WHERE id=" << current_row_id-1 << ";";
 
-		rc = sqlite3_prepare(database_, temp_stream.str().c_str(), -1, &statement, 0);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-	
-		rc = sqlite3_step(statement);
-	
-		if(rc == SQLITE_ROW) {
-			// row exists
-			
-			new_stable_point = sqlite3_column_int(statement,0);
-	
-			rc = sqlite3_finalize(statement);
-			if( rc!=SQLITE_OK ){
-				stringstream error_description;
-				error_description << "SQL error: " << sqlite3_errmsg(database_);
-				throw pSketcherException(error_description.str());
-			}
-	
-			// undo exists and has been fully defined
-			return true;
-	
-		} else {
-			// value doesn't exist, this is an error condition 
-			rc = sqlite3_finalize(statement);
-			throw pSketcherException("pSketcherModel Error: Inconsistant undo_stable_points table.");
-			return false;
-		}
-	}
+	// get the new stable point
+	CachedStatement statement(database_, "SELECT stable_point FROM undo_stable_points WHERE id=?;");
+	statement.Bind(1,current_row_id-1);
+	if(!statement.Step())
+		throw pSketcherException("pSketcherModel Error: Inconsistant undo_stable_points table.");
+
+	// undo exists and has been fully defined
+	new_stable_point = statement.GetInt(0);
+	return true;
 }
 
 bool pSketcherModel::IsRedoAvailable(int &current_stable_point, int &new_stable_point, int &current_row_id /* current row id of table undo_stable_points */, string &description)
 {
-	stringstream temp_stream;
-
-	char *zErrMsg = 0;
-	int rc;
-	sqlite3_stmt *statement;
-	
-	string sql_command = "SELECT * FROM undo_stable_points WHERE bool_current_stable_point=1;";
-
-	rc = sqlite3_prepare(database_, sql_command.c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(database_);
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// row exists
-		
-		current_row_id = sqlite3_column_int(statement,0);
-		current_stable_point = sqlite3_column_int(statement,1);
+	// a redo cannot be applied on top of changes that have been made since the current stable point
+	if(IsUndoLogPending(database_))
+		return false;
 
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
+	{
+		CachedStatement statement(database_, "SELECT * FROM undo_stable_points WHERE bool_current_stable_point=1;");
 
-	} else {
-		// the requested row does not exist in the database
 		// we are at the end of the undo/redo list, there is no redo available
-		
-		// must first finalize the previous sql statement
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-		
-		return false;
-	}
-
-	// get the new stalbe point
-	temp_stream.str("");
-	temp_stream << "SELECT stable_point FROM undo_stable_points WHERE id=" << current_row_id+1 << ";";
+		if(!statement.Step())
+			return false;
 
-	rc = sqlite3_prepare(database_, temp_stream.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(database_);
-		throw pSketcherException(error_description.str());
+		current_row_id = statement.GetInt(0);
+		current_stable_point = statement.GetInt(1);
 	}
 
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// row exists
-		
-		new_stable_point = sqlite3_column_int(statement,0);
-		temp_stream << sqlite3_column_text(statement,3);
-		description = temp_stream.str();
-
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-
-		// undo exists and has been fully defined
-		return true;
-
-	} else {
-		// no new stable points available, model is up to date 
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-
+	// get the new stable point, no new stable points are available if the model is up to date
+	CachedStatement statement(database_, "SELECT stable_point, description FROM undo_stable_points WHERE id=?;");
+	statement.Bind(1,current_row_id+1);
+	if(!statement.Step())
 		return false;
-	}
+
+	// redo exists and has been fully defined
+	new_stable_point = statement.GetInt(0);
+	description = statement.GetText(1);
+	return true;
 }
 
 bool pSketcherModel::Undo()
@@ -1457,96 +1454,23 @@ bool pSketcherModel::Undo()
 
 	if(undo_available)
 	{
+		// discard any recorded changes that leave the values where they started, they cannot be coalesced with later changes
+		FlushUndoLog(database_);
+
         // Turn off foreign key enforcement until the end of this method since their
         // is no garuntee that the foreign key constraints will be satisfied until the undo is completed
-        char *zErrMsg = 0;
-        int rc;
-        rc = sqlite3_exec(database_, "PRAGMA foreign_keys = OFF;", 0, 0, &zErrMsg);
-        if( rc!=SQLITE_OK ){
-            std::string error_description = "SQL error: " + std::string(zErrMsg);
-            sqlite3_free(zErrMsg);
-            throw pSketcherException(error_description);
-        }
+        ExecuteSQL(database_, "PRAGMA foreign_keys = OFF;");
 
 		cerr << "new_stable_point = " << new_stable_point << ", current_stable_point = " << current_stable_point << endl;
 	
-		// retrieve the appropriate SQL commands to undo from the database and execute each on
-		sqlite3_stmt *statement;
-		
-		stringstream sql_command;
-		sql_command << "SELECT undo FROM undo_redo_list WHERE (id > " << new_stable_point << " AND id <= " << current_stable_point << ") ORDER BY id DESC;";
-	
-		rc = sqlite3_prepare(database_, sql_command.str().c_str(), -1, &statement, 0);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-	
-		rc = sqlite3_step(statement);
-			
-		stringstream current_undo_command;
-		vector<string> undo_command_list;	
-
-
-		while(rc == SQLITE_ROW) {
-			//retrieve the undo command	
-			current_undo_command.str("");
-			current_undo_command << sqlite3_column_text(statement,0);
-			undo_command_list.push_back(current_undo_command.str());
-
-			// go to the next row in the results
-			rc = sqlite3_step(statement);
-		}
-	
-		if( rc!=SQLITE_DONE ){
-			// sql statement didn't finish properly, some error must to have occured
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-	
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-	
-		// loop through all of the undo commands and excecute each one
-		vector<string>::iterator it_undo = undo_command_list.begin();
-		while(it_undo != undo_command_list.end())
-		{
-			//cout << "Current Undo Command: " << it_undo->c_str() << endl;
-
-			// execute the redo command
-			rc = sqlite3_exec(database_, it_undo->c_str(), 0, 0, &zErrMsg);
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "pSketcherModel error: SQL error in replaying redo commands. SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-			
-			it_undo++;
-		}
+		// apply the undo log entries between the two stable points in reverse order
+		ApplyUndoLog(database_, new_stable_point, current_stable_point, true);
 
 		// update the current stable point to reflect the undo operation
-		sql_command.str("");
-		sql_command << "UPDATE undo_stable_points SET bool_current_stable_point=1 WHERE id=" << current_row_id-1 << ";";
-		rc = sqlite3_exec(database_, sql_command.str().c_str(), 0, 0, &zErrMsg);
-		if( rc!=SQLITE_OK ){
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
-		}
+		CachedStatement(database_, "UPDATE undo_stable_points SET bool_current_stable_point=1 WHERE id=?;").Bind(1,current_row_id-1).Execute();
 
         // Turn foreign key enforcement back on
-        rc = sqlite3_exec(database_, "PRAGMA foreign_keys = ON;", 0, 0, &zErrMsg);
-        if( rc!=SQLITE_OK ){
-            std::string error_description = "SQL error: " + std::string(zErrMsg);
-            sqlite3_free(zErrMsg);
-            throw pSketcherException(error_description);
-        }
+        ExecuteSQL(database_, "PRAGMA foreign_keys = ON;");
 
 		// the final step is to synchronize the model to the current database
 		SyncToDatabase();
@@ -1567,96 +1491,24 @@ bool pSketcherModel::Redo()
 
 	if(redo_available)
 	{
+		// discard any recorded changes that leave the values where they started, they cannot be coalesced with later changes
+		FlushUndoLog(database_);
+
         // Turn off foreign key enforcement until the end of this method since their
         // is no garuntee that the foreign key constraints will be satisfied until the undo is completed
-        char *zErrMsg = 0;
-        int rc;
-        rc = sqlite3_exec(database_, "PRAGMA foreign_keys = OFF;", 0, 0, &zErrMsg);
-        if( rc!=SQLITE_OK ){
-            std::string error_description = "SQL error: " + std::string(zErrMsg);
-            sqlite3_free(zErrMsg);
-            throw pSketcherException(error_description);
-        }
-
-		// retrieve the appropriate SQL commands to redo from the database and execute each one
-		sqlite3_stmt *statement;
-		
-		stringstream sql_command;
-		sql_command << "SELECT redo FROM undo_redo_list WHERE (id <= " << new_stable_point << " AND id > " << current_stable_point << ") ORDER BY id ASC;";
-	
-		rc = sqlite3_prepare(database_, sql_command.str().c_str(), -1, &statement, 0);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-	
-		rc = sqlite3_step(statement);
-		
-		stringstream current_redo_command;
-		std::vector<string> redo_command_list;
-		
-		while(rc == SQLITE_ROW) {
-			//store the redo command	
-			current_redo_command.str("");
-			current_redo_command << sqlite3_column_text(statement,0);
-			redo_command_list.push_back(current_redo_command.str());
-
-			// go to the next row in the results
-			rc = sqlite3_step(statement);
-		}
-	
-		if( rc!=SQLITE_DONE ){
-			// sql statement didn't finish properly, some error must to have occured
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
-	
-		rc = sqlite3_finalize(statement);
-		if( rc!=SQLITE_OK ){
-			stringstream error_description;
-			error_description << "SQL error: " << sqlite3_errmsg(database_);
-			throw pSketcherException(error_description.str());
-		}
+        ExecuteSQL(database_, "PRAGMA foreign_keys = OFF;");
 
-		// loop through all of the redo commands and excecute each one
-		vector<string>::iterator it_redo = redo_command_list.begin();
-		while(it_redo != redo_command_list.end())
-		{
-			//cout << "Current Redo Command: " << it_redo->c_str() << endl;
-
-			// execute the redo command
-			rc = sqlite3_exec(database_, it_redo->c_str(), 0, 0, &zErrMsg);
-			if( rc!=SQLITE_OK ){
-				std::string error_description = "pSketcherModel error: SQL error in replaying redo commands. SQL error: " + std::string(zErrMsg);
-				sqlite3_free(zErrMsg);
-				throw pSketcherException(error_description);
-			}
-			
-			it_redo++;
-		}
+		// apply the undo log entries between the two stable points in order
+		ApplyUndoLog(database_, current_stable_point, new_stable_point, false);
 
 		// update the current stable point to reflect the redo operation
-		sql_command.str("");
-		sql_command << "UPDATE undo_stable_points SET bool_current_stable_point=1 WHERE id=" << current_row_id+1 << ";";
-		rc = sqlite3_exec(database_, sql_command.str().c_str(), 0, 0, &zErrMsg);
-		if( rc!=SQLITE_OK ){
-			std::string error_description = "SQL error: " + std::string(zErrMsg);
-			sqlite3_free(zErrMsg);
-			throw pSketcherException(error_description);
-		}
+		CachedStatement(database_, "UPDATE undo_stable_points SET bool_current_stable_point=1 WHERE id=?;").Bind(1,current_row_id+1).Execute();
 
 		// the final step is to synchronize the model to the current database
 		SyncToDatabase();
 
         // Turn foreign key enforcement back on
-        rc = sqlite3_exec(database_, "PRAGMA foreign_keys = ON;", 0, 0, &zErrMsg);
-        if( rc!=SQLITE_OK ){
-            std::string error_description = "SQL error: " + std::string(zErrMsg);
-            sqlite3_free(zErrMsg);
-            throw pSketcherException(error_description);
-        }
+        ExecuteSQL(database_, "PRAGMA foreign_keys = ON;");
 
 		return true;
 	} else {
@@ -1717,8 +1569,7 @@ bool pSketcherModel::ExportDXF(const std::string &file_name)
 // old_dof must exist in the database
 void pSketcherModel::ReplaceDOF(DOFPointer old_dof, DOFPointer new_dof)
 {
-    stringstream undo_commands;
-    stringstream redo_commands;
+	CancelAsyncSolve();
 
     // Make sure the old_dof exists in the model
     map<unsigned,DOFPointer>::iterator dof_it = dof_list_.find(old_dof->GetID());
@@ -1739,66 +1590,15 @@ void pSketcherModel::ReplaceDOF(DOFPointer old_dof, DOFPointer new_dof)
     // Find all occurences of old_dof and the database and replace with new_dof
     // The foreign key relationships in the database schema are used to locate the
     // orcurrances of old_dof
-    char *zErrMsg = 0;
-    int rc;
-    sqlite3_stmt *statement;
-    string table_list_sql_command = "SELECT name FROM sqlite_master WHERE type='table';";
-
-    rc = sqlite3_prepare(database_, table_list_sql_command.c_str(), -1, &statement, 0);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
-    }
-
-    rc = sqlite3_step(statement);
-    stringstream current_table_name;
-    while(rc == SQLITE_ROW) {
-        current_table_name.str("");
-        current_table_name << sqlite3_column_text(statement,0);
-
-        // use the following utility function to generate the required SQL commands
-        // this method appends redo_commands and undo_commands string with the commands needed for the particular table
-        GetReplaceDOFSQLCommands(current_table_name.str(), old_dof, new_dof, redo_commands, undo_commands);
-
-        rc = sqlite3_step(statement);
-    }
-
-    if( rc!=SQLITE_DONE ){
-        // sql statement didn't finish properly, some error must to have occured
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
-    }
-
-    rc = sqlite3_finalize(statement);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
+    vector<string> table_names;
+    {
+        CachedStatement table_list(database_, "SELECT name FROM sqlite_master WHERE type='table';");
+        while(table_list.Step())
+            table_names.push_back(table_list.GetText(0));
     }
 
-   if(redo_commands.str().size() > 0)  // There are changes that need to be made so go ahead and do those changes
-    { 
-        // Now execute the the SQL commands to modify the database
-        rc = sqlite3_exec(database_, redo_commands.str().c_str(), 0, 0, &zErrMsg);
-        if( rc!=SQLITE_OK ){
-            std::string error_description = "SQL error: " + std::string(zErrMsg);
-            sqlite3_free(zErrMsg);
-            throw pSketcherException(error_description);
-        }
-    
-        // Update the undo_redo_list in the database with the database changes that have just been made
-        // need to use sqlite3_mprintf to make sure the single quotes in the sql statements get escaped where needed
-        char *sql_undo_redo = sqlite3_mprintf("INSERT INTO undo_redo_list(undo,redo) VALUES('%q','%q')",undo_commands.str().c_str(),redo_commands.str().c_str());
-    
-        rc = sqlite3_exec(database_, sql_undo_redo, 0, 0, &zErrMsg);
-        if( rc!=SQLITE_OK ){
-            std::string error_description = "SQL error: " + std::string(zErrMsg);
-            sqlite3_free(zErrMsg);
-            throw pSketcherException(error_description);
-        }
-    }
+    for(unsigned int i = 0; i < table_names.size(); i++)
+        ReplaceDOFInTable(table_names[i], old_dof, new_dof);
 
     // delete the existing old_dof entry in the database
     old_dof->RemoveFromDatabase();
@@ -1807,102 +1607,51 @@ void pSketcherModel::ReplaceDOF(DOFPointer old_dof, DOFPointer new_dof)
     SyncToDatabase();
 }
 
-void pSketcherModel::GetReplaceDOFSQLCommands(const std::string &table_name, DOFPointer old_dof, DOFPointer new_dof, std::stringstream &redo_command, std::stringstream &undo_command)
+// Replaces old_dof with new_dof in each column of table_name that references dof_list and records the changes in the undo log
+void pSketcherModel::ReplaceDOFInTable(const std::string &table_name, DOFPointer old_dof, DOFPointer new_dof)
 {
-    // Query this table for columns that relate to the column id of the table dof_lsit
-    char *zErrMsg = 0;
-    int rc;
-    sqlite3_stmt *statement;
-    stringstream sql_command;
-    sql_command << "PRAGMA foreign_key_list(" << table_name << ");";
-
-    rc = sqlite3_prepare(database_, sql_command.str().c_str(), -1, &statement, 0);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
+    // Query this table for columns that relate to the column id of the table dof_list
+    vector<string> dof_columns;
+    {
+        CachedStatement foreign_keys(database_, "PRAGMA foreign_key_list(" + table_name + ");");
+        while(foreign_keys.Step())
+            if(foreign_keys.GetText(2) == "dof_list") // table that the foreign key relates to
+                dof_columns.push_back(foreign_keys.GetText(3)); // column in table_name that has the foreign key
     }
 
-    rc = sqlite3_step(statement);
-    const char* foreign_table;
-    const char* foreign_column;
-    const char* local_column;
-    vector<unsigned> rowid_list;
-    while(rc == SQLITE_ROW) {
+    if(dof_columns.size() == 0)
+        return;
 
-        foreign_table = reinterpret_cast<const char*>(sqlite3_column_text(statement,2)); // table that foreign key relates to
-        local_column = reinterpret_cast<const char*>(sqlite3_column_text(statement,3)); // column in table that has the foreign key
-        foreign_column = reinterpret_cast<const char*>(sqlite3_column_text(statement,4)); // column that foreign key relates to
+    // the rows are identified in the undo log by their primary key
+    vector<string> key_columns;
+    GetPrimaryKeyColumns(database_, table_name, key_columns);
 
-        if(strcmp(foreign_table,"dof_list") == 0)
-        {
-            // Get the ROWID values for the rows, if any, that contain old_dof
-            GetROWIDList(table_name.c_str(),local_column,old_dof->GetID(),rowid_list);
+    string key_list;
+    for(unsigned int i = 0; i < key_columns.size(); i++)
+        key_list += (i == 0 ? "" : ",") + key_columns[i];
 
-            // now define the SQL commands to replace any occurances of old_dof
-            for(int i = 0; i < rowid_list.size(); i++)
+    for(unsigned int i = 0; i < dof_columns.size(); i++)
+    {
+        // Get the keys of the rows, if any, that contain old_dof
+        vector<vector<DatabaseValue> > row_keys;
+        {
+            CachedStatement select_rows(database_, "SELECT " + key_list + " FROM " + table_name + " WHERE " + dof_columns[i] + "=?;");
+            select_rows.Bind(1,old_dof->GetID());
+            while(select_rows.Step())
             {
-                redo_command << " UPDATE " << table_name << " SET " << local_column << "=" << new_dof->GetID() << " WHERE ROWID=" << rowid_list[i] << ";";
-                undo_command << " UPDATE " << table_name << " SET " << local_column << "=" << old_dof->GetID() << " WHERE ROWID=" << rowid_list[i] << ";";
+                row_keys.push_back(vector<DatabaseValue>());
+                for(unsigned int j = 0; j < key_columns.size(); j++)
+                    row_keys.back().push_back(select_rows.GetValue(j));
             }
         }
 
-        rc = sqlite3_step(statement);
-    }
+        if(row_keys.size() == 0)
+            continue;
 
-    if( rc!=SQLITE_DONE ){
-        // sql statement didn't finish properly, some error must to have occured
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
-    }
-
-    rc = sqlite3_finalize(statement);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
-    }
-}
-
-// Query the table table_name for rows that contain id_to_be_replaced in the column col_name
-// Store the ROWID for the rows found in the vector rowid_list
-void pSketcherModel::GetROWIDList(const char *table_name, const char *col_name, const unsigned id_to_be_replaced, std::vector<unsigned> &rowid_list)
-{
-    // clear the contents of the rowid vector
-    rowid_list.clear();
-
-    char *zErrMsg = 0;
-    int rc;
-    sqlite3_stmt *statement;
-    stringstream sql_command;
-    sql_command << "SELECT ROWID FROM " << table_name << " WHERE " << col_name << "=" << id_to_be_replaced << ";";
-
-    rc = sqlite3_prepare(database_, sql_command.str().c_str(), -1, &statement, 0);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
-    }
-
-    rc = sqlite3_step(statement);
-    while(rc == SQLITE_ROW) {
-        rowid_list.push_back(sqlite3_column_int(statement,0));
-
-        rc = sqlite3_step(statement);
-    }
-
-    if( rc!=SQLITE_DONE ){
-        // sql statement didn't finish properly, some error must to have occured
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
-    }
+        CachedStatement update(database_, "UPDATE " + table_name + " SET " + dof_columns[i] + "=? WHERE " + dof_columns[i] + "=?;");
+        update.Bind(1,new_dof->GetID()).Bind(2,old_dof->GetID()).Execute();
 
-    rc = sqlite3_finalize(statement);
-    if( rc!=SQLITE_OK ){
-        stringstream error_description;
-        error_description << "SQL error: " << sqlite3_errmsg(database_);
-        throw pSketcherException(error_description.str());
+        for(unsigned int j = 0; j < row_keys.size(); j++)
+            RecordValueChange(database_, table_name, dof_columns[i], row_keys[j], (int)old_dof->GetID(), (int)new_dof->GetID());
     }
 }
@@ -24,11 +24,41 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string>
 #include <map>
+#include <set>
+#include <pthread.h>
 
 #include "../sqlite3/sqlite3.h"
 #include "Primitives.h"
 #include "ConstraintSolver.h"
 
+class DatabaseSnapshot;
+
+// Final value of one constraint equation after a solve
+struct ConstraintResidual
+{
+	ConstraintResidual(unsigned id = 0, const std::string &name = "", double value = 0.0) : constraint_id(id), function_name(name), residual(value) {;}
+
+	unsigned constraint_id;     // id of the constraint equation
+	std::string function_name;  // solver function type of the constraint equation
+	double residual;            // zero when the constraint is satisfied
+};
+
+// Summary of one SolveConstraints call, passed to pSketcherModel::SolveCompleted and available from GetSolveReport
+struct SolveReport
+{
+	SolveReport() : total_time(0.0), partition_time(0.0), apply_solution_time(0.0), final_merit(0.0) {;}
+
+	SolverStatistics statistics;  // summed over the clusters that were solved
+
+	// wall times in seconds
+	double total_time;
+	double partition_time;
+	double apply_solution_time;   // writing the solution to the DOF's and the database
+
+	double final_merit;           // weighted sum of the squared residuals of the constraint equations in the constraint clusters
+	std::vector<ConstraintResidual> residuals; // every constraint equation, only filled in if solve profiling is enabled (see SetSolveProfiling)
+};
+
 class pSketcherModel
 {
 public:
@@ -37,10 +67,11 @@ public:
 
 	pSketcherModel(const std::string &file_name, PrimitiveBasePointer (*current_primitive_factory)(unsigned, pSketcherModel &) = pSketcherModel::PrimitiveFactory, ConstraintEquationBasePointer (*current_constraint_factory)(unsigned, pSketcherModel &) = pSketcherModel::ConstraintFactory);  // construct from file
 
-	~pSketcherModel();
+	virtual ~pSketcherModel();
 	
 	// methods used to manage the sqlite3 database, this database is used to implement saving to file and undo/redo functionality
 	void InitializeDatabase();
+	void UpgradeDatabase(); // brings a database that was written by an older version of pSketcher up to the current schema
 
 	// Constraint equation management
 	virtual void AddConstraintEquation(const ConstraintEquationBasePointer &new_constraint_equation, bool update_database = true);
@@ -58,6 +89,25 @@ public:
     void DeleteSelected();
 
 	void SolveConstraints();
+	// anytime solve used while dragging, stops after time_budget seconds or when *cancel_flag becomes non-zero and applies the best iterate found so far
+	// the database is not updated, the solved clusters are solved again and saved by the next call to SolveConstraints()
+	void SolveConstraintsInteractive(double time_budget, const int *cancel_flag = 0);
+
+	// asynchronous solve, the thread that owns the model never waits for the numerical solve
+	// SolveConstraintsAsync partitions the model and takes a snapshot of the DOF values of the modified clusters on the calling thread, the
+	// clusters are then solved on a background thread which calls AsyncSolveFinished when it is done. The owner of the model then calls
+	// ApplyAsyncSolve from its own thread to write the solution to the DOF's and the database. A new call to SolveConstraintsAsync (or to
+	// SolveConstraints) supersedes a solve that is still running, the old solve is cancelled and its result is discarded. The solution of a
+	// cluster with a DOF that was edited, freed, or fixed after the snapshot is not written, the edit is kept and the next solve takes it up.
+	unsigned SolveConstraintsAsync(); // returns the request number passed to AsyncSolveFinished
+	bool ApplyAsyncSolve(unsigned request); // returns false if the request has been superseded or has not finished
+	void CancelAsyncSolve(); // cancels the running solve, if any, and waits for the background thread to exit
+	void SetSolverEngine(SOLVER_ENGINE solver_engine) {solver_engine_ = solver_engine;} // select the numerical method used by SolveConstraints
+	SOLVER_ENGINE GetSolverEngine() const {return solver_engine_;}
+	const SolveReport & GetSolveReport() const {return solve_report_;} // work done by the last call to SolveConstraints
+	void SetSolveProfiling(bool profiling) {solve_profiling_ = profiling;} // if true the solve report includes the time spent in each solver function type and the residual of each constraint equation
+	void SetRobustSolve(const RobustSolveOptions &robust) {robust_solve_options_ = robust;} // multi-start options used by SolveConstraints, a single start by default
+	const RobustSolveOptions & GetRobustSolve() const {return robust_solve_options_;}
 
 	void UpdateDisplay();
 
@@ -84,6 +134,7 @@ public:
 	template <class data_t> boost::shared_ptr<data_t> FetchConstraint(unsigned id);
 	
 	sqlite3 *GetDatabase() {return database_;}
+	DatabaseSnapshot *GetSnapshot() {return snapshot_;} // the snapshot that SyncToDatabase is currently reading from, 0 at all other times
 
 	// methods to implement undo/redo functionality
 	bool Undo();
@@ -92,12 +143,26 @@ public:
 	bool IsUndoAvailable(int &current_stable_point, int &new_stable_point, int &current_row_id /* current row id of table undo_stable_points */, std::string &description);
 	bool IsRedoAvailable(std::string &description);
 	bool IsRedoAvailable(int &current_stable_point, int &new_stable_point, int &current_row_id /* current row id of table undo_stable_points */, std::string &description);
-	void MarkStablePoint(const std::string &description);
+	void MarkStablePoint(const std::string &description); // the changes made since the previous stable point are written to the undo log as one entry
+
+	// batch edits, the database changes made until the matching EndBatchEdit are made in one transaction,
+	// batches may be nested, prefer the BatchEdit scope class to calling these directly
+	// if the transaction cannot be committed it is rolled back, the model is read from the database again, and EndBatchEdit throws
+	void BeginBatchEdit();
+	void EndBatchEdit();
 
 	// methods for importing and exporting geometry
 	bool ExportDXF(const std::string &file_name);
 
 protected:
+	// called at the end of each SolveConstraints call, override to collect the solve reports
+	virtual void SolveCompleted(const SolveReport &report) {;}
+
+	// called from the background thread when an asynchronous solve finishes, must not access the model, see SolveConstraintsAsync
+	// a derived class that overrides this must call CancelAsyncSolve in its own destructor, the pSketcherModel destructor runs after the
+	// derived part of the object is gone and the background thread could otherwise still call the override
+	virtual void AsyncSolveFinished(unsigned request) {;}
+
 	// methods for generating objects directly from the database
 	DOFPointer DOFFactory(unsigned id);
 	static PrimitiveBasePointer PrimitiveFactory(unsigned id, pSketcherModel &psketcher_model);
@@ -116,17 +181,67 @@ private:
 	void DeleteFlagged(bool remove_from_db = true); // delete all of the primitives that have been flagged for deletion
 	void DeleteUnusedDOFs(bool remove_from_db = true); // delete all unused DOF's in the dof_list_ container
 
-    // utility methods used by ReplaceDOF and ReplacePrimitive
-    void GetReplaceDOFSQLCommands(const std::string &table_name, DOFPointer old_dof, DOFPointer new_dof, std::stringstream &redo_command, std::stringstream &undo_command);
-    void GetROWIDList(const char *table_name, const char *col_name, const unsigned id_to_be_replaced, std::vector<unsigned> &rowid_list);
+	void SolveConstraints(const SolveLimits &limits, bool update_database);
+	std::vector<unsigned> PrepareSolve(); // partitions the model if needed, returns the modified clusters and takes their snapshots
+	void FinishSolve(const std::vector<unsigned> &solve_order, bool update_database, double solve_start, double partition_time); // applies the solution and completes the solve report
+	static void *AsyncSolveThread(void *psketcher_model);
+	void PartitionConstraints(std::vector<ConstraintCluster> &clusters); // split the constraint equations into independent clusters for SolveConstraints
+	void InvalidateConstraintClusters(bool solve_all = false); // called when constraints or DOF's are added, deleted, or replaced, if solve_all is true every cluster is solved by the next SolveConstraints call
+
+    // utility method used by ReplaceDOF
+    void ReplaceDOFInTable(const std::string &table_name, DOFPointer old_dof, DOFPointer new_dof);
 
 	SelectionMask current_selection_mask_;
 
 	// SQLite3 database that will be used to implement file save and undo/redo
 	sqlite3 *database_;
+	DatabaseSnapshot *snapshot_;
 
 	// current file name
 	std::string current_file_name_;
+
+	// numerical method used by SolveConstraints
+	SOLVER_ENGINE solver_engine_;
+	SolveReport solve_report_;
+	bool solve_profiling_;
+	RobustSolveOptions robust_solve_options_;
+
+	// persistent solver structure, SolveConstraints only solves the clusters affected by changes since the last solve
+	std::vector<ConstraintCluster> constraint_clusters_;
+	bool repartition_required_;
+	std::set<unsigned> solved_constraint_ids_; // constraint equations that have been solved at least once in their current cluster
+
+	// the solve running on the background thread, the solver settings are copied when it starts
+	struct AsyncSolveRequest
+	{
+		unsigned number;
+		std::vector<unsigned> solve_order;
+		SOLVER_ENGINE solver_engine;
+		bool profiling;
+		RobustSolveOptions robust;
+		double start_time;
+		double partition_time;
+	};
+	AsyncSolveRequest async_request_;
+	unsigned num_async_requests_;
+	pthread_t async_thread_;
+	bool async_running_;       // async_thread_ has been started and not joined
+	int async_cancel_;         // read and written with the __atomic builtins
+	bool async_finished_;      // async_finished_ and async_error_ are set by the background thread and protected by async_lock_
+	bool async_error_;
+	pthread_mutex_t async_lock_;
+};
+
+// Opens a batch edit on psketcher_model for the lifetime of this object, nothing is done if active is false
+class BatchEdit
+{
+public:
+	BatchEdit(pSketcherModel &psketcher_model, bool active = true) : psketcher_model_(psketcher_model), active_(active) {if(active_) psketcher_model_.BeginBatchEdit();}
+	~BatchEdit();
+
+private:
+	pSketcherModel &psketcher_model_;
+	bool active_;
 };
 
 
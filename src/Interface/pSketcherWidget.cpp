@@ -228,6 +228,7 @@ void pSketcherWidget::GenerateDefaultSketch()
 	VectorPointer up( new Vector(0.0,1.0,0.0));
 	PointPointer base( new Point(0.0,0.0,0.0));
 	current_sketch_ = QtSketchPointer(new QtSketch(scene(),normal, up, base));
+	current_sketch_->SetSolveReceiver(this);
 
 	modelChanged(tr("Initialize Sketch"));
 }
@@ -287,10 +288,10 @@ void pSketcherWidget::GenerateTestSketch()
 	std::cout << "Expression for DependentDOF 22 (from memory)= " << test_dof_3->GetExpression() << ", value = " << test_dof_3->GetValue() << ", free = " << test_dof_3->IsFree() << ", dependent = " << test_dof_3->IsDependent() << ", name = " << test_dof_3->GetVariable().get_name() << std::endl;
 
 	Point2DPointer test_point = current_sketch_->FetchPrimitive<Point2D>(10);
-	test_point->SyncListsToDatabase("dof_table_10","primitive_table_10",*current_sketch_);	
+	test_point->SyncListsToDatabase(*current_sketch_);	
 
 	DistancePoint2DPointer test_constraint = current_sketch_->FetchConstraint<DistancePoint2D>(19);
-	//test_constraint->SyncListsToDatabase("dof_table_19","primitive_table_19",*current_sketch_);
+	//test_constraint->SyncListsToDatabase(*current_sketch_);
 	//test_constraint->SyncConstraintListToDatabase("constraint_table_19",*current_sketch_);
 	*/
 
@@ -337,9 +338,16 @@ void pSketcherWidget::GenerateTestSketch()
 
 void pSketcherWidget::SolveConstraints() 
 {
+	// the solve runs in the background, asyncSolveFinished displays the result
 	if(current_sketch_ != 0)
+		current_sketch_->SolveConstraintsAsync();
+}
+
+void pSketcherWidget::asyncSolveFinished(unsigned int request)
+{
+	// ignored if a newer solve has been started since
+	if(current_sketch_ != 0 && current_sketch_->ApplyAsyncSolve(request))
 	{
-		current_sketch_->SolveConstraints();
 		current_sketch_->UpdateDisplay();
 
 		modelChanged(tr("Solve constraints"));
@@ -535,6 +543,7 @@ void pSketcherWidget::open()
 	{
 		delete current_sketch_;
 		current_sketch_ = new QtSketch(scene(),file_name.toStdString());
+		current_sketch_->SetSolveReceiver(this);
 	}
 }
 
@@ -556,6 +565,7 @@ void pSketcherWidget::newFile()
 	VectorPointer up( new Vector(0.0,1.0,0.0));
 	PointPointer base( new Point(0.0,0.0,0.0));
 	current_sketch_ = QtSketchPointer(new QtSketch(scene(),normal, up, base));
+	current_sketch_->SetSolveReceiver(this);
 
 	modelChanged(tr("Intialize sketch"));
 }
@@ -61,6 +61,7 @@ class pSketcherWidget : public QGraphicsView
         void GenerateTestSketch();
         void ExecutePythonScript();
         void SolveConstraints();
+        void asyncSolveFinished(unsigned int request);
 
         void select(); // overides the select solot for QoccViewWidget
 
@@ -1,5 +1,6 @@
 
 #include <iostream>
+#include <unistd.h>
 #include "../ConstraintSolver/Sketch.h"
 
 int main(int argc, char *argv[])
@@ -37,4 +38,32 @@ int main(int argc, char *argv[])
     
     std::cout << "Starting constraint solver..." << std::endl;
     current_sketch->SolveConstraints();
+
+    // a DOF edited while an asynchronous solve is running must keep its new value when the solution is applied
+    Point2DPointer anchor_point = current_sketch->AddPoint2D(20.0,0.0,false,false);
+    Point2DPointer drag_point = current_sketch->AddPoint2D(20.0,5.0,true,true);
+    current_sketch->AddDistancePoint2D(anchor_point,drag_point,8.0);
+
+    unsigned request = current_sketch->SolveConstraintsAsync();
+    drag_point->GetSDOF()->SetValue(25.0);
+    while(!current_sketch->ApplyAsyncSolve(request))
+        usleep(1000);
+
+    if(drag_point->GetSValue() != 25.0)
+    {
+        std::cerr << "Error: the asynchronous solve overwrote a DOF that was edited while it was running." << std::endl;
+        return 1;
+    }
+    std::cout << "Edit made during the asynchronous solve was kept." << std::endl;
+
+    // the edited cluster is still modified and is solved by the next solve
+    current_sketch->SolveConstraints();
+    if(current_sketch->GetSolveReport().statistics.clusters_solved != 1)
+    {
+        std::cerr << "Error: the cluster edited during the asynchronous solve was not solved again." << std::endl;
+        return 1;
+    }
+
+    delete current_sketch;
+    return 0;
 }
\ No newline at end of file
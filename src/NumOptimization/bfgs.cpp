@@ -20,7 +20,9 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include <iostream>
+#include <vector>
 #include "bfgs.h"
+#include "../mmcMatrix/mmcFixedMatrix.h"
 
 using namespace std;
 
@@ -281,12 +283,12 @@ double MeritFunction::BackTrack(const mmcMatrix &position, const mmcMatrix &grad
 
 	double lambda = 1.0;
 
-	mmcMatrix new_position;
+	mmcMatrix new_position(NumDimensions,1);
 	double prev_new_merit_value = 0;
 	double lambda_temp, lambda_prev = 0, disc;
-	mmcMatrix temp1(2,2);
-	mmcMatrix temp2(2,1);
-	mmcMatrix result;
+	mmcFixedMatrix<2,2> temp1;
+	mmcFixedMatrix<2,1> temp2;
+	mmcFixedMatrix<2,1> result;
 	double a,b;
 
     bool finished_first_backtrack = false;	
@@ -302,7 +304,9 @@ double MeritFunction::BackTrack(const mmcMatrix &position, const mmcMatrix &grad
 			return lambda;
 		}
 
-		new_position = position + search_dir.GetScaled(lambda);
+		// new_position = position + lambda*search_dir, computed in place to avoid temporaries
+		for(int i = 0; i < NumDimensions; i++)
+			new_position(i,0) = position(i,0) + lambda*search_dir(i,0);
 		GetMeritValuePlusGradient(new_position, new_merit, new_gradient);
 		MeritEvals++;
 		
@@ -370,6 +374,45 @@ double MeritFunction::BackTrack(const mmcMatrix &position, const mmcMatrix &grad
 
 
 /*********************************************************************/
+// Calculates the search direction using the limited memory BFGS two-loop recursion
+// position_changes and gradient_changes hold the most recent correction pairs, oldest first
+// Both the memory use and the work are proportional to the number of pairs times NumDimensions
+mmcMatrix MeritFunction::GetNextLbfgsSearchDir(const mmcMatrix &current_gradient,
+											const std::deque<mmcMatrix> &position_changes,
+											const std::deque<mmcMatrix> &gradient_changes)const
+{
+	int num_pairs = position_changes.size();
+	std::vector<double> rho(num_pairs);
+	std::vector<double> alpha(num_pairs);
+
+	mmcMatrix q = current_gradient;
+
+	// first loop, newest pair to oldest pair
+	for(int i = num_pairs - 1; i >= 0; i--)
+	{
+		rho[i] = 1.0 / gradient_changes[i].DotProduct(position_changes[i]);
+		alpha[i] = rho[i] * position_changes[i].DotProduct(q);
+		q -= gradient_changes[i].GetScaled(alpha[i]);
+	}
+
+	// the initial inverse hessian approximation is a scaled identity matrix
+	if(num_pairs > 0)
+	{
+		double gamma = position_changes[num_pairs-1].DotProduct(gradient_changes[num_pairs-1]) /
+		               gradient_changes[num_pairs-1].DotProduct(gradient_changes[num_pairs-1]);
+		q *= gamma;
+	}
+
+	// second loop, oldest pair to newest pair
+	for(int i = 0; i < num_pairs; i++)
+	{
+		double beta = rho[i] * gradient_changes[i].DotProduct(q);
+		q += position_changes[i].GetScaled(alpha[i] - beta);
+	}
+
+	return q.GetScaled(-1.0);
+}
+
 mmcMatrix MeritFunction::GetNextBfgsSearchDir(const mmcMatrix &current_position, 
 											const mmcMatrix &previous_position,
 											const mmcMatrix &current_gradient,
@@ -445,18 +488,13 @@ mmcMatrix MeritFunction::GetNextBfgsSearchDir(const mmcMatrix &current_position,
 	**  Will first calculate p
 	** p = current_position - previous_position
 	*/
-	//p = current_position - previous_position;
-  p = current_position;
-  p -= previous_position;
+	p = current_position - previous_position;
   
 	/*
 	**  Now will evaluate y
 	**  y = current_gradient - previous_gradient
 	*/
-	/*  First need to multiply the previous gradient by -1 */
-	//y = current_gradient - previous_gradient;
-  y = current_gradient;
-  y -= previous_gradient;
+	y = current_gradient - previous_gradient;
 
 	/*
 	**  Will now calculate sigma
@@ -495,9 +533,7 @@ mmcMatrix MeritFunction::GetNextBfgsSearchDir(const mmcMatrix &current_position,
 	**  Can now calculate the current inv hessian
 	** inv_hessian = prev_inv_hessan + d
 	*/
-	//new_inv_hessian = prev_inv_hessian + d;
-  new_inv_hessian = prev_inv_hessian;
-  new_inv_hessian += d;
+	new_inv_hessian = prev_inv_hessian + d;
   
 	/*
 	**  Can now calculate the new search direction
@@ -631,6 +667,10 @@ mmcMatrix MeritFunction::MinimizeMeritFunction(const mmcMatrix &x_init, double s
 {
   MaxMeritEvals = max_merit_evals;
   MeritEvals = 0;
+  Iterations = 0;
+  LineSearchTime = 0.0;
+  SearchDirectionTime = 0.0;
+  Interrupted = false;
 	
   out_buf = output_buffer;
 	
@@ -644,8 +684,10 @@ mmcMatrix MeritFunction::MinimizeMeritFunction(const mmcMatrix &x_init, double s
   mmcMatrix prev_gradient;
   double prev_merit, new_merit;
   mmcMatrix current_gradient;
-  mmcMatrix prev_inv_hessian(NumDimensions, NumDimensions);
+  mmcMatrix prev_inv_hessian;
   mmcMatrix current_inv_hessian;
+  std::deque<mmcMatrix> position_changes; // correction pairs used by the limited memory update
+  std::deque<mmcMatrix> gradient_changes;
   mmcMatrix displacement_vector;
   mmcMatrix x_previous;
   mmcMatrix search_dir;
@@ -673,13 +715,19 @@ mmcMatrix MeritFunction::MinimizeMeritFunction(const mmcMatrix &x_init, double s
     
       /*
       **  assign prev_inv_hessian_pp to the identity matrix
+      **  (the limited memory update never forms the inverse hessian)
       */
-	  prev_inv_hessian.SetIdentity();
+	  if(LbfgsHistory <= 0)
+	  {
+		  prev_inv_hessian.SetSize(NumDimensions, NumDimensions);
+		  prev_inv_hessian.SetIdentity();
+	  }
 
       /* 
       **  set the current x equal to the initial x
       */
       x_previous = x_init;
+      x_best = x_init; // returned if the first iteration is interrupted
 
       /*
       **  Calculate the gradient at the initial position
@@ -719,7 +767,14 @@ mmcMatrix MeritFunction::MinimizeMeritFunction(const mmcMatrix &x_init, double s
       */
       for (count = 0; count < maxit; count++)
 	{
+	  if(IsCancelled())
+	  {
+		  Interrupted = true;
+		  break;
+	  }
 
+	  Iterations++;
+	  double phase_start = GetSolverTime();
 
 	  if(LineSearch == GOLDEN_SECTION)
 	  {
@@ -758,6 +813,8 @@ mmcMatrix MeritFunction::MinimizeMeritFunction(const mmcMatrix &x_init, double s
 	    lambda_mid = 0.0;
 	  }
 
+	  LineSearchTime += GetSolverTime() - phase_start;
+
 	  /* 
 	  **  get the value for the current x position
 	  */
@@ -801,8 +858,29 @@ mmcMatrix MeritFunction::MinimizeMeritFunction(const mmcMatrix &x_init, double s
 	  /*
 	  **  Calculate the next search direction using bfgs method
 	  */
-	  search_dir = GetNextBfgsSearchDir(x_best, x_previous, current_gradient, prev_gradient,
-		                                prev_inv_hessian, current_inv_hessian);
+	  phase_start = GetSolverTime();
+	  if(LbfgsHistory > 0)
+	  {
+		  // store the newest correction pair, pairs that do not satisfy the curvature condition are skipped to keep the update positive definite
+		  mmcMatrix position_change = x_best - x_previous;
+		  mmcMatrix gradient_change = current_gradient - prev_gradient;
+		  if(position_change.DotProduct(gradient_change) > 1.0e-10 * gradient_change.DotProduct(gradient_change))
+		  {
+			  position_changes.push_back(position_change);
+			  gradient_changes.push_back(gradient_change);
+			  if((int)position_changes.size() > LbfgsHistory)
+			  {
+				  position_changes.pop_front();
+				  gradient_changes.pop_front();
+			  }
+		  }
+
+		  search_dir = GetNextLbfgsSearchDir(current_gradient, position_changes, gradient_changes);
+	  } else {
+		  search_dir = GetNextBfgsSearchDir(x_best, x_previous, current_gradient, prev_gradient,
+			                                prev_inv_hessian, current_inv_hessian);
+	  }
+	  SearchDirectionTime += GetSolverTime() - phase_start;
 
 	  /*
 	  **  Check that search direction is still pointing in a 
@@ -817,7 +895,13 @@ mmcMatrix MeritFunction::MinimizeMeritFunction(const mmcMatrix &x_init, double s
     			**  gradient
     			*/
     		  search_dir = current_gradient.GetScaled(-1.0);
-    			current_inv_hessian.SetIdentity();
+    			if(LbfgsHistory > 0)
+    			{
+    				position_changes.clear();
+    				gradient_changes.clear();
+    			} else {
+    				current_inv_hessian.SetIdentity();
+    			}
 
     			if(VerboseLevel >= 1)
  			  		*out_buf << "Started going the wrong way!!!  Now going opposite of gradient.\n"; 					
@@ -915,7 +999,7 @@ double GetRandomNumber(double lower_limit, double upper_limit)
 
 
 
-mmcMatrix MeritFunction::MonteCarloOptimization(const mmcMatrix &x_init, const mmcMatrix &x_delta, int number_iterations, int verbose_level)
+mmcMatrix MeritFunction::MonteCarloOptimization(const mmcMatrix &x_init, const mmcMatrix &x_delta, int number_iterations, int verbose_level, bool include_initial)
 {
 	VerboseLevel = verbose_level;
 
@@ -925,7 +1009,7 @@ mmcMatrix MeritFunction::MonteCarloOptimization(const mmcMatrix &x_init, const m
 	double temp_merit;
 	double current_merit_min;
 	
-	current_merit_min = GetMeritValue(x_init);
+	current_merit_min = include_initial ? GetMeritValue(x_init) : HUGE_VAL;
 	
 	if (VerboseLevel >= 1)
 		cout << "Current merit value = " << current_merit_min << "\n";
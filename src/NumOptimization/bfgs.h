@@ -26,7 +26,9 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <math.h>
 #include <time.h>
+#include <deque>
 #include "../mmcMatrix/mmcMatrix.h"
+#include "solver_timer.h"
 
 enum LINE_SEARCH {GOLDEN_SECTION, BACK_TRACK}; 
 
@@ -37,8 +39,8 @@ class MeritFunction
 public:
 	
 	//Constructors and destructors (must be overridden by child class)
-	MeritFunction(LINE_SEARCH line_search = BACK_TRACK) {LineSearch = line_search;} //The child class virtual constructor must initialize NumDimensions
-	MeritFunction(int num_dims, LINE_SEARCH line_search = BACK_TRACK) {NumDimensions = num_dims; LineSearch = line_search;}
+	MeritFunction(LINE_SEARCH line_search = BACK_TRACK) {LineSearch = line_search; LbfgsHistory = 0; Iterations = 0; LineSearchTime = 0.0; SearchDirectionTime = 0.0; CancelFlag = 0; Deadline = 0.0; Interrupted = false;} //The child class virtual constructor must initialize NumDimensions
+	MeritFunction(int num_dims, LINE_SEARCH line_search = BACK_TRACK) {NumDimensions = num_dims; LineSearch = line_search; LbfgsHistory = 0; Iterations = 0; LineSearchTime = 0.0; SearchDirectionTime = 0.0; CancelFlag = 0; Deadline = 0.0; Interrupted = false;}
 	virtual ~MeritFunction() {} 
 	
 	
@@ -52,6 +54,25 @@ public:
 	//acessors
 	int GetNumDims() const {return NumDimensions;}
 	void SetNumDims(int num_dims) {NumDimensions = num_dims;}
+
+	// Number of correction pairs kept by the limited memory BFGS update (typically 5 to 20)
+	// 0 selects the dense BFGS update which stores the full NumDimensions x NumDimensions inverse hessian
+	void SetLbfgsHistory(int history) {LbfgsHistory = history;}
+	int GetLbfgsHistory() const {return LbfgsHistory;}
+
+	int GetNumIterations() const {return Iterations;} // number of iterations taken by the last call to MinimizeMeritFunction
+
+	// seconds spent by the last call to MinimizeMeritFunction in the line search (including the merit evaluations it makes) and in
+	// computing the search direction (the inverse hessian or limited memory update)
+	double GetLineSearchTime() const {return LineSearchTime;}
+	double GetSearchDirectionTime() const {return SearchDirectionTime;}
+
+	// MinimizeMeritFunction returns the best position found so far at the start of the first iteration after *cancel_flag becomes
+	// non-zero or GetSolverTime() passes the deadline, the flag may be set from another thread with __atomic_store_n, 0 disables either check
+	void SetCancelFlag(const int *cancel_flag) {CancelFlag = cancel_flag;}
+	void SetDeadline(double deadline) {Deadline = deadline;}
+	virtual bool IsCancelled() const {return (CancelFlag != 0 && __atomic_load_n(CancelFlag, __ATOMIC_ACQUIRE) != 0) || (Deadline > 0.0 && GetSolverTime() >= Deadline);}
+	bool WasInterrupted() const {return Interrupted;} // true if the last call to MinimizeMeritFunction was stopped by IsCancelled
 	
 	//Methods that are not virtual
 	mmcMatrix MinimizeMeritFunction(const mmcMatrix &x_init, double search_distance, double tolerance, double mult_gold_resolution, int maxit, int verbose_level, std::ostream *output_buffer = &std::cout, int max_merit_evals = 0);
@@ -61,6 +82,9 @@ public:
 									const mmcMatrix &previous_gradient,
 									const mmcMatrix &prev_inv_hessian,
 									mmcMatrix &new_inv_hessian)const;
+	mmcMatrix GetNextLbfgsSearchDir(const mmcMatrix &current_gradient,
+									const std::deque<mmcMatrix> &position_changes,
+									const std::deque<mmcMatrix> &gradient_changes)const;
     mmcMatrix ConjugateGradient(const mmcMatrix &x_init, double search_distance, double tolerance, double mult_gold_resolution, int maxit, int verbose_level, std::ostream *output_buffer);
 
 	double  GetLambdaLimit(const mmcMatrix & x_ref, const mmcMatrix & search_dir);
@@ -74,7 +98,9 @@ public:
 	double BackTrack(const mmcMatrix &position, const mmcMatrix &gradient, const double &initial_merit, mmcMatrix &search_dir, double max_step,
 	                 double step_tol, double alpha, double beta, bool &error, mmcMatrix &new_gradient, double &new_merit);
 
-	mmcMatrix MonteCarloOptimization(const mmcMatrix &x_init, const mmcMatrix &x_delta, int number_iterations, int verbose_level = 0);
+	// returns the lowest merit point among number_iterations random points within x_init +/- x_delta, x_init itself is
+	// only a candidate if include_initial is true
+	mmcMatrix MonteCarloOptimization(const mmcMatrix &x_init, const mmcMatrix &x_delta, int number_iterations, int verbose_level = 0, bool include_initial = true);
 
 	//Exception class
 	class MeritFunctionException{};
@@ -88,6 +114,13 @@ private:
 	int MeritEvals;
 	std::ostream *out_buf;
 	LINE_SEARCH LineSearch;
+	int LbfgsHistory;
+	int Iterations;
+	double LineSearchTime;
+	double SearchDirectionTime;
+	const int *CancelFlag;
+	double Deadline;
+	bool Interrupted;
 };
 
 
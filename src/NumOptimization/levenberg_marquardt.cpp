@@ -0,0 +1,250 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "levenberg_marquardt.h"
+
+using namespace std;
+
+void SparseJacobian::Clear(int num_columns)
+{
+	NumColumns = num_columns;
+	RowStart.assign(1,0);
+	Columns.clear();
+	Values.clear();
+}
+
+void SparseJacobian::AddRow(std::vector<std::pair<int,double> > &entries)
+{
+	sort(entries.begin(), entries.end());
+
+	for(unsigned int i = 0; i < entries.size(); i++)
+	{
+		if(entries[i].first < 0 || entries[i].first >= NumColumns)
+			continue;
+
+		if(Columns.size() > (unsigned)RowStart.back() && Columns.back() == entries[i].first)
+			Values.back() += entries[i].second; // duplicate column, sum the entries
+		else {
+			Columns.push_back(entries[i].first);
+			Values.push_back(entries[i].second);
+		}
+	}
+
+	RowStart.push_back(Values.size());
+}
+
+mmcMatrix SparseJacobian::Multiply(const mmcMatrix &x) const
+{
+	mmcMatrix result(GetNumRows(),1,0.0);
+	double *x_data = x.GetMatrixData();
+	double *result_data = result.GetMatrixData();
+
+	for(int row = 0; row < GetNumRows(); row++)
+		for(int index = RowStart[row]; index < RowStart[row+1]; index++)
+			result_data[row] += Values[index]*x_data[Columns[index]];
+
+	return result;
+}
+
+mmcMatrix SparseJacobian::TransposeMultiply(const mmcMatrix &y) const
+{
+	mmcMatrix result(NumColumns,1,0.0);
+	double *y_data = y.GetMatrixData();
+	double *result_data = result.GetMatrixData();
+
+	for(int row = 0; row < GetNumRows(); row++)
+		for(int index = RowStart[row]; index < RowStart[row+1]; index++)
+			result_data[Columns[index]] += Values[index]*y_data[row];
+
+	return result;
+}
+
+mmcMatrix SparseJacobian::GetNormalDiagonal() const
+{
+	mmcMatrix result(NumColumns,1,0.0);
+	double *result_data = result.GetMatrixData();
+
+	for(unsigned int index = 0; index < Values.size(); index++)
+		result_data[Columns[index]] += Values[index]*Values[index];
+
+	return result;
+}
+
+// Solves (J^T*J + mu*I) step = rhs using conjugate gradients with a Jacobi preconditioner
+// J^T*J is never formed, each iteration only requires a product with J and J^T
+mmcMatrix ResidualFunction::SolveDampedNormalEquations(const SparseJacobian &jacobian, const mmcMatrix &normal_diagonal, double mu, const mmcMatrix &rhs) const
+{
+	int n = NumVariables;
+	double *diag_data = normal_diagonal.GetMatrixData();
+
+	mmcMatrix step(n,1,0.0);
+	mmcMatrix residual(rhs);
+	mmcMatrix preconditioned(n,1);
+	mmcMatrix direction(n,1);
+	mmcMatrix product;
+
+	double *step_data = step.GetMatrixData();
+	double *residual_data = residual.GetMatrixData();
+	double *preconditioned_data = preconditioned.GetMatrixData();
+	double *direction_data = direction.GetMatrixData();
+
+	double rhs_norm = rhs.GetMagnitude();
+	if(rhs_norm == 0.0)
+		return step;
+
+	double rz = 0.0;
+	for(int i = 0; i < n; i++)
+	{
+		preconditioned_data[i] = residual_data[i] / (diag_data[i] + mu);
+		direction_data[i] = preconditioned_data[i];
+		rz += residual_data[i]*preconditioned_data[i];
+	}
+
+	for(int iteration = 0; iteration < 2*n; iteration++)
+	{
+		// product = (J^T*J + mu*I) * direction
+		product = jacobian.TransposeMultiply(jacobian.Multiply(direction));
+		double *product_data = product.GetMatrixData();
+		double curvature = 0.0;
+		for(int i = 0; i < n; i++)
+		{
+			product_data[i] += mu*direction_data[i];
+			curvature += direction_data[i]*product_data[i];
+		}
+
+		if(curvature <= 0.0)
+			break;
+
+		double alpha = rz / curvature;
+		double residual_norm = 0.0;
+		for(int i = 0; i < n; i++)
+		{
+			step_data[i] += alpha*direction_data[i];
+			residual_data[i] -= alpha*product_data[i];
+			residual_norm += residual_data[i]*residual_data[i];
+		}
+
+		if(sqrt(residual_norm) < 1.0e-12*rhs_norm)
+			break;
+
+		double rz_new = 0.0;
+		for(int i = 0; i < n; i++)
+		{
+			preconditioned_data[i] = residual_data[i] / (diag_data[i] + mu);
+			rz_new += residual_data[i]*preconditioned_data[i];
+		}
+
+		double beta = rz_new / rz;
+		rz = rz_new;
+		for(int i = 0; i < n; i++)
+			direction_data[i] = preconditioned_data[i] + beta*direction_data[i];
+	}
+
+	return step;
+}
+
+mmcMatrix ResidualFunction::MinimizeResiduals(const mmcMatrix &x_init, double tolerance, int maxit, int verbose_level, ostream *output_buffer)
+{
+	if(NumVariables <= 0 || NumResiduals <= 0)
+		throw ResidualFunctionException();
+
+	mmcMatrix x(x_init);
+	mmcMatrix residuals(NumResiduals,1);
+	mmcMatrix new_x;
+	mmcMatrix new_residuals(NumResiduals,1);
+	SparseJacobian jacobian(NumVariables);
+
+	GetResidualsPlusJacobian(x, residuals, jacobian);
+	double merit = residuals.DotProduct(residuals);
+
+	mmcMatrix gradient = jacobian.TransposeMultiply(residuals);
+	mmcMatrix normal_diagonal = jacobian.GetNormalDiagonal();
+
+	// initial damping is scaled to the largest diagonal element of J^T*J
+	double max_diagonal = 0.0;
+	for(int i = 0; i < NumVariables; i++)
+		max_diagonal = max(max_diagonal, normal_diagonal(i,0));
+	double mu = 1.0e-3 * max_diagonal;
+	double nu = 2.0;
+
+	if(verbose_level >= 1)
+		*output_buffer << "Initial Merit Value = " << merit << "\n" << flush;
+
+	Iterations = 0;
+	LinearSolveTime = 0.0;
+	Interrupted = false;
+	for(int count = 0; count < maxit; count++)
+	{
+		if(IsCancelled())
+		{
+			Interrupted = true;
+			break;
+		}
+
+		// converged if the residuals or the gradient vanish
+		double max_gradient = 0.0;
+		for(int i = 0; i < NumVariables; i++)
+			max_gradient = max(max_gradient, fabs(gradient(i,0)));
+
+		if(merit < tolerance*tolerance || max_gradient < tolerance*tolerance)
+			break;
+
+		Iterations++;
+
+		double solve_start = GetSolverTime();
+		mmcMatrix step = SolveDampedNormalEquations(jacobian, normal_diagonal, mu, gradient.GetScaled(-1.0));
+		LinearSolveTime += GetSolverTime() - solve_start;
+
+		if(step.GetMagnitude() < tolerance*(x.GetMagnitude() + tolerance))
+			break;
+
+		new_x = x + step;
+		GetResiduals(new_x, new_residuals);
+		double new_merit = new_residuals.DotProduct(new_residuals);
+
+		// ratio of the actual reduction to the reduction predicted by the linear model
+		double predicted_reduction = step.DotProduct(step.GetScaled(mu) - gradient);
+		double rho = (predicted_reduction > 0.0) ? (merit - new_merit) / predicted_reduction : -1.0;
+
+		if(rho > 0.0)
+		{
+			// step accepted
+			x = new_x;
+			GetResidualsPlusJacobian(x, residuals, jacobian);
+			merit = residuals.DotProduct(residuals);
+			gradient = jacobian.TransposeMultiply(residuals);
+			normal_diagonal = jacobian.GetNormalDiagonal();
+
+			mu *= max(1.0/3.0, 1.0 - pow(2.0*rho - 1.0, 3));
+			nu = 2.0;
+		} else {
+			// step rejected, increase the damping
+			mu *= nu;
+			nu *= 2.0;
+		}
+
+		if(verbose_level >= 1)
+			*output_buffer << "Iteration =" << count << ", mu = " << mu << ", Merit = " << merit << "\n" << flush;
+	}
+
+	return x;
+}
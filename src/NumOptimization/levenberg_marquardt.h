@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef levenberg_marquardtH
+#define levenberg_marquardtH
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include "../mmcMatrix/mmcMatrix.h"
+#include "solver_timer.h"
+
+// Sparse jacobian stored in compressed row format, one row per residual
+class SparseJacobian
+{
+public:
+	SparseJacobian(int num_columns = 0) {Clear(num_columns);}
+
+	void Clear(int num_columns);
+
+	// Appends a row to the jacobian. Entries may be in any order and may contain duplicate columns (duplicates are summed).
+	// Entries with a column outside of [0,num_columns) are dropped.
+	void AddRow(std::vector<std::pair<int,double> > &entries);
+
+	int GetNumRows() const {return RowStart.size()-1;}
+	int GetNumColumns() const {return NumColumns;}
+	int GetNumNonZeros() const {return Values.size();}
+
+	// compressed row arrays, row i is stored in [GetRowStart()[i], GetRowStart()[i+1])
+	const std::vector<int> & GetRowStart() const {return RowStart;}
+	const std::vector<int> & GetColumns() const {return Columns;}
+	const std::vector<double> & GetValues() const {return Values;}
+
+	mmcMatrix Multiply(const mmcMatrix &x) const;           // returns J*x
+	mmcMatrix TransposeMultiply(const mmcMatrix &y) const;  // returns J^T*y
+	mmcMatrix GetNormalDiagonal() const;                    // returns the diagonal of J^T*J as a column vector
+
+private:
+	int NumColumns;
+	std::vector<int> RowStart;
+	std::vector<int> Columns;
+	std::vector<double> Values;
+};
+
+// Abstract base class for problems of the form: minimize the sum of the squares of a vector of residuals
+class ResidualFunction
+{
+public:
+	ResidualFunction(int num_variables, int num_residuals) {NumVariables = num_variables; NumResiduals = num_residuals; Iterations = 0; LinearSolveTime = 0.0; CancelFlag = 0; Deadline = 0.0; Interrupted = false;}
+	virtual ~ResidualFunction() {}
+
+	//Virtual methods that must be overridden by the child class
+	virtual void GetResiduals(const mmcMatrix & x, mmcMatrix &residuals) = 0;
+	virtual void GetResidualsPlusJacobian(const mmcMatrix & x, mmcMatrix &residuals, SparseJacobian &jacobian) = 0;
+
+	//acessors
+	int GetNumVariables() const {return NumVariables;}
+	int GetNumResiduals() const {return NumResiduals;}
+	int GetNumIterations() const {return Iterations;} // number of iterations taken by the last call to MinimizeResiduals
+	double GetLinearSolveTime() const {return LinearSolveTime;} // seconds spent solving the damped normal equations in the last call to MinimizeResiduals
+
+	// MinimizeResiduals returns the current position at the start of the first iteration after *cancel_flag becomes non-zero
+	// or GetSolverTime() passes the deadline, the flag may be set from another thread with __atomic_store_n, 0 disables either check
+	void SetCancelFlag(const int *cancel_flag) {CancelFlag = cancel_flag;}
+	void SetDeadline(double deadline) {Deadline = deadline;}
+	virtual bool IsCancelled() const {return (CancelFlag != 0 && __atomic_load_n(CancelFlag, __ATOMIC_ACQUIRE) != 0) || (Deadline > 0.0 && GetSolverTime() >= Deadline);}
+	bool WasInterrupted() const {return Interrupted;} // true if the last call to MinimizeResiduals was stopped by IsCancelled
+
+	// Levenberg-Marquardt minimization of the sum of squared residuals
+	// the linear system for each step is solved with preconditioned conjugate gradients so that the jacobian is never formed densely
+	mmcMatrix MinimizeResiduals(const mmcMatrix &x_init, double tolerance, int maxit, int verbose_level, std::ostream *output_buffer = &std::cout);
+
+	//Exception class
+	class ResidualFunctionException{};
+
+private:
+	// solves (J^T*J + mu*I) step = rhs
+	mmcMatrix SolveDampedNormalEquations(const SparseJacobian &jacobian, const mmcMatrix &normal_diagonal, double mu, const mmcMatrix &rhs) const;
+
+	int NumVariables;
+	int NumResiduals;
+	int Iterations;
+	double LinearSolveTime;
+	const int *CancelFlag;
+	double Deadline;
+	bool Interrupted;
+};
+
+
+#endif //levenberg_marquardtH
@@ -177,6 +177,9 @@ void QtPoint2D::mouseMoveEvent ( QGraphicsSceneMouseEvent * event )
 		SetSValue(event->scenePos().x(),false /*update_db*/);
 		SetTValue(-event->scenePos().y(),false /*update_db*/);
 
+		// let the rest of the sketch follow the point, limited to one frame so that the drag stays interactive
+		DragSolve();
+
 		// force a update of the display so that the drag event is seen interactively
 		scene()->update();
 
@@ -196,6 +199,9 @@ void QtPoint2D::mouseReleaseEvent ( QGraphicsSceneMouseEvent * event )
 		SetSValue(GetSValue());
 		SetTValue(GetTValue());
 
+		// finish the solve and save the DOF's that were moved by the drag solves
+		DragSolve(true /*drag_finished*/);
+
 		pending_db_save_ = false;
 	}
 
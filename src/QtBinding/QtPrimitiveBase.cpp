@@ -22,11 +22,16 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <QtGui>
 
 #include "QtPrimitiveBase.h"
+#include "../ConstraintSolver/pSketcherModel.h"
+
+// time budget in seconds for the solve made for each mouse move event of a drag, about one frame at 60 Hz
+const double drag_solve_time_budget = 0.015;
 
 QtPrimitiveBase::QtPrimitiveBase(QGraphicsItem * parent ) : 
 QGraphicsItem(parent),
 selection_diameter_(6.0),
-bounding_rect_pad_(10.0)
+bounding_rect_pad_(10.0),
+sketch_(0)
 {
 	// by default use primitive display properties
 	SetProperties(Primitive);
@@ -52,6 +57,19 @@ void QtPrimitiveBase::UpdateDisplay()
 	update();
 }
 
+void QtPrimitiveBase::DragSolve(bool drag_finished)
+{
+	if(sketch_ == 0)
+		return;
+
+	if(drag_finished)
+		sketch_->SolveConstraints();
+	else
+		sketch_->SolveConstraintsInteractive(drag_solve_time_budget);
+
+	sketch_->UpdateDisplay();
+}
+
 bool QtPrimitiveBase::IsSelected()
 {
 	return isSelected();
@@ -54,6 +54,9 @@ class QtPrimitiveBase : public QGraphicsItem, virtual public PrimitiveBase
 		virtual bool IsSelected();
 		virtual void SetSelectable(bool selectable_);
 
+		// the sketch that this primitive belongs to, set by QtSketch::AddPrimitive and used to solve the constraints while the primitive is dragged
+		void SetSketch(pSketcherModel *sketch) {sketch_ = sketch;}
+
 		// some utility methods used to paint primitives
 		void PaintPoint(QPainter *painter, const QStyleOptionGraphicsItem *option, double x, double y);
 		void PaintPointAndSelectionPath(QPainter *painter, const QStyleOptionGraphicsItem *option, double x, double y,QPainterPath &selection_path);
@@ -78,6 +81,13 @@ class QtPrimitiveBase : public QGraphicsItem, virtual public PrimitiveBase
 		double selection_diameter_;
 
 		double bounding_rect_pad_;
+
+		// solves the constraints after each mouse move of a drag within a fixed time budget, the best iterate found is displayed
+		// the solve at the end of the drag runs to convergence and saves the result to the database
+		void DragSolve(bool drag_finished = false);
+
+	private:
+		pSketcherModel *sketch_;
 };
 
 
@@ -21,13 +21,15 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <sstream>
 
 #include "QtSketch.h"
+#include "../ConstraintSolver/DatabaseSnapshot.h"
 
 using namespace std;
 
 QtSketch::QtSketch(QGraphicsScene *scene, VectorPointer normal, VectorPointer up, PointPointer base, bool grid_snap):
 Sketch(normal,up,base, QtSketch::PrimitiveFactory, QtSketch::ConstraintFactory),
 grid_snap_(grid_snap),
-scene_(scene)
+scene_(scene),
+solve_receiver_(0)
 {
 
 }
@@ -35,7 +37,8 @@ scene_(scene)
 QtSketch::QtSketch(QGraphicsScene *scene, const std::string &file_name, bool grid_snap):
 Sketch(file_name,QtSketch::PrimitiveFactory, QtSketch::ConstraintFactory),
 scene_(scene),
-grid_snap_(grid_snap)
+grid_snap_(grid_snap),
+solve_receiver_(0)
 {
 	// now that primitives and constraints have been defined from the file, loop through all of the primitives and constraints and display any that are derived from QGraphicsItem
 	// loop over the primitives
@@ -49,6 +52,10 @@ grid_snap_(grid_snap)
 		{
 			scene_->addItem(temp_graphics_item);
 		}
+
+		QtPrimitiveBase *qt_primitive = dynamic_cast<QtPrimitiveBase*>(primitive_it->second.get());
+		if(qt_primitive != 0)
+			qt_primitive->SetSketch(this);
 	}
 
 	// loop over the constraints
@@ -66,6 +73,19 @@ grid_snap_(grid_snap)
 
 }
 
+QtSketch::~QtSketch()
+{
+	// the solver thread calls AsyncSolveFinished so it must be stopped while this part of the object still exists
+	CancelAsyncSolve();
+}
+
+void QtSketch::AsyncSolveFinished(unsigned request)
+{
+	// called from the solver thread, the queued call runs the receiver's slot in the GUI thread
+	if(solve_receiver_ != 0)
+		QMetaObject::invokeMethod(solve_receiver_, "asyncSolveFinished", Qt::QueuedConnection, Q_ARG(unsigned int, request));
+}
+
 QtPoint2DPointer QtSketch::AddPoint2D ( double s, double t, bool s_free, bool t_free)
 {
 	QtPoint2DPointer new_point(new QtPoint2D(0,s,t,GetSketchPlane(),s_free,t_free));
@@ -76,6 +96,9 @@ QtPoint2DPointer QtSketch::AddPoint2D ( double s, double t, bool s_free, bool t_
 
 QtArc2DPointer QtSketch::AddArc2D (double s_center, double t_center, double theta_1, double theta_2, double radius, bool s_center_free, bool t_center_free, bool theta_1_free, bool theta_2_free, bool radius_free)
 {
+	// the arc and its points are added to the database in one transaction
+	BatchEdit batch(*this);
+
 	QtArc2DPointer new_arc(new QtArc2D(0,s_center, t_center, theta_1, theta_2, radius, GetSketchPlane(),s_center_free, t_center_free, theta_1_free, theta_2_free, radius_free));
 	AddPrimitive(new_arc);
 
@@ -104,6 +127,9 @@ QtArc2DPointer QtSketch::AddArc2D (double s_center, double t_center, double thet
 
 QtCircle2DPointer QtSketch::AddCircle2D (double s_center, double t_center, double radius, bool s_center_free, bool t_center_free, bool radius_free)
 {
+    // the circle and its center point are added to the database in one transaction
+    BatchEdit batch(*this);
+
     QtCircle2DPointer new_circle(new QtCircle2D(0,s_center, t_center, radius, GetSketchPlane(),s_center_free, t_center_free, radius_free));
     AddPrimitive(new_circle);
 
@@ -144,6 +170,9 @@ QtArc2DPointer QtSketch::AddArc2D (double s1, double t1, double s2, double t2, d
 	
 	if(success)
 	{
+		// the arc and its points are added to the database in one transaction
+		BatchEdit batch(*this);
+
 		AddPrimitive(new_arc);
 	
 		// now add the end points and the center of the arc as seperate primitives so that they can be selected by the user for constructing lines and other primitives
@@ -276,6 +305,10 @@ void QtSketch::AddPrimitive(const PrimitiveBasePointer &new_primitive, bool upda
 		//std::cout << "adding primitive to the scene" << std::endl;
 	}
 
+	QtPrimitiveBase *qt_primitive = dynamic_cast<QtPrimitiveBase*>(new_primitive.get());
+	if(qt_primitive != 0)
+		qt_primitive->SetSketch(this);
+
 	// now call the base class version of this method
 	pSketcherModel::AddPrimitive(new_primitive, update_database);
 }
@@ -283,49 +316,20 @@ void QtSketch::AddPrimitive(const PrimitiveBasePointer &new_primitive, bool upda
 PrimitiveBasePointer QtSketch::PrimitiveFactory(unsigned id, pSketcherModel &psketcher_model)
 {
 	// grab the table name from the database so we now exactly which class needs to be created
-	int rc;
-	sqlite3_stmt *statement;
-	stringstream table_name_stream;
 	string table_name;
 
-	stringstream sql_command;
-	sql_command << "SELECT * FROM primitive_list WHERE id=" << id << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// row exist, store the values to initialize this object
-		table_name_stream << sqlite3_column_text(statement,1);
-		table_name = table_name_stream.str();
-	} else {
-		// the requested row does not exist in the database
-		sqlite3_finalize(statement);
-
-		stringstream error_description;
-		error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
+	{
+		TableRow row(psketcher_model, "primitive_list", id);
+
+		if(row.Exists()) {
+			// row exist, store the values to initialize this object
+			table_name = row.GetText(1);
+		} else {
+			// the requested row does not exist in the database
+			stringstream error_description;
+			error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
+			throw pSketcherException(error_description.str());
+		}
 	}
 
 	// now generate the object based on the table name
@@ -364,49 +368,20 @@ ConstraintEquationBasePointer QtSketch::ConstraintFactory(unsigned id, pSketcher
 {
 
 	// grab the table name from the database so we now exactly which class needs to be created
-	int rc;
-	sqlite3_stmt *statement;
-	stringstream table_name_stream;
 	string table_name;
 
-	stringstream sql_command;
-	sql_command << "SELECT * FROM constraint_equation_list WHERE id=" << id << ";";
-
-	rc = sqlite3_prepare(psketcher_model.GetDatabase(), sql_command.str().c_str(), -1, &statement, 0);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-
-	if(rc == SQLITE_ROW) {
-		// row exist, store the values to initialize this object
-		table_name_stream << sqlite3_column_text(statement,1);
-		table_name = table_name_stream.str();
-	} else {
-		// the requested row does not exist in the database
-		sqlite3_finalize(statement);
-
-		stringstream error_description;
-		error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
-		throw pSketcherException(error_description.str());
-	}
-
-	rc = sqlite3_step(statement);
-	if( rc!=SQLITE_DONE ){
-		// sql statement didn't finish properly, some error must to have occured
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
-	}
-	
-	rc = sqlite3_finalize(statement);
-	if( rc!=SQLITE_OK ){
-		stringstream error_description;
-		error_description << "SQL error: " << sqlite3_errmsg(psketcher_model.GetDatabase());
-		throw pSketcherException(error_description.str());
+	{
+		TableRow row(psketcher_model, "constraint_equation_list", id);
+
+		if(row.Exists()) {
+			// row exist, store the values to initialize this object
+			table_name = row.GetText(1);
+		} else {
+			// the requested row does not exist in the database
+			stringstream error_description;
+			error_description << "SQLite rowid " << id << " in table " << table_name << " does not exist";
+			throw pSketcherException(error_description.str());
+		}
 	}
 
 	// now generate the object based on the table name
@@ -35,11 +35,16 @@ class QtSketch : public Sketch
 		// constructor
 		QtSketch(QGraphicsScene *scene, VectorPointer normal, VectorPointer up, PointPointer base, bool grid_snap = false);
 		QtSketch(QGraphicsScene *scene, const std::string &file_name, bool grid_snap = false);
+		virtual ~QtSketch();
 
 		// accessor methods
 		bool GetGridSnap() {return grid_snap_;}
 		void SetGridSnap(bool grid_snap) {grid_snap_ = grid_snap;}
 
+		// the receiver's asyncSolveFinished(unsigned int) slot is invoked in the receiver's thread when an asynchronous solve finishes, it
+		// should call ApplyAsyncSolve with the request number (see pSketcherModel::SolveConstraintsAsync)
+		void SetSolveReceiver(QObject *receiver) {solve_receiver_ = receiver;}
+
 		// override some of the pSketcherModel methods
 		void ClearSelected() {scene_->clearSelection(); pSketcherModel::ClearSelected();}
 		virtual void AddConstraintEquation(const ConstraintEquationBasePointer &new_constraint_equation, bool update_database = true);
@@ -61,6 +66,9 @@ class QtSketch : public Sketch
 		QtAngleLine2DPointer AddAngleLine2D(const Line2DPointer line1, const Line2DPointer line2, bool interior_angle);
 		QtTangentEdge2DPointer AddTangentEdge2D(Edge2DBasePointer edge1, EdgePointNumber point_num_1, Edge2DBasePointer edge2, EdgePointNumber point_num_2);
 
+	protected:
+		virtual void AsyncSolveFinished(unsigned request);
+
 	private:
 		// methods for generating objects directly from the database
 		// These methods are private since the Fetch methods should be used to access the DOF's primitives and constraints and they will call these methods if necessary
@@ -69,6 +77,7 @@ class QtSketch : public Sketch
 
 		QGraphicsScene *scene_;
 		bool grid_snap_;
+		QObject *solve_receiver_;
 };
 //typedef boost::shared_ptr<QtSketch> QtSketchPointer;
 typedef QtSketch* QtSketchPointer;
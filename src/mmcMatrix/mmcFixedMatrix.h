@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef mmcFixedMatrixH
+#define mmcFixedMatrixH
+
+#include <math.h>
+#include "mmcMatrix.h"
+
+// Matrix with dimensions fixed at compile time and inline storage, no heap memory is ever allocated
+// Intended for the small vectors and matrices (2x1, 2x2, 3x1, local parameter vectors, ...) used in the inner loops of the solver
+// Provides the same operator set as mmcMatrix, converting to an mmcMatrix allocates
+template <int R, int C> class mmcFixedMatrix
+{
+public:
+  enum {NumRows = R, NumColumns = C};
+
+  // Default constructer, elements are not initialized
+  mmcFixedMatrix() {}
+
+  // Constructer that initializes every element of the matrix
+  explicit mmcFixedMatrix(double initial_value) {for(int i = 0; i < R*C; i++) MatrixData[i] = initial_value;}
+
+  // construct from an mmcMatrix of the same dimensions
+  explicit mmcFixedMatrix(const mmcMatrix &input)
+  {
+    if(MMC_ERROR_CHECK && (input.GetNumRows() != R || input.GetNumColumns() != C))
+      throw mmcException(ADD_INCOMPAT, __LINE__, "mmcFixedMatrix.h");
+    for(int row = 0; row < R; row++)
+      for(int col = 0; col < C; col++)
+        MatrixData[row * C + col] = input(row,col);
+  }
+
+  // methods to set or get matrix elements
+  void SetElement(int row, int col, double new_value) {CheckIndex(row,col); MatrixData[row * C + col] = new_value;}
+  double& operator() (int row, int col)               {CheckIndex(row,col); return MatrixData[row * C + col];}
+  double GetElement(int row, int col)const            {CheckIndex(row,col); return MatrixData[row * C + col];}
+  double operator() (int row, int col)const           {CheckIndex(row,col); return MatrixData[row * C + col];}
+
+  // overloaded operators
+  mmcFixedMatrix operator+(const mmcFixedMatrix & rhs)const {mmcFixedMatrix result(*this); result += rhs; return result;}
+  mmcFixedMatrix operator-(const mmcFixedMatrix & rhs)const {mmcFixedMatrix result(*this); result -= rhs; return result;}
+  mmcFixedMatrix operator*(double scale_factor)const {mmcFixedMatrix result(*this); result *= scale_factor; return result;}
+  friend mmcFixedMatrix operator*(double scale_factor, const mmcFixedMatrix & rhs) {return rhs*scale_factor;}
+  const mmcFixedMatrix & operator+=(const mmcFixedMatrix & rhs) {for(int i = 0; i < R*C; i++) MatrixData[i] += rhs.MatrixData[i]; return *this;}
+  const mmcFixedMatrix & operator-=(const mmcFixedMatrix & rhs) {for(int i = 0; i < R*C; i++) MatrixData[i] -= rhs.MatrixData[i]; return *this;}
+  const mmcFixedMatrix & operator*=(double scale_factor) {for(int i = 0; i < R*C; i++) MatrixData[i] *= scale_factor; return *this;}
+
+  // matrix multiplication, the dimensions are checked at compile time
+  template <int C2> mmcFixedMatrix<R,C2> operator*(const mmcFixedMatrix<C,C2> & rhs)const
+  {
+    mmcFixedMatrix<R,C2> result(0.0);
+    for(int row = 0; row < R; row++)
+      for(int col = 0; col < C2; col++)
+        for(int index = 0; index < C; index++)
+          result(row,col) += MatrixData[row * C + index] * rhs(index,col);
+    return result;
+  }
+
+  // conversion to mmcMatrix, allows fixed matrices to be used wherever an mmcMatrix is expected (allocates heap memory)
+  operator mmcMatrix()const
+  {
+    mmcMatrix result(R,C);
+    for(int row = 0; row < R; row++)
+      for(int col = 0; col < C; col++)
+        result(row,col) = MatrixData[row * C + col];
+    return result;
+  }
+
+  // accessor functions that do not change the object
+  int GetNumRows()const {return R;}
+  int GetNumColumns()const {return C;}
+
+  // functions that return a matrix without changing the original matrix
+  mmcFixedMatrix<C,R> GetTranspose()const
+  {
+    mmcFixedMatrix<C,R> result;
+    for(int row = 0; row < R; row++)
+      for(int col = 0; col < C; col++)
+        result(col,row) = MatrixData[row * C + col];
+    return result;
+  }
+  mmcFixedMatrix GetScaled(double scale_factor)const {return (*this)*scale_factor;}
+  double DotProduct(const mmcFixedMatrix & rhs)const {double result = 0.0; for(int i = 0; i < R*C; i++) result += MatrixData[i]*rhs.MatrixData[i]; return result;}
+  mmcFixedMatrix CrossProduct(const mmcFixedMatrix & rhs)const
+  {
+    if(MMC_ERROR_CHECK && R*C != 3)
+      throw mmcException(CANNOT_CROSS, __LINE__, "mmcFixedMatrix.h");
+    mmcFixedMatrix result;
+    result.MatrixData[0] = MatrixData[1]*rhs.MatrixData[2] - MatrixData[2]*rhs.MatrixData[1];
+    result.MatrixData[1] = MatrixData[2]*rhs.MatrixData[0] - MatrixData[0]*rhs.MatrixData[2];
+    result.MatrixData[2] = MatrixData[0]*rhs.MatrixData[1] - MatrixData[1]*rhs.MatrixData[0];
+    return result;
+  }
+  double GetMagnitude()const {return sqrt(DotProduct(*this));}
+  mmcFixedMatrix GetNormalized()const
+  {
+    double magnitude = GetMagnitude();
+    if(MMC_ERROR_CHECK && magnitude == 0.0)
+      throw mmcException(DIVIDE_BY_ZERO, __LINE__, "mmcFixedMatrix.h");
+    return (*this)*(1.0/magnitude);
+  }
+  double GetDistanceTo(const mmcFixedMatrix &input_vector, bool take_sqrt = true)const
+  {
+    double result = 0.0;
+    for(int i = 0; i < R*C; i++)
+      result += (MatrixData[i]-input_vector.MatrixData[i])*(MatrixData[i]-input_vector.MatrixData[i]);
+    return take_sqrt ? sqrt(result) : result;
+  }
+
+  // functions that change the original matrix
+  const mmcFixedMatrix & SetIdentity()
+  {
+    for(int row = 0; row < R; row++)
+      for(int col = 0; col < C; col++)
+        MatrixData[row * C + col] = (row == col) ? 1.0 : 0.0;
+    return *this;
+  }
+  const mmcFixedMatrix & SetZero() {for(int i = 0; i < R*C; i++) MatrixData[i] = 0.0; return *this;}
+
+  double *GetMatrixData() {return MatrixData;}
+  const double *GetMatrixData()const {return MatrixData;}
+
+private:
+  void CheckIndex(int row, int col)const
+  {
+    if(MMC_ERROR_CHECK && (row < 0 || row >= R || col < 0 || col >= C))
+      throw mmcException(OVERRUN, __LINE__, "mmcFixedMatrix.h");
+  }
+
+  double MatrixData[R*C];
+};
+
+#endif //mmcFixedMatrixH
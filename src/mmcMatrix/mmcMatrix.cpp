@@ -19,7 +19,6 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 
-#include <pthread.h>
 #include <iomanip>
 #include <stdlib.h>
 #include <fstream>
@@ -27,11 +26,10 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <gsl/gsl_linalg.h>
 #include "mmcMatrix.h"
+#include "mmcThreadPool.h"
 
 using namespace std;
 
-pthread_mutex_t mmcLock; // mutex lock
-
 // Default constructor, does not allocate memory
 mmcMatrix::mmcMatrix()
 {
@@ -108,6 +106,10 @@ void mmcMatrix::SetSize(int rows, int columns, double initial_value)
       throw mmcException(CANNOT_CREATE, __LINE__);
   }
 
+  // nothing to do if the size is not changing
+  if(MatrixData != NULL && rows == NumRows && columns == NumColumns)
+    return;
+
   // Need to remember the original size of the matrix
   int old_num_rows = NumRows;
   int old_num_columns = NumColumns;
@@ -158,6 +160,10 @@ void mmcMatrix::SetSize(int rows, int columns)
       throw mmcException(CANNOT_CREATE, __LINE__);
   }
 
+  // nothing to do if the size is not changing
+  if(MatrixData != NULL && rows == NumRows && columns == NumColumns)
+    return;
+
   // Need to remember the original size of the matrix
   int old_num_rows = NumRows;
   int old_num_columns = NumColumns;
@@ -227,6 +233,44 @@ mmcMatrix::mmcMatrix(const mmcMatrix & rhs)
 }
 
 
+#if __cplusplus >= 201103L
+// move constructor, takes over the matrix data of rhs
+mmcMatrix::mmcMatrix(mmcMatrix && rhs)
+{
+  OutputFormat = MMC_NATIVE;
+  Name[0] = '\0';
+
+  NumRows = rhs.NumRows;
+  NumColumns = rhs.NumColumns;
+  MatrixData = rhs.MatrixData;
+
+  rhs.NumRows = 0;
+  rhs.NumColumns = 0;
+  rhs.MatrixData = NULL;
+}
+
+// move assignment, swaps the matrix data with rhs so that rhs frees the old data of this matrix
+mmcMatrix & mmcMatrix::operator=(mmcMatrix && rhs)
+{
+  if (this == &rhs)
+    return *this;
+
+  int temp_num_rows = NumRows;
+  int temp_num_columns = NumColumns;
+  double *temp_matrix_data = MatrixData;
+
+  NumRows = rhs.NumRows;
+  NumColumns = rhs.NumColumns;
+  MatrixData = rhs.MatrixData;
+
+  rhs.NumRows = temp_num_rows;
+  rhs.NumColumns = temp_num_columns;
+  rhs.MatrixData = temp_matrix_data;
+
+  return *this;
+}
+#endif
+
 // Assignment operator overload function (overloads binary =)
 mmcMatrix & mmcMatrix::operator=(const mmcMatrix & rhs)
 {
@@ -237,20 +281,22 @@ mmcMatrix & mmcMatrix::operator=(const mmcMatrix & rhs)
   if (this == &rhs)
     return *this;
 
-  // deallocate the memory already allocated for this matrix object
-  if(MatrixData != NULL)
+  // reuse the memory already allocated for this matrix object if it holds the same number of elements,
+  // otherwise deallocate it
+  bool reuse_memory = (MatrixData != NULL && rhs.MatrixData != NULL && NumRows*NumColumns == rhs.GetNumRows()*rhs.GetNumColumns());
+  if(!reuse_memory && MatrixData != NULL)
+  {
     delete [] MatrixData;
-  MatrixData = NULL;
+    MatrixData = NULL;
+  }
 
   // copy the number of rows and columns
   NumRows = rhs.GetNumRows();
   NumColumns = rhs.GetNumColumns();
 
   // allocate memory for the matrix if rhs has memory allocated
-  if(rhs.MatrixData != NULL)
+  if(!reuse_memory && rhs.MatrixData != NULL)
     MatrixData = new double[NumRows * NumColumns];
-  else
-    MatrixData = NULL;
 
   double *rhs_matrix_data = rhs.GetMatrixData();
   int rhs_num_columns = rhs.GetNumColumns();
@@ -263,49 +309,6 @@ mmcMatrix & mmcMatrix::operator=(const mmcMatrix & rhs)
   return *this;
 }
 
-//  Addition operator overload function (overlaods binary +)
-mmcMatrix mmcMatrix::operator+(const mmcMatrix & rhs)const
-{
-  int row, col;
-
-  
-  if(MMC_ERROR_CHECK)
-  {
-    // insure that both matrices have the same dimensions
-    if(NumRows != rhs.GetNumRows() || NumColumns != rhs.GetNumColumns())
-      throw mmcException(ADD_INCOMPAT, __LINE__);
-  
-    // insure matrices have at least one element
-    if((NumRows == 0 && NumColumns == 0) || (rhs.GetNumRows() == 0 &&
-               rhs.GetNumColumns() == 0))
-      throw mmcException(SIZE_ZERO, __LINE__);
-  
-     // insure that there is memory allocated for the left hand side matrix
-    if(MatrixData == NULL)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  
-    // insure that there is memory allocated for the right had side matrix
-    if(rhs.MatrixData == NULL)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  }
-
-  // create a new mmcMatrix object in order to store the result
-  mmcMatrix result(NumRows, NumColumns);
-
-  double *result_matrix_data = result.GetMatrixData();
-  int result_num_columns = result.GetNumColumns();
-  double *rhs_matrix_data = rhs.GetMatrixData();
-  int rhs_num_columns = rhs.GetNumColumns();  
-  
-  // Add the two matrices element by element
-  for(row = 0; row < NumRows; row++)
-    for(col = 0; col < NumColumns; col++)
-        result_matrix_data[row*result_num_columns + col] = MatrixData[row*NumColumns + col] + rhs_matrix_data[row*rhs_num_columns + col];
-
-  // return the result
-  return result;
-}
-
 
 const mmcMatrix & mmcMatrix::operator+=(const mmcMatrix & rhs)
 {
@@ -380,55 +383,136 @@ const mmcMatrix & mmcMatrix::operator-=(const mmcMatrix & rhs)
 }
 
 
-//  Subtraction operator overload function (overlaods binary -)
-mmcMatrix mmcMatrix::operator-(const mmcMatrix & rhs)const
+// Adds lhs(row_begin:row_end,depth_begin:depth_end) * rhs(depth_begin:depth_end,col_begin:col_end) to the result
+// The innermost loop runs along rows of rhs and result so that it accesses memory contiguously
+static void mmcMultiplyBlock(const mmcMultiplyData &data, int row_begin, int row_end, int col_begin, int col_end, int depth_begin, int depth_end)
 {
-  double difference;  // Variable to store temporary results
-  int row, col;
+  for(int row = row_begin; row < row_end; row++)
+  {
+    const double *lhs_row = data.lhs_data + row*data.lhs_num_columns;
+    double *result_row = data.result_data + row*data.rhs_num_columns;
 
-  if(MMC_ERROR_CHECK)
+    if(col_end - col_begin < 4)
+    {
+      // narrow blocks (matrix vector products) are computed as dot products
+      for(int col = col_begin; col < col_end; col++)
+      {
+        double sum = 0.0;
+        for(int index = depth_begin; index < depth_end; index++)
+          sum += lhs_row[index] * data.rhs_data[index*data.rhs_num_columns + col];
+        result_row[col] += sum;
+      }
+    } else {
+      for(int index = depth_begin; index < depth_end; index++)
+      {
+        double lhs_value = lhs_row[index];
+        const double *rhs_row = data.rhs_data + index*data.rhs_num_columns;
+        for(int col = col_begin; col < col_end; col++)
+          result_row[col] += lhs_value * rhs_row[col];
+      }
+    }
+  }
+}
+
+// The AVX2 kernel is compiled with the target attribute so that the library does not require -mavx2,
+// it is only used if the processor supports it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MMC_AVX2_KERNEL
+#endif
+
+#ifdef MMC_AVX2_KERNEL
+#include <immintrin.h>
+
+// Same as mmcMultiplyBlock, computes 4x8 sub-blocks of the result with the accumulators held in registers
+__attribute__((target("avx2,fma")))
+static void mmcMultiplyBlockAVX2(const mmcMultiplyData &data, int row_begin, int row_end, int col_begin, int col_end, int depth_begin, int depth_end)
+{
+  const int lhs_stride = data.lhs_num_columns;
+  const int rhs_stride = data.rhs_num_columns;
+
+  int row = row_begin;
+  for(; row + 4 <= row_end; row += 4)
   {
-    // insure that both matrices have the same dimensions
-    if(NumRows != rhs.GetNumRows() || NumColumns != rhs.GetNumColumns())
-      throw mmcException(ADD_INCOMPAT, __LINE__);
-  
-    // insure matrices have at least one element
-    if((NumRows == 0 && NumColumns == 0) || (rhs.GetNumRows() == 0 &&
-            rhs.GetNumColumns() == 0))
-      throw mmcException(SIZE_ZERO, __LINE__);
-  
-     // insure that there is memory allocated for the left hand side matrix
-    if(MatrixData == NULL)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  
-    // insure that there is memory allocated for the right had side matrix
-    if(rhs.MatrixData == NULL)
-      throw mmcException(SIZE_ZERO, __LINE__);
+    const double *lhs0 = data.lhs_data + row*lhs_stride;
+    const double *lhs1 = lhs0 + lhs_stride;
+    const double *lhs2 = lhs1 + lhs_stride;
+    const double *lhs3 = lhs2 + lhs_stride;
+
+    int col = col_begin;
+    for(; col + 8 <= col_end; col += 8)
+    {
+      double *result0 = data.result_data + row*rhs_stride + col;
+      double *result1 = result0 + rhs_stride;
+      double *result2 = result1 + rhs_stride;
+      double *result3 = result2 + rhs_stride;
+
+      __m256d c00 = _mm256_loadu_pd(result0), c01 = _mm256_loadu_pd(result0+4);
+      __m256d c10 = _mm256_loadu_pd(result1), c11 = _mm256_loadu_pd(result1+4);
+      __m256d c20 = _mm256_loadu_pd(result2), c21 = _mm256_loadu_pd(result2+4);
+      __m256d c30 = _mm256_loadu_pd(result3), c31 = _mm256_loadu_pd(result3+4);
+
+      const double *rhs_row = data.rhs_data + depth_begin*rhs_stride + col;
+      for(int index = depth_begin; index < depth_end; index++, rhs_row += rhs_stride)
+      {
+        __m256d b0 = _mm256_loadu_pd(rhs_row);
+        __m256d b1 = _mm256_loadu_pd(rhs_row+4);
+        __m256d a;
+
+        a = _mm256_broadcast_sd(lhs0 + index); c00 = _mm256_fmadd_pd(a, b0, c00); c01 = _mm256_fmadd_pd(a, b1, c01);
+        a = _mm256_broadcast_sd(lhs1 + index); c10 = _mm256_fmadd_pd(a, b0, c10); c11 = _mm256_fmadd_pd(a, b1, c11);
+        a = _mm256_broadcast_sd(lhs2 + index); c20 = _mm256_fmadd_pd(a, b0, c20); c21 = _mm256_fmadd_pd(a, b1, c21);
+        a = _mm256_broadcast_sd(lhs3 + index); c30 = _mm256_fmadd_pd(a, b0, c30); c31 = _mm256_fmadd_pd(a, b1, c31);
+      }
+
+      _mm256_storeu_pd(result0, c00); _mm256_storeu_pd(result0+4, c01);
+      _mm256_storeu_pd(result1, c10); _mm256_storeu_pd(result1+4, c11);
+      _mm256_storeu_pd(result2, c20); _mm256_storeu_pd(result2+4, c21);
+      _mm256_storeu_pd(result3, c30); _mm256_storeu_pd(result3+4, c31);
+    }
+
+    // columns left over at the edge of the block
+    if(col < col_end)
+      mmcMultiplyBlock(data, row, row+4, col, col_end, depth_begin, depth_end);
   }
 
-  // create a new mmcMatrix object in order to store the result
-  mmcMatrix result(NumRows, NumColumns);
+  // rows left over at the edge of the block
+  if(row < row_end)
+    mmcMultiplyBlock(data, row, row_end, col_begin, col_end, depth_begin, depth_end);
+}
+#endif //MMC_AVX2_KERNEL
 
-  double *result_matrix_data = result.GetMatrixData();
-  int result_num_columns = result.GetNumColumns();
-  double *rhs_matrix_data = rhs.GetMatrixData();
-  int rhs_num_columns = rhs.GetNumColumns();  
-  
-  // Add the two matrices element by element
-  for(row = 0; row < NumRows; row++)
-    for(col = 0; col < NumColumns; col++)
-        result_matrix_data[row*result_num_columns + col] = MatrixData[row*NumColumns + col] - rhs_matrix_data[row*rhs_num_columns + col];
+// returns the fastest block multiplication kernel supported by the processor
+static mmcMultiplyBlockFunction mmcGetMultiplyBlockFunction()
+{
+#ifdef MMC_AVX2_KERNEL
+  static bool avx2_supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  if(avx2_supported)
+    return mmcMultiplyBlockAVX2;
+#endif
+  return mmcMultiplyBlock;
+}
 
-  // return the result
-  return result;
+// computes one tile of the result of a matrix multiplication, the depth is blocked so that the rows of rhs used by
+// the tile stay in cache, tiles do not overlap so no locking is needed
+static void mmcMultiplyTile(int tile, void *task_data)
+{
+  const mmcMultiplyData &data = *(const mmcMultiplyData *)task_data;
+
+  int row_begin = (tile / data.num_tile_columns) * mmcTileRows;
+  int col_begin = (tile % data.num_tile_columns) * mmcTileColumns;
+  int row_end = row_begin + mmcTileRows < data.lhs_num_rows ? row_begin + mmcTileRows : data.lhs_num_rows;
+  int col_end = col_begin + mmcTileColumns < data.rhs_num_columns ? col_begin + mmcTileColumns : data.rhs_num_columns;
+
+  for(int depth_begin = 0; depth_begin < data.lhs_num_columns; depth_begin += mmcTileDepth)
+  {
+    int depth_end = depth_begin + mmcTileDepth < data.lhs_num_columns ? depth_begin + mmcTileDepth : data.lhs_num_columns;
+    data.block_function(data, row_begin, row_end, col_begin, col_end, depth_begin, depth_end);
+  }
 }
 
 //  Multiplication operator overload function (overlaods binary *)
 mmcMatrix mmcMatrix::operator*(const mmcMatrix & rhs)const
 {
-  double sum;  // Variable to store temporary results
-  int row, col, index;
-
   if(MMC_ERROR_CHECK)
   {
     // insure that the number of columns in the left hand side matrix
@@ -452,172 +536,32 @@ mmcMatrix mmcMatrix::operator*(const mmcMatrix & rhs)const
 
   // create a new mmcMatrix object of the correct dimensions
   // in order to store the result
-  mmcMatrix result(NumRows, rhs.GetNumColumns());
-
-  if(mmcMaxNumThreads > 1 && NumColumns*NumRows > mmcThreshold) // if more that one thread is allowed, used multiple threads. Otherwise use serial code
-  {  
-    bool done = false;
-    int error, status;
-
-    //cout << "starting new multiplication" << endl;
-    
-    // Define data structure that will passed to all of the threads
-    mmcThreadData thread_data;
-    thread_data.lhs_data = MatrixData;
-    thread_data.lhs_num_rows = NumRows;
-    thread_data.lhs_num_columns = NumColumns;        
-    thread_data.result_data = result.GetMatrixData();
-    thread_data.result_num_columns = result.GetNumColumns();
-    thread_data.result_num_rows = result.GetNumRows();
-    thread_data.rhs_data = rhs.GetMatrixData();
-    thread_data.rhs_num_columns = rhs.GetNumColumns();
-    thread_data.rhs_num_rows = rhs.GetNumRows();
-    thread_data.current_column = 0;
-    thread_data.current_row = 0;  
-
-    mmcThreadData *data = &thread_data;
-    
-    // create all of the threads
-    pthread_t threads[mmcMaxNumThreads-1];
-    for(int i = 0; i < mmcMaxNumThreads-1; i++)
-    {
-        error = pthread_create(&threads[i], 0, mmcThreadMultiply, (void *)&thread_data);
-        if (error)
-          cout << "Error occurred while creating thread number: " << i << endl;
-    }
+  mmcMatrix result(NumRows, rhs.GetNumColumns(), 0.0);
+
+  // the result is divided into tiles that are computed independently
+  mmcMultiplyData multiply_data;
+  multiply_data.lhs_data = MatrixData;
+  multiply_data.rhs_data = rhs.GetMatrixData();
+  multiply_data.result_data = result.GetMatrixData();
+  multiply_data.lhs_num_rows = NumRows;
+  multiply_data.lhs_num_columns = NumColumns;
+  multiply_data.rhs_num_columns = rhs.GetNumColumns();
+  multiply_data.num_tile_columns = (rhs.GetNumColumns() + mmcTileColumns - 1) / mmcTileColumns;
+  multiply_data.block_function = mmcGetMultiplyBlockFunction();
+
+  int num_tiles = ((NumRows + mmcTileRows - 1) / mmcTileRows) * multiply_data.num_tile_columns;
+
+  // only use the thread pool if there is enough work to make up for the synchronization overhead
+  if((double)NumRows * NumColumns * rhs.GetNumColumns() >= mmcThreshold)
+    mmcRunTasks(mmcMultiplyTile, &multiply_data, num_tiles);
+  else
+    for(int tile = 0; tile < num_tiles; tile++)
+      mmcMultiplyTile(tile, &multiply_data);
 
-    // join in on the work
-    while(!done)
-    {
-     // obtain the mutex lock and determine current row and column
-     pthread_mutex_lock(&mmcLock);
-     row = (data->current_row);
-     col = (data->current_column);
-     data->current_column += mmcChunkSize;
-     while(data->current_column >= data->rhs_num_columns)
-     {
-         data->current_column = data->current_column - data->rhs_num_columns;
-         (data->current_row)++;
-      }
-     pthread_mutex_unlock(&mmcLock); // release the lock
-
-     for(int i = 0; i < mmcChunkSize && !done; i++)
-     {
-       // if there is work left to be done, do it!
-       if(row < data->lhs_num_rows && col < data->rhs_num_columns)
-       {
-         //cout << "(" << row << ", " << col << ")" << endl;
-         // Preform sum of row in left hand matrix times column in right hand
-         // matrix.
-         sum = 0.0;
-
-         for(index = 0; index < data->lhs_num_columns; index ++)
-           sum += data->lhs_data[row*data->lhs_num_columns + index] * data->rhs_data[index*data->rhs_num_columns + col];
-
-         data->result_data[row*data->result_num_columns + col] = sum;
-
-         col++;
-         if(col == data->rhs_num_columns)
-         {
-             col = 0;
-             row++;
-          }
-
-       } else {
-         // there is nothing else left to be done
-         done = true;
-       }
-     }
-    }  // while(!done) 
-
-    // wait for the other threads to finish
-    for(int i =  0; i < mmcMaxNumThreads-1; i++)
-    {
-        error = pthread_join(threads[i], (void **)&status);
-        if (error)
-          cout << "Error joining thread." << endl;            
-    }
-  } else { // Only one thread allowed, using serial code
-   double *result_matrix_data = result.GetMatrixData();
-   int result_num_columns = result.GetNumColumns();
-   double *rhs_matrix_data = rhs.GetMatrixData();
-   int rhs_num_columns = rhs.GetNumColumns();
-
-   // Preform the actual multiplication
-   for(row = 0; row < NumRows; row++)
-     for(col = 0; col < rhs.GetNumColumns(); col++)
-       {
-         // Preform sum of row in left hand matrix times column in right hand
-         // matrix.
-         sum = 0.0;
-
-         for(index = 0; index < NumColumns; index ++)
-           sum += MatrixData[row*NumColumns + index] * rhs_matrix_data[index*rhs_num_columns + col];
-
-         result_matrix_data[row*result_num_columns + col] = sum;
-       }
-   }
-  
   // return the result
   return result;
 }
 
-// thread routine for matrix multiply
-void *mmcThreadMultiply(void *thread_data)
-{
-  int row, col, index;
-  bool done = false;
-  double sum;
-  
-  mmcThreadData *data;
-  data = (mmcThreadData *)thread_data;
-
-  while(!done)
-  {
-   // obtain the mutex lock and determine current row and column
-   pthread_mutex_lock(&mmcLock);
-   row = (data->current_row);
-   col = (data->current_column);
-   data->current_column += mmcChunkSize;
-   while(data->current_column >= data->rhs_num_columns)
-   {
-       data->current_column = data->current_column - data->rhs_num_columns;
-       (data->current_row)++;
-    }
-   pthread_mutex_unlock(&mmcLock); // release the lock
-
-   for(int i = 0; i < mmcChunkSize && !done; i++)
-   {
-     // if there is work left to be done, do it!
-     if(row < data->lhs_num_rows && col < data->rhs_num_columns)
-     {
-       //cout << "(" << row << ", " << col << ")" << endl;
-       // Preform sum of row in left hand matrix times column in right hand
-       // matrix.
-       sum = 0.0;
-
-       for(index = 0; index < data->lhs_num_columns; index ++)
-         sum += data->lhs_data[row*data->lhs_num_columns + index] * data->rhs_data[index*data->rhs_num_columns + col];
-
-       data->result_data[row*data->result_num_columns + col] = sum;
-
-       col++;
-       if(col == data->rhs_num_columns)
-       {
-           col = 0;
-           row++;
-        }       
-       
-     } else {
-       // there is nothing else left to be done
-       done = true;
-     }
-   }
-  }  // while(!done) 
-  
-  pthread_exit((void*)0);
-}
-
 #if MMC_ERROR_CHECK==1 // Only define these methods if error checking is on, otherwise they are inlined
   // returns an element of the matrix
   double mmcMatrix::GetElement(int row, int col)const
@@ -705,97 +649,8 @@ mmcMatrix mmcMatrix::GetTranspose()const
   return(result);
 }
 
-// returns matrix scaled by a constant
-mmcMatrix mmcMatrix::GetScaled(double scale_factor)const
-{
-  int row, col;
-
-  if(MMC_ERROR_CHECK)
-  {
-    // insure that the matrix has at least one element
-    if(NumRows == 0 && NumColumns == 0)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  
-    // insure that the matrix data pointer is not NULL
-    if(MatrixData == NULL)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  }
-
-  // create a matrix object to store the transpose
-  mmcMatrix result(NumRows, NumColumns);
-
-  double *result_matrix_data = result.GetMatrixData();
-  int result_num_columns = result.GetNumColumns();
-  
-  // Multiply each element of the matrix by the scale factor
-  for(row = 0; row < NumRows; row++)
-    for(col = 0; col < NumColumns; col++)
-      result_matrix_data[row*result_num_columns + col] = scale_factor * MatrixData[row*NumColumns + col];
-
-  return(result);
-}
-
-mmcMatrix mmcMatrix::operator*(double scale_factor)const
-{
-  int row, col;
-
-  if(MMC_ERROR_CHECK)
-  {
-    // insure that the matrix has at least one element
-    if(NumRows == 0 && NumColumns == 0)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  
-    // insure that the matrix data pointer is not NULL
-    if(MatrixData == NULL)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  }
-
-  // create a matrix object to store the transpose
-  mmcMatrix result(NumRows, NumColumns);
 
-  double *result_matrix_data = result.GetMatrixData();
-  int result_num_columns = result.GetNumColumns();
-  
-  // Multiply each element of the matrix by the scale factor
-  for(row = 0; row < NumRows; row++)
-    for(col = 0; col < NumColumns; col++)
-      result_matrix_data[row*result_num_columns + col] = scale_factor * MatrixData[row*NumColumns + col];
 
-  return(result);
-}
-
-
-mmcMatrix operator*(double scale_factor, const mmcMatrix & rhs)
-{
-  int row, col;
-
-  if(MMC_ERROR_CHECK)
-  {
-    // insure that the matrix has at least one element
-    if(rhs.GetNumRows() == 0 && rhs.GetNumColumns() == 0)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  
-    // insure that the matrix data pointer is not NULL
-    if(rhs.GetMatrixData() == NULL)
-      throw mmcException(SIZE_ZERO, __LINE__);
-  }
-
-  double *rhs_matrix_data = rhs.GetMatrixData();
-  int rhs_num_columns = rhs.GetNumColumns();  
-  
-  // create a matrix object to store the transpose
-  mmcMatrix result(rhs.GetNumRows(), rhs.GetNumColumns());
-
-  double *result_matrix_data = result.GetMatrixData();
-  int result_num_columns = result.GetNumColumns();
-  
-  // Multiply each element of the matrix by the scale factor
-  for(row = 0; row < rhs.GetNumRows(); row++)
-    for(col = 0; col < rhs.GetNumColumns(); col++)
-      result_matrix_data[row*result_num_columns + col] = scale_factor * rhs_matrix_data[row*rhs_num_columns + col];
-
-  return(result);
-}
 
 // returns matrix scaled by a constant
 const mmcMatrix & mmcMatrix::operator*=(double scale_factor)
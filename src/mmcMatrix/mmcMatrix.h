@@ -22,6 +22,7 @@ DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define mmcMatrixH
 
 #include <iostream>
+#include <math.h>
 
 
 // If MMC_ERROR_CHECK is set to 1, mmcMatrix class checks for overruns when accessing matrices.
@@ -59,28 +60,51 @@ enum mmcOUTPUT_FORMAT {MMC_NATIVE, MATLAB_ASCII};
 // this name is only used for outputting files in the MATLAB format
 const int mmcMAX_NAME_LENGTH = 25;
 
-// declare constants and data types used for multithreading (set to 1 for a uniprocessor system for maximum efficiency)
-const int mmcMaxNumThreads = 1;
-const int mmcChunkSize = 100;
-const int mmcThreshold = 60000;  // min number of elements a matrix should have in order to use multithreading
-typedef struct mmcThreadData_s{  // struct to store data used by threads
-  double *rhs_data;
-  double *lhs_data;
+// constants used by the matrix multiplication, the result is divided into tiles of mmcTileRows x mmcTileColumns elements
+// that are computed in parallel by the thread pool (see mmcThreadPool.h), the sum over the inner dimension is
+// blocked into mmcTileDepth long pieces so that the data used by a tile stays in cache
+const int mmcTileRows = 64;
+const int mmcTileColumns = 256;
+const int mmcTileDepth = 256;
+const int mmcThreshold = 60000;  // min number of multiply-adds a product should have in order to use multithreading
+
+// data shared by the tasks of one matrix multiplication
+struct mmcMultiplyData;
+typedef void (*mmcMultiplyBlockFunction)(const mmcMultiplyData &data, int row_begin, int row_end, int col_begin, int col_end, int depth_begin, int depth_end);
+struct mmcMultiplyData{
+  const double *lhs_data;
+  const double *rhs_data;
   double *result_data;
-  int rhs_num_rows;
-  int rhs_num_columns;
   int lhs_num_rows;
   int lhs_num_columns;
-  int result_num_rows;
-  int result_num_columns;
-  int current_row;                  // Mutex mmcLock must be used to access this value
-  int current_column;            // Mutex mmcLock must be used to access this value
-}mmcThreadData;
-// thread routine used for matrix multiplication
-void *mmcThreadMultiply(void *thread_data);
+  int rhs_num_columns;
+  int num_tile_columns;                       // number of tiles across the columns of the result
+  mmcMultiplyBlockFunction block_function;    // kernel used to multiply the blocks (chosen at runtime based on the processor)
+};
+
+class mmcMatrix;
+template <class E> class mmcScaledExpression;
+
+// Base class of the lazy matrix expressions (curiously recurring template pattern). The element-wise operators
+// (+, -, scalar * and GetScaled) build expression objects instead of temporary matrices, the expression is evaluated
+// in a single pass when it is assigned to, added to, or used to construct an mmcMatrix. Every expression type E
+// provides GetNumRows(), GetNumColumns(), and GetLinearElement(index) where index = row*num_columns + col.
+template <class E> class mmcMatrixExpression
+{
+public:
+  const E & Self()const {return static_cast<const E &>(*this);}
+
+  // methods that allow an expression to be used like an mmcMatrix without first evaluating it
+  double GetElement(int row, int col)const;
+  double DotProduct(const mmcMatrix & rhs)const;
+  double GetMagnitude()const;
+  mmcMatrix GetNormalized()const;
+  mmcMatrix GetTranspose()const;
+  mmcScaledExpression<E> GetScaled(double scale_factor)const;
+};
 
       
-class mmcMatrix
+class mmcMatrix : public mmcMatrixExpression<mmcMatrix>
 {
 public:
   // Default constructer, does not allocate memory
@@ -98,6 +122,15 @@ public:
   //copy constructer
   mmcMatrix(const mmcMatrix &);
 
+  // constructs the matrix by evaluating a matrix expression, no temporary matrices are created
+  template <class E> mmcMatrix(const mmcMatrixExpression<E> &rhs);
+
+#if __cplusplus >= 201103L
+  // move constructer and move assignment, the matrix data of rhs is taken over and rhs is left empty
+  mmcMatrix(mmcMatrix &&rhs);
+  mmcMatrix & operator=(mmcMatrix &&rhs);
+#endif
+
   // methods to set or get matrix elements
 #if MMC_ERROR_CHECK==1 // error checking enabled, will used original methods not the inlined ones below
   void SetElement( int row, int col, double new_value);  
@@ -119,21 +152,20 @@ public:
   // overloaded operators:
   //assignment operator (overload of the binary = operator)
   mmcMatrix & operator=(const mmcMatrix & rhs);
-  //addition operator (overload of the binary + operator)
-  mmcMatrix operator+(const mmcMatrix & rhs)const;
-  //minus operator (overload of the binary - operator)
-  mmcMatrix operator-(const mmcMatrix & rhs)const;
+  template <class E> mmcMatrix & operator=(const mmcMatrixExpression<E> & rhs); // evaluates the expression directly into this matrix
   //multiplication operator (overload of the binary * operator)
   mmcMatrix operator*(const mmcMatrix & rhs)const;
-  mmcMatrix operator*(double scale_factor)const;
-  friend mmcMatrix operator*(double scale_factor, const mmcMatrix & rhs);
   const mmcMatrix & operator+=(const mmcMatrix & rhs);
   const mmcMatrix & operator-=(const mmcMatrix & rhs);
+  template <class E> const mmcMatrix & operator+=(const mmcMatrixExpression<E> & rhs);
+  template <class E> const mmcMatrix & operator-=(const mmcMatrixExpression<E> & rhs);
   const mmcMatrix & operator*=(double scale_factor);
+  // the element-wise operators +, - and scalar * are defined for all matrix expressions below the mmcException class
   
   // accessor functions that do not change the object
   int GetNumRows()const {return NumRows;} 
   int GetNumColumns()const {return NumColumns;}
+  double GetLinearElement(int index)const {return MatrixData[index];} // element access used when evaluating expressions, no range checking
 
   void DisplayMatrix()const;  //Prints the matrix to the screen
   
@@ -142,7 +174,7 @@ public:
   mmcMatrix GetInverse3By3()const;  // return inverse of original a 3x3 matrix
   double GetDeterminate3By3()const; // return the determinate of a 3x3 matrix
   mmcMatrix GetTranspose()const; // return transpose of original matrix
-  mmcMatrix GetScaled(double scale_factor)const; // return scaled version of original matrix
+  // GetScaled is inherited from mmcMatrixExpression and returns a lazily evaluated expression
   double DotProduct(const mmcMatrix & rhs)const; // calculates dot product
   mmcMatrix CrossProduct(const mmcMatrix & rhs)const;  // calculates dot product
   mmcMatrix ElementWiseMultiplication(const mmcMatrix & rhs)const; 
@@ -210,6 +242,223 @@ private:
   mmcECODE ErrorCode;
 }; 
 
+// operand storage used by the expression classes, matrices are held by reference and expressions by value
+// (expressions are small and are usually temporaries that would otherwise go out of scope)
+template <class E> struct mmcExpressionOperand {typedef const E type;};
+template <> struct mmcExpressionOperand<mmcMatrix> {typedef const mmcMatrix & type;};
+
+// checks that an operand of an element-wise operation holds data
+inline void mmcCheckExpressionOperand(const mmcMatrix &operand)
+{
+  if(MMC_ERROR_CHECK && operand.GetMatrixData() == NULL)
+    throw mmcException(SIZE_ZERO, __LINE__, "mmcMatrix.h");
+}
+template <class E> inline void mmcCheckExpressionOperand(const mmcMatrixExpression<E> &) {}
+
+struct mmcAddOperation {static double Apply(double lhs, double rhs) {return lhs + rhs;}};
+struct mmcSubtractOperation {static double Apply(double lhs, double rhs) {return lhs - rhs;}};
+
+// element-wise binary operation of two expressions with the same dimensions
+template <class L, class R, class Op> class mmcBinaryExpression : public mmcMatrixExpression<mmcBinaryExpression<L,R,Op> >
+{
+public:
+  mmcBinaryExpression(const L &lhs, const R &rhs) : Lhs(lhs), Rhs(rhs)
+  {
+    if(MMC_ERROR_CHECK)
+    {
+      mmcCheckExpressionOperand(lhs);
+      mmcCheckExpressionOperand(rhs);
+      if(lhs.GetNumRows() != rhs.GetNumRows() || lhs.GetNumColumns() != rhs.GetNumColumns())
+        throw mmcException(ADD_INCOMPAT, __LINE__, "mmcMatrix.h");
+    }
+  }
+
+  int GetNumRows()const {return Lhs.GetNumRows();}
+  int GetNumColumns()const {return Lhs.GetNumColumns();}
+  double GetLinearElement(int index)const {return Op::Apply(Lhs.GetLinearElement(index), Rhs.GetLinearElement(index));}
+
+private:
+  typename mmcExpressionOperand<L>::type Lhs;
+  typename mmcExpressionOperand<R>::type Rhs;
+};
+
+// expression multiplied by a scalar
+template <class E> class mmcScaledExpression : public mmcMatrixExpression<mmcScaledExpression<E> >
+{
+public:
+  mmcScaledExpression(const E &operand, double scale_factor) : Operand(operand), ScaleFactor(scale_factor) {mmcCheckExpressionOperand(operand);}
+
+  int GetNumRows()const {return Operand.GetNumRows();}
+  int GetNumColumns()const {return Operand.GetNumColumns();}
+  double GetLinearElement(int index)const {return ScaleFactor * Operand.GetLinearElement(index);}
+
+private:
+  typename mmcExpressionOperand<E>::type Operand;
+  double ScaleFactor;
+};
+
+// element-wise operators for matrices and expressions
+template <class L, class R> inline mmcBinaryExpression<L,R,mmcAddOperation> operator+(const mmcMatrixExpression<L> & lhs, const mmcMatrixExpression<R> & rhs)
+{
+  return mmcBinaryExpression<L,R,mmcAddOperation>(lhs.Self(), rhs.Self());
+}
+
+template <class L, class R> inline mmcBinaryExpression<L,R,mmcSubtractOperation> operator-(const mmcMatrixExpression<L> & lhs, const mmcMatrixExpression<R> & rhs)
+{
+  return mmcBinaryExpression<L,R,mmcSubtractOperation>(lhs.Self(), rhs.Self());
+}
+
+template <class E> inline mmcScaledExpression<E> operator*(const mmcMatrixExpression<E> & lhs, double scale_factor)
+{
+  return mmcScaledExpression<E>(lhs.Self(), scale_factor);
+}
+
+template <class E> inline mmcScaledExpression<E> operator*(double scale_factor, const mmcMatrixExpression<E> & rhs)
+{
+  return mmcScaledExpression<E>(rhs.Self(), scale_factor);
+}
+
+// evaluates an expression into a new matrix, matrices are passed through without a copy
+template <class E> inline mmcMatrix mmcEvaluate(const mmcMatrixExpression<E> & expression) {return mmcMatrix(expression.Self());}
+inline const mmcMatrix & mmcEvaluate(const mmcMatrix & matrix) {return matrix;}
+
+// matrix multiplication involving an expression, the expressions are evaluated first
+// (mmcMatrix::operator* is used when both operands are matrices)
+template <class L, class R> inline mmcMatrix operator*(const mmcMatrixExpression<L> & lhs, const mmcMatrixExpression<R> & rhs)
+{
+  return mmcEvaluate(lhs.Self()) * mmcEvaluate(rhs.Self());
+}
+
+// exact matches for a matrix and an expression, so these are not ambiguous with mmcMatrix::operator*
+template <class E> inline mmcMatrix operator*(const mmcMatrix & lhs, const mmcMatrixExpression<E> & rhs)
+{
+  return lhs * mmcEvaluate(rhs.Self());
+}
+
+template <class E> inline mmcMatrix operator*(const mmcMatrixExpression<E> & lhs, const mmcMatrix & rhs)
+{
+  return mmcEvaluate(lhs.Self()) * rhs;
+}
+
+template <class E> mmcMatrix::mmcMatrix(const mmcMatrixExpression<E> &rhs)
+{
+  const E &expression = rhs.Self();
+
+  OutputFormat = MMC_NATIVE;
+  Name[0] = '\0';
+
+  NumRows = expression.GetNumRows();
+  NumColumns = expression.GetNumColumns();
+  MatrixData = new double[NumRows * NumColumns];
+
+  for(int index = 0; index < NumRows * NumColumns; index++)
+    MatrixData[index] = expression.GetLinearElement(index);
+}
+
+template <class E> mmcMatrix & mmcMatrix::operator=(const mmcMatrixExpression<E> & rhs)
+{
+  const E &expression = rhs.Self();
+
+  // the matrix memory is only reallocated when the number of elements changes, an expression that refers to this
+  // matrix always has the same dimensions so it is safe to evaluate the expression directly into MatrixData
+  if(MatrixData == NULL || NumRows * NumColumns != expression.GetNumRows() * expression.GetNumColumns())
+  {
+    if(MatrixData != NULL)
+      delete [] MatrixData;
+    MatrixData = new double[expression.GetNumRows() * expression.GetNumColumns()];
+  }
+  NumRows = expression.GetNumRows();
+  NumColumns = expression.GetNumColumns();
+
+  for(int index = 0; index < NumRows * NumColumns; index++)
+    MatrixData[index] = expression.GetLinearElement(index);
+
+  return *this;
+}
+
+template <class E> const mmcMatrix & mmcMatrix::operator+=(const mmcMatrixExpression<E> & rhs)
+{
+  const E &expression = rhs.Self();
+
+  if(MMC_ERROR_CHECK)
+  {
+    if(MatrixData == NULL)
+      throw mmcException(SIZE_ZERO, __LINE__, "mmcMatrix.h");
+    if(NumRows != expression.GetNumRows() || NumColumns != expression.GetNumColumns())
+      throw mmcException(ADD_INCOMPAT, __LINE__, "mmcMatrix.h");
+  }
+
+  for(int index = 0; index < NumRows * NumColumns; index++)
+    MatrixData[index] += expression.GetLinearElement(index);
+
+  return *this;
+}
+
+template <class E> const mmcMatrix & mmcMatrix::operator-=(const mmcMatrixExpression<E> & rhs)
+{
+  const E &expression = rhs.Self();
+
+  if(MMC_ERROR_CHECK)
+  {
+    if(MatrixData == NULL)
+      throw mmcException(SIZE_ZERO, __LINE__, "mmcMatrix.h");
+    if(NumRows != expression.GetNumRows() || NumColumns != expression.GetNumColumns())
+      throw mmcException(ADD_INCOMPAT, __LINE__, "mmcMatrix.h");
+  }
+
+  for(int index = 0; index < NumRows * NumColumns; index++)
+    MatrixData[index] -= expression.GetLinearElement(index);
+
+  return *this;
+}
+
+template <class E> double mmcMatrixExpression<E>::GetElement(int row, int col)const
+{
+  if(MMC_ERROR_CHECK && (row < 0 || row >= Self().GetNumRows() || col < 0 || col >= Self().GetNumColumns()))
+    throw mmcException(OVERRUN, __LINE__, "mmcMatrix.h");
+
+  return Self().GetLinearElement(row * Self().GetNumColumns() + col);
+}
+
+template <class E> double mmcMatrixExpression<E>::DotProduct(const mmcMatrix & rhs)const
+{
+  if(MMC_ERROR_CHECK && Self().GetNumRows() * Self().GetNumColumns() != rhs.GetNumRows() * rhs.GetNumColumns())
+    throw mmcException(VECTOR_INCOMPAT, __LINE__, "mmcMatrix.h");
+
+  double result = 0.0;
+  for(int index = 0; index < rhs.GetNumRows() * rhs.GetNumColumns(); index++)
+    result += Self().GetLinearElement(index) * rhs.GetLinearElement(index);
+
+  return result;
+}
+
+template <class E> double mmcMatrixExpression<E>::GetMagnitude()const
+{
+  if(MMC_ERROR_CHECK && Self().GetNumRows() != 1 && Self().GetNumColumns() != 1)
+    throw mmcException(NOT_VECTOR, __LINE__, "mmcMatrix.h");
+
+  double magnitude = 0.0;
+  for(int index = 0; index < Self().GetNumRows() * Self().GetNumColumns(); index++)
+    magnitude += Self().GetLinearElement(index) * Self().GetLinearElement(index);
+
+  return sqrt(magnitude);
+}
+
+template <class E> mmcMatrix mmcMatrixExpression<E>::GetNormalized()const
+{
+  return mmcMatrix(Self()).GetNormalized();
+}
+
+template <class E> mmcMatrix mmcMatrixExpression<E>::GetTranspose()const
+{
+  return mmcMatrix(Self()).GetTranspose();
+}
+
+template <class E> mmcScaledExpression<E> mmcMatrixExpression<E>::GetScaled(double scale_factor)const
+{
+  return mmcScaledExpression<E>(Self(), scale_factor);
+}
+
 
 
 #endif //mmcMatrixH
@@ -0,0 +1,261 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+#include <iostream>
+#include "mmcThreadPool.h"
+
+using namespace std;
+
+class mmcThreadPool
+{
+public:
+  mmcThreadPool();
+  ~mmcThreadPool();
+
+  void SetNumThreads(int num_threads);
+  int GetNumThreads();
+  void RunTasks(mmcTaskFunction task_function, void *task_data, int num_tasks);
+
+private:
+  struct WorkerData
+  {
+    mmcThreadPool *pool;
+    int thread_index;
+    unsigned start_generation; // job generation when the thread was created, the thread waits for the next one
+  };
+
+  static void *WorkerThread(void *worker_data);
+  void StartWorkers();
+  void StopWorkers();
+  void RunAssignedTasks(int thread_index);
+
+  int NumThreads;                    // total number of threads including the thread calling RunTasks, only written while both
+                                     // JobLock and StateLock are held so either lock is enough to read it
+  std::vector<pthread_t> Workers;
+  std::vector<WorkerData> WorkerDataList;
+
+  pthread_mutex_t JobLock;           // held for the duration of a job, only one job runs at a time
+  pthread_mutex_t StateLock;         // protects the job state below
+  pthread_cond_t JobStarted;
+  pthread_cond_t JobFinished;
+
+  unsigned JobGeneration;            // incremented each time a new job is started
+  int WorkersRemaining;              // workers that have not yet finished the current job
+  bool ShutDown;
+  mmcTaskFunction TaskFunction;
+  void *TaskData;
+  int NumTasks;
+};
+
+mmcThreadPool::mmcThreadPool()
+{
+  NumThreads = 0;
+  JobGeneration = 0;
+  WorkersRemaining = 0;
+  ShutDown = false;
+  TaskFunction = 0;
+  TaskData = 0;
+  NumTasks = 0;
+
+  pthread_mutex_init(&JobLock, 0);
+  pthread_mutex_init(&StateLock, 0);
+  pthread_cond_init(&JobStarted, 0);
+  pthread_cond_init(&JobFinished, 0);
+}
+
+mmcThreadPool::~mmcThreadPool()
+{
+  StopWorkers();
+
+  pthread_cond_destroy(&JobFinished);
+  pthread_cond_destroy(&JobStarted);
+  pthread_mutex_destroy(&StateLock);
+  pthread_mutex_destroy(&JobLock);
+}
+
+void mmcThreadPool::SetNumThreads(int num_threads)
+{
+  if(num_threads <= 0)
+  {
+    long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = num_processors > 0 ? (int)num_processors : 1;
+  }
+
+  // wait for any running job to finish before replacing the workers
+  pthread_mutex_lock(&JobLock);
+  if(num_threads != NumThreads)
+  {
+    StopWorkers();
+    pthread_mutex_lock(&StateLock);
+    NumThreads = num_threads;
+    pthread_mutex_unlock(&StateLock);
+  }
+  pthread_mutex_unlock(&JobLock);
+}
+
+int mmcThreadPool::GetNumThreads()
+{
+  // only the state lock is taken so that the count can be read while a job is running
+  pthread_mutex_lock(&StateLock);
+  int num_threads = NumThreads;
+  pthread_mutex_unlock(&StateLock);
+
+  if(num_threads == 0)
+  {
+    SetNumThreads(0);
+
+    pthread_mutex_lock(&StateLock);
+    num_threads = NumThreads;
+    pthread_mutex_unlock(&StateLock);
+  }
+
+  return num_threads;
+}
+
+// called with JobLock held
+void mmcThreadPool::StartWorkers()
+{
+  ShutDown = false;
+  WorkerDataList.resize(NumThreads-1);
+  Workers.resize(NumThreads-1);
+
+  for(int i = 0; i < NumThreads-1; i++)
+  {
+    WorkerDataList[i].pool = this;
+    WorkerDataList[i].thread_index = i+1; // the calling thread is thread 0
+    WorkerDataList[i].start_generation = JobGeneration;
+    if(pthread_create(&Workers[i], 0, WorkerThread, (void *)&WorkerDataList[i]) != 0)
+    {
+      // could not create all of the threads, run with the ones that were created
+      cerr << "mmcThreadPool: error occurred while creating thread number: " << i << endl;
+      Workers.resize(i);
+      WorkerDataList.resize(i);
+      pthread_mutex_lock(&StateLock);
+      NumThreads = i+1;
+      pthread_mutex_unlock(&StateLock);
+      break;
+    }
+  }
+}
+
+void mmcThreadPool::StopWorkers()
+{
+  pthread_mutex_lock(&StateLock);
+  ShutDown = true;
+  pthread_cond_broadcast(&JobStarted);
+  pthread_mutex_unlock(&StateLock);
+
+  for(unsigned i = 0; i < Workers.size(); i++)
+    pthread_join(Workers[i], 0);
+
+  Workers.clear();
+  WorkerDataList.clear();
+}
+
+void mmcThreadPool::RunAssignedTasks(int thread_index)
+{
+  for(int task = thread_index; task < NumTasks; task += NumThreads)
+    TaskFunction(task, TaskData);
+}
+
+void *mmcThreadPool::WorkerThread(void *worker_data)
+{
+  WorkerData *data = (WorkerData *)worker_data;
+  mmcThreadPool *pool = data->pool;
+  unsigned last_generation = data->start_generation;
+
+  pthread_mutex_lock(&pool->StateLock);
+  while(true)
+  {
+    // wait for a new job
+    while(!pool->ShutDown && pool->JobGeneration == last_generation)
+      pthread_cond_wait(&pool->JobStarted, &pool->StateLock);
+
+    if(pool->ShutDown)
+      break;
+
+    last_generation = pool->JobGeneration;
+    pthread_mutex_unlock(&pool->StateLock);
+
+    pool->RunAssignedTasks(data->thread_index);
+
+    pthread_mutex_lock(&pool->StateLock);
+    if(--(pool->WorkersRemaining) == 0)
+      pthread_cond_signal(&pool->JobFinished);
+  }
+  pthread_mutex_unlock(&pool->StateLock);
+
+  return 0;
+}
+
+void mmcThreadPool::RunTasks(mmcTaskFunction task_function, void *task_data, int num_tasks)
+{
+  // run serially if there is only one thread, one task, or the pool is already busy with another job
+  if(num_tasks <= 1 || GetNumThreads() <= 1 || pthread_mutex_trylock(&JobLock) != 0)
+  {
+    for(int task = 0; task < num_tasks; task++)
+      task_function(task, task_data);
+    return;
+  }
+
+  if((int)Workers.size() != NumThreads-1)
+    StartWorkers();
+
+  // publish the job and wake up the workers
+  pthread_mutex_lock(&StateLock);
+  TaskFunction = task_function;
+  TaskData = task_data;
+  NumTasks = num_tasks;
+  WorkersRemaining = Workers.size();
+  JobGeneration++;
+  pthread_cond_broadcast(&JobStarted);
+  pthread_mutex_unlock(&StateLock);
+
+  // join in on the work
+  RunAssignedTasks(0);
+
+  // wait for the workers to finish their tasks
+  pthread_mutex_lock(&StateLock);
+  while(WorkersRemaining > 0)
+    pthread_cond_wait(&JobFinished, &StateLock);
+  pthread_mutex_unlock(&StateLock);
+
+  pthread_mutex_unlock(&JobLock);
+}
+
+static mmcThreadPool mmcPool;
+
+void mmcSetNumThreads(int num_threads)
+{
+  mmcPool.SetNumThreads(num_threads);
+}
+
+int mmcGetNumThreads()
+{
+  return mmcPool.GetNumThreads();
+}
+
+void mmcRunTasks(mmcTaskFunction task_function, void *task_data, int num_tasks)
+{
+  mmcPool.RunTasks(task_function, task_data, num_tasks);
+}
@@ -0,0 +1,39 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef mmcThreadPoolH
+#define mmcThreadPoolH
+
+// Persistent pool of worker threads used to parallelize matrix operations and constraint cluster solves. The threads are
+// created the first time they are needed and then wait for work, so running a job does not create or join any threads.
+
+// a job is split into num_tasks independent tasks, the task function is called once for each task index
+typedef void (*mmcTaskFunction)(int task, void *task_data);
+
+// sets the number of threads used to run jobs (including the calling thread), 0 selects the number of online processors
+void mmcSetNumThreads(int num_threads);
+int mmcGetNumThreads();
+
+// Runs all of the tasks and returns when they are complete. The calling thread works on the job too. Tasks are assigned
+// to the threads statically (thread i runs tasks i, i+num_threads, ...), so no locking is needed to hand out work. If the
+// pool is already running a job (a call from another thread or from within a task), the tasks are run serially instead.
+void mmcRunTasks(mmcTaskFunction task_function, void *task_data, int num_tasks);
+
+#endif //mmcThreadPoolH
@@ -0,0 +1,174 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "mmcSparseCholesky.h"
+#include "mmcSparseOrdering.h"
+
+using namespace std;
+
+// Finds the pattern of row k of L, the set of nodes reachable in the elimination tree from the entries above the diagonal
+// in column k of the (symmetric) matrix. The pattern is returned in pattern[top..size-1] in topological order.
+static int GetRowPattern(const mmcSparseMatrix &matrix, int k, const vector<int> &parent, vector<int> &pattern, vector<int> &marker)
+{
+  const vector<int> &column_start = matrix.GetColumnStart();
+  const vector<int> &row_indices = matrix.GetRowIndices();
+  int size = matrix.GetNumColumns();
+  int top = size;
+
+  marker[k] = k;
+  for(int index = column_start[k]; index < column_start[k+1]; index++)
+  {
+    int i = row_indices[index];
+    if(i > k)
+      continue;
+
+    // walk up the tree until a node already in the pattern is found, then push the path onto the stack
+    int length = 0;
+    for(; marker[i] != k; i = parent[i])
+    {
+      pattern[length++] = i;
+      marker[i] = k;
+    }
+    while(length > 0)
+      pattern[--top] = pattern[--length];
+  }
+  return top;
+}
+
+void mmcSparseCholesky::Analyze(const mmcSparseMatrix &matrix, mmcSparseOrderingMethod ordering)
+{
+  if(matrix.GetNumRows() != matrix.GetNumColumns())
+    throw mmcException(NOT_SQUARE, __LINE__, "mmcSparseCholesky.cpp");
+
+  Size = matrix.GetNumColumns();
+  Factorized = false;
+
+  if(ordering == MMC_AMD_ORDERING)
+    Permutation = mmcApproximateMinimumDegree(matrix);
+  else {
+    Permutation.resize(Size);
+    for(int i = 0; i < Size; i++)
+      Permutation[i] = i;
+  }
+
+  mmcSparseMatrix permuted = matrix.GetSymmetricPermutation(Permutation);
+  Parent = mmcEliminationTree(permuted);
+
+  // the column counts of L follow from the row patterns
+  vector<int> column_count(Size, 1);
+  vector<int> pattern(Size);
+  vector<int> marker(Size, -1);
+  for(int k = 0; k < Size; k++)
+    for(int top = GetRowPattern(permuted, k, Parent, pattern, marker); top < Size; top++)
+      column_count[pattern[top]]++;
+
+  FactorColumnStart.assign(Size+1, 0);
+  for(int col = 0; col < Size; col++)
+    FactorColumnStart[col+1] = FactorColumnStart[col] + column_count[col];
+  FactorRowIndices.assign(FactorColumnStart[Size], 0);
+  FactorValues.assign(FactorColumnStart[Size], 0.0);
+}
+
+void mmcSparseCholesky::Factorize(const mmcSparseMatrix &matrix)
+{
+  if(matrix.GetNumRows() != Size || matrix.GetNumColumns() != Size)
+    throw mmcException(ADD_INCOMPAT, __LINE__, "mmcSparseCholesky.cpp");
+
+  Factorized = false;
+  mmcSparseMatrix permuted = matrix.GetSymmetricPermutation(Permutation);
+  const vector<int> &column_start = permuted.GetColumnStart();
+  const vector<int> &row_indices = permuted.GetRowIndices();
+  const vector<double> &values = permuted.GetValues();
+
+  // up-looking factorization, row k of L is found with a sparse triangular solve using the columns of L computed so far
+  vector<int> next(FactorColumnStart.begin(), FactorColumnStart.end()-1);  // next free entry in each column of L
+  vector<int> pattern(Size);
+  vector<int> marker(Size, -1);
+  vector<double> work(Size, 0.0);
+  for(int k = 0; k < Size; k++)
+  {
+    int top = GetRowPattern(permuted, k, Parent, pattern, marker);
+
+    for(int index = column_start[k]; index < column_start[k+1]; index++)
+      if(row_indices[index] <= k)
+        work[row_indices[index]] = values[index];
+    double diagonal = work[k];
+    work[k] = 0.0;
+
+    for(; top < Size; top++)
+    {
+      int i = pattern[top];
+      double l_ki = work[i] / FactorValues[FactorColumnStart[i]];
+      work[i] = 0.0;
+      for(int index = FactorColumnStart[i] + 1; index < next[i]; index++)
+        work[FactorRowIndices[index]] -= FactorValues[index]*l_ki;
+      diagonal -= l_ki*l_ki;
+
+      int destination = next[i]++;
+      FactorRowIndices[destination] = k;
+      FactorValues[destination] = l_ki;
+    }
+
+    if(!(diagonal > 0.0))
+      throw mmcException(SINGULAR, __LINE__, "mmcSparseCholesky.cpp");
+
+    int destination = next[k]++;
+    FactorRowIndices[destination] = k;
+    FactorValues[destination] = sqrt(diagonal);
+  }
+
+  Factorized = true;
+}
+
+mmcMatrix mmcSparseCholesky::Solve(const mmcMatrix &rhs) const
+{
+  if(!Factorized)
+    throw mmcException(SIZE_ZERO, __LINE__, "mmcSparseCholesky.cpp");
+  if(rhs.GetNumRows() != Size || rhs.GetNumColumns() != 1)
+    throw mmcException(MULT_INCOMPAT, __LINE__, "mmcSparseCholesky.cpp");
+
+  vector<double> work(Size);
+  const double *rhs_data = rhs.GetMatrixData();
+  for(int i = 0; i < Size; i++)
+    work[i] = rhs_data[Permutation[i]];
+
+  // L*y = P*rhs
+  for(int col = 0; col < Size; col++)
+  {
+    work[col] /= FactorValues[FactorColumnStart[col]];
+    for(int index = FactorColumnStart[col] + 1; index < FactorColumnStart[col+1]; index++)
+      work[FactorRowIndices[index]] -= FactorValues[index]*work[col];
+  }
+
+  // L^T*z = y
+  for(int col = Size-1; col >= 0; col--)
+  {
+    for(int index = FactorColumnStart[col] + 1; index < FactorColumnStart[col+1]; index++)
+      work[col] -= FactorValues[index]*work[FactorRowIndices[index]];
+    work[col] /= FactorValues[FactorColumnStart[col]];
+  }
+
+  mmcMatrix solution(Size, 1);
+  double *solution_data = solution.GetMatrixData();
+  for(int i = 0; i < Size; i++)
+    solution_data[Permutation[i]] = work[i];
+  return solution;
+}
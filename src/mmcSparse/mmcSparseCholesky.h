@@ -0,0 +1,62 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef mmcSparseCholeskyH
+#define mmcSparseCholeskyH
+
+#include <vector>
+#include "mmcSparseMatrix.h"
+
+enum mmcSparseOrderingMethod {MMC_NATURAL_ORDERING, MMC_AMD_ORDERING};
+
+// Sparse Cholesky factorization P*A*P^T = L*L^T of a symmetric positive definite matrix, such as the normal matrix
+// J^T*J + mu*I of a least squares problem. Analyze computes the fill reducing ordering and the structure of L once,
+// Factorize can then be called repeatedly for matrices with the same pattern (for example with a different mu).
+class mmcSparseCholesky
+{
+public:
+  mmcSparseCholesky() {Size = 0; Factorized = false;}
+  mmcSparseCholesky(const mmcSparseMatrix &matrix, mmcSparseOrderingMethod ordering = MMC_AMD_ORDERING) {Analyze(matrix, ordering); Factorize(matrix);}
+
+  // symbolic analysis, only the pattern of the matrix is used
+  void Analyze(const mmcSparseMatrix &matrix, mmcSparseOrderingMethod ordering = MMC_AMD_ORDERING);
+
+  // numeric factorization, both triangles of the matrix must be stored and the pattern must match the one given to Analyze
+  // throws mmcException(SINGULAR) if the matrix is not positive definite
+  void Factorize(const mmcSparseMatrix &matrix);
+
+  mmcMatrix Solve(const mmcMatrix &rhs) const;  // returns the solution of A*x = rhs
+
+  int GetSize() const {return Size;}
+  int GetNumFactorNonZeros() const {return FactorRowIndices.size();}  // number of entries of L including the diagonal
+  const std::vector<int> & GetPermutation() const {return Permutation;}
+
+private:
+  int Size;
+  bool Factorized;
+  std::vector<int> Permutation;
+  std::vector<int> Parent;           // elimination tree of the permuted matrix
+  std::vector<int> FactorColumnStart;
+  std::vector<int> FactorRowIndices;  // the diagonal is the first entry of each column
+  std::vector<double> FactorValues;
+};
+
+#endif //mmcSparseCholeskyH
@@ -0,0 +1,359 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <algorithm>
+#include "mmcSparseMatrix.h"
+
+using namespace std;
+
+// sorts the (row, value) pairs of one column and sums duplicate rows
+static void CompressColumn(vector<pair<int,double> > &column)
+{
+  sort(column.begin(), column.end());
+
+  unsigned last = 0;
+  for(unsigned i = 1; i < column.size(); i++)
+  {
+    if(column[i].first == column[last].first)
+      column[last].second += column[i].second;
+    else
+      column[++last] = column[i];
+  }
+  if(column.size() > 0)
+    column.resize(last+1);
+}
+
+mmcSparseMatrix::mmcSparseMatrix(int rows, int columns)
+{
+  if(rows < 0 || columns < 0)
+    throw mmcException(CANNOT_CREATE, __LINE__, "mmcSparseMatrix.cpp");
+
+  NumRows = rows;
+  NumColumns = columns;
+  ColumnStart.assign(columns+1, 0);
+}
+
+mmcSparseMatrix::mmcSparseMatrix(int rows, int columns, const vector<mmcSparseEntry> &entries)
+{
+  if(rows < 0 || columns < 0)
+    throw mmcException(CANNOT_CREATE, __LINE__, "mmcSparseMatrix.cpp");
+
+  NumRows = rows;
+  NumColumns = columns;
+
+  vector<vector<pair<int,double> > > column_entries(columns);
+  for(unsigned i = 0; i < entries.size(); i++)
+  {
+    if(entries[i].row < 0 || entries[i].row >= rows || entries[i].column < 0 || entries[i].column >= columns)
+      throw mmcException(OVERRUN, __LINE__, "mmcSparseMatrix.cpp");
+    column_entries[entries[i].column].push_back(make_pair(entries[i].row, entries[i].value));
+  }
+
+  ColumnStart.reserve(columns+1);
+  ColumnStart.push_back(0);
+  for(int col = 0; col < columns; col++)
+  {
+    CompressColumn(column_entries[col]);
+    for(unsigned i = 0; i < column_entries[col].size(); i++)
+    {
+      RowIndices.push_back(column_entries[col][i].first);
+      Values.push_back(column_entries[col][i].second);
+    }
+    ColumnStart.push_back(RowIndices.size());
+  }
+}
+
+mmcSparseMatrix mmcSparseMatrix::FromCompressedRows(int rows, int columns, const vector<int> &row_start, const vector<int> &column_indices, const vector<double> &values)
+{
+  if((int)row_start.size() != rows+1)
+    throw mmcException(ADD_INCOMPAT, __LINE__, "mmcSparseMatrix.cpp");
+
+  vector<mmcSparseEntry> entries;
+  entries.reserve(values.size());
+  for(int row = 0; row < rows; row++)
+    for(int index = row_start[row]; index < row_start[row+1]; index++)
+      entries.push_back(mmcSparseEntry(row, column_indices[index], values[index]));
+
+  return mmcSparseMatrix(rows, columns, entries);
+}
+
+mmcSparseMatrix mmcSparseMatrix::Identity(int size, double diagonal_value)
+{
+  mmcSparseMatrix result(size, size);
+  result.RowIndices.resize(size);
+  result.Values.assign(size, diagonal_value);
+  for(int i = 0; i < size; i++)
+  {
+    result.RowIndices[i] = i;
+    result.ColumnStart[i+1] = i+1;
+  }
+  return result;
+}
+
+double mmcSparseMatrix::GetElement(int row, int column) const
+{
+  if(row < 0 || row >= NumRows || column < 0 || column >= NumColumns)
+    throw mmcException(OVERRUN, __LINE__, "mmcSparseMatrix.cpp");
+
+  vector<int>::const_iterator begin = RowIndices.begin() + ColumnStart[column];
+  vector<int>::const_iterator end = RowIndices.begin() + ColumnStart[column+1];
+  vector<int>::const_iterator location = lower_bound(begin, end, row);
+  if(location == end || *location != row)
+    return 0.0;
+  return Values[location - RowIndices.begin()];
+}
+
+mmcMatrix mmcSparseMatrix::operator*(const mmcMatrix &x) const
+{
+  if(x.GetNumRows() != NumColumns || x.GetNumColumns() != 1)
+    throw mmcException(MULT_INCOMPAT, __LINE__, "mmcSparseMatrix.cpp");
+
+  mmcMatrix result(NumRows, 1, 0.0);
+  double *result_data = result.GetMatrixData();
+  const double *x_data = x.GetMatrixData();
+  for(int col = 0; col < NumColumns; col++)
+  {
+    double x_col = x_data[col];
+    if(x_col == 0.0)
+      continue;
+    for(int index = ColumnStart[col]; index < ColumnStart[col+1]; index++)
+      result_data[RowIndices[index]] += Values[index]*x_col;
+  }
+  return result;
+}
+
+mmcMatrix mmcSparseMatrix::TransposeMultiply(const mmcMatrix &y) const
+{
+  if(y.GetNumRows() != NumRows || y.GetNumColumns() != 1)
+    throw mmcException(MULT_INCOMPAT, __LINE__, "mmcSparseMatrix.cpp");
+
+  mmcMatrix result(NumColumns, 1, 0.0);
+  double *result_data = result.GetMatrixData();
+  const double *y_data = y.GetMatrixData();
+  for(int col = 0; col < NumColumns; col++)
+  {
+    double sum = 0.0;
+    for(int index = ColumnStart[col]; index < ColumnStart[col+1]; index++)
+      sum += Values[index]*y_data[RowIndices[index]];
+    result_data[col] = sum;
+  }
+  return result;
+}
+
+mmcSparseMatrix mmcSparseMatrix::operator+(const mmcSparseMatrix &rhs) const
+{
+  if(NumRows != rhs.NumRows || NumColumns != rhs.NumColumns)
+    throw mmcException(ADD_INCOMPAT, __LINE__, "mmcSparseMatrix.cpp");
+
+  // merge the sorted row lists of each column
+  mmcSparseMatrix result(NumRows, NumColumns);
+  for(int col = 0; col < NumColumns; col++)
+  {
+    int lhs_index = ColumnStart[col], rhs_index = rhs.ColumnStart[col];
+    while(lhs_index < ColumnStart[col+1] || rhs_index < rhs.ColumnStart[col+1])
+    {
+      int lhs_row = (lhs_index < ColumnStart[col+1]) ? RowIndices[lhs_index] : NumRows;
+      int rhs_row = (rhs_index < rhs.ColumnStart[col+1]) ? rhs.RowIndices[rhs_index] : NumRows;
+      if(lhs_row == rhs_row)
+      {
+        result.RowIndices.push_back(lhs_row);
+        result.Values.push_back(Values[lhs_index++] + rhs.Values[rhs_index++]);
+      } else if(lhs_row < rhs_row) {
+        result.RowIndices.push_back(lhs_row);
+        result.Values.push_back(Values[lhs_index++]);
+      } else {
+        result.RowIndices.push_back(rhs_row);
+        result.Values.push_back(rhs.Values[rhs_index++]);
+      }
+    }
+    result.ColumnStart[col+1] = result.RowIndices.size();
+  }
+  return result;
+}
+
+mmcSparseMatrix mmcSparseMatrix::operator*(const mmcSparseMatrix &rhs) const
+{
+  if(NumColumns != rhs.NumRows)
+    throw mmcException(MULT_INCOMPAT, __LINE__, "mmcSparseMatrix.cpp");
+
+  // column j of the result is the combination of the columns of this matrix selected by column j of rhs
+  mmcSparseMatrix result(NumRows, rhs.NumColumns);
+  vector<int> marker(NumRows, -1);
+  vector<double> accumulator(NumRows, 0.0);
+  vector<int> pattern;
+  for(int col = 0; col < rhs.NumColumns; col++)
+  {
+    pattern.clear();
+    for(int rhs_index = rhs.ColumnStart[col]; rhs_index < rhs.ColumnStart[col+1]; rhs_index++)
+    {
+      int inner = rhs.RowIndices[rhs_index];
+      double scale = rhs.Values[rhs_index];
+      for(int index = ColumnStart[inner]; index < ColumnStart[inner+1]; index++)
+      {
+        int row = RowIndices[index];
+        if(marker[row] != col)
+        {
+          marker[row] = col;
+          accumulator[row] = 0.0;
+          pattern.push_back(row);
+        }
+        accumulator[row] += scale*Values[index];
+      }
+    }
+
+    sort(pattern.begin(), pattern.end());
+    for(unsigned i = 0; i < pattern.size(); i++)
+    {
+      result.RowIndices.push_back(pattern[i]);
+      result.Values.push_back(accumulator[pattern[i]]);
+    }
+    result.ColumnStart[col+1] = result.RowIndices.size();
+  }
+  return result;
+}
+
+mmcSparseMatrix mmcSparseMatrix::GetScaled(double scale_factor) const
+{
+  mmcSparseMatrix result(*this);
+  for(unsigned i = 0; i < result.Values.size(); i++)
+    result.Values[i] *= scale_factor;
+  return result;
+}
+
+mmcSparseMatrix mmcSparseMatrix::GetTranspose() const
+{
+  mmcSparseMatrix result(NumColumns, NumRows);
+
+  // count the entries in each row, these become the columns of the transpose
+  for(unsigned i = 0; i < RowIndices.size(); i++)
+    result.ColumnStart[RowIndices[i]+1]++;
+  for(int row = 0; row < NumRows; row++)
+    result.ColumnStart[row+1] += result.ColumnStart[row];
+
+  // visiting the columns in order leaves the row indices of the transpose sorted
+  vector<int> next(result.ColumnStart.begin(), result.ColumnStart.end()-1);
+  result.RowIndices.resize(RowIndices.size());
+  result.Values.resize(Values.size());
+  for(int col = 0; col < NumColumns; col++)
+    for(int index = ColumnStart[col]; index < ColumnStart[col+1]; index++)
+    {
+      int destination = next[RowIndices[index]]++;
+      result.RowIndices[destination] = col;
+      result.Values[destination] = Values[index];
+    }
+  return result;
+}
+
+mmcSparseMatrix mmcSparseMatrix::GetNormalMatrix(double shift) const
+{
+  // (A^T*A)(:,j) = sum over the rows k of column j of A(k,j)*A(k,:)^T, the rows of A are the columns of A^T
+  mmcSparseMatrix transpose = GetTranspose();
+  mmcSparseMatrix result(NumColumns, NumColumns);
+  vector<int> marker(NumColumns, -1);
+  vector<double> accumulator(NumColumns, 0.0);
+  vector<int> pattern;
+  for(int col = 0; col < NumColumns; col++)
+  {
+    // the diagonal is always stored so that the pattern does not depend on the shift
+    pattern.clear();
+    marker[col] = col;
+    accumulator[col] = shift;
+    pattern.push_back(col);
+
+    for(int index = ColumnStart[col]; index < ColumnStart[col+1]; index++)
+    {
+      int row = RowIndices[index];
+      double scale = Values[index];
+      for(int transpose_index = transpose.ColumnStart[row]; transpose_index < transpose.ColumnStart[row+1]; transpose_index++)
+      {
+        int result_row = transpose.RowIndices[transpose_index];
+        if(marker[result_row] != col)
+        {
+          marker[result_row] = col;
+          accumulator[result_row] = 0.0;
+          pattern.push_back(result_row);
+        }
+        accumulator[result_row] += scale*transpose.Values[transpose_index];
+      }
+    }
+
+    sort(pattern.begin(), pattern.end());
+    for(unsigned i = 0; i < pattern.size(); i++)
+    {
+      result.RowIndices.push_back(pattern[i]);
+      result.Values.push_back(accumulator[pattern[i]]);
+    }
+    result.ColumnStart[col+1] = result.RowIndices.size();
+  }
+  return result;
+}
+
+mmcSparseMatrix mmcSparseMatrix::GetSymmetricPermutation(const vector<int> &permutation) const
+{
+  if(NumRows != NumColumns)
+    throw mmcException(NOT_SQUARE, __LINE__, "mmcSparseMatrix.cpp");
+  if((int)permutation.size() != NumColumns)
+    throw mmcException(ADD_INCOMPAT, __LINE__, "mmcSparseMatrix.cpp");
+
+  vector<int> inverse = mmcInvertPermutation(permutation);
+  vector<mmcSparseEntry> entries;
+  entries.reserve(Values.size());
+  for(int col = 0; col < NumColumns; col++)
+    for(int index = ColumnStart[col]; index < ColumnStart[col+1]; index++)
+      entries.push_back(mmcSparseEntry(inverse[RowIndices[index]], inverse[col], Values[index]));
+
+  return mmcSparseMatrix(NumRows, NumColumns, entries);
+}
+
+mmcSparseMatrix mmcSparseMatrix::GetColumnPermutation(const vector<int> &permutation) const
+{
+  if((int)permutation.size() != NumColumns)
+    throw mmcException(ADD_INCOMPAT, __LINE__, "mmcSparseMatrix.cpp");
+
+  mmcSparseMatrix result(NumRows, NumColumns);
+  result.RowIndices.reserve(RowIndices.size());
+  result.Values.reserve(Values.size());
+  for(int col = 0; col < NumColumns; col++)
+  {
+    int source = permutation[col];
+    result.RowIndices.insert(result.RowIndices.end(), RowIndices.begin() + ColumnStart[source], RowIndices.begin() + ColumnStart[source+1]);
+    result.Values.insert(result.Values.end(), Values.begin() + ColumnStart[source], Values.begin() + ColumnStart[source+1]);
+    result.ColumnStart[col+1] = result.RowIndices.size();
+  }
+  return result;
+}
+
+mmcMatrix mmcSparseMatrix::GetDense() const
+{
+  mmcMatrix result(NumRows, NumColumns, 0.0);
+  for(int col = 0; col < NumColumns; col++)
+    for(int index = ColumnStart[col]; index < ColumnStart[col+1]; index++)
+      result(RowIndices[index], col) = Values[index];
+  return result;
+}
+
+vector<int> mmcInvertPermutation(const vector<int> &permutation)
+{
+  vector<int> inverse(permutation.size());
+  for(unsigned i = 0; i < permutation.size(); i++)
+    inverse[permutation[i]] = i;
+  return inverse;
+}
@@ -0,0 +1,95 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef mmcSparseMatrixH
+#define mmcSparseMatrixH
+
+#include <vector>
+#include "../mmcMatrix/mmcMatrix.h"
+
+// one (row, column, value) entry used to assemble a sparse matrix
+struct mmcSparseEntry
+{
+  mmcSparseEntry(int row_index, int column_index, double entry_value) : row(row_index), column(column_index), value(entry_value) {}
+
+  int row;
+  int column;
+  double value;
+};
+
+// Sparse matrix stored in compressed column (CSC) format. The row indices within each column are sorted and unique.
+// The compressed column storage of A is the compressed row (CSR) storage of A^T, so a CSR matrix is handled by building
+// its transpose with FromCompressedRows and calling GetTranspose when the column form is needed.
+class mmcSparseMatrix
+{
+public:
+  mmcSparseMatrix() {NumRows = 0; NumColumns = 0; ColumnStart.push_back(0);}
+  mmcSparseMatrix(int rows, int columns);  // all zero
+
+  // assembles the matrix from entries in any order, duplicate entries are summed
+  mmcSparseMatrix(int rows, int columns, const std::vector<mmcSparseEntry> &entries);
+
+  // builds the matrix from compressed row arrays (row_start has rows+1 elements), columns within a row may be unsorted or repeated
+  static mmcSparseMatrix FromCompressedRows(int rows, int columns, const std::vector<int> &row_start, const std::vector<int> &column_indices, const std::vector<double> &values);
+
+  static mmcSparseMatrix Identity(int size, double diagonal_value = 1.0);
+
+  int GetNumRows() const {return NumRows;}
+  int GetNumColumns() const {return NumColumns;}
+  int GetNumNonZeros() const {return RowIndices.size();}
+
+  // direct access to the compressed column arrays
+  const std::vector<int> & GetColumnStart() const {return ColumnStart;}
+  const std::vector<int> & GetRowIndices() const {return RowIndices;}
+  const std::vector<double> & GetValues() const {return Values;}
+
+  double GetElement(int row, int column) const;  // binary search within the column, zero if the entry is not stored
+
+  mmcMatrix operator*(const mmcMatrix &x) const;    // returns A*x
+  mmcMatrix TransposeMultiply(const mmcMatrix &y) const;  // returns A^T*y without forming A^T
+  mmcSparseMatrix operator+(const mmcSparseMatrix &rhs) const;
+  mmcSparseMatrix operator*(const mmcSparseMatrix &rhs) const;
+  mmcSparseMatrix GetScaled(double scale_factor) const;
+  mmcSparseMatrix GetTranspose() const;
+
+  // returns A^T*A + shift*I, the normal matrix of a least squares problem with Levenberg-Marquardt damping shift
+  mmcSparseMatrix GetNormalMatrix(double shift = 0.0) const;
+
+  // returns P*A*P^T for a square matrix where new index i is old index permutation[i]
+  mmcSparseMatrix GetSymmetricPermutation(const std::vector<int> &permutation) const;
+
+  // returns A with column j taken from column permutation[j]
+  mmcSparseMatrix GetColumnPermutation(const std::vector<int> &permutation) const;
+
+  mmcMatrix GetDense() const;
+
+private:
+  int NumRows;
+  int NumColumns;
+  std::vector<int> ColumnStart;   // NumColumns+1 elements, column j is stored in [ColumnStart[j], ColumnStart[j+1])
+  std::vector<int> RowIndices;
+  std::vector<double> Values;
+};
+
+// returns the inverse of a permutation vector
+std::vector<int> mmcInvertPermutation(const std::vector<int> &permutation);
+
+#endif //mmcSparseMatrixH
@@ -0,0 +1,236 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <set>
+#include <algorithm>
+#include "mmcSparseOrdering.h"
+
+using namespace std;
+
+// Minimum degree ordering on the quotient graph (see Amestoy, Davis, and Duff, "An approximate minimum degree ordering
+// algorithm", 1996). Each variable keeps its remaining variable neighbors and the elements (eliminated cliques) it
+// belongs to. Eliminating a pivot merges its elements into one new element and the degrees of the variables of that
+// element are updated with the approximate external degree bound instead of the exact degree. Supervariable detection
+// and mass elimination are not done, the matrices assembled from sketches are small enough not to need them.
+static vector<int> QuotientGraphMinimumDegree(vector<vector<int> > &variable_neighbors, vector<vector<int> > &variable_elements, vector<vector<int> > &element_variables)
+{
+  int num_variables = variable_neighbors.size();
+  int num_initial_elements = element_variables.size();
+
+  // the element created by eliminating variable p has index num_initial_elements + p
+  element_variables.resize(num_initial_elements + num_variables);
+  vector<bool> absorbed(element_variables.size(), false);
+  vector<bool> eliminated(num_variables, false);
+  vector<int> external_size(element_variables.size(), 0);  // |L_e \ L_p|, valid for the elements stamped with the current pivot
+  vector<int> element_stamp(element_variables.size(), -1);
+  vector<int> variable_stamp(num_variables, -1);
+
+  vector<int> degree(num_variables);
+  set<pair<int,int> > queue;
+  for(int i = 0; i < num_variables; i++)
+  {
+    degree[i] = variable_neighbors[i].size();
+    for(unsigned index = 0; index < variable_elements[i].size(); index++)
+      degree[i] += element_variables[variable_elements[i][index]].size() - 1;
+    degree[i] = min(degree[i], num_variables - 1);
+    queue.insert(make_pair(degree[i], i));
+  }
+
+  vector<int> permutation;
+  permutation.reserve(num_variables);
+  for(int step = 0; step < num_variables; step++)
+  {
+    int pivot = queue.begin()->second;
+    queue.erase(queue.begin());
+    eliminated[pivot] = true;
+    permutation.push_back(pivot);
+
+    // the new element is the union of the pivot's neighbors and of the variables of its elements, which are absorbed
+    int new_element = num_initial_elements + pivot;
+    vector<int> &pivot_element = element_variables[new_element];
+    variable_stamp[pivot] = step;
+    for(unsigned index = 0; index < variable_neighbors[pivot].size(); index++)
+    {
+      int variable = variable_neighbors[pivot][index];
+      if(!eliminated[variable] && variable_stamp[variable] != step)
+      {
+        variable_stamp[variable] = step;
+        pivot_element.push_back(variable);
+      }
+    }
+    for(unsigned index = 0; index < variable_elements[pivot].size(); index++)
+    {
+      int element = variable_elements[pivot][index];
+      if(absorbed[element])
+        continue;
+      for(unsigned var_index = 0; var_index < element_variables[element].size(); var_index++)
+      {
+        int variable = element_variables[element][var_index];
+        if(!eliminated[variable] && variable_stamp[variable] != step)
+        {
+          variable_stamp[variable] = step;
+          pivot_element.push_back(variable);
+        }
+      }
+      absorbed[element] = true;
+      vector<int>().swap(element_variables[element]);
+    }
+    vector<int>().swap(variable_neighbors[pivot]);
+    vector<int>().swap(variable_elements[pivot]);
+
+    // the neighbors covered by the new element are pruned and the new element replaces the absorbed ones
+    for(unsigned index = 0; index < pivot_element.size(); index++)
+    {
+      int variable = pivot_element[index];
+
+      vector<int> &neighbors = variable_neighbors[variable];
+      unsigned kept = 0;
+      for(unsigned neighbor_index = 0; neighbor_index < neighbors.size(); neighbor_index++)
+        if(!eliminated[neighbors[neighbor_index]] && variable_stamp[neighbors[neighbor_index]] != step)
+          neighbors[kept++] = neighbors[neighbor_index];
+      neighbors.resize(kept);
+
+      vector<int> &elements = variable_elements[variable];
+      kept = 0;
+      for(unsigned element_index = 0; element_index < elements.size(); element_index++)
+        if(!absorbed[elements[element_index]])
+          elements[kept++] = elements[element_index];
+      elements.resize(kept);
+
+      // external size of the other elements of this variable
+      for(unsigned element_index = 0; element_index < elements.size(); element_index++)
+      {
+        int element = elements[element_index];
+        if(element_stamp[element] != step)
+        {
+          element_stamp[element] = step;
+          external_size[element] = element_variables[element].size();
+        }
+        external_size[element]--;
+      }
+    }
+
+    // elements entirely inside the new element are absorbed, then the approximate degrees are updated
+    int remaining = num_variables - step - 1;
+    for(unsigned index = 0; index < pivot_element.size(); index++)
+    {
+      int variable = pivot_element[index];
+      vector<int> &elements = variable_elements[variable];
+      int new_degree = variable_neighbors[variable].size() + pivot_element.size() - 1;
+      unsigned kept = 0;
+      for(unsigned element_index = 0; element_index < elements.size(); element_index++)
+      {
+        int element = elements[element_index];
+        if(external_size[element] == 0)
+        {
+          absorbed[element] = true;
+          vector<int>().swap(element_variables[element]);
+          continue;
+        }
+        new_degree += external_size[element];
+        elements[kept++] = element;
+      }
+      elements.resize(kept);
+      elements.push_back(new_element);
+
+      new_degree = min(new_degree, remaining - 1);
+      queue.erase(make_pair(degree[variable], variable));
+      degree[variable] = new_degree;
+      queue.insert(make_pair(new_degree, variable));
+    }
+  }
+
+  return permutation;
+}
+
+vector<int> mmcApproximateMinimumDegree(const mmcSparseMatrix &matrix)
+{
+  if(matrix.GetNumRows() != matrix.GetNumColumns())
+    throw mmcException(NOT_SQUARE, __LINE__, "mmcSparseOrdering.cpp");
+
+  // neighbor lists of the graph of A+A^T
+  int size = matrix.GetNumColumns();
+  const vector<int> &column_start = matrix.GetColumnStart();
+  const vector<int> &row_indices = matrix.GetRowIndices();
+  vector<vector<int> > variable_neighbors(size);
+  for(int col = 0; col < size; col++)
+    for(int index = column_start[col]; index < column_start[col+1]; index++)
+    {
+      int row = row_indices[index];
+      if(row == col)
+        continue;
+      variable_neighbors[col].push_back(row);
+      variable_neighbors[row].push_back(col);
+    }
+  for(int i = 0; i < size; i++)
+  {
+    sort(variable_neighbors[i].begin(), variable_neighbors[i].end());
+    variable_neighbors[i].erase(unique(variable_neighbors[i].begin(), variable_neighbors[i].end()), variable_neighbors[i].end());
+  }
+
+  vector<vector<int> > variable_elements(size);
+  vector<vector<int> > element_variables;
+  return QuotientGraphMinimumDegree(variable_neighbors, variable_elements, element_variables);
+}
+
+vector<int> mmcColumnApproximateMinimumDegree(const mmcSparseMatrix &matrix)
+{
+  // the columns in each row of A form a clique of A^T*A, each row starts out as an element of the quotient graph
+  int num_columns = matrix.GetNumColumns();
+  mmcSparseMatrix transpose = matrix.GetTranspose();
+  const vector<int> &row_start = transpose.GetColumnStart();
+  const vector<int> &column_indices = transpose.GetRowIndices();
+
+  vector<vector<int> > element_variables(matrix.GetNumRows());
+  vector<vector<int> > variable_elements(num_columns);
+  for(int row = 0; row < matrix.GetNumRows(); row++)
+    for(int index = row_start[row]; index < row_start[row+1]; index++)
+    {
+      element_variables[row].push_back(column_indices[index]);
+      variable_elements[column_indices[index]].push_back(row);
+    }
+
+  vector<vector<int> > variable_neighbors(num_columns);
+  return QuotientGraphMinimumDegree(variable_neighbors, variable_elements, element_variables);
+}
+
+vector<int> mmcEliminationTree(const mmcSparseMatrix &matrix)
+{
+  // Liu's algorithm with path compression through the ancestor array
+  int size = matrix.GetNumColumns();
+  const vector<int> &column_start = matrix.GetColumnStart();
+  const vector<int> &row_indices = matrix.GetRowIndices();
+  vector<int> parent(size, -1);
+  vector<int> ancestor(size, -1);
+  for(int col = 0; col < size; col++)
+    for(int index = column_start[col]; index < column_start[col+1]; index++)
+    {
+      for(int i = row_indices[index]; i != -1 && i < col; )
+      {
+        int next = ancestor[i];
+        ancestor[i] = col;
+        if(next == -1)
+          parent[i] = col;
+        i = next;
+      }
+    }
+  return parent;
+}
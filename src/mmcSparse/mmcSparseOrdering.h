@@ -0,0 +1,40 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef mmcSparseOrderingH
+#define mmcSparseOrderingH
+
+#include <vector>
+#include "mmcSparseMatrix.h"
+
+// Fill reducing orderings. Each returns a permutation where new index i is old index permutation[i].
+
+// approximate minimum degree ordering of a symmetric matrix, only the pattern of A+A^T off of the diagonal is used
+std::vector<int> mmcApproximateMinimumDegree(const mmcSparseMatrix &matrix);
+
+// approximate minimum degree ordering of the columns of A for the factorization of A^T*A (or the QR factorization of A),
+// A^T*A is never formed
+std::vector<int> mmcColumnApproximateMinimumDegree(const mmcSparseMatrix &matrix);
+
+// elimination tree of a symmetric matrix, parent[j] is the parent of column j or -1 for a root, only the upper triangle is used
+std::vector<int> mmcEliminationTree(const mmcSparseMatrix &matrix);
+
+#endif //mmcSparseOrderingH
@@ -0,0 +1,211 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <algorithm>
+#include "mmcSparseQR.h"
+#include "mmcSparseOrdering.h"
+
+using namespace std;
+
+void mmcSparseQR::Analyze(const mmcSparseMatrix &matrix, mmcSparseOrderingMethod ordering)
+{
+  NumRows = matrix.GetNumRows();
+  NumColumns = matrix.GetNumColumns();
+  Factorized = false;
+
+  if(ordering == MMC_AMD_ORDERING)
+    Permutation = mmcColumnApproximateMinimumDegree(matrix);
+  else {
+    Permutation.resize(NumColumns);
+    for(int i = 0; i < NumColumns; i++)
+      Permutation[i] = i;
+  }
+
+  // row j of R has the pattern of column j of the Cholesky factor of P^T*A^T*A*P, the diagonal is always included so
+  // the pattern also covers the damping rows
+  mmcSparseMatrix normal = matrix.GetColumnPermutation(Permutation).GetNormalMatrix(1.0);
+  Parent = mmcEliminationTree(normal);
+
+  const vector<int> &column_start = normal.GetColumnStart();
+  const vector<int> &row_indices = normal.GetRowIndices();
+  vector<vector<int> > row_pattern(NumColumns);
+  vector<int> marker(NumColumns, -1);
+  for(int k = 0; k < NumColumns; k++)
+  {
+    // the nodes reachable in the elimination tree from the entries of column k above the diagonal form row k of L
+    marker[k] = k;
+    row_pattern[k].push_back(k);
+    for(int index = column_start[k]; index < column_start[k+1]; index++)
+      for(int i = row_indices[index]; i < k && marker[i] != k; i = Parent[i])
+      {
+        marker[i] = k;
+        row_pattern[i].push_back(k);
+      }
+  }
+
+  FactorRowStart.assign(NumColumns+1, 0);
+  FactorColumns.clear();
+  for(int row = 0; row < NumColumns; row++)
+  {
+    FactorColumns.insert(FactorColumns.end(), row_pattern[row].begin(), row_pattern[row].end());
+    FactorRowStart[row+1] = FactorColumns.size();
+  }
+  FactorValues.assign(FactorColumns.size(), 0.0);
+}
+
+void mmcSparseQR::Factorize(const mmcSparseMatrix &matrix, double damping)
+{
+  if(matrix.GetNumRows() != NumRows || matrix.GetNumColumns() != NumColumns)
+    throw mmcException(ADD_INCOMPAT, __LINE__, "mmcSparseQR.cpp");
+
+  Factorized = false;
+  Damping = damping;
+  Matrix = matrix.GetColumnPermutation(Permutation);
+  mmcSparseMatrix rows = Matrix.GetTranspose();
+  const vector<int> &row_start = rows.GetColumnStart();
+  const vector<int> &column_indices = rows.GetRowIndices();
+  const vector<double> &values = rows.GetValues();
+
+  fill(FactorValues.begin(), FactorValues.end(), 0.0);
+  vector<bool> row_defined(NumColumns, false);
+  vector<double> work(NumColumns, 0.0);
+
+  // each row is rotated into R starting at its first column and following the elimination tree, its pattern is always
+  // contained in the pattern of the row of R it is rotated with
+  double damping_root = sqrt(damping);
+  int num_rows = NumRows + (damping > 0.0 ? NumColumns : 0);
+  for(int row = 0; row < num_rows; row++)
+  {
+    int k;
+    if(row < NumRows)
+    {
+      if(row_start[row] == row_start[row+1])
+        continue;
+      k = NumColumns;
+      for(int index = row_start[row]; index < row_start[row+1]; index++)
+      {
+        work[column_indices[index]] = values[index];
+        k = min(k, column_indices[index]);
+      }
+    } else {
+      k = row - NumRows;
+      work[k] = damping_root;
+    }
+
+    for(; k != -1; k = Parent[k])
+    {
+      if(work[k] == 0.0)
+        continue;
+
+      int begin = FactorRowStart[k], end = FactorRowStart[k+1];
+      if(!row_defined[k])
+      {
+        for(int index = begin; index < end; index++)
+        {
+          FactorValues[index] = work[FactorColumns[index]];
+          work[FactorColumns[index]] = 0.0;
+        }
+        row_defined[k] = true;
+        break;
+      }
+
+      // the rotation is computed from the ratio of a and b so that a*a + b*b cannot underflow or overflow
+      double a = FactorValues[begin];
+      double b = work[k];
+      double c, s;
+      if(fabs(b) > fabs(a))
+      {
+        double ratio = a/b;
+        s = 1.0/sqrt(1.0 + ratio*ratio);
+        if(b < 0.0)
+          s = -s;
+        c = s*ratio;
+      } else {
+        double ratio = b/a;
+        c = 1.0/sqrt(1.0 + ratio*ratio);
+        if(a < 0.0)
+          c = -c;
+        s = c*ratio;
+      }
+      for(int index = begin; index < end; index++)
+      {
+        int col = FactorColumns[index];
+        double r_value = FactorValues[index];
+        FactorValues[index] = c*r_value + s*work[col];
+        work[col] = -s*r_value + c*work[col];
+      }
+      work[k] = 0.0;
+    }
+  }
+
+  Factorized = true;
+}
+
+void mmcSparseQR::SolveFactor(vector<double> &work) const
+{
+  // R^T*y = work
+  for(int row = 0; row < NumColumns; row++)
+  {
+    double diagonal = FactorValues[FactorRowStart[row]];
+    if(diagonal == 0.0)
+      throw mmcException(SINGULAR, __LINE__, "mmcSparseQR.cpp");
+    work[row] /= diagonal;
+    for(int index = FactorRowStart[row] + 1; index < FactorRowStart[row+1]; index++)
+      work[FactorColumns[index]] -= FactorValues[index]*work[row];
+  }
+
+  // R*x = y
+  for(int row = NumColumns-1; row >= 0; row--)
+  {
+    for(int index = FactorRowStart[row] + 1; index < FactorRowStart[row+1]; index++)
+      work[row] -= FactorValues[index]*work[FactorColumns[index]];
+    work[row] /= FactorValues[FactorRowStart[row]];
+  }
+}
+
+mmcMatrix mmcSparseQR::Solve(const mmcMatrix &rhs) const
+{
+  if(!Factorized)
+    throw mmcException(SIZE_ZERO, __LINE__, "mmcSparseQR.cpp");
+  if(rhs.GetNumRows() != NumRows || rhs.GetNumColumns() != 1)
+    throw mmcException(MULT_INCOMPAT, __LINE__, "mmcSparseQR.cpp");
+
+  // x = (R^T*R)^-1 * A^T*b
+  mmcMatrix normal_rhs = Matrix.TransposeMultiply(rhs);
+  vector<double> solution(normal_rhs.GetMatrixData(), normal_rhs.GetMatrixData() + NumColumns);
+  SolveFactor(solution);
+
+  // one step of refinement with the residual of the damped problem, A^T*(b - A*x) - damping*x
+  mmcMatrix x(NumColumns, 1);
+  for(int i = 0; i < NumColumns; i++)
+    x(i,0) = solution[i];
+  mmcMatrix residual = rhs - Matrix*x;
+  mmcMatrix correction_rhs = Matrix.TransposeMultiply(residual);
+  vector<double> correction(correction_rhs.GetMatrixData(), correction_rhs.GetMatrixData() + NumColumns);
+  for(int i = 0; i < NumColumns; i++)
+    correction[i] -= Damping*solution[i];
+  SolveFactor(correction);
+
+  mmcMatrix result(NumColumns, 1);
+  for(int i = 0; i < NumColumns; i++)
+    result(Permutation[i],0) = solution[i] + correction[i];
+  return result;
+}
@@ -0,0 +1,67 @@
+/*
+Copyright (c) 2006-2014, Michael Greminger
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF A
+DVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef mmcSparseQRH
+#define mmcSparseQRH
+
+#include <vector>
+#include "mmcSparseMatrix.h"
+#include "mmcSparseCholesky.h"
+
+// Sparse QR factorization A*P = Q*R of an m x n matrix with m >= n for least squares problems, min |A*x - b|^2 + damping*|x|^2.
+// The rows of A (and the rows sqrt(damping)*I) are merged into R one at a time with Givens rotations (George and Heath),
+// R has the structure of the Cholesky factor of P^T*A^T*A*P which is found by Analyze. Q is not stored, the least
+// squares solution is found from the corrected semi-normal equations R^T*R*x = A^T*b followed by one step of refinement.
+class mmcSparseQR
+{
+public:
+  mmcSparseQR() {NumRows = 0; NumColumns = 0; Damping = 0.0; Factorized = false;}
+  mmcSparseQR(const mmcSparseMatrix &matrix, double damping = 0.0, mmcSparseOrderingMethod ordering = MMC_AMD_ORDERING) {Analyze(matrix, ordering); Factorize(matrix, damping);}
+
+  // symbolic analysis, only the pattern of the matrix is used
+  void Analyze(const mmcSparseMatrix &matrix, mmcSparseOrderingMethod ordering = MMC_AMD_ORDERING);
+
+  // numeric factorization, the pattern must match the one given to Analyze
+  void Factorize(const mmcSparseMatrix &matrix, double damping = 0.0);
+
+  // returns the least squares solution, throws mmcException(SINGULAR) if R has a zero on the diagonal (a rank deficient
+  // matrix without damping)
+  mmcMatrix Solve(const mmcMatrix &rhs) const;
+
+  int GetNumFactorNonZeros() const {return FactorColumns.size();}  // number of entries of R including the diagonal
+  const std::vector<int> & GetPermutation() const {return Permutation;}
+
+private:
+  void SolveFactor(std::vector<double> &work) const;  // R^T*R*work = work, in the permuted ordering
+
+  int NumRows;
+  int NumColumns;
+  double Damping;
+  bool Factorized;
+  mmcSparseMatrix Matrix;            // A*P, kept for the refinement step
+  std::vector<int> Permutation;
+  std::vector<int> Parent;           // elimination tree of P^T*A^T*A*P
+  std::vector<int> FactorRowStart;   // R is stored by rows, the diagonal is the first entry of each row
+  std::vector<int> FactorColumns;
+  std::vector<double> FactorValues;
+};
+
+#endif //mmcSparseQRH